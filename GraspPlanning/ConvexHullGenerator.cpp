@@ -19,13 +19,15 @@ namespace GraspStudio
 {
     boost::mutex ConvexHullGenerator::qhull_mutex;
 
-    bool ConvexHullGenerator::ConvertPoints(std::vector<Eigen::Vector3f>& points, double* storePointsQHull, bool lockMutex)
-    {
-        if (lockMutex)
-        {
-            qhull_mutex.lock();
-        }
+#if qh_THREADSAFE
+    // the qhull globals are thread local (see qh_THREADLOCAL in user.h), so independent threads do not need to be serialized
+    static const bool qhullNeedsLock = false;
+#else
+    static const bool qhullNeedsLock = true;
+#endif
 
+    bool ConvexHullGenerator::ConvertPoints(std::vector<Eigen::Vector3f>& points, double* storePointsQHull)
+    {
         for (int i = 0; i < (int)points.size(); i++)
         {
             storePointsQHull[i * 3 + 0] = points[i][0];
@@ -33,21 +35,11 @@ namespace GraspStudio
             storePointsQHull[i * 3 + 2] = points[i][2];
         }
 
-        if (lockMutex)
-        {
-            qhull_mutex.unlock();
-        }
-
         return true;
     }
 
-    bool ConvexHullGenerator::ConvertPoints(std::vector<ContactPoint>& points, double* storePointsQHull, bool lockMutex)
+    bool ConvexHullGenerator::ConvertPoints(std::vector<ContactPoint>& points, double* storePointsQHull)
     {
-        if (lockMutex)
-        {
-            qhull_mutex.lock();
-        }
-
         for (int i = 0; i < (int)points.size(); i++)
         {
             storePointsQHull[i * 6 + 0] = points[i].p[0];
@@ -58,17 +50,14 @@ namespace GraspStudio
             storePointsQHull[i * 6 + 5] = points[i].n[2];
         }
 
-        if (lockMutex)
-        {
-            qhull_mutex.unlock();
-        }
-
         return true;
     }
 
 
     VirtualRobot::MathTools::ConvexHull3DPtr ConvexHullGenerator::CreateConvexHull(VirtualRobot::TriMeshModelPtr pointsInput, bool lockMutex /*= true*/)
     {
+        lockMutex = lockMutex && qhullNeedsLock;
+
         if (lockMutex)
         {
             qhull_mutex.lock();
@@ -88,6 +77,8 @@ namespace GraspStudio
 
     VirtualRobot::MathTools::ConvexHull3DPtr ConvexHullGenerator::CreateConvexHull(std::vector<Eigen::Vector3f>& pointsInput, bool lockMutex /*= true*/)
     {
+        lockMutex = lockMutex && qhullNeedsLock;
+
         if (lockMutex)
         {
             qhull_mutex.lock();
@@ -143,7 +134,7 @@ namespace GraspStudio
 #endif
 
         //cout << "QHULL input: nVertices: " << pointsInput.size() << endl;
-        ConvertPoints(pointsInput, points, false);
+        ConvertPoints(pointsInput, points);
         /*for (i=numpoints; i--; )
         rows[i]= points+dim*i;
         qh_printmatrix (outfile, "input", rows, numpoints, dim);*/
@@ -278,6 +269,8 @@ namespace GraspStudio
 
     VirtualRobot::MathTools::ConvexHull6DPtr ConvexHullGenerator::CreateConvexHull(std::vector<ContactPoint>& pointsInput, bool lockMutex)
     {
+        lockMutex = lockMutex && qhullNeedsLock;
+
         if (lockMutex)
         {
             qhull_mutex.lock();
@@ -336,7 +329,7 @@ namespace GraspStudio
 
         //cout << "QHULL input: nVertices: " << pointsInput.size() << endl;
         //printVertices(pointsInput);
-        ConvertPoints(pointsInput, points, false);
+        ConvertPoints(pointsInput, points);
         exitcode = qh_new_qhull(dim, numpoints, points, ismalloc,
                                 flags, outfile, errfile);
 
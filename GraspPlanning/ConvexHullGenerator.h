@@ -35,6 +35,9 @@ namespace GraspStudio
     * A convex hull can be generated out of point arrays.
     * This class is thread safe, which means that multiple threads
     * are allowed to use the static methods of ConvexHullGenerator.
+    * The bundled qhull keeps its global state in thread local storage (qh_THREADLOCAL),
+    * hence hulls are computed concurrently. Only if the compiler does not support
+    * thread local storage, all calls are serialized with qhull_mutex.
     */
     class GRASPSTUDIO_IMPORT_EXPORT ConvexHullGenerator
     {
@@ -50,17 +53,17 @@ namespace GraspStudio
         static void PrintStatistics(VirtualRobot::MathTools::ConvexHull6DPtr convHull);
 
         /*!
-            Convert points to qhull format
+            Convert points to qhull format.
         */
-        static bool ConvertPoints(std::vector<Eigen::Vector3f>& points, double* storePointsQHull, bool lockMutex = true);
-        static bool ConvertPoints(std::vector<VirtualRobot::MathTools::ContactPoint>& points, double* storePointsQHull, bool lockMutex = true);
+        static bool ConvertPoints(std::vector<Eigen::Vector3f>& points, double* storePointsQHull);
+        static bool ConvertPoints(std::vector<VirtualRobot::MathTools::ContactPoint>& points, double* storePointsQHull);
 
         static void PrintVertices(std::vector<VirtualRobot::MathTools::ContactPoint>& pointsInput);
 
         static bool checkVerticeOrientation(const Eigen::Vector3f& v1, const Eigen::Vector3f& v2, const Eigen::Vector3f& v3, const Eigen::Vector3f& n);
 
     protected:
-        //! QHull is not thread safe, so protect qHull calls with a mutex
+        //! Protects the qhull calls when qhull is built without thread local storage (qh_THREADSAFE == 0)
         static boost::mutex qhull_mutex;
     };
 
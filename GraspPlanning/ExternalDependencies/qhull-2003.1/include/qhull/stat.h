@@ -479,10 +479,10 @@ union intrealT
 typedef struct qhstatT qhstatT;
 #if qh_QHpointer
 #define qhstat qh_qhstat->
-extern qhstatT* qh_qhstat;
+extern qh_THREADLOCAL qhstatT* qh_qhstat;
 #else
 #define qhstat qh_qhstat.
-extern qhstatT qh_qhstat;
+extern qh_THREADLOCAL qhstatT qh_qhstat;
 #endif
 struct qhstatT
 {
@@ -530,6 +530,34 @@ qh_freeqhull(!qh_ALL);  /* frees long memory used by second call */
 qh_memfreeshort(&curlong, &totlong);   /* frees short memory and memory allocator */
 #endif
 
+/*-<a                             href="qh-user.htm#TOC"
+  >--------------------------------</a><a name="THREADlocal">-</a>
+
+  qh_THREADLOCAL
+    storage class of the global data structures qh_qh, qh_qhstat, qhmem
+    and of the seed of qh_rand()
+
+  qh_THREADSAFE = 1     every thread has its own instance of the globals,
+                        hence independent threads may call qh_new_qhull()
+                        concurrently (without qh_save_qhull/qh_restore_qhull)
+                = 0     the compiler does not support thread local storage,
+                        calls to qhull have to be serialized by the caller
+
+  notes:
+    Simox extension, not part of the original qhull distribution.
+    A hull and its facets must be used and freed by the thread that created it.
+*/
+#if defined(_MSC_VER)
+#define qh_THREADLOCAL __declspec(thread)
+#define qh_THREADSAFE 1
+#elif defined(__GNUC__) || defined(__clang__)
+#define qh_THREADLOCAL __thread
+#define qh_THREADSAFE 1
+#else
+#define qh_THREADLOCAL
+#define qh_THREADSAFE 0
+#endif
+
 /*-<a                             href="qh-user.htm#TOC"
   >--------------------------------</a><a name="QUICKhelp">-</a>
 
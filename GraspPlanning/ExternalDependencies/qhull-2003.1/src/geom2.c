@@ -1561,7 +1561,7 @@ void qh_projectpoints (signed char *project, int n, realT *points,
        this is silently enforced by qh_srand()
     can make 'Rn' much faster by moving qh_rand to qh_distplane
 */
-int qh_rand_seed= 1;  /* define as global variable instead of using qh */
+qh_THREADLOCAL int qh_rand_seed= 1;  /* define as global variable instead of using qh */
 
 int qh_rand( void) {
 #define qh_rand_a 16807
@@ -47,7 +47,7 @@ void    qh_errexit(int exitcode, facetT *, ridgeT *);
     see mem.h for definition
 */
 
-qhmemT qhmem;
+qh_THREADLOCAL qhmemT qhmem;
 /*= {0};
 / * remove "= {0}" if this causes a compiler error */
 
@@ -17,6 +17,8 @@
 #ifndef qhDEFmem
 #define qhDEFmem
 
+#include "user.h"  /* qh_THREADLOCAL */
+
 /*-<a                             href="qh-mem.htm#TOC"
   >-------------------------------</a><a name="NOmem">-</a>
 
@@ -80,7 +82,7 @@ typedef unsigned long ptr_intT;
    contents of qhmem.
 */
 typedef struct qhmemT qhmemT;
-extern qhmemT qhmem;
+extern qh_THREADLOCAL qhmemT qhmem;
 
 struct qhmemT                 /* global memory management variables */
 {
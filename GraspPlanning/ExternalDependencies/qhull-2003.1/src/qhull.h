@@ -381,10 +381,10 @@ struct vertexT
 typedef struct qhT qhT;
 #if qh_QHpointer
 #define qh qh_qh->
-extern qhT* qh_qh;     /* allocated in global.c */
+extern qh_THREADLOCAL qhT* qh_qh;     /* allocated in global.c */
 #else
 #define qh qh_qh.
-extern qhT qh_qh;
+extern qh_THREADLOCAL qhT qh_qh;
 #endif
 
 struct qhT
@@ -14,9 +14,9 @@
 /*============ global data structure ==========*/
 
 #if qh_QHpointer
-qhstatT *qh_qhstat=NULL;  /* global data structure */
+qh_THREADLOCAL qhstatT *qh_qhstat=NULL;  /* global data structure */
 #else
-qhstatT qh_qhstat;   /* add "={0}" if this causes a compiler error */
+qh_THREADLOCAL qhstatT qh_qhstat;   /* add "={0}" if this causes a compiler error */
 #endif
 
 /*========== functions in alphabetic order ================*/
@@ -3,17 +3,51 @@
 #include <VirtualRobot/Robot.h>
 #include <VirtualRobot/RobotConfig.h>
 #include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/CollisionDetection/CollisionChecker.h>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 #include "../GraspQuality/GraspQualityMeasureWrenchSpace.h"
 #include "../GraspQuality/GraspQualityMeasure.h"
 #include "../ApproachMovementGenerator.h"
 
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <Eigen/StdVector>
+
 using namespace std;
 
 namespace GraspStudio
 {
 
+    /*!
+        A grasp hypothesis of planParallel(): the input (global pose and joint values of the EEF robot) and the result of the evaluation.
+        The global pose of the robot is stored instead of the GCP pose, since setGlobalPoseForRobotNode() depends on the previous pose of the
+        robot and the evaluation would not be reproducible in the worker threads.
+    */
+    struct GraspHypothesis
+    {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        bool valid;
+        Eigen::Matrix4f robotPose;
+        std::vector<float> jointValues;
+
+        bool success;
+        float score;
+        Eigen::Matrix4f objectPoseTCP;
+        std::map< std::string, float > configValues;
+    };
+
+    struct GenericGraspPlanner::EvaluationBatch
+    {
+        boost::mutex mutex;
+        size_t nextHypothesis;
+        std::vector< GraspHypothesis, Eigen::aligned_allocator<GraspHypothesis> > hypotheses;
+    };
+
 
     GenericGraspPlanner::GenericGraspPlanner(VirtualRobot::GraspSetPtr graspSet, GraspStudio::GraspQualityMeasurePtr graspQuality, GraspStudio::ApproachMovementGeneratorPtr approach, float minQuality, bool forceClosure)
         : GraspPlanner(graspSet), graspQuality(graspQuality), approach(approach), minQuality(minQuality), forceClosure(forceClosure)
@@ -76,11 +110,6 @@ namespace GraspStudio
 
     VirtualRobot::GraspPtr GenericGraspPlanner::planGrasp()
     {
-
-        std::string sGraspPlanner("Simox - GraspStudio - ");
-        sGraspPlanner += graspQuality->getName();
-        std::string sGraspNameBase = "Grasp ";
-
         VirtualRobot::RobotPtr robot = approach->getEEFOriginal()->getRobot();
         VirtualRobot::RobotNodePtr tcp = eef->getTcp();
 
@@ -95,51 +124,254 @@ namespace GraspStudio
             return VirtualRobot::GraspPtr();
         }
 
+        float score;
+
+        if (!evaluateGrasp(eef, object, graspQuality, score, verbose))
+        {
+            return VirtualRobot::GraspPtr();
+        }
+
+        Eigen::Matrix4f objP = object->getGlobalPose();
+        Eigen::Matrix4f pLocal = tcp->toLocalCoordinateSystem(objP);
+        // set joint config
+        VirtualRobot::RobotConfigPtr config = eef->getConfiguration();
+        std::map< std::string, float > configValues = config->getRobotNodeJointValueMap();
+        return createGrasp(pLocal, score, configValues);
+    }
+
+    bool GenericGraspPlanner::evaluateGrasp(VirtualRobot::EndEffectorPtr eef, VirtualRobot::SceneObjectPtr object, GraspStudio::GraspQualityMeasurePtr quality, float& storeScore, bool printInfo)
+    {
         VirtualRobot::EndEffector::ContactInfoVector contacts;
         contacts = eef->closeActors(object);
 
         if (contacts.size() < 2)
         {
-            if (verbose)
+            if (printInfo)
             {
                 GRASPSTUDIO_INFO << ": ignoring grasp hypothesis, low number of contacts" << endl;
             }
 
-            return VirtualRobot::GraspPtr();
+            return false;
         }
 
-        graspQuality->setContactPoints(contacts);
-        float score = graspQuality->getGraspQuality();
+        quality->setContactPoints(contacts);
+        float score = quality->getGraspQuality();
 
         if (score < minQuality)
         {
-            return VirtualRobot::GraspPtr();
+            return false;
         }
 
-        if (forceClosure && !graspQuality->isGraspForceClosure())
+        if (forceClosure && !quality->isGraspForceClosure())
         {
-            return VirtualRobot::GraspPtr();
+            return false;
         }
 
         // found valid grasp
-        if (verbose)
+        if (printInfo)
         {
             GRASPSTUDIO_INFO << ": Found grasp with " << contacts.size() << " contacts, score: " << score << endl;
         }
 
+        storeScore = score;
+        return true;
+    }
+
+    VirtualRobot::GraspPtr GenericGraspPlanner::createGrasp(const Eigen::Matrix4f& objectPoseTCP, float score, std::map< std::string, float >& configValues)
+    {
+        std::string sGraspPlanner("Simox - GraspStudio - ");
+        sGraspPlanner += graspQuality->getName();
+        std::string sGraspNameBase = "Grasp ";
+        VirtualRobot::RobotPtr robot = approach->getEEFOriginal()->getRobot();
+
         std::stringstream ss;
         ss << sGraspNameBase << (graspSet->getSize() + 1);
         std::string sGraspName = ss.str();
-        Eigen::Matrix4f objP = object->getGlobalPose();
-        Eigen::Matrix4f pLocal = tcp->toLocalCoordinateSystem(objP);
-        VirtualRobot::GraspPtr g(new VirtualRobot::Grasp(sGraspName, robot->getType(), eef->getName(), pLocal, sGraspPlanner, score));
-        // set joint config
-        VirtualRobot::RobotConfigPtr config = eef->getConfiguration();
-        std::map< std::string, float > configValues = config->getRobotNodeJointValueMap();
+        VirtualRobot::GraspPtr g(new VirtualRobot::Grasp(sGraspName, robot->getType(), eef->getName(), objectPoseTCP, sGraspPlanner, score));
         g->setConfiguration(configValues);
         return g;
     }
 
+    int GenericGraspPlanner::planParallel(int nrGrasps, int timeOutMS, unsigned int numThreads, unsigned int batchSize)
+    {
+        boost::posix_time::ptime deadline = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(timeOutMS);
+
+        if (numThreads == 0)
+        {
+            numThreads = std::max(1u, boost::thread::hardware_concurrency());
+        }
+
+        if (batchSize == 0)
+        {
+            batchSize = 4 * numThreads;
+        }
+
+        numThreads = std::min(numThreads, batchSize);
+
+        if (verbose)
+        {
+            GRASPSTUDIO_INFO << ": Searching " << nrGrasps << " grasps for EEF:" << approach->getEEF()->getName() << " and object:" << graspQuality->getObject()->getName() << " with " << numThreads << " threads.\n";
+            GRASPSTUDIO_INFO << ": Approach movements are generated with " << approach->getName() << endl;
+            GRASPSTUDIO_INFO << ": Grasps are evaluated with " << graspQuality->getName() << endl;
+        }
+
+        // the object properties are computed once and copied to the clones of the quality measure
+        graspQuality->calculateObjectProperties();
+
+        VirtualRobot::RobotPtr eefRobot = approach->getEEFRobotClone();
+        std::vector<VirtualRobot::RobotNodePtr> robotNodes = eefRobot->getRobotNodes();
+
+        // setup the workers: the cloning reads the original data, so this is done sequentially
+        std::vector<EvaluationThreadData> threadData(numThreads);
+
+        for (unsigned int t = 0; t < numThreads; t++)
+        {
+            EvaluationThreadData& d = threadData[t];
+            VirtualRobot::CollisionCheckerPtr colChecker(new VirtualRobot::CollisionChecker());
+            std::stringstream ss;
+            ss << eefRobot->getName() << "_grasp_thread_" << t;
+            d.eefRobot = eefRobot->clone(ss.str(), colChecker);
+            d.eefRobot->setUpdateVisualization(false);
+            d.robotNodes = d.eefRobot->getRobotNodes();
+            THROW_VR_EXCEPTION_IF(d.robotNodes.size() != robotNodes.size(), "Could not clone EEF robot " << eefRobot->getName());
+            d.eef = d.eefRobot->getEndEffector(eef->getName());
+            THROW_VR_EXCEPTION_IF(!d.eef || !d.eef->getGCP() || !d.eef->getTcp(), "Could not clone EEF " << eef->getName());
+            d.object = object->clone(object->getName(), colChecker);
+            d.object->setUpdateVisualization(false);
+            d.graspQuality = graspQuality->clone(d.object);
+
+            if (!d.graspQuality)
+            {
+                GRASPSTUDIO_WARNING << ": Grasp quality measure " << graspQuality->getName() << " can not be cloned, planning sequentially" << endl;
+                return plan(nrGrasps, timeOutMS);
+            }
+
+            d.graspQuality->setVerbose(false);
+            d.error = false;
+        }
+
+        EvaluationBatch batch;
+        batch.hypotheses.resize(batchSize);
+
+        int nLoop = 0;
+        int nGraspsCreated = 0;
+
+        while (nGraspsCreated < nrGrasps && (timeOutMS <= 0 || boost::posix_time::microsec_clock::universal_time() < deadline))
+        {
+            // the hypotheses are generated sequentially: the random numbers are drawn in the same order as in plan()
+            for (unsigned int i = 0; i < batchSize; i++)
+            {
+                GraspHypothesis& h = batch.hypotheses[i];
+                h.valid = approach->setEEFToRandomApproachPose();
+                h.success = false;
+
+                if (h.valid)
+                {
+                    h.robotPose = eefRobot->getGlobalPose();
+                    h.jointValues.resize(robotNodes.size());
+
+                    for (size_t j = 0; j < robotNodes.size(); j++)
+                    {
+                        h.jointValues[j] = robotNodes[j]->getJointValue();
+                    }
+                }
+            }
+
+            batch.nextHypothesis = 0;
+            boost::thread_group threads;
+
+            for (unsigned int t = 0; t < numThreads; t++)
+            {
+                threads.create_thread(boost::bind(&GenericGraspPlanner::evaluateBatchThread, this, &threadData[t], &batch));
+            }
+
+            threads.join_all();
+
+            for (unsigned int t = 0; t < numThreads; t++)
+            {
+                THROW_VR_EXCEPTION_IF(threadData[t].error, "Error while evaluating grasps in worker thread " << t);
+            }
+
+            // merge in the order of generation
+            for (unsigned int i = 0; i < batchSize && nGraspsCreated < nrGrasps; i++)
+            {
+                nLoop++;
+                GraspHypothesis& h = batch.hypotheses[i];
+
+                if (!h.success)
+                {
+                    continue;
+                }
+
+                if (verbose)
+                {
+                    GRASPSTUDIO_INFO << ": Found grasp with score: " << h.score << endl;
+                }
+
+                VirtualRobot::GraspPtr g = createGrasp(h.objectPoseTCP, h.score, h.configValues);
+                graspSet->addGrasp(g);
+                plannedGrasps.push_back(g);
+                nGraspsCreated++;
+            }
+        }
+
+        if (verbose)
+        {
+            GRASPSTUDIO_INFO << ": created " << nGraspsCreated << " valid grasps in " << nLoop << " loops" << endl;
+        }
+
+        return nGraspsCreated;
+    }
+
+    void GenericGraspPlanner::evaluateBatchThread(EvaluationThreadData* threadData, EvaluationBatch* batch)
+    {
+        VR_ASSERT(threadData && batch);
+
+        try
+        {
+            VirtualRobot::RobotNodePtr tcp = threadData->eef->getTcp();
+
+            while (true)
+            {
+                size_t index;
+
+                {
+                    boost::mutex::scoped_lock lock(batch->mutex);
+
+                    if (batch->nextHypothesis >= batch->hypotheses.size())
+                    {
+                        break;
+                    }
+
+                    index = batch->nextHypothesis++;
+                }
+
+                GraspHypothesis& h = batch->hypotheses[index];
+
+                if (!h.valid)
+                {
+                    continue;
+                }
+
+                threadData->eefRobot->setJointValues(threadData->robotNodes, h.jointValues);
+                threadData->eefRobot->setGlobalPose(h.robotPose);
+
+                if (!evaluateGrasp(threadData->eef, threadData->object, threadData->graspQuality, h.score, false))
+                {
+                    continue;
+                }
+
+                h.objectPoseTCP = tcp->toLocalCoordinateSystem(threadData->object->getGlobalPose());
+                h.configValues = threadData->eef->getConfiguration()->getRobotNodeJointValueMap();
+                h.success = true;
+            }
+        }
+        catch (...)
+        {
+            threadData->error = true;
+        }
+    }
+
     bool GenericGraspPlanner::timeout()
     {
         if (timeOutMS <= 0)
@@ -62,6 +62,22 @@ namespace GraspStudio
         */
         virtual int plan(int nrGrasps, int timeOutMS = 0);
 
+        /*!
+            Creates new grasps with multiple threads.
+            The grasp hypotheses (approach poses) are generated in batches by the approach movement generator and evaluated in parallel:
+            Each worker thread closes its own clone of the EEF on its own clone of the object (with its own collision checker) and scores
+            the contacts with its own clone of the grasp quality measure (\see GraspQualityMeasure::clone()).
+            The results of a batch are added to the GraspSet in the order in which the hypotheses were generated. Hence, without a time out,
+            the planned grasps do not depend on the number of threads or the batch size. If the object properties of the grasp quality measure
+            have been calculated before, the result is identical to the result of plan() with the same random seed.
+            If the grasp quality measure does not support cloning, the grasps are planned sequentially with plan().
+            \param nrGrasps The number of grasps to be planned.
+            \param timeOutMS The time out in milliseconds (wall time). No further batches are started when this time is exceeded. Disabled when zero.
+            \param numThreads The number of worker threads. If 0, the number of hardware threads is used.
+            \param batchSize The number of hypotheses that are generated and evaluated at once. If 0, four hypotheses per thread are used.
+            \return Number of generated grasps.
+        */
+        virtual int planParallel(int nrGrasps, int timeOutMS = 0, unsigned int numThreads = 0, unsigned int batchSize = 0);
 
     protected:
 
@@ -69,6 +85,32 @@ namespace GraspStudio
 
         VirtualRobot::GraspPtr planGrasp();
 
+        /*!
+            Closes the actors of eef on object and checks the resulting contacts with quality.
+            \return true if a valid grasp was found. In this case, the score is stored.
+        */
+        bool evaluateGrasp(VirtualRobot::EndEffectorPtr eef, VirtualRobot::SceneObjectPtr object, GraspStudio::GraspQualityMeasurePtr quality, float& storeScore, bool printInfo);
+
+        //! Creates a grasp with the given pose of the object relative to the TCP (the name is derived from the size of the graspSet).
+        VirtualRobot::GraspPtr createGrasp(const Eigen::Matrix4f& objectPoseTCP, float score, std::map< std::string, float >& configValues);
+
+        //! Data of one worker thread of planParallel()
+        struct EvaluationThreadData
+        {
+            VirtualRobot::RobotPtr eefRobot;
+            std::vector<VirtualRobot::RobotNodePtr> robotNodes;
+            VirtualRobot::EndEffectorPtr eef;
+            VirtualRobot::SceneObjectPtr object;
+            GraspStudio::GraspQualityMeasurePtr graspQuality;
+            bool error;
+        };
+
+        //! The hypotheses of a batch that are shared by the worker threads of planParallel() (defined in GenericGraspPlanner.cpp)
+        struct EvaluationBatch;
+
+        //! Thread method of planParallel(). Evaluates hypotheses of the batch until all are done.
+        void evaluateBatchThread(EvaluationThreadData* threadData, EvaluationBatch* batch);
+
         VirtualRobot::SceneObjectPtr object;
         VirtualRobot::EndEffectorPtr eef;
 
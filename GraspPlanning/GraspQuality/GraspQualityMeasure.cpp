@@ -33,6 +33,11 @@ namespace GraspStudio
     {
     }
 
+    GraspQualityMeasurePtr GraspQualityMeasure::clone(VirtualRobot::SceneObjectPtr newObject)
+    {
+        return GraspQualityMeasurePtr();
+    }
+
     bool GraspQualityMeasure::sampleObjectPoints(int nMaxFaces)
     {
         sampledObjectPoints.clear();
@@ -67,6 +67,16 @@ namespace GraspStudio
         virtual bool isValid();
 
         virtual ContactConeGeneratorPtr getConeGenerator();
+
+        /*!
+            Creates a copy of this measure (with all parameters and the already calculated object properties) that operates on newObject,
+            which is usually a clone of the object (e.g. with another collision checker).
+            Since a measure stores the contact points and intermediate results, it must not be used by multiple threads in parallel.
+            Instead, each thread should operate on its own clone.
+            \return The clone or an empty pointer if cloning is not supported by this measure.
+        */
+        virtual GraspQualityMeasurePtr clone(VirtualRobot::SceneObjectPtr newObject);
+
     protected:
 
         //Methods
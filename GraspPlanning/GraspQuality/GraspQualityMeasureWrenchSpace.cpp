@@ -42,6 +42,23 @@ namespace GraspStudio
     {
     }
 
+    GraspQualityMeasurePtr GraspQualityMeasureWrenchSpace::clone(VirtualRobot::SceneObjectPtr newObject)
+    {
+        boost::shared_ptr<GraspQualityMeasureWrenchSpace> m(new GraspQualityMeasureWrenchSpace(newObject, unitForce, frictionCoeff, frictionConeSamples));
+        m->verbose = verbose;
+        m->maxContacts = maxContacts;
+        m->sampledObjectPoints = sampledObjectPoints;
+        m->sampledObjectPointsM = sampledObjectPointsM;
+
+        // the OWS is not modified, hence it can be shared
+        m->OWSCalculated = OWSCalculated;
+        m->convexHullOWS = convexHullOWS;
+        m->convexHullCenterOWS = convexHullCenterOWS;
+        m->minOffsetOWS = minOffsetOWS;
+        m->volumeOWS = volumeOWS;
+        return m;
+    }
+
 
     void GraspQualityMeasureWrenchSpace::setContactPoints(const std::vector<VirtualRobot::MathTools::ContactPoint>& contactPoints)
     {
@@ -127,6 +127,8 @@ namespace GraspStudio
         //! Returns description of this object
         virtual std::string getName();
 
+        virtual GraspQualityMeasurePtr clone(VirtualRobot::SceneObjectPtr newObject);
+
         virtual float getOWSMinOffset()
         {
             return minOffsetOWS;
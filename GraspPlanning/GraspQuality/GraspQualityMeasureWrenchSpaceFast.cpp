@@ -0,0 +1,466 @@
+#include "GraspQualityMeasureWrenchSpaceFast.h"
+#include "GraspQualityMeasureWrenchSpace.h"
+#include <Eigen/Dense>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include <float.h>
+
+using namespace std;
+using namespace VirtualRobot;
+
+namespace GraspStudio
+{
+    namespace
+    {
+        // the origin is considered to be inside of the GWS up to this distance (same threshold as GraspQualityMeasureWrenchSpace::isOriginInGWSHull())
+        const double forceClosureThreshold = 1e-4;
+
+        // number of sampled directions from which the support function is minimized locally
+        const int nrDescentStarts = 8;
+        const int nrDescentSteps = 100;
+    }
+
+    GraspQualityMeasureWrenchSpaceFast::GraspQualityMeasureWrenchSpaceFast(VirtualRobot::SceneObjectPtr object, float unitForce, float frictionConeCoeff, int frictionConeSamples)
+        : GraspQualityMeasure(object, unitForce, frictionConeCoeff, frictionConeSamples)
+    {
+        OWSCalculated = false;
+        GWSCalculated = false;
+        epsilonGWSCalculated = false;
+        distanceGWS = 0;
+        epsilonGWS = 0;
+        epsilonOWS = 0.0f;
+
+        // directions: the coordinate axes, the diagonals of all coordinate planes and the diagonals of the unit cube
+        std::vector<Wrench, Eigen::aligned_allocator<Wrench> > dirs;
+
+        for (int i = 0; i < 6; i++)
+        {
+            for (int s = -1; s <= 1; s += 2)
+            {
+                Wrench d = Wrench::Zero();
+                d(i) = s;
+                dirs.push_back(d);
+            }
+        }
+
+        for (int i = 0; i < 6; i++)
+        {
+            for (int j = i + 1; j < 6; j++)
+            {
+                for (int s = 0; s < 4; s++)
+                {
+                    Wrench d = Wrench::Zero();
+                    d(i) = (s & 1) ? 1.0 : -1.0;
+                    d(j) = (s & 2) ? 1.0 : -1.0;
+                    dirs.push_back(d.normalized());
+                }
+            }
+        }
+
+        for (int s = 0; s < 64; s++)
+        {
+            Wrench d;
+
+            for (int i = 0; i < 6; i++)
+            {
+                d(i) = (s & (1 << i)) ? 1.0 : -1.0;
+            }
+
+            dirs.push_back(d.normalized());
+        }
+
+        directions.resize(6, dirs.size());
+
+        for (size_t i = 0; i < dirs.size(); i++)
+        {
+            directions.col(i) = dirs[i];
+        }
+    }
+
+    GraspQualityMeasureWrenchSpaceFast::~GraspQualityMeasureWrenchSpaceFast()
+    {
+    }
+
+    GraspQualityMeasurePtr GraspQualityMeasureWrenchSpaceFast::clone(VirtualRobot::SceneObjectPtr newObject)
+    {
+        boost::shared_ptr<GraspQualityMeasureWrenchSpaceFast> m(new GraspQualityMeasureWrenchSpaceFast(newObject, unitForce, frictionCoeff, frictionConeSamples));
+        m->verbose = verbose;
+        m->maxContacts = maxContacts;
+        m->sampledObjectPoints = sampledObjectPoints;
+        m->sampledObjectPointsM = sampledObjectPointsM;
+        m->OWSCalculated = OWSCalculated;
+        m->epsilonOWS = epsilonOWS;
+        return m;
+    }
+
+    void GraspQualityMeasureWrenchSpaceFast::setContactPoints(const std::vector<VirtualRobot::MathTools::ContactPoint>& contactPoints)
+    {
+        GraspQualityMeasure::setContactPoints(contactPoints);
+        GWSCalculated = false;
+        epsilonGWSCalculated = false;
+    }
+
+    void GraspQualityMeasureWrenchSpaceFast::setContactPoints(const VirtualRobot::EndEffector::ContactInfoVector& contactPoints)
+    {
+        GraspQualityMeasure::setContactPoints(contactPoints);
+        GWSCalculated = false;
+        epsilonGWSCalculated = false;
+    }
+
+    float GraspQualityMeasureWrenchSpaceFast::getGraspQuality()
+    {
+        calculateObjectProperties();
+        calculateGraspQuality();
+        return graspQuality;
+    }
+
+    bool GraspQualityMeasureWrenchSpaceFast::isGraspForceClosure()
+    {
+        if (!GWSCalculated)
+        {
+            calculateGWS();
+        }
+
+        return GWSCalculated && distanceGWS <= forceClosureThreshold;
+    }
+
+    void GraspQualityMeasureWrenchSpaceFast::preCalculatedOWS(float epsilon)
+    {
+        epsilonOWS = epsilon;
+        OWSCalculated = true;
+    }
+
+    void GraspQualityMeasureWrenchSpaceFast::calculateOWS(int samplePoints)
+    {
+        if (!sampleObjectPoints(samplePoints))
+        {
+            return;
+        }
+
+        std::vector<VirtualRobot::MathTools::ContactPoint> conePoints;
+
+        for (size_t i = 0; i < sampledObjectPointsM.size(); i++)
+        {
+            coneGenerator->computeConePoints(sampledObjectPointsM[i], conePoints);
+        }
+
+        // the OWS only depends on the object, so the exact value is computed once with a convex hull.
+        // contact points are already moved so that com is at origin
+        std::vector<VirtualRobot::MathTools::ContactPoint> wrenchPoints = GraspQualityMeasureWrenchSpace::createWrenchPoints(conePoints, Eigen::Vector3f::Zero(), objectLength);
+        VirtualRobot::MathTools::ConvexHull6DPtr hull = ConvexHullGenerator::CreateConvexHull(wrenchPoints);
+
+        if (!hull || hull->faces.empty())
+        {
+            GRASPSTUDIO_ERROR << "Could not create convex hull of OWS" << endl;
+            return;
+        }
+
+        // distance of the origin to the nearest facet (distNormZero is negative for facets that face away from the origin)
+        float epsilon = FLT_MAX;
+
+        for (size_t i = 0; i < hull->faces.size(); i++)
+        {
+            epsilon = std::min(epsilon, -hull->faces[i].distNormZero);
+        }
+
+        epsilonOWS = std::max(0.0f, epsilon);
+
+        if (verbose)
+        {
+            GRASPSTUDIO_INFO << ": Epsilon of OWS: " << epsilonOWS << endl;
+        }
+
+        OWSCalculated = true;
+    }
+
+    void GraspQualityMeasureWrenchSpaceFast::calculateGWS()
+    {
+        if (contactPointsM.empty())
+        {
+            GRASPSTUDIO_ERROR << "Contact points not set." << endl;
+            return;
+        }
+
+        std::vector<VirtualRobot::MathTools::ContactPoint> conePoints;
+
+        for (size_t i = 0; i < contactPointsM.size(); i++)
+        {
+            coneGenerator->computeConePoints(contactPointsM[i], conePoints);
+        }
+
+        wrenchesGWS = createWrenches(conePoints, objectLength);
+        distanceGWS = distanceToWrenchHull(wrenchesGWS, Wrench::Zero());
+        epsilonGWSCalculated = false;
+        GWSCalculated = true;
+    }
+
+    float GraspQualityMeasureWrenchSpaceFast::getGWSDistance()
+    {
+        if (!GWSCalculated)
+        {
+            calculateGWS();
+        }
+
+        return (float)distanceGWS;
+    }
+
+    float GraspQualityMeasureWrenchSpaceFast::getGWSEpsilon()
+    {
+        if (!isGraspForceClosure())
+        {
+            return 0.0f;
+        }
+
+        if (!epsilonGWSCalculated)
+        {
+            // the origin may be slightly outside (see forceClosureThreshold)
+            epsilonGWS = std::max(0.0, minSupport(wrenchesGWS));
+            epsilonGWSCalculated = true;
+        }
+
+        return (float)epsilonGWS;
+    }
+
+    bool GraspQualityMeasureWrenchSpaceFast::calculateGraspQuality()
+    {
+        graspQuality = 0.0f;
+
+        if (!GWSCalculated)
+        {
+            calculateGWS();
+        }
+
+        if (!GWSCalculated)
+        {
+            return false;
+        }
+
+        float epsilon = getGWSEpsilon();
+
+        if (epsilonOWS > 0)
+        {
+            graspQuality = epsilon / epsilonOWS;
+        }
+        else
+        {
+            graspQuality = epsilon;
+        }
+
+        if (verbose)
+        {
+            GRASPSTUDIO_INFO << endl;
+            cout << ": GWS distance to origin: " << distanceGWS << endl;
+            cout << ": GWS epsilon : " << epsilon << endl;
+            cout << ": OWS epsilon : " << epsilonOWS << endl;
+            cout << ": GraspQuality: " << graspQuality << endl;
+        }
+
+        return true;
+    }
+
+    bool GraspQualityMeasureWrenchSpaceFast::calculateObjectProperties()
+    {
+        if (!OWSCalculated)
+        {
+            calculateOWS();
+        }
+
+        return true;
+    }
+
+    std::string GraspQualityMeasureWrenchSpaceFast::getName()
+    {
+        std::string sName("GraspWrenchSpaceFast");
+        return sName;
+    }
+
+    GraspQualityMeasureWrenchSpaceFast::WrenchMatrix GraspQualityMeasureWrenchSpaceFast::createWrenches(std::vector<VirtualRobot::MathTools::ContactPoint>& conePoints, float objectLengthMM)
+    {
+        // contact points are already moved so that com is at origin
+        std::vector<VirtualRobot::MathTools::ContactPoint> w = GraspQualityMeasureWrenchSpace::createWrenchPoints(conePoints, Eigen::Vector3f::Zero(), objectLengthMM);
+        WrenchMatrix result(6, w.size());
+
+        for (size_t i = 0; i < w.size(); i++)
+        {
+            result.block(0, i, 3, 1) = w[i].p.cast<double>();
+            result.block(3, i, 3, 1) = w[i].n.cast<double>();
+        }
+
+        return result;
+    }
+
+    double GraspQualityMeasureWrenchSpaceFast::distanceToWrenchHull(const WrenchMatrix& wrenches, const Wrench& point)
+    {
+        const int nWrenches = (int)wrenches.cols();
+
+        if (nWrenches == 0)
+        {
+            return FLT_MAX;
+        }
+
+        WrenchMatrix p = wrenches.colwise() - point;
+        const double maxSqNorm = std::max(p.colwise().squaredNorm().maxCoeff(), DBL_MIN);
+        const double zeroWeight = 1e-12;
+
+        // corral: affinely independent points whose convex hull contains the current nearest point x
+        std::vector<int> corral;
+        std::vector<double> weights;
+        int start;
+        p.colwise().squaredNorm().minCoeff(&start);
+        corral.push_back(start);
+        weights.push_back(1.0);
+        Wrench x = p.col(start);
+
+        for (int loop = 0; loop < 10 * nWrenches + 100; loop++)
+        {
+            double xSqNorm = x.squaredNorm();
+
+            if (xSqNorm <= 1e-20 * maxSqNorm)
+            {
+                return 0.0;
+            }
+
+            // support point in direction -x
+            int j;
+            double minProj = (x.transpose() * p).minCoeff(&j);
+
+            if (xSqNorm - minProj <= 1e-12 * maxSqNorm || corral.size() == 7 || std::find(corral.begin(), corral.end(), j) != corral.end())
+            {
+                // x is the nearest point (up to numerical precision)
+                break;
+            }
+
+            corral.push_back(j);
+            weights.push_back(0.0);
+
+            while (true)
+            {
+                // nearest point of the affine hull of the corral: x = p_0 + sum_i mu_i (p_i - p_0)
+                const int k = (int)corral.size();
+
+                if (k == 1)
+                {
+                    weights[0] = 1.0;
+                    break;
+                }
+
+                Eigen::MatrixXd d(6, k - 1);
+
+                for (int i = 1; i < k; i++)
+                {
+                    d.col(i - 1) = p.col(corral[i]) - p.col(corral[0]);
+                }
+
+                Eigen::VectorXd mu = d.colPivHouseholderQr().solve(-p.col(corral[0]));
+                Eigen::VectorXd affineWeights(k);
+                affineWeights(0) = 1.0 - mu.sum();
+                affineWeights.tail(k - 1) = mu;
+
+                if (affineWeights.minCoeff() > zeroWeight)
+                {
+                    for (int i = 0; i < k; i++)
+                    {
+                        weights[i] = affineWeights(i);
+                    }
+
+                    break;
+                }
+
+                // move towards the affine minimum until the first weight becomes zero, then remove that point from the corral
+                double theta = 1.0;
+                int removeIndex = 0;
+
+                for (int i = 0; i < k; i++)
+                {
+                    if (affineWeights(i) <= zeroWeight && weights[i] - affineWeights(i) > 0)
+                    {
+                        double t = weights[i] / (weights[i] - affineWeights(i));
+
+                        if (t < theta)
+                        {
+                            theta = t;
+                            removeIndex = i;
+                        }
+                    }
+                }
+
+                for (int i = 0; i < k; i++)
+                {
+                    weights[i] = theta * affineWeights(i) + (1.0 - theta) * weights[i];
+                }
+
+                weights[removeIndex] = 0.0;
+
+                for (int i = k - 1; i >= 0; i--)
+                {
+                    if (weights[i] <= zeroWeight)
+                    {
+                        corral.erase(corral.begin() + i);
+                        weights.erase(weights.begin() + i);
+                    }
+                }
+            }
+
+            x.setZero();
+
+            for (size_t i = 0; i < corral.size(); i++)
+            {
+                x += weights[i] * p.col(corral[i]);
+            }
+        }
+
+        return x.norm();
+    }
+
+    double GraspQualityMeasureWrenchSpaceFast::minSupport(const WrenchMatrix& wrenches)
+    {
+        if (wrenches.cols() == 0)
+        {
+            return 0.0;
+        }
+
+        // support function h(u) = max_i <w_i,u> for all sampled directions
+        Eigen::VectorXd support = (directions.transpose() * wrenches).rowwise().maxCoeff();
+
+        std::vector< std::pair<double, int> > sorted(support.size());
+
+        for (int i = 0; i < (int)support.size(); i++)
+        {
+            sorted[i] = std::make_pair(support(i), i);
+        }
+
+        const int nrStarts = std::min(nrDescentStarts, (int)sorted.size());
+        std::partial_sort(sorted.begin(), sorted.begin() + nrStarts, sorted.end());
+        double result = sorted[0].first;
+
+        // h is convex, so a subgradient of h at u is the supporting wrench.
+        // Its tangential part is followed on the unit sphere with decreasing step sizes.
+        for (int s = 0; s < nrStarts; s++)
+        {
+            Wrench u = directions.col(sorted[s].second);
+            double step = 0.3;
+
+            for (int i = 0; i < nrDescentSteps; i++)
+            {
+                int index;
+                double h = (u.transpose() * wrenches).maxCoeff(&index);
+                result = std::min(result, h);
+
+                Wrench g = wrenches.col(index) - h * u;
+                double gNorm = g.norm();
+
+                if (gNorm < 1e-12)
+                {
+                    break;
+                }
+
+                u = (u - step * g / gNorm).normalized();
+                step *= 0.95;
+            }
+        }
+
+        return result;
+    }
+
+} // namespace
@@ -0,0 +1,141 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    GraspStudio
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef __GRASP_QUALTIY_MEASURE_WRENCH_FAST_H__
+#define __GRASP_QUALTIY_MEASURE_WRENCH_FAST_H__
+
+#include "../GraspStudio.h"
+#include "GraspQualityMeasure.h"
+
+#include <Eigen/Core>
+
+namespace GraspStudio
+{
+
+    /*!
+        \brief A grasp wrench space measure that does not compute convex hulls of the grasp wrench space.
+
+        The wrenches of the friction cones are set up as in GraspQualityMeasureWrenchSpace, but instead of
+        building the 6D convex hull of the grasp wrench space (GWS) with qhull, the hull is only accessed implicitly:
+        - Force closure: The distance of the origin to the GWS is computed with the
+          minimum norm point algorithm of Wolfe (which is the point set variant of GJK).
+          A grasp is force closure if this distance is (nearly) zero, which is the same test as
+          GraspQualityMeasureWrenchSpace::isGraspForceClosure() performs on the facets of the hull.
+        - Quality: The epsilon quality, i.e. the radius of the largest 6D ball around the origin that fits into the GWS,
+          is the minimum of the support function h(u) = max_i <w_i,u> over all unit directions u.
+          It is approximated by evaluating h for a fixed set of directions followed by a local descent on the unit sphere.
+          Since only a subset of all directions is considered, the result is an upper bound of the exact value.
+          It is normalized with the exact epsilon value of the object wrench space (OWS), which is computed once per object with qhull.
+
+        Hence getGraspQuality() is an upper bound of the exact ratio epsilon_GWS / epsilon_OWS with both balls centered at the origin
+        (the classical definition): A grasp with a quality below a threshold here does not reach this threshold with the exact values either.
+        Note that GraspQualityMeasureWrenchSpace measures the distances from the centers of the hulls instead,
+        so its values differ and this guarantee does not carry over to it.
+        Grasps that are not force closure get a quality of zero.
+    */
+    class GRASPSTUDIO_IMPORT_EXPORT GraspQualityMeasureWrenchSpaceFast : public GraspQualityMeasure
+    {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef Eigen::Matrix<double, 6, 1> Wrench;
+        typedef Eigen::Matrix<double, 6, Eigen::Dynamic> WrenchMatrix;
+
+        GraspQualityMeasureWrenchSpaceFast(VirtualRobot::SceneObjectPtr object, float unitForce = 1.0f, float frictionConeCoeff = 0.35f, int frictionConeSamples = 8);
+        ~GraspQualityMeasureWrenchSpaceFast();
+
+        /*!
+            The OWS should not change for an object, so if you have the data calculated once, you can set it here.
+            \param epsilon The exact epsilon value of the OWS, see getOWSEpsilon(). The quality is only an upper bound of the exact one if this value is not overestimated.
+        */
+        virtual void preCalculatedOWS(float epsilon);
+
+        /*!
+            Returns epsilon_GWS / epsilon_OWS, or zero if the grasp is not force closure.
+            If the OWS could not be computed, the unnormalized epsilon_GWS is returned.
+        */
+        virtual float getGraspQuality();
+
+        /*!
+            Checks if the origin of the wrench space is inside the GWS.
+        */
+        virtual bool isGraspForceClosure();
+
+        void calculateOWS(int samplePoints = 300);
+        void calculateGWS();
+
+        //! The radius of the largest ball around the origin that is contained in the OWS (computed from the facets of the convex hull).
+        float getOWSEpsilon()
+        {
+            return epsilonOWS;
+        }
+
+        //! The (unnormalized) radius of the largest ball around the origin that is contained in the GWS, approximated from above. Zero if the grasp is not force closure.
+        float getGWSEpsilon();
+
+        //! The distance of the origin to the GWS. Zero (up to numerical precision) for force closure grasps.
+        float getGWSDistance();
+
+        virtual void setContactPoints(const std::vector<VirtualRobot::MathTools::ContactPoint>& contactPoints);
+        virtual void setContactPoints(const VirtualRobot::EndEffector::ContactInfoVector& contactPoints);
+
+        virtual bool calculateGraspQuality();
+        virtual bool calculateObjectProperties();
+
+        //! Returns description of this object
+        virtual std::string getName();
+
+        virtual GraspQualityMeasurePtr clone(VirtualRobot::SceneObjectPtr newObject);
+
+        /*!
+            The wrenches of the given friction cone points (in m), as columns of a 6xn matrix.
+            The torques are scaled with the object length, as done by GraspQualityMeasureWrenchSpace::createWrenchPoints().
+        */
+        static WrenchMatrix createWrenches(std::vector<VirtualRobot::MathTools::ContactPoint>& conePoints, float objectLengthMM);
+
+        /*!
+            Computes the distance of point to the convex hull of the columns of wrenches (minimum norm point algorithm of Wolfe).
+            \return The distance or FLT_MAX if no wrenches are given.
+        */
+        static double distanceToWrenchHull(const WrenchMatrix& wrenches, const Wrench& point);
+
+    protected:
+
+        //! The minimum of the support function of wrenches over all unit directions (approximated, an upper bound of the exact value).
+        double minSupport(const WrenchMatrix& wrenches);
+
+        bool OWSCalculated;
+        bool GWSCalculated;
+        bool epsilonGWSCalculated;
+
+        WrenchMatrix wrenchesGWS;
+        double distanceGWS;
+        double epsilonGWS;
+        float epsilonOWS;
+
+        //! The directions (unit vectors) for which the support function is evaluated, one per column.
+        WrenchMatrix directions;
+    };
+
+} // namespace
+
+#endif /* __GRASP_QUALTIY_MEASURE_WRENCH_FAST_H__ */
@@ -74,6 +74,7 @@ namespace GraspStudio
 
     class GraspQualityMeasure;
     class GraspQualityMeasureWrenchSpace;
+    class GraspQualityMeasureWrenchSpaceFast;
     class ContactConeGenerator;
 
     class GraspQualityMeasure;
@@ -84,6 +85,7 @@ namespace GraspStudio
 
     typedef boost::shared_ptr<GraspQualityMeasure> GraspQualityMeasurePtr;
     typedef boost::shared_ptr<GraspQualityMeasureWrenchSpace> GraspQualityMeasureWrenchSpacePtr;
+    typedef boost::shared_ptr<GraspQualityMeasureWrenchSpaceFast> GraspQualityMeasureWrenchSpaceFastPtr;
     typedef boost::shared_ptr<ContactConeGenerator> ContactConeGeneratorPtr;
     typedef boost::shared_ptr<GraspQualityMeasure> GraspQualityMeasurePtr;
     typedef boost::shared_ptr<ApproachMovementGenerator> ApproachMovementGeneratorPtr;
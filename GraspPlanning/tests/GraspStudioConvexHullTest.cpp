@@ -0,0 +1,162 @@
+/**
+* @package    GraspStudio
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE GraspStudio_GraspStudioConvexHullTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/MathTools.h>
+#include <GraspPlanning/ConvexHullGenerator.h>
+#include <GraspPlanning/ContactConeGenerator.h>
+#include <vector>
+#include <cstdlib>
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <Eigen/Core>
+
+using namespace VirtualRobot;
+
+namespace
+{
+    typedef std::vector<MathTools::ContactPoint> ContactPoints;
+
+    //! Grasp wrench space like input: the discretized friction cones of four random contacts on a small object.
+    std::vector<ContactPoints> createInputs(int nrHulls)
+    {
+        srand(3);
+        GraspStudio::ContactConeGenerator cone(8, 0.35f, 1.0f);
+        std::vector<ContactPoints> inputs;
+
+        for (int k = 0; k < nrHulls; k++)
+        {
+            ContactPoints points;
+
+            for (int c = 0; c < 4; c++)
+            {
+                MathTools::ContactPoint p;
+                p.p = Eigen::Vector3f::Random() * 0.05f;
+                p.n = -p.p.normalized();
+                p.force = 1.0f;
+                cone.computeConePoints(p, points);
+            }
+
+            inputs.push_back(points);
+        }
+
+        return inputs;
+    }
+
+    //! Computes the hulls with index start, start + step, ...
+    void computeHulls(std::vector<ContactPoints>* inputs, std::vector<MathTools::ConvexHull6DPtr>* storeHulls, size_t start, size_t step)
+    {
+        for (size_t i = start; i < inputs->size(); i += step)
+        {
+            (*storeHulls)[i] = GraspStudio::ConvexHullGenerator::CreateConvexHull((*inputs)[i]);
+        }
+    }
+
+    //! The force member is not set by the hull generator.
+    bool isEqual(const MathTools::ContactPoint& a, const MathTools::ContactPoint& b)
+    {
+        return a.p == b.p && a.n == b.n;
+    }
+
+    //! Bitwise comparison of all values that are computed by qhull.
+    bool isEqual(MathTools::ConvexHull6DPtr a, MathTools::ConvexHull6DPtr b)
+    {
+        if (!a || !b || a->vertices.size() != b->vertices.size() || a->faces.size() != b->faces.size())
+        {
+            return false;
+        }
+
+        if (a->volume != b->volume || !isEqual(a->center, b->center))
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < a->vertices.size(); i++)
+        {
+            if (!isEqual(a->vertices[i], b->vertices[i]))
+            {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < a->faces.size(); i++)
+        {
+            const MathTools::TriangleFace6D& fa = a->faces[i];
+            const MathTools::TriangleFace6D& fb = b->faces[i];
+
+            for (int j = 0; j < 6; j++)
+            {
+                if (fa.id[j] != fb.id[j])
+                {
+                    return false;
+                }
+            }
+
+            if (!isEqual(fa.normal, fb.normal) || fa.distNormZero != fb.distNormZero || fa.distNormCenter != fb.distNormCenter
+                || fa.distPlaneZero != fb.distPlaneZero || fa.distPlaneCenter != fb.distPlaneCenter || fa.offset != fb.offset)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(ConvexHull)
+
+BOOST_AUTO_TEST_CASE(testConvexHullConcurrent)
+{
+    std::vector<ContactPoints> inputs = createInputs(200);
+
+    // sequential reference
+    std::vector<MathTools::ConvexHull6DPtr> reference(inputs.size());
+    computeHulls(&inputs, &reference, 0, 1);
+
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        BOOST_REQUIRE(reference[i]);
+        BOOST_REQUIRE(!reference[i]->faces.empty());
+    }
+
+    // the hulls are interleaved over the threads, so the qhull calls of the threads overlap
+    for (size_t nrThreads = 1; nrThreads <= 8; nrThreads *= 2)
+    {
+        std::vector<MathTools::ConvexHull6DPtr> hulls(inputs.size());
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+        boost::thread_group threads;
+
+        for (size_t t = 0; t < nrThreads; t++)
+        {
+            threads.create_thread(boost::bind(&computeHulls, &inputs, &hulls, t, nrThreads));
+        }
+
+        threads.join_all();
+        double ms = (double)(boost::posix_time::microsec_clock::local_time() - start).total_microseconds() / 1000.0;
+
+        int mismatches = 0;
+
+        for (size_t i = 0; i < hulls.size(); i++)
+        {
+            if (!isEqual(hulls[i], reference[i]))
+            {
+                mismatches++;
+            }
+        }
+
+        BOOST_CHECK_EQUAL(mismatches, 0);
+
+        // on a single core machine, no speedup can be expected
+        BOOST_TEST_MESSAGE(nrThreads << " thread(s): " << ms << " ms for " << hulls.size() << " hulls (" << (double)hulls.size() * 1000.0 / ms << " hulls/s)");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
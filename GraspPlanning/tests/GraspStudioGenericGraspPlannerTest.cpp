@@ -0,0 +1,234 @@
+/**
+* @package    GraspStudio
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE GraspStudio_GraspStudioGenericGraspPlannerTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/ManipulationObject.h>
+#include <VirtualRobot/EndEffector/EndEffector.h>
+#include <VirtualRobot/CollisionDetection/CollisionChecker.h>
+#include <VirtualRobot/Grasping/Grasp.h>
+#include <VirtualRobot/Grasping/GraspSet.h>
+#include <GraspPlanning/GraspPlanner/GenericGraspPlanner.h>
+#include <GraspPlanning/GraspQuality/GraspQualityMeasureWrenchSpace.h>
+#include <GraspPlanning/GraspQuality/GraspQualityMeasureWrenchSpaceFast.h>
+#include <GraspPlanning/ApproachMovementSurfaceNormal.h>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <Eigen/Core>
+
+using namespace VirtualRobot;
+
+namespace
+{
+    typedef std::vector<MathTools::ContactPoint> ContactPoints;
+
+    //! A hand with four fingers around the GCP that close towards the approach direction (z axis), each finger has a box collision model.
+    RobotPtr createHand()
+    {
+        const std::string robotString =
+            "<Robot Type='TestHand' RootNode='Base'>"
+            " <RobotNode name='Base'><Child name='Palm'/><Child name='GCP'/><Child name='F1'/><Child name='F2'/><Child name='F3'/><Child name='F4'/></RobotNode>"
+            " <RobotNode name='Palm'/>"
+            " <RobotNode name='GCP'><Transform><Translation x='0' y='0' z='600'/></Transform></RobotNode>"
+            " <RobotNode name='F1'><Transform><Translation x='700' y='0' z='0'/></Transform>"
+            "  <Joint type='revolute'><axis x='0' y='1' z='0'/><Limits unit='radian' lo='-1.5' hi='1.5'/></Joint></RobotNode>"
+            " <RobotNode name='F2'><Transform><Translation x='-700' y='0' z='0'/></Transform>"
+            "  <Joint type='revolute'><axis x='0' y='1' z='0'/><Limits unit='radian' lo='-1.5' hi='1.5'/></Joint></RobotNode>"
+            " <RobotNode name='F3'><Transform><Translation x='0' y='700' z='0'/></Transform>"
+            "  <Joint type='revolute'><axis x='1' y='0' z='0'/><Limits unit='radian' lo='-1.5' hi='1.5'/></Joint></RobotNode>"
+            " <RobotNode name='F4'><Transform><Translation x='0' y='-700' z='0'/></Transform>"
+            "  <Joint type='revolute'><axis x='1' y='0' z='0'/><Limits unit='radian' lo='-1.5' hi='1.5'/></Joint></RobotNode>"
+            " <Endeffector name='Hand' base='Base' tcp='GCP' gcp='GCP'>"
+            "  <Static><Node name='Palm'/></Static>"
+            "  <Actor name='A1'><Node name='F1' considerCollisions='All' direction='-1'/></Actor>"
+            "  <Actor name='A2'><Node name='F2' considerCollisions='All' direction='1'/></Actor>"
+            "  <Actor name='A3'><Node name='F3' considerCollisions='All' direction='1'/></Actor>"
+            "  <Actor name='A4'><Node name='F4' considerCollisions='All' direction='-1'/></Actor>"
+            " </Endeffector>"
+            "</Robot>";
+        RobotPtr robot = RobotIO::createRobotFromString(robotString);
+        BOOST_REQUIRE(robot);
+        robot->getRobotNode("Palm")->setCollisionModel(VirtualRobotTest::createBox(Eigen::Vector3f(-800.0f, -800.0f, -300.0f), Eigen::Vector3f(800.0f, 800.0f, -120.0f), "Palm"));
+        robot->getRobotNode("F1")->setCollisionModel(VirtualRobotTest::createBox(Eigen::Vector3f(-100.0f, -100.0f, 0.0f), Eigen::Vector3f(0.0f, 100.0f, 1400.0f), "F1"));
+        robot->getRobotNode("F2")->setCollisionModel(VirtualRobotTest::createBox(Eigen::Vector3f(0.0f, -100.0f, 0.0f), Eigen::Vector3f(100.0f, 100.0f, 1400.0f), "F2"));
+        robot->getRobotNode("F3")->setCollisionModel(VirtualRobotTest::createBox(Eigen::Vector3f(-100.0f, -100.0f, 0.0f), Eigen::Vector3f(100.0f, 0.0f, 1400.0f), "F3"));
+        robot->getRobotNode("F4")->setCollisionModel(VirtualRobotTest::createBox(Eigen::Vector3f(-100.0f, 0.0f, 0.0f), Eigen::Vector3f(100.0f, 100.0f, 1400.0f), "F4"));
+        robot->applyJointValues();
+        return robot;
+    }
+
+    ManipulationObjectPtr createObject()
+    {
+        TriMeshModelPtr mesh = VirtualRobotTest::createBoxMesh(Eigen::Vector3f(-350.0f, -250.0f, -300.0f), Eigen::Vector3f(350.0f, 250.0f, 300.0f));
+        VisualizationNodePtr visu(new VirtualRobotTest::MeshVisualizationNode(mesh));
+        return ManipulationObjectPtr(new ManipulationObject("object", visu, VirtualRobotTest::createCollisionModel(mesh, "object")));
+    }
+
+    //! A wrench space measure that does not support cloning (as custom measures that only implement the base interface).
+    class NonCloneableWrenchSpace : public GraspStudio::GraspQualityMeasureWrenchSpace
+    {
+    public:
+        NonCloneableWrenchSpace(SceneObjectPtr object) : GraspStudio::GraspQualityMeasureWrenchSpace(object) {}
+
+        virtual GraspStudio::GraspQualityMeasurePtr clone(SceneObjectPtr newObject)
+        {
+            return GraspStudio::GraspQualityMeasurePtr();
+        }
+    };
+
+    /*!
+        Plans nrGrasps grasps with the same random seed.
+        \param numThreads The number of threads of planParallel(), plan() is used if zero.
+    */
+    GraspSetPtr planGrasps(RobotPtr hand, ManipulationObjectPtr object, GraspStudio::GraspQualityMeasurePtr quality, int nrGrasps, unsigned int numThreads, unsigned int batchSize = 0)
+    {
+        GraspSetPtr graspSet(new GraspSet("grasps", hand->getType(), "Hand"));
+        srand(123);
+        GraspStudio::ApproachMovementSurfaceNormalPtr approach(new GraspStudio::ApproachMovementSurfaceNormal(object, hand->getEndEffector("Hand")));
+        GraspStudio::GenericGraspPlanner planner(graspSet, quality, approach, 0.0f, false);
+        planner.setVerbose(false);
+
+        // the time out only guards against endless planning, it is never reached
+        int nrCreated = (numThreads == 0) ? planner.plan(nrGrasps, 60000) : planner.planParallel(nrGrasps, 60000, numThreads, batchSize);
+        BOOST_CHECK_EQUAL(nrCreated, nrGrasps);
+        return graspSet;
+    }
+
+    //! Checks that both sets contain the same grasps in the same order.
+    void checkEqual(GraspSetPtr expected, GraspSetPtr grasps)
+    {
+        BOOST_REQUIRE_EQUAL(grasps->getSize(), expected->getSize());
+
+        for (unsigned int i = 0; i < expected->getSize(); i++)
+        {
+            GraspPtr a = expected->getGrasp(i);
+            GraspPtr b = grasps->getGrasp(i);
+            BOOST_CHECK_EQUAL(b->getName(), a->getName());
+            BOOST_CHECK_EQUAL(b->getQuality(), a->getQuality());
+            BOOST_CHECK(b->getTransformation() == a->getTransformation());
+            BOOST_CHECK(b->getConfiguration() == a->getConfiguration());
+        }
+    }
+
+    //! A contact on the surface of the object (mm) with the outward normal n.
+    void addContact(ContactPoints& contacts, float x, float y, float z, float nx, float ny, float nz)
+    {
+        MathTools::ContactPoint p;
+        p.p = Eigen::Vector3f(x, y, z);
+        p.n = Eigen::Vector3f(nx, ny, nz);
+        p.force = 1.0f;
+        contacts.push_back(p);
+    }
+
+    //! One contact on each side of the object.
+    ContactPoints createContacts()
+    {
+        ContactPoints contacts;
+        addContact(contacts, 350.0f, 50.0f, 20.0f, 1.0f, 0.0f, 0.0f);
+        addContact(contacts, -350.0f, -50.0f, -20.0f, -1.0f, 0.0f, 0.0f);
+        addContact(contacts, 100.0f, 250.0f, -50.0f, 0.0f, 1.0f, 0.0f);
+        addContact(contacts, -100.0f, -250.0f, 50.0f, 0.0f, -1.0f, 0.0f);
+        addContact(contacts, -120.0f, 30.0f, 300.0f, 0.0f, 0.0f, 1.0f);
+        addContact(contacts, 120.0f, -30.0f, -300.0f, 0.0f, 0.0f, -1.0f);
+        return contacts;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(GenericGraspPlanner)
+
+BOOST_AUTO_TEST_CASE(testGraspQualityMeasureClone)
+{
+    ManipulationObjectPtr object = createObject();
+    SceneObjectPtr objectClone = object->clone(object->getName(), CollisionCheckerPtr(new CollisionChecker()));
+    ContactPoints contacts = createContacts();
+
+    // the object properties are copied to the clone
+    GraspStudio::GraspQualityMeasureWrenchSpacePtr quality(new GraspStudio::GraspQualityMeasureWrenchSpace(object));
+    srand(7);
+    quality->calculateOWS(100);
+    GraspStudio::GraspQualityMeasureWrenchSpacePtr qualityClone = boost::dynamic_pointer_cast<GraspStudio::GraspQualityMeasureWrenchSpace>(quality->clone(objectClone));
+    BOOST_REQUIRE(qualityClone);
+    BOOST_CHECK(qualityClone->getObject() == objectClone);
+    BOOST_CHECK_EQUAL(qualityClone->getOWSMinOffset(), quality->getOWSMinOffset());
+    BOOST_CHECK_EQUAL(qualityClone->getOWSVolume(), quality->getOWSVolume());
+
+    quality->setContactPoints(contacts);
+    qualityClone->setContactPoints(contacts);
+    BOOST_CHECK(quality->isGraspForceClosure());
+    BOOST_CHECK_EQUAL(qualityClone->isGraspForceClosure(), quality->isGraspForceClosure());
+    BOOST_CHECK_EQUAL(qualityClone->getGraspQuality(), quality->getGraspQuality());
+
+    GraspStudio::GraspQualityMeasureWrenchSpaceFastPtr fast(new GraspStudio::GraspQualityMeasureWrenchSpaceFast(object));
+    srand(7);
+    fast->calculateOWS(100);
+    GraspStudio::GraspQualityMeasureWrenchSpaceFastPtr fastClone = boost::dynamic_pointer_cast<GraspStudio::GraspQualityMeasureWrenchSpaceFast>(fast->clone(objectClone));
+    BOOST_REQUIRE(fastClone);
+    BOOST_CHECK(fastClone->getObject() == objectClone);
+    BOOST_CHECK_EQUAL(fastClone->getOWSEpsilon(), fast->getOWSEpsilon());
+
+    fast->setContactPoints(contacts);
+    fastClone->setContactPoints(contacts);
+    BOOST_CHECK(fast->isGraspForceClosure());
+    BOOST_CHECK_EQUAL(fastClone->isGraspForceClosure(), fast->isGraspForceClosure());
+    BOOST_CHECK_EQUAL(fastClone->getGraspQuality(), fast->getGraspQuality());
+
+    // measures that do not implement clone()
+    NonCloneableWrenchSpace nonCloneable(object);
+    BOOST_CHECK(!nonCloneable.clone(objectClone));
+}
+
+BOOST_AUTO_TEST_CASE(testPlanParallel)
+{
+    const int nrGrasps = 10;
+    RobotPtr hand = createHand();
+    ManipulationObjectPtr object = createObject();
+
+    GraspStudio::GraspQualityMeasureWrenchSpacePtr quality(new GraspStudio::GraspQualityMeasureWrenchSpace(object));
+    srand(7);
+    quality->calculateOWS(100);
+
+    boost::posix_time::ptime t1 = boost::posix_time::microsec_clock::universal_time();
+    GraspSetPtr sequential = planGrasps(hand, object, quality, nrGrasps, 0);
+    boost::posix_time::ptime t2 = boost::posix_time::microsec_clock::universal_time();
+    GraspSetPtr oneThread = planGrasps(hand, object, quality, nrGrasps, 1);
+    boost::posix_time::ptime t3 = boost::posix_time::microsec_clock::universal_time();
+    GraspSetPtr fourThreads = planGrasps(hand, object, quality, nrGrasps, 4, 6);
+    boost::posix_time::ptime t4 = boost::posix_time::microsec_clock::universal_time();
+
+    // the grasps do not depend on the number of threads or the batch size and are identical to the result of plan()
+    checkEqual(oneThread, fourThreads);
+    checkEqual(sequential, oneThread);
+
+    BOOST_TEST_MESSAGE("Planning " << nrGrasps << " grasps: plan() " << (t2 - t1).total_milliseconds() << " ms, planParallel() with 1 thread "
+                       << (t3 - t2).total_milliseconds() << " ms, with 4 threads " << (t4 - t3).total_milliseconds() << " ms");
+}
+
+BOOST_AUTO_TEST_CASE(testPlanParallelWithoutClone)
+{
+    const int nrGrasps = 5;
+    RobotPtr hand = createHand();
+    ManipulationObjectPtr object = createObject();
+
+    GraspStudio::GraspQualityMeasurePtr quality(new NonCloneableWrenchSpace(object));
+    srand(7);
+    quality->calculateObjectProperties();
+
+    // falls back to plan()
+    GraspSetPtr sequential = planGrasps(hand, object, quality, nrGrasps, 0);
+    GraspSetPtr parallel = planGrasps(hand, object, quality, nrGrasps, 4);
+    checkEqual(sequential, parallel);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,145 @@
+/**
+* @package    GraspStudio
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE GraspStudio_GraspStudioWrenchSpaceFastTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
+#include <VirtualRobot/MathTools.h>
+#include <VirtualRobot/ManipulationObject.h>
+#include <GraspPlanning/GraspQuality/GraspQualityMeasureWrenchSpace.h>
+#include <GraspPlanning/GraspQuality/GraspQualityMeasureWrenchSpaceFast.h>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cfloat>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+using namespace VirtualRobot;
+
+namespace
+{
+    typedef std::vector<MathTools::ContactPoint> ContactPoints;
+
+    //! A box of 100 x 60 x 40 mm, centered at the origin.
+    ManipulationObjectPtr createBoxObject()
+    {
+        TriMeshModelPtr mesh = VirtualRobotTest::createBoxMesh(Eigen::Vector3f(-50.0f, -30.0f, -20.0f), Eigen::Vector3f(50.0f, 30.0f, 20.0f));
+        VisualizationNodePtr visu(new VirtualRobotTest::MeshVisualizationNode(mesh));
+        CollisionModelPtr colModel = VirtualRobotTest::createCollisionModel(mesh, "box");
+        return ManipulationObjectPtr(new ManipulationObject("box", visu, colModel));
+    }
+
+    //! A contact on the surface of the box (mm) with the outward normal n.
+    void addContact(ContactPoints& contacts, float x, float y, float z, float nx, float ny, float nz)
+    {
+        MathTools::ContactPoint p;
+        p.p = Eigen::Vector3f(x, y, z);
+        p.n = Eigen::Vector3f(nx, ny, nz);
+        p.force = 1.0f;
+        contacts.push_back(p);
+    }
+
+    //! The exact epsilon of a hull: the distance of the origin to the nearest facet (zero if the origin is outside).
+    float getEpsilon(MathTools::ConvexHull6DPtr hull)
+    {
+        float epsilon = FLT_MAX;
+
+        for (size_t i = 0; i < hull->faces.size(); i++)
+        {
+            epsilon = std::min(epsilon, -hull->faces[i].distNormZero);
+        }
+
+        return std::max(0.0f, epsilon);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(GraspQualityMeasureWrenchSpaceFast)
+
+BOOST_AUTO_TEST_CASE(testWrenchSpaceFastAgainstConvexHull)
+{
+    ManipulationObjectPtr object = createBoxObject();
+    GraspStudio::GraspQualityMeasureWrenchSpace exact(object);
+    GraspStudio::GraspQualityMeasureWrenchSpaceFast fast(object);
+
+    // the same object samples for both measures
+    srand(7);
+    exact.calculateOWS(100);
+    srand(7);
+    fast.calculateOWS(100);
+    BOOST_REQUIRE(exact.getConvexHullOWS());
+    BOOST_CHECK_CLOSE(fast.getOWSEpsilon(), getEpsilon(exact.getConvexHullOWS()), 1e-3f);
+    BOOST_REQUIRE_GT(fast.getOWSEpsilon(), 0.0f);
+
+    std::vector<ContactPoints> contactSets(4);
+    std::vector<std::string> names;
+
+    // one contact on each side
+    names.push_back("six sides");
+    addContact(contactSets[0], 50.0f, 10.0f, 5.0f, 1.0f, 0.0f, 0.0f);
+    addContact(contactSets[0], -50.0f, -10.0f, -5.0f, -1.0f, 0.0f, 0.0f);
+    addContact(contactSets[0], 20.0f, 30.0f, -10.0f, 0.0f, 1.0f, 0.0f);
+    addContact(contactSets[0], -20.0f, -30.0f, 10.0f, 0.0f, -1.0f, 0.0f);
+    addContact(contactSets[0], -25.0f, 5.0f, 20.0f, 0.0f, 0.0f, 1.0f);
+    addContact(contactSets[0], 25.0f, -5.0f, -20.0f, 0.0f, 0.0f, -1.0f);
+
+    // two contacts on each of the opposite sides
+    names.push_back("pinch");
+    addContact(contactSets[1], 50.0f, 15.0f, 10.0f, 1.0f, 0.0f, 0.0f);
+    addContact(contactSets[1], 50.0f, -15.0f, -10.0f, 1.0f, 0.0f, 0.0f);
+    addContact(contactSets[1], -50.0f, 15.0f, -10.0f, -1.0f, 0.0f, 0.0f);
+    addContact(contactSets[1], -50.0f, -15.0f, 10.0f, -1.0f, 0.0f, 0.0f);
+
+    // three sides
+    names.push_back("three sides");
+    addContact(contactSets[2], 50.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+    addContact(contactSets[2], -50.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
+    addContact(contactSets[2], 0.0f, 30.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+
+    // all contacts on the top side: the object can be lifted
+    names.push_back("top side");
+    addContact(contactSets[3], 40.0f, 20.0f, 20.0f, 0.0f, 0.0f, 1.0f);
+    addContact(contactSets[3], -40.0f, 20.0f, 20.0f, 0.0f, 0.0f, 1.0f);
+    addContact(contactSets[3], -40.0f, -20.0f, 20.0f, 0.0f, 0.0f, 1.0f);
+    addContact(contactSets[3], 40.0f, -20.0f, 20.0f, 0.0f, 0.0f, 1.0f);
+
+    std::vector<bool> forceClosure(contactSets.size());
+
+    for (size_t i = 0; i < contactSets.size(); i++)
+    {
+        BOOST_TEST_MESSAGE("Contact set: " << names[i]);
+        exact.setContactPoints(contactSets[i]);
+        fast.setContactPoints(contactSets[i]);
+
+        exact.calculateGWS();
+        BOOST_REQUIRE(exact.getConvexHullGWS());
+        BOOST_REQUIRE(!exact.getConvexHullGWS()->faces.empty());
+
+        forceClosure[i] = exact.isGraspForceClosure();
+        BOOST_CHECK_EQUAL(fast.isGraspForceClosure(), forceClosure[i]);
+
+        if (!forceClosure[i])
+        {
+            BOOST_CHECK_EQUAL(fast.getGWSEpsilon(), 0.0f);
+            BOOST_CHECK_EQUAL(fast.getGraspQuality(), 0.0f);
+            continue;
+        }
+
+        // the fast epsilon is an upper bound of the exact one
+        float epsilon = getEpsilon(exact.getConvexHullGWS());
+        BOOST_TEST_MESSAGE("epsilon: exact " << epsilon << ", fast " << fast.getGWSEpsilon());
+        BOOST_CHECK_GE(fast.getGWSEpsilon(), epsilon - 1e-5f);
+        BOOST_CHECK_GE(fast.getGraspQuality(), epsilon / fast.getOWSEpsilon() - 1e-4f);
+        BOOST_CHECK_CLOSE(fast.getGraspQuality(), fast.getGWSEpsilon() / fast.getOWSEpsilon(), 1e-3f);
+    }
+
+    BOOST_CHECK(forceClosure[0]);
+    BOOST_CHECK(!forceClosure[3]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -21,9 +21,15 @@ using namespace std;
 namespace Saba
 {
 
-    SABA_IMPORT_EXPORT boost::mutex CSpace::colCheckMutex;
+    SABA_IMPORT_EXPORT boost::recursive_mutex CSpace::colCheckMutex;
     SABA_IMPORT_EXPORT int CSpace::cloneCounter = 0;
 
+    namespace
+    {
+        boost::mutex poolGenerationMutex;
+        unsigned long poolGenerationCounter = 0;
+    }
+
     //#define DO_THE_TESTS
     CSpace::CSpace(VirtualRobot::RobotPtr robot, VirtualRobot::CDManagerPtr collisionManager, VirtualRobot::RobotNodeSetPtr robotNodes, unsigned int maxConfigs, unsigned int randomSeed)
     {
@@ -54,6 +60,8 @@ namespace Saba
 
         useMetricWeights = false;
         multiThreaded = false;
+        threadLocalContexts = false;
+        contextPool.reset(new CollisionContextPool());
         stopPathCheck = false;
 
         sampleAlgorithm.reset();
@@ -397,6 +405,13 @@ namespace Saba
 
         performaceVars_distanceCheck++;
 
+        if (threadLocalContexts)
+        {
+            CollisionContext* c = getCollisionContext();
+            c->robot->setJointValues(c->robotNodes, config);
+            return c->cdm->getDistance();
+        }
+
         if (multiThreaded)
         {
             colCheckMutex.lock();
@@ -448,6 +463,15 @@ namespace Saba
     {
         SABA_ASSERT(config.rows() == dimension)
 
+        if (threadLocalContexts)
+        {
+            CollisionContext* c = getCollisionContext();
+            c->robot->setJointValues(c->robotNodes, config);
+            bool col = c->cdm->isInCollision();
+            performaceVars_collisionCheck++;
+            return !col;
+        }
+
         if (multiThreaded)
         {
             colCheckMutex.lock();
@@ -519,6 +543,121 @@ namespace Saba
         return true;
     }
 
+    int CSpace::getFirstInvalidConfig(const std::vector<Eigen::VectorXf>& configs, ValidityCheckOrder order, bool findLowestIndex, bool checkBorders, bool checkCollisions, bool checkConstraints)
+    {
+        if (configs.size() == 0)
+        {
+            return -1;
+        }
+
+        return checkConfigBatch(&(configs[0]), (unsigned int)configs.size(), order, findLowestIndex, checkBorders, checkCollisions, checkConstraints);
+    }
+
+    int CSpace::checkConfigBatch(const Eigen::VectorXf* configs, unsigned int nrConfigs, ValidityCheckOrder order, bool findLowestIndex, bool checkBorders, bool checkCollisions, bool checkConstraints)
+    {
+        if (nrConfigs == 0)
+        {
+            return -1;
+        }
+
+        // van der Corput order: bit reversal of 1..2^bits-1, the first index (0) is checked last
+        unsigned int nrBits = 0;
+
+        while ((1u << nrBits) < nrConfigs)
+        {
+            nrBits++;
+        }
+
+        unsigned int nrSteps = (order == eVanDerCorputOrder) ? (1u << nrBits) : nrConfigs;
+
+        VirtualRobot::RobotPtr r = robo;
+
+        if (checkCollisions && threadLocalContexts)
+        {
+            r = getCollisionContext()->robot;
+        }
+
+        // lock once for the whole batch, isCollisionFree() re-acquires both locks recursively
+        boost::unique_lock<boost::recursive_mutex> colLock(colCheckMutex, boost::defer_lock);
+
+        if (checkCollisions && multiThreaded && !threadLocalContexts)
+        {
+            colLock.lock();
+        }
+
+        WriteLockPtr robotLock;
+
+        if (checkCollisions)
+        {
+            robotLock = r->getWriteLock();
+        }
+
+        int result = -1;
+
+        for (unsigned int step = 0; step < nrSteps; step++)
+        {
+            unsigned int index = step;
+
+            if (order == eVanDerCorputOrder)
+            {
+                unsigned int s = (step + 1) % nrSteps;
+                index = 0;
+
+                for (unsigned int b = 0; b < nrBits; b++)
+                {
+                    index = (index << 1) | ((s >> b) & 1);
+                }
+
+                if (index >= nrConfigs)
+                {
+                    continue;
+                }
+            }
+
+            if (result >= 0 && (int)index > result)
+            {
+                // we already know an invalid configuration with lower index
+                continue;
+            }
+
+            if (stopPathCheck)
+            {
+                return (int)index;
+            }
+
+            const Eigen::VectorXf& config = configs[index];
+            SABA_ASSERT(config.rows() == dimension)
+            bool valid = true;
+
+            if (checkBorders && !isInBoundary(config))
+            {
+                valid = false;
+            }
+
+            if (valid && checkCollisions && !isCollisionFree(config))
+            {
+                valid = false;
+            }
+
+            if (valid && checkConstraints && !isSatisfyingConstraints(config))
+            {
+                valid = false;
+            }
+
+            if (!valid)
+            {
+                result = (int)index;
+
+                if (!findLowestIndex || index == 0 || order == eSequentialOrder)
+                {
+                    break;
+                }
+            }
+        }
+
+        return result;
+    }
+
 
     float CSpace::getBoundaryMin(unsigned int d)
     {
@@ -579,6 +718,8 @@ namespace Saba
     // config values are not set! (except id)
     CSpaceNodePtr CSpace::createNewNode()
     {
+        boost::lock_guard<boost::mutex> lock(nodeMutex);
+
         if (freeNodes.size() == 0)
         {
             SABA_ERROR << " Could not create new nodes... (maxNodes exceeded:" << maxNodes << ")" << std::endl;
@@ -750,6 +891,124 @@ namespace Saba
         return multiThreaded;
     }
 
+    void CSpace::enableThreadLocalCollisionContexts(bool enable)
+    {
+        threadLocalContexts = enable;
+    }
+
+    bool CSpace::hasThreadLocalCollisionContexts() const
+    {
+        return threadLocalContexts;
+    }
+
+    unsigned int CSpace::getNrOfCollisionContexts()
+    {
+        boost::mutex::scoped_lock lock(contextPool->mutex);
+        return (unsigned int)contextPool->contexts.size();
+    }
+
+    CSpace::CollisionContextPool::CollisionContextPool()
+    {
+        boost::mutex::scoped_lock lock(poolGenerationMutex);
+        generation = ++poolGenerationCounter;
+    }
+
+    CSpace::ThreadCollisionContext::~ThreadCollisionContext()
+    {
+        CollisionContextPoolPtr p = pool.lock();
+
+        if (p && context)
+        {
+            boost::mutex::scoped_lock lock(p->mutex);
+            p->freeContexts.push_back(context);
+        }
+    }
+
+    CSpace::CollisionContext* CSpace::getCollisionContext()
+    {
+        ThreadCollisionContext* t = threadContext.get();
+
+        // the generation check covers stale entries of a destroyed cspace (and pool) at the same address
+        if (t && t->poolGeneration == contextPool->generation)
+        {
+            return t->context.get();
+        }
+
+        t = new ThreadCollisionContext();
+        t->pool = contextPool;
+        t->poolGeneration = contextPool->generation;
+
+        {
+            boost::mutex::scoped_lock lock(contextPool->mutex);
+
+            if (!contextPool->freeContexts.empty())
+            {
+                t->context = contextPool->freeContexts.back();
+                contextPool->freeContexts.pop_back();
+            }
+        }
+
+        if (!t->context)
+        {
+            t->context = createCollisionContext();
+        }
+
+        threadContext.reset(t);
+        return t->context.get();
+    }
+
+    CSpace::CollisionContextPtr CSpace::createCollisionContext()
+    {
+        // cloning reads the original models, so we serialize the creation of contexts
+        boost::mutex::scoped_lock lock(contextPool->mutex);
+
+        if (multiThreaded)
+        {
+            colCheckMutex.lock();
+        }
+
+        CollisionContextPtr c(new CollisionContext());
+
+        try
+        {
+            c->colChecker.reset(new VirtualRobot::CollisionChecker());
+            std::stringstream ss;
+            ss << robo->getName() << "_context_" << contextPool->contexts.size();
+            c->robot = robo->clone(ss.str(), c->colChecker);
+            c->robot->setUpdateVisualization(false);
+
+            std::map<VirtualRobot::RobotPtr, VirtualRobot::RobotPtr> robotMapping;
+            robotMapping[robo] = c->robot;
+            c->cdm = cdm->clone(c->colChecker, robotMapping);
+        }
+        catch (...)
+        {
+            if (multiThreaded)
+            {
+                colCheckMutex.unlock();
+            }
+
+            throw;
+        }
+
+        if (multiThreaded)
+        {
+            colCheckMutex.unlock();
+        }
+
+        if (c->robot->hasRobotNodeSet(robotNodes->getName()))
+        {
+            c->robotNodes = c->robot->getRobotNodeSet(robotNodes->getName());
+        }
+        else
+        {
+            c->robotNodes = robotNodes->clone(c->robot);
+        }
+
+        contextPool->contexts.push_back(c);
+        return c;
+    }
+
     /*int CSpace::getMaxConfigs() const
     {
         return maxConfigs;
@@ -793,6 +1052,7 @@ namespace Saba
             return;
         }
 
+        boost::lock_guard<boost::mutex> lock(nodeMutex);
         node->allocated = false;
         freeNodes.push_back(node);
     }
@@ -846,6 +1106,12 @@ namespace Saba
         return false;
     }
 
+    bool CSpace::isBorderlessDimensionEnabled(unsigned int dim) const
+    {
+        SABA_ASSERT(dim < dimension)
+        return borderLessDimension[dim];
+    }
+
     unsigned int CSpace::getDimension() const
     {
         return dimension;
@@ -856,6 +1122,11 @@ namespace Saba
         return robo;
     }
 
+    VirtualRobot::CDManagerPtr CSpace::getCDManager() const
+    {
+        return cdm;
+    }
+
     void CSpace::addConstraintCheck(ConfigurationConstraintPtr constraint)
     {
         constraints.push_back(constraint);
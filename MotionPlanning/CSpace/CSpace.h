@@ -117,6 +117,11 @@ namespace Saba
 
         bool isBorderlessDimension(unsigned int dim) const;
 
+        /*!
+            Returns true, if dimension dim is currently handled as borderless dimension (@see checkForBorderlessDimensions).
+        */
+        bool isBorderlessDimensionEnabled(unsigned int dim) const;
+
         //! get cspace dimension
         unsigned int getDimension() const;
 
@@ -218,6 +223,38 @@ namespace Saba
         void exclusiveRobotAccess(bool bGranted = true);
         bool hasExclusiveRobotAccess();
 
+        /*!
+            A collision context holds independent instances of the robot, the collision checker and the collision manager.
+        */
+        struct CollisionContext
+        {
+            VirtualRobot::CollisionCheckerPtr colChecker;
+            VirtualRobot::RobotPtr robot;
+            VirtualRobot::RobotNodeSetPtr robotNodes;
+            VirtualRobot::CDManagerPtr cdm;
+
+            std::vector<Eigen::VectorXf> tmpConfigs;    //!< thread local temporary data (e.g. for path checks)
+        };
+        typedef boost::shared_ptr<CollisionContext> CollisionContextPtr;
+
+        /*!
+            Enable lock-free parallel collision checking.
+            When enabled, each thread that performs collision or distance queries on this cspace operates on its own collision context,
+            i.e. on clones of the robot, the collision checker and the collision manager (including all obstacles).
+            The contexts are created lazily on the first query of a thread and reused for all following queries of that thread.
+            When a thread finishes, its context is handed over to the next thread that needs one.
+            Hence, multiple threads (e.g. PlanningThreads sharing this cspace) can check configurations truly in parallel and the mutex
+            protection (@see exclusiveRobotAccess) is not needed.
+            Note, that the contexts are created from the current state of the robot and the environment, later changes (e.g. moving obstacles)
+            are not considered. The original robot is not modified by collision queries in this mode.
+            (standard: disabled)
+        */
+        void enableThreadLocalCollisionContexts(bool enable);
+        bool hasThreadLocalCollisionContexts() const;
+
+        //! Number of collision contexts that have been created so far.
+        unsigned int getNrOfCollisionContexts();
+
 
         //! if multithreading is enabled, the colChecking mutex can be locked/unlocked externally
         static void lock();
@@ -298,6 +335,27 @@ namespace Saba
         //! check whether a configuration is valid (collision, boundary, and constraints check)
         virtual bool isConfigValid(const Eigen::VectorXf& pConfig, bool checkBorders = true, bool checkCollisions = true, bool checkConstraints = true);
 
+        enum ValidityCheckOrder
+        {
+            eSequentialOrder,       //!< check the configurations as given
+            eVanDerCorputOrder      //!< check the middle configuration first, then the quarters, the eighths, ...
+        };
+
+        /*!
+            Check a batch of configurations (e.g. intermediate configurations of a path segment).
+            Compared to calling isConfigValid for each configuration, the robot (and the collision mutex in multithreaded mode)
+            is locked only once for the whole batch.
+            With eVanDerCorputOrder the configurations are checked in van der Corput (bit-reversal) order, i.e. samples that are
+            far apart are checked first. Since obstacles usually invalidate a contiguous range of samples, invalid batches are detected earlier.
+            \param configs The configurations.
+            \param order The order in which the configurations are checked.
+            \param findLowestIndex If set, the lowest invalid index is determined, i.e. the check proceeds with all lower indices after an invalid configuration was detected.
+                   Otherwise the method returns as soon as any invalid configuration is found.
+            \return -1 if all configurations are valid, otherwise the index of the first invalid configuration.
+                    If the check was stopped (@see requestStop), the index of the current configuration is returned.
+        */
+        virtual int getFirstInvalidConfig(const std::vector<Eigen::VectorXf>& configs, ValidityCheckOrder order = eVanDerCorputOrder, bool findLowestIndex = true, bool checkBorders = true, bool checkCollisions = true, bool checkConstraints = true);
+
         /*!
             Add a configuration constraint to be checked within this cspace.
             Standard: No constraints, meaning that a check for constraints will report a valid status
@@ -308,6 +366,39 @@ namespace Saba
 
 
 
+        /*!
+            Returns the collision context of the calling thread (which is created if needed).
+            Only valid when thread local collision contexts are enabled.
+        */
+        CollisionContext* getCollisionContext();
+        CollisionContextPtr createCollisionContext();
+
+        /*!
+            Batch check of nrConfigs configurations, starting at configs (@see getFirstInvalidConfig).
+            Each configuration is checked with isInBoundary(), isCollisionFree() and isSatisfyingConstraints(), so overrides of these methods are respected.
+            The collision mutex and the robot lock are acquired once for the whole batch.
+        */
+        int checkConfigBatch(const Eigen::VectorXf* configs, unsigned int nrConfigs, ValidityCheckOrder order, bool findLowestIndex, bool checkBorders, bool checkCollisions, bool checkConstraints);
+
+        struct CollisionContextPool
+        {
+            CollisionContextPool();
+            unsigned long generation;                       // unique for each pool, addresses may be reused
+            boost::mutex mutex;
+            std::vector<CollisionContextPtr> contexts;      // all contexts
+            std::vector<CollisionContextPtr> freeContexts;  // contexts that are currently not used by any thread
+        };
+        typedef boost::shared_ptr<CollisionContextPool> CollisionContextPoolPtr;
+
+        // owned by the thread, returns the context to the pool when the thread finishes
+        struct ThreadCollisionContext
+        {
+            ~ThreadCollisionContext();
+            boost::weak_ptr<CollisionContextPool> pool;
+            unsigned long poolGeneration;
+            CollisionContextPtr context;
+        };
+
         // gets direction vector from c1 to c2, with (weighted) length
         virtual void getDirectionVector(const Eigen::VectorXf& c1, const Eigen::VectorXf& c2, Eigen::VectorXf& storeDir, float length);
 
@@ -343,6 +434,7 @@ namespace Saba
         int maxNodes;
         std::vector< CSpaceNodePtr > nodes;                         //! vector with pointers to really used nodes
         std::vector< CSpaceNodePtr > freeNodes;                     //! vector with pointers to free (not used) nodes
+        boost::mutex nodeMutex;                                     //! protects the node pool, since multiple trees may add nodes concurrently (@see ParallelBiRrt)
 
         std::vector<VirtualRobot::RobotNodePtr> robotJoints;        //!< joints of the robot that we are manipulating
 
@@ -354,8 +446,12 @@ namespace Saba
         std::vector< bool > borderLessDimension;         // store borderless state
 
         bool multiThreaded;                             // indicates that more than one CSpace is used by some threads
-        static boost::mutex colCheckMutex;              // only needed when multithreading support is enabled
+        static boost::recursive_mutex colCheckMutex;    // only needed when multithreading support is enabled (recursive: checkConfigBatch holds it while calling isCollisionFree)
         //  -> setting the configurations and checking against collisions is protected by this mutex
+
+        bool threadLocalContexts;                                           // each thread uses its own collision context
+        CollisionContextPoolPtr contextPool;
+        boost::thread_specific_ptr<ThreadCollisionContext> threadContext;   // the context of each thread
         std::vector<ConfigurationConstraintPtr>  constraints;
 
         SamplerPtr sampleAlgorithm; // standard is NULL (uniformly sampling), is used in getRandomConfig()
@@ -0,0 +1,595 @@
+#include "CSpaceKdTree.h"
+#include "CSpace.h"
+#include "CSpaceNode.h"
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+using namespace std;
+
+namespace Saba
+{
+
+    namespace
+    {
+        // sorts entries according to one coordinate
+        struct EntryCompare
+        {
+            EntryCompare(const std::vector<float>& points, unsigned int dimension, int dim)
+                : points(points), dimension(dimension), dim(dim)
+            {
+            }
+
+            bool operator()(int a, int b) const
+            {
+                return points[a * dimension + dim] < points[b * dimension + dim];
+            }
+
+            const std::vector<float>& points;
+            unsigned int dimension;
+            int dim;
+        };
+    }
+
+    CSpaceKdTree::CSpaceKdTree(CSpacePtr cspace, bool useMetricWeights)
+    {
+        if (!cspace)
+        {
+            THROW_SABA_EXCEPTION("NULL data, aborting...");
+        }
+
+        dimension = cspace->getDimension();
+        weights2.resize(dimension, 1.0f);
+        borderless.resize(dimension, false);
+        Eigen::VectorXf w = cspace->getMetricWeights();
+
+        for (unsigned int i = 0; i < dimension; i++)
+        {
+            if (useMetricWeights)
+            {
+                weights2[i] = w[i] * w[i];
+            }
+
+            borderless[i] = cspace->isBorderlessDimensionEnabled(i);
+        }
+
+        balanceFactor = 0.75f;
+        root = -1;
+        nrRemoved = 0;
+    }
+
+    CSpaceKdTree::~CSpaceKdTree()
+    {
+    }
+
+    void CSpaceKdTree::reset()
+    {
+        points.clear();
+        bbMin.clear();
+        bbMax.clear();
+        splitDim.clear();
+        left.clear();
+        right.clear();
+        subtreeSize.clear();
+        nodeIDs.clear();
+        removed.clear();
+        idEntryMapping.clear();
+        root = -1;
+        nrRemoved = 0;
+    }
+
+    unsigned int CSpaceKdTree::getNrOfNodes() const
+    {
+        return (unsigned int)nodeIDs.size() - nrRemoved;
+    }
+
+    unsigned int CSpaceKdTree::getDimension() const
+    {
+        return dimension;
+    }
+
+    float CSpaceKdTree::dimDist(unsigned int dim, float a, float b) const
+    {
+        // same as CSpace::calcDist2
+        float d = a - b;
+
+        if (borderless[dim] && fabs(d) > M_PI)
+        {
+            d = 2.0f * (float)M_PI - fabs(d);
+        }
+
+        return d;
+    }
+
+    float CSpaceKdTree::dist2(const float* a, const float* b) const
+    {
+        float res = 0.0f;
+
+        for (unsigned int i = 0; i < dimension; i++)
+        {
+            float d = dimDist(i, a[i], b[i]);
+            res += weights2[i] * d * d;
+        }
+
+        return res;
+    }
+
+    float CSpaceKdTree::lowerBoundDist2(int kdNode, const float* query) const
+    {
+        const float* lo = &bbMin[kdNode * dimension];
+        const float* hi = &bbMax[kdNode * dimension];
+        float res = 0.0f;
+
+        for (unsigned int i = 0; i < dimension; i++)
+        {
+            float q = query[i];
+
+            if (q >= lo[i] && q <= hi[i])
+            {
+                continue;
+            }
+
+            float d;
+
+            if (!borderless[i])
+            {
+                d = (q < lo[i]) ? (lo[i] - q) : (q - hi[i]);
+            }
+            else
+            {
+                // the wrapped distance is piecewise linear in (q-x), its minimum within the box is located
+                // at the box borders or where q-x equals +-2PI
+                float dMin = q - hi[i];
+                float dMax = q - lo[i];
+                const float twoPi = 2.0f * (float)M_PI;
+
+                if ((dMin <= twoPi && dMax >= twoPi) || (dMin <= -twoPi && dMax >= -twoPi))
+                {
+                    continue;
+                }
+
+                d = std::min(fabs(dimDist(i, q, hi[i])), fabs(dimDist(i, q, lo[i])));
+            }
+
+            res += weights2[i] * d * d;
+        }
+
+        return res;
+    }
+
+    void CSpaceKdTree::expandBoundingBox(int entry, const float* p)
+    {
+        float* lo = &bbMin[entry * dimension];
+        float* hi = &bbMax[entry * dimension];
+
+        for (unsigned int i = 0; i < dimension; i++)
+        {
+            lo[i] = std::min(lo[i], p[i]);
+            hi[i] = std::max(hi[i], p[i]);
+        }
+    }
+
+    void CSpaceKdTree::expandBoundingBox(int entry, int child)
+    {
+        float* lo = &bbMin[entry * dimension];
+        float* hi = &bbMax[entry * dimension];
+        const float* cLo = &bbMin[child * dimension];
+        const float* cHi = &bbMax[child * dimension];
+
+        for (unsigned int i = 0; i < dimension; i++)
+        {
+            lo[i] = std::min(lo[i], cLo[i]);
+            hi[i] = std::max(hi[i], cHi[i]);
+        }
+    }
+
+    void CSpaceKdTree::addNode(CSpaceNodePtr node)
+    {
+        SABA_ASSERT(node)
+        SABA_ASSERT(node->configuration.rows() == dimension)
+
+        int entry = (int)nodeIDs.size();
+        const float* p = node->configuration.data();
+
+        points.insert(points.end(), p, p + dimension);
+        bbMin.insert(bbMin.end(), p, p + dimension);
+        bbMax.insert(bbMax.end(), p, p + dimension);
+        splitDim.push_back(0);
+        left.push_back(-1);
+        right.push_back(-1);
+        subtreeSize.push_back(1);
+        nodeIDs.push_back(node->ID);
+        removed.push_back(false);
+
+        if (idEntryMapping.size() <= node->ID)
+        {
+            idEntryMapping.resize(node->ID + 1, -1);
+        }
+
+        idEntryMapping[node->ID] = entry;
+
+        if (root < 0)
+        {
+            root = entry;
+            return;
+        }
+
+        // descend and update bounding boxes / sizes on the way
+        std::vector<int> path;
+        int cur = root;
+
+        while (true)
+        {
+            path.push_back(cur);
+            expandBoundingBox(cur, p);
+            subtreeSize[cur]++;
+            int s = splitDim[cur];
+            std::vector<int>& child = (p[s] < points[cur * dimension + s]) ? left : right;
+
+            if (child[cur] < 0)
+            {
+                child[cur] = entry;
+                break;
+            }
+
+            cur = child[cur];
+        }
+
+        // split along the dimension with the largest (weighted) extent of the parent's region
+        float bestExtent = -1.0f;
+
+        for (unsigned int i = 0; i < dimension; i++)
+        {
+            float e = weights2[i] * (bbMax[cur * dimension + i] - bbMin[cur * dimension + i]);
+
+            if (e > bestExtent)
+            {
+                bestExtent = e;
+                splitDim[entry] = i;
+            }
+        }
+
+        // check if the depth exceeds the alpha-height bound
+        float maxDepth = logf((float)subtreeSize[root]) / logf(1.0f / balanceFactor);
+
+        if ((float)path.size() <= maxDepth)
+        {
+            return;
+        }
+
+        // search scapegoat (an alpha-unbalanced ancestor) and rebuild its subtree
+        for (int i = (int)path.size() - 2; i >= 0; i--)
+        {
+            int n = path[i];
+            int c = path[i + 1];
+
+            if ((float)subtreeSize[c] > balanceFactor * (float)subtreeSize[n])
+            {
+                rebuildSubtree(n, i > 0 ? path[i - 1] : -1);
+                return;
+            }
+        }
+    }
+
+    void CSpaceKdTree::removeNode(CSpaceNodePtr node)
+    {
+        SABA_ASSERT(node)
+
+        if (node->ID >= idEntryMapping.size() || idEntryMapping[node->ID] < 0)
+        {
+            SABA_WARNING << "node " << node->ID << " not in kd-tree" << endl;
+            return;
+        }
+
+        int entry = idEntryMapping[node->ID];
+        removed[entry] = true;
+        idEntryMapping[node->ID] = -1;
+        nrRemoved++;
+
+        if (nrRemoved * 2 > nodeIDs.size())
+        {
+            rebuild();
+        }
+    }
+
+    void CSpaceKdTree::build(const std::vector<CSpaceNodePtr>& nodes)
+    {
+        reset();
+
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            SABA_ASSERT(nodes[i]->configuration.rows() == dimension)
+            const float* p = nodes[i]->configuration.data();
+            points.insert(points.end(), p, p + dimension);
+            nodeIDs.push_back(nodes[i]->ID);
+
+            if (idEntryMapping.size() <= nodes[i]->ID)
+            {
+                idEntryMapping.resize(nodes[i]->ID + 1, -1);
+            }
+
+            idEntryMapping[nodes[i]->ID] = (int)i;
+        }
+
+        size_t n = nodeIDs.size();
+        bbMin.resize(n * dimension);
+        bbMax.resize(n * dimension);
+        splitDim.resize(n, 0);
+        left.resize(n, -1);
+        right.resize(n, -1);
+        subtreeSize.resize(n, 1);
+        removed.resize(n, false);
+
+        std::vector<int> entries(n);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            entries[i] = (int)i;
+        }
+
+        root = buildRecursive(entries, 0, (int)n);
+    }
+
+    void CSpaceKdTree::rebuild()
+    {
+        std::vector<CSpaceNodePtr> activeNodes;
+
+        for (size_t i = 0; i < nodeIDs.size(); i++)
+        {
+            if (!removed[i])
+            {
+                CSpaceNodePtr n(new CSpaceNode());
+                n->ID = nodeIDs[i];
+                n->configuration = Eigen::Map<const Eigen::VectorXf>(&points[i * dimension], dimension);
+                activeNodes.push_back(n);
+            }
+        }
+
+        build(activeNodes);
+    }
+
+    void CSpaceKdTree::rebuildSubtree(int entry, int parent)
+    {
+        std::vector<int> entries;
+        entries.reserve(subtreeSize[entry]);
+        std::vector<int> stack(1, entry);
+
+        while (!stack.empty())
+        {
+            int n = stack.back();
+            stack.pop_back();
+            entries.push_back(n);
+
+            if (left[n] >= 0)
+            {
+                stack.push_back(left[n]);
+            }
+
+            if (right[n] >= 0)
+            {
+                stack.push_back(right[n]);
+            }
+        }
+
+        int newRoot = buildRecursive(entries, 0, (int)entries.size());
+
+        if (parent < 0)
+        {
+            root = newRoot;
+        }
+        else if (left[parent] == entry)
+        {
+            left[parent] = newRoot;
+        }
+        else
+        {
+            right[parent] = newRoot;
+        }
+    }
+
+    int CSpaceKdTree::buildRecursive(std::vector<int>& entries, int begin, int end)
+    {
+        if (begin >= end)
+        {
+            return -1;
+        }
+
+        // determine split dimension (largest weighted extent)
+        std::vector<float> lo(points.begin() + entries[begin] * dimension, points.begin() + (entries[begin] + 1) * dimension);
+        std::vector<float> hi = lo;
+
+        for (int j = begin + 1; j < end; j++)
+        {
+            const float* p = &points[entries[j] * dimension];
+
+            for (unsigned int i = 0; i < dimension; i++)
+            {
+                lo[i] = std::min(lo[i], p[i]);
+                hi[i] = std::max(hi[i], p[i]);
+            }
+        }
+
+        int dim = 0;
+        float bestExtent = -1.0f;
+
+        for (unsigned int i = 0; i < dimension; i++)
+        {
+            float e = weights2[i] * (hi[i] - lo[i]);
+
+            if (e > bestExtent)
+            {
+                bestExtent = e;
+                dim = i;
+            }
+        }
+
+        int mid = begin + (end - begin) / 2;
+        std::nth_element(entries.begin() + begin, entries.begin() + mid, entries.begin() + end, EntryCompare(points, dimension, dim));
+
+        int n = entries[mid];
+        splitDim[n] = dim;
+        subtreeSize[n] = end - begin;
+        std::copy(lo.begin(), lo.end(), bbMin.begin() + n * dimension);
+        std::copy(hi.begin(), hi.end(), bbMax.begin() + n * dimension);
+        left[n] = buildRecursive(entries, begin, mid);
+        right[n] = buildRecursive(entries, mid + 1, end);
+
+        return n;
+    }
+
+    int CSpaceKdTree::getNearestNeighborID(const Eigen::VectorXf& config, float* storeDist2) const
+    {
+        SABA_ASSERT(config.rows() == dimension)
+
+        if (root < 0 || getNrOfNodes() == 0)
+        {
+            return -1;
+        }
+
+        const float* q = config.data();
+        float best = FLT_MAX;
+        int bestEntry = -1;
+
+        std::vector<int> stack;
+        stack.reserve(64);
+        stack.push_back(root);
+
+        while (!stack.empty())
+        {
+            int n = stack.back();
+            stack.pop_back();
+
+            if (lowerBoundDist2(n, q) >= best)
+            {
+                continue;
+            }
+
+            if (!removed[n])
+            {
+                float d = dist2(q, &points[n * dimension]);
+
+                if (d < best)
+                {
+                    best = d;
+                    bestEntry = n;
+                }
+            }
+
+            // visit the child containing the query first (pushed last)
+            int s = splitDim[n];
+            bool goLeft = q[s] < points[n * dimension + s];
+            int first = goLeft ? left[n] : right[n];
+            int second = goLeft ? right[n] : left[n];
+
+            if (second >= 0)
+            {
+                stack.push_back(second);
+            }
+
+            if (first >= 0)
+            {
+                stack.push_back(first);
+            }
+        }
+
+        if (bestEntry < 0)
+        {
+            return -1;
+        }
+
+        if (storeDist2)
+        {
+            *storeDist2 = best;
+        }
+
+        return (int)nodeIDs[bestEntry];
+    }
+
+    unsigned int CSpaceKdTree::getKNearestNeighborIDs(const Eigen::VectorXf& config, unsigned int k, std::vector<int>& storeIDs, std::vector<float>* storeDist2, float maxDist2) const
+    {
+        SABA_ASSERT(config.rows() == dimension)
+
+        storeIDs.clear();
+
+        if (storeDist2)
+        {
+            storeDist2->clear();
+        }
+
+        if (root < 0 || getNrOfNodes() == 0 || k == 0)
+        {
+            return 0;
+        }
+
+        const float* q = config.data();
+
+        // max-heap of the k best entries, the worst one is on top
+        std::vector< std::pair<float, int> > best;
+        best.reserve(k + 1);
+
+        std::vector<int> stack;
+        stack.reserve(64);
+        stack.push_back(root);
+
+        while (!stack.empty())
+        {
+            int n = stack.back();
+            stack.pop_back();
+
+            float bound = (best.size() < k) ? maxDist2 : best.front().first;
+
+            if (lowerBoundDist2(n, q) >= bound)
+            {
+                continue;
+            }
+
+            if (!removed[n])
+            {
+                float d = dist2(q, &points[n * dimension]);
+
+                if (d < bound)
+                {
+                    best.push_back(std::make_pair(d, n));
+                    std::push_heap(best.begin(), best.end());
+
+                    if (best.size() > k)
+                    {
+                        std::pop_heap(best.begin(), best.end());
+                        best.pop_back();
+                    }
+                }
+            }
+
+            // visit the child containing the query first (pushed last)
+            int s = splitDim[n];
+            bool goLeft = q[s] < points[n * dimension + s];
+            int first = goLeft ? left[n] : right[n];
+            int second = goLeft ? right[n] : left[n];
+
+            if (second >= 0)
+            {
+                stack.push_back(second);
+            }
+
+            if (first >= 0)
+            {
+                stack.push_back(first);
+            }
+        }
+
+        std::sort_heap(best.begin(), best.end());
+
+        for (size_t i = 0; i < best.size(); i++)
+        {
+            storeIDs.push_back((int)nodeIDs[best[i].second]);
+
+            if (storeDist2)
+            {
+                storeDist2->push_back(best[i].first);
+            }
+        }
+
+        return (unsigned int)best.size();
+    }
+
+} // namespace Saba
@@ -0,0 +1,135 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef _saba_cspacekdtree_h
+#define _saba_cspacekdtree_h
+
+#include "../Saba.h"
+#include <vector>
+#include <cfloat>
+
+namespace Saba
+{
+
+    /*!
+     * \brief An incremental kd-tree for nearest neighbor queries in c-space.
+     *
+     * The tree uses the same metric as CSpace::calcDist2: Dimensions can be weighted
+     * and borderless (rotational) dimensions are handled by considering the wrap-around distance.
+     * Each kd-node stores the bounding box of its subtree, which is used to compute exact lower bounds
+     * during the search, also for borderless dimensions.
+     *
+     * Nodes are added incrementally. Since RRTs add long chains of nearby configurations, unbalanced subtrees
+     * are rebuilt on the fly (scapegoat strategy), so the depth stays logarithmic.
+     * Removed nodes are marked and skipped. When more than half of the stored entries have been removed, the tree is rebuilt.
+     * All data is stored in flat arrays in order to allow cache friendly traversals.
+     *
+     * Note: The metric settings (weights, borderless dimensions) of the cspace are copied on construction.
+     *
+     * @see CSpaceTree::setNearestNeighborSearch
+     */
+    class SABA_IMPORT_EXPORT CSpaceKdTree
+    {
+    public:
+        /*!
+            Constructor
+            \param cspace The c-space, defining the dimension and the borderless dimensions.
+            \param useMetricWeights If set, the metric weights of the cspace are used for distance computation.
+        */
+        CSpaceKdTree(CSpacePtr cspace, bool useMetricWeights = false);
+        virtual ~CSpaceKdTree();
+
+        //! Add a node (identified by node->ID) to the index.
+        void addNode(CSpaceNodePtr node);
+
+        //! Remove a node from the index.
+        void removeNode(CSpaceNodePtr node);
+
+        //! Removes all entries.
+        void reset();
+
+        /*!
+            Build a balanced tree with the given nodes (all existing entries are removed).
+        */
+        void build(const std::vector<CSpaceNodePtr>& nodes);
+
+        /*!
+            Search the nearest neighbor.
+            \param config The query configuration.
+            \param storeDist2 If given, the squared distance is stored here.
+            \return The ID of the nearest CSpaceNode or -1 if the tree is empty.
+        */
+        int getNearestNeighborID(const Eigen::VectorXf& config, float* storeDist2 = NULL) const;
+
+        /*!
+            Search the k nearest neighbors.
+            \param config The query configuration.
+            \param k The maximal number of neighbors.
+            \param storeIDs The IDs of the neighbors are stored here, sorted by distance (nearest first).
+            \param storeDist2 If given, the squared distances are stored here.
+            \param maxDist2 Only neighbors with a squared distance below this value are considered.
+            \return The number of neighbors that were found.
+        */
+        unsigned int getKNearestNeighborIDs(const Eigen::VectorXf& config, unsigned int k, std::vector<int>& storeIDs, std::vector<float>* storeDist2 = NULL, float maxDist2 = FLT_MAX) const;
+
+        //! Number of (not removed) entries.
+        unsigned int getNrOfNodes() const;
+
+        unsigned int getDimension() const;
+
+    protected:
+        int buildRecursive(std::vector<int>& entries, int begin, int end);
+        void rebuildSubtree(int entry, int parent);
+        void rebuild();
+
+        void expandBoundingBox(int entry, const float* p);
+        void expandBoundingBox(int entry, int child);
+
+        float dist2(const float* a, const float* b) const;
+        float lowerBoundDist2(int kdNode, const float* query) const;
+        float dimDist(unsigned int dim, float a, float b) const;
+
+        unsigned int dimension;
+        std::vector<float> weights2;            //!< squared metric weights
+        std::vector<bool> borderless;           //!< borderless dimensions
+
+        // flat storage, one entry per inserted config
+        std::vector<float> points;              //!< dimension floats per entry
+        std::vector<float> bbMin;               //!< bounding box of the subtree (dimension floats per entry)
+        std::vector<float> bbMax;
+        std::vector<int> splitDim;
+        std::vector<int> left;
+        std::vector<int> right;
+        std::vector<unsigned int> subtreeSize;  //!< number of entries in the subtree (including removed ones)
+        std::vector<unsigned int> nodeIDs;      //!< CSpaceNode id of each entry
+        std::vector<bool> removed;
+
+        std::vector<int> idEntryMapping;        //!< CSpaceNode id -> entry (-1 if not present)
+
+        int root;
+        unsigned int nrRemoved;
+        float balanceFactor;                    //!< alpha of the scapegoat balancing
+    };
+
+} // namespace Saba
+
+#endif // _saba_cspacekdtree_h
@@ -52,6 +52,7 @@ namespace Saba
         unsigned int ID;                        //!< id of CSpaceNode
 
         bool allocated;
+        bool lazy;                              //!< the edge to the parent has not been checked for collisions yet (@see Rrt::enableLazyCollisionChecking)
 
         // optional
         int status;
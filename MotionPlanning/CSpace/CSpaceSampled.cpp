@@ -19,21 +19,14 @@ namespace Saba
 {
 
     CSpaceSampled::CSpaceSampled(VirtualRobot::RobotPtr robot, VirtualRobot::CDManagerPtr collisionManager, VirtualRobot::RobotNodeSetPtr robotNodes, unsigned int maxConfigs, unsigned int randomSeed)
-        : CSpace(robot, collisionManager, robotNodes, maxConfigs, randomSeed),
-          recursionMaxDepth(1000)
+        : CSpace(robot, collisionManager, robotNodes, maxConfigs, randomSeed)
     {
-        recursiveTmpValuesIndex = 0;
         samplingSizePaths = 0.1f;
         samplingSizeDCD = 0.1f;
         SABA_ASSERT(dimension != 0);
 
         checkPathConfig.setZero(dimension);
         tmpConfig.setZero(dimension);
-
-        for (int i = 0; i < recursionMaxDepth; i++)
-        {
-            recursiveTmpValues.push_back(tmpConfig);
-        }
     }
 
 
@@ -173,8 +166,8 @@ namespace Saba
 
         Eigen::VectorXf lastConfig = start;
 
-        // init tmp values
-        tmpConfig = start;
+        // init tmp values (local copy, since this method may be called concurrently with thread local collision contexts)
+        Eigen::VectorXf tmpConfig = start;
 
         float nodeDist = 0.0f;
         float colCheckDist = getSamplingSizeDCD();
@@ -239,39 +232,57 @@ namespace Saba
 
     bool CSpaceSampled::isPathValid(const Eigen::VectorXf& q1, const Eigen::VectorXf& q2)
     {
-        if (stopPathCheck)
+        return (getFirstInvalidPathConfig(q1, q2, eVanDerCorputOrder, false) < 0);
+    }
+
+    int CSpaceSampled::getFirstInvalidPathConfig(const Eigen::VectorXf& q1, const Eigen::VectorXf& q2, ValidityCheckOrder order, bool findLowestIndex, float stepSize, unsigned int* storeNrSamples)
+    {
+        SABA_ASSERT(q1.rows() == dimension);
+        SABA_ASSERT(q2.rows() == dimension);
+
+        if (stepSize <= 0)
         {
-            return false;
+            stepSize = samplingSizeDCD;
         }
 
         // actual weighted distance for collision checking
-        float actualWeightedDistance = calcDist(q1, q2);
+        float dist = calcDist(q1, q2);
+        unsigned int nrSamples = 1;
+
+        if (dist > stepSize * 1.001f)
+        {
+            nrSamples = (unsigned int)ceil(dist / (stepSize * 1.001f));
+        }
 
-        if (actualWeightedDistance <= samplingSizeDCD * 1.001f)
+        if (storeNrSamples)
         {
-            // just checking q2, to avoid double checks
-            return isConfigValid(q2, false, true, true); // assuming that q1 and q2 are within the limits of the CSpace
+            *storeNrSamples = nrSamples;
         }
-        else
+
+        // use thread local temporary data, if this method may be called concurrently
+        std::vector<Eigen::VectorXf>& samples = threadLocalContexts ? getCollisionContext()->tmpConfigs : pathCheckConfigs;
+
+        if (samples.size() < nrSamples)
         {
-            recursiveTmpValuesIndex++;
+            samples.resize(nrSamples, tmpConfig);
+        }
 
-            if (recursiveTmpValuesIndex >= recursionMaxDepth)
+        for (unsigned int i = 0; i < nrSamples - 1; i++)
+        {
+            float step = (float)(i + 1) / (float)nrSamples;
+
+            for (unsigned int d = 0; d < dimension; d++)
             {
-                SABA_WARNING << "Recursion depth too high: " << recursiveTmpValuesIndex << std::endl;
-                recursiveTmpValuesIndex--;
-                return false;
+                samples[i][d] = interpolate(q1, q2, d, step);
             }
+        }
 
-            Eigen::VectorXf& middleConfiguration = recursiveTmpValues[recursiveTmpValuesIndex];
-
-            // generate a configuration exactly in the middle of q1 and q2 using weighted distances
-            generateNewConfig(q2, q1, middleConfiguration, actualWeightedDistance * 0.5f, actualWeightedDistance);
+        // avoid rounding errors at the end of the segment
+        samples[nrSamples - 1] = q2;
 
-            bool r = (isPathValid(q1, middleConfiguration) && isPathValid(middleConfiguration, q2));
-            recursiveTmpValuesIndex--;
-            return r;
-        }
+        // assuming that q1 and q2 are within the limits of the CSpace
+        int res = checkConfigBatch(&(samples[0]), nrSamples, order, findLowestIndex, false, true, true);
+        return (res < 0) ? -1 : res + 1;
     }
 
 } // Saba
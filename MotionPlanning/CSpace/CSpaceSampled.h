@@ -93,13 +93,25 @@ namespace Saba
         virtual CSpacePtr clone(VirtualRobot::CollisionCheckerPtr newColChecker, VirtualRobot::RobotPtr newRobot, VirtualRobot::CDManagerPtr newCDM, unsigned int newRandomSeed = 0);
 
         /*!
-            Checks the middle configuration and when it is not invalid (in collision or constraints are violated) the path is split
-            and both parts are recursively checked until the distance is smalled than the DCD sampling size.
-            Recursion is performed maximal recursionMaxDepth times, since an array of temporary variables is used,
-            in order to avoid slow allocating/deallocating of memory.
+            Checks the path segment from q1 to q2 for collisions and constraint violations.
+            The segment is sampled with the DCD sampling size and the intermediate configurations are checked
+            in van der Corput order (middle first, then the quarters, ...) until an invalid configuration is found.
+            q1 is not checked. Temporary configurations are reused, in order to avoid slow allocating/deallocating of memory.
         */
         bool isPathValid(const Eigen::VectorXf& q1, const Eigen::VectorXf& q2);
 
+        /*!
+            Samples the path segment from q1 to q2 and checks the samples with one batch query (@see CSpace::getFirstInvalidConfig).
+            \param q1 The start of the segment (not checked).
+            \param q2 The end of the segment.
+            \param order The order in which the samples are checked.
+            \param findLowestIndex If set, the invalid sample that is nearest to q1 is determined, otherwise any invalid sample is reported.
+            \param stepSize The maximal distance between two samples. If <=0, the DCD sampling size is used.
+            \param storeNrSamples If given, the number of samples is stored here (the last sample is q2).
+            \return -1 if all samples are valid, otherwise the (1 based) number of the first invalid sample, i.e. the configuration q1 + (q2-q1)*result/nrSamples.
+        */
+        int getFirstInvalidPathConfig(const Eigen::VectorXf& q1, const Eigen::VectorXf& q2, ValidityCheckOrder order = eVanDerCorputOrder, bool findLowestIndex = true, float stepSize = -1.0f, unsigned int* storeNrSamples = NULL);
+
         /*!
         Create a path from start to goal without any checks.
         Intermediate configurations are added according to the current implementation of the cspace.
@@ -122,11 +134,8 @@ namespace Saba
         float samplingSizeDCD;                  //!< euclidean sample size for collision check
         Eigen::VectorXf checkPathConfig;
 
-        int recursiveTmpValuesIndex;
-        std::vector<Eigen::VectorXf> recursiveTmpValues;
+        std::vector<Eigen::VectorXf> pathCheckConfigs;  //!< temporary samples for path checking
         Eigen::VectorXf tmpConfig;
-
-        const int recursionMaxDepth;
     };
 
 }
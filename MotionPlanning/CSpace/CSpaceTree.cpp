@@ -2,6 +2,7 @@
 #include "VirtualRobot/CollisionDetection/CDManager.h"
 #include "CSpaceTree.h"
 #include "CSpaceNode.h"
+#include "CSpaceKdTree.h"
 #include "CSpacePath.h"
 #include "CSpace.h"
 #include "VirtualRobot/Robot.h"
@@ -9,6 +10,8 @@
 #include "float.h"
 #include <cmath>
 #include <fstream>
+#include <algorithm>
+#include <set>
 #include <iomanip>
 #include <time.h>
 
@@ -29,6 +32,7 @@ namespace Saba
         this->cspace = cspace;
         randMult = (float)(1.0 / (double)(RAND_MAX));
         updateChildren = false;
+        nnSearch = eLinearSearch;
 
         dimension = cspace->getDimension();
 
@@ -62,6 +66,32 @@ namespace Saba
     {
         idNodeMapping.clear();
         nodes.clear();
+
+        if (kdTree)
+        {
+            kdTree->reset();
+        }
+    }
+
+    void CSpaceTree::setNearestNeighborSearch(NearestNeighborSearch method)
+    {
+        nnSearch = method;
+
+        if (nnSearch == eKdTreeSearch)
+        {
+            // the linear search does not consider metric weights
+            kdTree.reset(new CSpaceKdTree(cspace, false));
+            kdTree->build(nodes);
+        }
+        else
+        {
+            kdTree.reset();
+        }
+    }
+
+    CSpaceTree::NearestNeighborSearch CSpaceTree::getNearestNeighborSearch() const
+    {
+        return nnSearch;
     }
 
     CSpaceNodePtr CSpaceTree::getNode(unsigned int id)
@@ -167,6 +197,12 @@ namespace Saba
         newNode->configuration = config;
         // no distance information
         newNode->obstacleDistance = -1.0f;
+        newNode->lazy = false;
+
+        if (kdTree)
+        {
+            kdTree->addNode(newNode);
+        }
 
         // calculate distances
         if (calcDistance)
@@ -288,10 +324,70 @@ namespace Saba
 
         nodes.erase(it);
         idNodeMapping.erase(n->ID);
+
+        if (kdTree)
+        {
+            kdTree->removeNode(n);
+        }
         cspace->removeNode(n);
     }
 
 
+    unsigned int CSpaceTree::removeSubTree(CSpaceNodePtr n)
+    {
+        if (!hasNode(n))
+        {
+            SABA_ERROR << ": node not in tree" << std::endl;
+            return 0;
+        }
+
+        // parents are always added before their children, so all successors are found with one pass over the nodes
+        std::set<unsigned int> removeIDs;
+        removeIDs.insert(n->ID);
+        std::vector<CSpaceNodePtr> remainingNodes;
+        std::vector<CSpaceNodePtr> removedNodes;
+        remainingNodes.reserve(nodes.size());
+
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            if (nodes[i] == n || (nodes[i]->parentID >= 0 && removeIDs.find((unsigned int)nodes[i]->parentID) != removeIDs.end()))
+            {
+                removeIDs.insert(nodes[i]->ID);
+                removedNodes.push_back(nodes[i]);
+            }
+            else
+            {
+                remainingNodes.push_back(nodes[i]);
+            }
+        }
+
+        if (updateChildren && n->parentID >= 0)
+        {
+            CSpaceNodePtr parent = getNode(n->parentID);
+
+            if (parent)
+            {
+                parent->children.erase(std::remove(parent->children.begin(), parent->children.end(), n), parent->children.end());
+            }
+        }
+
+        nodes.swap(remainingNodes);
+
+        for (size_t i = 0; i < removedNodes.size(); i++)
+        {
+            idNodeMapping.erase(removedNodes[i]->ID);
+
+            if (kdTree)
+            {
+                kdTree->removeNode(removedNodes[i]);
+            }
+
+            cspace->removeNode(removedNodes[i]);
+        }
+
+        return (unsigned int)removedNodes.size();
+    }
+
     CSpaceNodePtr CSpaceTree::getNearestNeighbor(const Eigen::VectorXf& config, float* storeDist)
     {
         return getNode(getNearestNeighborID(config, storeDist));
@@ -300,15 +396,30 @@ namespace Saba
 
     unsigned int CSpaceTree::getNearestNeighborID(const Eigen::VectorXf& config, float* storeDist)
     {
-        // goes through complete list of nodes, toDO: everything is better than this: eg octrees,something hierarchical...
-        // update: only if we have more than 1000 nodes in the tree!
-
         if (nodes.size() == 0 || !cspace)
         {
             SABA_WARNING << "no nodes in tree..." << endl;
             return 0;
         }
 
+        if (kdTree)
+        {
+            float d2;
+            int id = kdTree->getNearestNeighborID(config, &d2);
+
+            if (id >= 0)
+            {
+                if (storeDist != NULL)
+                {
+                    *storeDist = sqrtf(d2);
+                }
+
+                return (unsigned int)id;
+            }
+        }
+
+        // goes through complete list of nodes (use setNearestNeighborSearch(eKdTreeSearch) for large trees)
+
         unsigned int bestID = nodes[0]->ID;
         float dist2 = cspace->calcDist2(config, nodes[0]->configuration, true);
         float test;
@@ -43,6 +43,12 @@ namespace Saba
     public:
         EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
+        enum NearestNeighborSearch
+        {
+            eLinearSearch,                      // check all nodes (standard)
+            eKdTreeSearch                       // use an incrementally built kd-tree (@see CSpaceKdTree)
+        };
+
         //! constructor
         CSpaceTree(CSpacePtr cspace);
 
@@ -95,6 +101,16 @@ namespace Saba
             return updateChildren;
         }
 
+        /*!
+            Select the nearest neighbor search method (standard: eLinearSearch).
+            The kd-tree search is recommended for large trees (several thousand nodes). It is kept in sync
+            with appendNode/removeNode and it delivers the same distances as the linear search.
+            When switching to eKdTreeSearch, the kd-tree is built with all current nodes.
+            Note: The kd-tree copies the borderless settings of the cspace, hence select the method after the cspace has been set up.
+        */
+        void setNearestNeighborSearch(NearestNeighborSearch method);
+        NearestNeighborSearch getNearestNeighborSearch() const;
+
 
         //! creates new CSpaceNode with configuration config and parentID
         /*!
@@ -108,6 +124,12 @@ namespace Saba
         //! remove tree node
         virtual void removeNode(CSpaceNodePtr n);
 
+        /*!
+            Remove n and all its successors from the tree.
+            \return The number of removed nodes.
+        */
+        virtual unsigned int removeSubTree(CSpaceNodePtr n);
+
         /*!
             get ID of nearest neighbor
           \param config configuration
@@ -183,6 +205,9 @@ namespace Saba
 
         std::map<unsigned int, CSpaceNodePtr > idNodeMapping; // mapping id<->node
 
+        NearestNeighborSearch nnSearch;
+        CSpaceKdTreePtr kdTree;                 // only used with eKdTreeSearch
+
         boost::mutex mutex;
     };
 
@@ -140,22 +140,29 @@ namespace Saba
                 rrtModeB = rrtMode2;
             }
 
-            switch (rrtModeA)
+            if (lazyCollisionChecking)
             {
-                case eExtend:
-                    extResultA = extend(tmpConfig, treeA, *lastIDA);
-                    break;
+                extResultA = extendLazy(tmpConfig, treeA, rrtModeA, *lastIDA);
+            }
+            else
+            {
+                switch (rrtModeA)
+                {
+                    case eExtend:
+                        extResultA = extend(tmpConfig, treeA, *lastIDA);
+                        break;
 
-                case eConnect:
-                    extResultA = connectUntilCollision(tmpConfig, treeA, *lastIDA);
-                    break;
+                    case eConnect:
+                        extResultA = connectUntilCollision(tmpConfig, treeA, *lastIDA);
+                        break;
 
-                case eConnectCompletePath:
-                    extResultA = connectComplete(tmpConfig, treeA, *lastIDA);
-                    break;
+                    case eConnectCompletePath:
+                        extResultA = connectComplete(tmpConfig, treeA, *lastIDA);
+                        break;
 
-                default:
-                    break;
+                    default:
+                        break;
+                }
             }
 
             LOCAL_DEBUG("ExtResultA:" << extResultA << endl);
@@ -173,22 +180,29 @@ namespace Saba
                 tmpConfig = n->configuration;
                 LOCAL_DEBUG("Tmp goal B:" << endl << tmpConfig << endl);
 
-                switch (rrtModeB)
+                if (lazyCollisionChecking)
                 {
-                    case eExtend:
-                        extResultB = extend(tmpConfig, treeB, *lastIDB);
-                        break;
+                    extResultB = extendLazy(tmpConfig, treeB, rrtModeB, *lastIDB);
+                }
+                else
+                {
+                    switch (rrtModeB)
+                    {
+                        case eExtend:
+                            extResultB = extend(tmpConfig, treeB, *lastIDB);
+                            break;
 
-                    case eConnect:
-                        extResultB = connectUntilCollision(tmpConfig, treeB, *lastIDB);
-                        break;
+                        case eConnect:
+                            extResultB = connectUntilCollision(tmpConfig, treeB, *lastIDB);
+                            break;
 
-                    case eConnectCompletePath:
-                        extResultB = connectComplete(tmpConfig, treeB, *lastIDB);
-                        break;
+                        case eConnectCompletePath:
+                            extResultB = connectComplete(tmpConfig, treeB, *lastIDB);
+                            break;
 
-                    default:
-                        break;
+                        default:
+                            break;
+                    }
                 }
 
                 LOCAL_DEBUG("Last ID B:" << *lastIDB << endl);
@@ -199,6 +213,12 @@ namespace Saba
                     stopSearch = true;
                 }
 
+                if (extResultB == eSuccess && lazyCollisionChecking && !(checkLazyPath(treeA, *lastIDA) && checkLazyPath(treeB, *lastIDB)))
+                {
+                    // the invalid part of the trees has been removed, resume the search
+                    extResultB = eFailed;
+                }
+
                 if (extResultB == eSuccess)
                 {
                     goalNode = treeB->getNode(*lastIDB);
@@ -0,0 +1,366 @@
+
+#include "ParallelBiRrt.h"
+
+#include "../CSpace/CSpaceNode.h"
+#include "../CSpace/CSpaceTree.h"
+#include "../CSpace/CSpacePath.h"
+
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using namespace std;
+using namespace VirtualRobot;
+
+namespace Saba
+{
+
+    namespace
+    {
+        // locks a tree until the end of the scope
+        struct ScopedTreeLock
+        {
+            ScopedTreeLock(CSpaceTreePtr t) : tree(t)
+            {
+                tree->lock();
+            }
+            ~ScopedTreeLock()
+            {
+                tree->unlock();
+            }
+            CSpaceTreePtr tree;
+        };
+    }
+
+    ParallelBiRrt::ParallelBiRrt(CSpaceSampledPtr cspace, unsigned int nrThreads, RrtMethod modeA, RrtMethod modeB)
+        : BiRrt(cspace, modeA, modeB)
+    {
+        cspaceSampled = cspace;
+        setNrThreads(nrThreads);
+        found = false;
+        error = false;
+    }
+
+    ParallelBiRrt::~ParallelBiRrt()
+    {
+    }
+
+    void ParallelBiRrt::setNrThreads(unsigned int nrThreads)
+    {
+        if (nrThreads == 0)
+        {
+            nrThreads = std::max(1u, boost::thread::hardware_concurrency());
+        }
+
+        this->nrThreads = nrThreads;
+    }
+
+    unsigned int ParallelBiRrt::getNrThreads() const
+    {
+        return nrThreads;
+    }
+
+    bool ParallelBiRrt::plan(bool bQuiet)
+    {
+        if (!bQuiet)
+        {
+            SABA_INFO << "Starting ParallelBiRrt planner with " << nrThreads << " threads" << std::endl;
+        }
+
+        if (!isInitialized())
+        {
+            SABA_ERROR << " planner: not initialized..." << std::endl;
+            return false;
+        }
+
+        if (lazyCollisionChecking)
+        {
+            SABA_WARNING << " lazy collision checking is not supported, all edges are checked..." << std::endl;
+        }
+
+        cycles = 0;
+
+        int distChecksStart = cspace->performaceVars_distanceCheck;
+        int colChecksStart = cspace->performaceVars_collisionCheck;
+
+        found = false;
+        error = false;
+        stopSearch = false;
+
+        // processor time would sum up the time of all threads
+        boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::local_time();
+
+        solution.reset();
+
+        // the workers check the paths concurrently
+        bool threadLocalContexts = cspace->hasThreadLocalCollisionContexts();
+        cspace->enableThreadLocalCollisionContexts(true);
+
+        boost::thread_group threads;
+
+        for (unsigned int i = 0; i < nrThreads; i++)
+        {
+            // the seeds are taken from the random sequence of the cspace (@see CSpace::getRandomSeed)
+            threads.create_thread(boost::bind(&ParallelBiRrt::workingMethod, this, i, (unsigned int)rand()));
+        }
+
+        threads.join_all();
+
+        cspace->enableThreadLocalCollisionContexts(threadLocalContexts);
+
+        boost::posix_time::time_duration d = boost::posix_time::microsec_clock::local_time() - startTime;
+        long diffTime = (long)d.total_milliseconds();
+        planningTime = (float)diffTime;
+
+        if (!bQuiet)
+        {
+            SABA_INFO << "Needed " << diffTime << " ms." << std::endl;
+
+            SABA_INFO << "Created " << tree->getNrOfNodes() << " + " << tree2->getNrOfNodes() << " = " << tree->getNrOfNodes() + tree2->getNrOfNodes() << " nodes." << std::endl;
+            SABA_INFO << "Collision Checks: " << (cspace->performaceVars_collisionCheck - colChecksStart) << std::endl;
+            SABA_INFO << "Distance Calculations: " << (cspace->performaceVars_distanceCheck - distChecksStart) << std::endl;
+
+            int nColChecks = (cspace->performaceVars_collisionCheck - colChecksStart);
+
+            if (diffTime > 0)
+            {
+                float fPerf = (float)nColChecks / (float)diffTime * 1000.0f;
+                std::cout << "Performance: " << fPerf << " cps (collision-checks per second)." << std::endl;
+            }
+        }
+
+        if (found)
+        {
+            if (!bQuiet)
+            {
+                SABA_INFO << "Found RRT solution with " << cycles << " cycles." << std::endl;
+            }
+
+            createSolution(bQuiet);
+
+            return true;
+        }
+
+        // something went wrong...
+        if (error)
+        {
+            SABA_ERROR << " error during planning..." << std::endl;
+        }
+
+        if (cycles >= maxCycles)
+        {
+            SABA_WARNING << " maxCycles exceeded..." << std::endl;
+        }
+
+        if (stopSearch)
+        {
+            SABA_WARNING << " search was stopped..." << std::endl;
+        }
+
+        return false;
+    }
+
+    void ParallelBiRrt::workingMethod(unsigned int threadIndex, unsigned int seed)
+    {
+        boost::mt19937 generator(seed);
+        Eigen::VectorXf randomConfig(cspace->getDimension());
+        Eigen::VectorXf lastConfigA(cspace->getDimension());
+        Eigen::VectorXf lastConfigB(cspace->getDimension());
+        int lastIDA = -1;
+        int lastIDB = -1;
+
+        // half of the workers start with the goal tree
+        bool switched = (threadIndex % 2) == 1;
+
+        try
+        {
+            while (true)
+            {
+                {
+                    boost::mutex::scoped_lock lock(mutex);
+
+                    if (found || error || stopSearch || cycles >= maxCycles)
+                    {
+                        break;
+                    }
+
+                    cycles++;
+                }
+
+                CSpaceTreePtr treeA = switched ? tree2 : tree;
+                CSpaceTreePtr treeB = switched ? tree : tree2;
+                RrtMethod rrtModeA = switched ? rrtMode2 : rrtMode;
+                RrtMethod rrtModeB = switched ? rrtMode : rrtMode2;
+                switched = !switched;
+
+                // CHOOSE A RANDOM CONFIGURATION (NOT GOAL DIRECTED, ONLY RANDOMLY)
+                if (!getRandomConfig(generator, randomConfig))
+                {
+                    break;
+                }
+
+                ExtensionResult extResultA = extendShared(randomConfig, treeA, rrtModeA, lastIDA, lastConfigA);
+
+                if (extResultA == eError)
+                {
+                    boost::mutex::scoped_lock lock(mutex);
+                    error = true;
+                    break;
+                }
+
+                if (extResultA != ePartial && extResultA != eSuccess)
+                {
+                    continue;
+                }
+
+                // try to connect the other tree to the new node
+                ExtensionResult extResultB = extendShared(lastConfigA, treeB, rrtModeB, lastIDB, lastConfigB);
+
+                if (extResultB == eError)
+                {
+                    boost::mutex::scoped_lock lock(mutex);
+                    error = true;
+                    break;
+                }
+
+                if (extResultB == eSuccess)
+                {
+                    boost::mutex::scoped_lock lock(mutex);
+
+                    // only the first connection is used as bridge (see createSolution)
+                    if (!found)
+                    {
+                        found = true;
+                        lastAddedID = (treeA == tree) ? lastIDA : lastIDB;
+                        lastAddedID2 = (treeA == tree) ? lastIDB : lastIDA;
+                    }
+                }
+            }
+        }
+        catch (...)
+        {
+            SABA_ERROR << "Exception in worker thread " << threadIndex << std::endl;
+            boost::mutex::scoped_lock lock(mutex);
+            error = true;
+        }
+    }
+
+    bool ParallelBiRrt::getRandomConfig(boost::mt19937& generator, Eigen::VectorXf& storeConfig)
+    {
+        const double randMult = 1.0 / (double)(boost::mt19937::max)();
+
+        while (true)
+        {
+            for (unsigned int i = 0; i < cspace->getDimension(); i++)
+            {
+                float r = (float)((double)generator() * randMult);
+                storeConfig[i] = cspace->getBoundaryMin(i) + (cspace->getBoundaryMax(i) - cspace->getBoundaryMin(i)) * r;
+            }
+
+            if (cspace->isConfigValid(storeConfig, false, true, true))
+            {
+                return true;
+            }
+
+            // each rejected sample counts as a cycle, otherwise a cspace without (reachable) valid configurations would never terminate
+            boost::mutex::scoped_lock lock(mutex);
+
+            if (found || error || stopSearch || cycles >= maxCycles)
+            {
+                return false;
+            }
+
+            cycles++;
+        }
+    }
+
+    Rrt::ExtensionResult ParallelBiRrt::extendShared(const Eigen::VectorXf& c, CSpaceTreePtr t, RrtMethod mode, int& storeLastAddedID, Eigen::VectorXf& storeLastConfig)
+    {
+        // NEAREST NEIGHBOR OF RANDOM CONFIGURATION
+        CSpaceNodePtr nn;
+
+        {
+            ScopedTreeLock lock(t);
+            nn = t->getNearestNeighbor(c);
+        }
+
+        if (!nn)
+        {
+            return eError;
+        }
+
+        // the configuration of a node is not changed after the node has been added, so we can access it without locking the tree
+        Eigen::VectorXf target = c;
+        bool reached = true;
+
+        if (mode == eExtend)
+        {
+            // length of the new extension step
+            float totalLength = cspace->calcDist(nn->configuration, c);
+
+            if (totalLength > extendStepSize)
+            {
+                float factor = extendStepSize / totalLength;
+                target = nn->configuration + ((c - nn->configuration) * factor);
+                reached = false;
+            }
+        }
+
+        if (cspace->calcDist(nn->configuration, target) == 0.0f)
+        {
+            // already in tree
+            storeLastAddedID = nn->ID;
+            storeLastConfig = target;
+            return eSuccess;
+        }
+
+        // CHECK PATH FOR COLLISIONS AND VALID NODES
+        // all samples are checked with one batch query in the collision context of this thread, no lock is held
+        // connect needs the first invalid sample, which is found faster in sequential order (the obstacle is usually close to the tree)
+        unsigned int nrSamples = 0;
+        CSpace::ValidityCheckOrder order = (mode == eConnect) ? CSpace::eSequentialOrder : CSpace::eVanDerCorputOrder;
+        int invalid = cspaceSampled->getFirstInvalidPathConfig(nn->configuration, target, order, mode == eConnect, -1.0f, &nrSamples);
+
+        if (invalid >= 0)
+        {
+            if (mode != eConnect || invalid <= 1)
+            {
+                return eFailed;
+            }
+
+            // connect until collision: the samples before the first invalid one are valid
+            target = cspace->interpolate(nn->configuration, target, (float)(invalid - 1) / (float)nrSamples);
+            reached = false;
+        }
+
+        // ADD IT TO RRT TREE
+        {
+            ScopedTreeLock lock(t);
+
+            if (!t->appendPath(nn, target, &storeLastAddedID))
+            {
+                return eError;
+            }
+        }
+
+        storeLastConfig = target;
+        return reached ? eSuccess : ePartial;
+    }
+
+    void ParallelBiRrt::printConfig(bool printOnlyParams)
+    {
+        if (!printOnlyParams)
+        {
+            std::cout << "-- ParallelBiRrt config --" << std::endl;
+            std::cout << "------------------------------" << std::endl;
+        }
+
+        std::cout << "-- Threads: " << nrThreads << std::endl;
+        BiRrt::printConfig(true);
+
+        if (!printOnlyParams)
+        {
+            std::cout << "------------------------------" << std::endl;
+        }
+    }
+
+} // namespace
@@ -0,0 +1,110 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef _Saba_ParallelBiRrt_h
+#define _Saba_ParallelBiRrt_h
+
+#include "../Saba.h"
+#include "../CSpace/CSpaceSampled.h"
+#include "../CSpace/CSpacePath.h"
+#include "BiRrt.h"
+
+#include <boost/thread.hpp>
+#include <boost/random/mersenne_twister.hpp>
+
+namespace Saba
+{
+
+    /*!
+     * A cooperative, multithreaded version of the bidirectional RRT planner.
+     * In contrast to running several independent planners (@see PlanningThread), all worker threads extend
+     * the same two search trees (start and goal tree), so that the planning time of a single query is reduced.
+     *
+     * Each worker samples its own random configurations, alternates between the two trees and tries to connect the other tree
+     * to the newly added node, just as the standard BiRrt does.
+     * The expensive part, i.e. the collision checking of a path segment, is done with one batch query (@see CSpaceSampled::getFirstInvalidPathConfig)
+     * without holding any lock. Only the nearest neighbor search and the insertion of the new nodes are protected by the mutex of the corresponding tree,
+     * hence workers that operate on different trees do not block each other.
+     *
+     * Thread local collision contexts are enabled on the cspace during planning (@see CSpace::enableThreadLocalCollisionContexts).
+     * The random configurations are sampled uniformly with a generator per thread, a custom sampler of the cspace is not considered.
+     * Since the workers run concurrently, the results are not deterministic (even with a fixed random seed).
+     */
+    class SABA_IMPORT_EXPORT ParallelBiRrt : public BiRrt
+    {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        /*!
+            Constructor
+            \param cspace An initialized cspace object.
+            \param nrThreads The number of worker threads. If 0, the number of hardware threads is used.
+            \param modeA Specify the RRT method that should be used to build the first tree
+            \param modeB Specify the RRT method that should be used to build the second tree
+        */
+        ParallelBiRrt(CSpaceSampledPtr cspace, unsigned int nrThreads = 0, RrtMethod modeA = eConnect, RrtMethod modeB = eConnect);
+        virtual ~ParallelBiRrt();
+
+        /*!
+            do the planning (blocking method)
+            The cycles of all worker threads are summed up and compared with maxCycles.
+            \return true if solution was found, otherwise false
+        */
+        virtual bool plan(bool bQuiet = false);
+
+        virtual void printConfig(bool printOnlyParams = false);
+
+        void setNrThreads(unsigned int nrThreads);
+        unsigned int getNrThreads() const;
+
+    protected:
+
+        //! The planning loop of one worker thread.
+        void workingMethod(unsigned int threadIndex, unsigned int seed);
+
+        /*!
+            Uniformly samples a valid configuration. Each invalid sample is counted as a cycle.
+            \return False, if the search has to be stopped before a valid configuration was found (e.g. maxCycles is exceeded).
+        */
+        bool getRandomConfig(boost::mt19937& generator, Eigen::VectorXf& storeConfig);
+
+        /*!
+            Extends tree towards c (thread safe).
+            \param c The configuration to extend to.
+            \param t The tree.
+            \param mode The RRT method.
+            \param storeLastAddedID The ID of the last added node is stored here.
+            \param storeLastConfig The configuration of the last added node is stored here.
+        */
+        ExtensionResult extendShared(const Eigen::VectorXf& c, CSpaceTreePtr t, RrtMethod mode, int& storeLastAddedID, Eigen::VectorXf& storeLastConfig);
+
+        unsigned int nrThreads;
+        CSpaceSampledPtr cspaceSampled;
+
+        boost::mutex mutex;             //!< protects cycles, found, the bridge node IDs and the error state during planning
+        bool found;
+        bool error;
+    };
+
+} // namespace
+
+#endif // _Saba_ParallelBiRrt_h
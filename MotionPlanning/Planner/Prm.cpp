@@ -0,0 +1,834 @@
+
+#include "Prm.h"
+
+#include "../CSpace/CSpaceNode.h"
+#include "../CSpace/CSpacePath.h"
+#include "VirtualRobot/Robot.h"
+#include "VirtualRobot/RobotNodeSet.h"
+#include "VirtualRobot/XML/FileIO.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <algorithm>
+#include <queue>
+#include <cfloat>
+#include <fstream>
+#include <time.h>
+
+using namespace std;
+using namespace VirtualRobot;
+
+namespace Saba
+{
+
+    namespace
+    {
+        // the nodes are sampled in chunks with an own random seed, so the roadmap does not depend on the number of threads
+        const unsigned int nodesPerChunk = 100;
+
+        const std::string fileTypeString = "Saba Roadmap Binary File";
+
+        //! The number of bytes behind the current read position.
+        uint64_t getRemainingBytes(std::ifstream& file)
+        {
+            std::streampos pos = file.tellg();
+            file.seekg(0, std::ios::end);
+            std::streampos end = file.tellg();
+            file.seekg(pos);
+            return (file && end >= pos) ? (uint64_t)(end - pos) : 0;
+        }
+    }
+
+    Prm::Prm(CSpaceSampledPtr cspace, unsigned int nrNeighbors, float maxEdgeLength)
+        : MotionPlanner(boost::dynamic_pointer_cast<CSpace>(cspace))
+    {
+        cspaceSampled = cspace;
+        this->nrNeighbors = std::max(1u, nrNeighbors);
+        this->maxEdgeLength = maxEdgeLength;
+        nrRoadmapNodes = 0;
+        nrRoadmapEdges = 0;
+        lazyChecks = 0;
+        name = "Prm";
+    }
+
+    Prm::~Prm()
+    {
+    }
+
+    bool Prm::buildRoadmap(unsigned int nrNodes, unsigned int nrThreads, bool bQuiet)
+    {
+        if (nrThreads == 0)
+        {
+            nrThreads = std::max(1u, boost::thread::hardware_concurrency());
+        }
+
+        if (!bQuiet)
+        {
+            SABA_INFO << "Building roadmap with " << nrNodes << " nodes (" << nrThreads << " threads)" << std::endl;
+        }
+
+        clearRoadmap();
+        stopSearch = false;
+
+        int colChecksStart = cspace->performaceVars_collisionCheck;
+
+        // processor time would sum up the time of all threads
+        boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::local_time();
+
+        bool threadLocalContexts = cspace->hasThreadLocalCollisionContexts();
+        cspace->enableThreadLocalCollisionContexts(true);
+
+        // SAMPLE NODES
+        // the seeds are taken from the random sequence of the cspace (@see CSpace::getRandomSeed)
+        unsigned int nrChunks = (nrNodes + nodesPerChunk - 1) / nodesPerChunk;
+        std::vector<unsigned int> seeds(nrChunks);
+
+        for (unsigned int i = 0; i < nrChunks; i++)
+        {
+            seeds[i] = (unsigned int)rand();
+        }
+
+        std::vector< std::vector<Eigen::VectorXf> > chunks(nrChunks);
+        {
+            boost::thread_group threads;
+
+            for (unsigned int i = 0; i < nrThreads; i++)
+            {
+                threads.create_thread(boost::bind(&Prm::sampleNodes, this, i, nrThreads, nrNodes, &seeds, &chunks));
+            }
+
+            threads.join_all();
+        }
+
+        for (unsigned int i = 0; i < nrChunks && !stopSearch; i++)
+        {
+            if (chunks[i].size() < std::min(nodesPerChunk, nrNodes - i * nodesPerChunk))
+            {
+                SABA_WARNING << "Could not sample enough valid configurations (" << maxCycles << " invalid samples in chunk " << i << "), aborting..." << std::endl;
+                cspace->enableThreadLocalCollisionContexts(threadLocalContexts);
+                return false;
+            }
+        }
+
+        for (unsigned int i = 0; i < nrChunks; i++)
+        {
+            for (size_t j = 0; j < chunks[i].size(); j++)
+            {
+                addNode(chunks[i][j], eValid);
+            }
+        }
+
+        nrRoadmapNodes = (unsigned int)nodes.size();
+        kdTree.reset(new CSpaceKdTree(cspace, false));
+        kdTree->build(nodes);
+
+        // SEARCH NEIGHBORS
+        std::vector< std::vector<int> > neighbors(nodes.size());
+        {
+            boost::thread_group threads;
+
+            for (unsigned int i = 0; i < nrThreads; i++)
+            {
+                threads.create_thread(boost::bind(&Prm::searchNeighbors, this, i, nrThreads, &neighbors));
+            }
+
+            threads.join_all();
+        }
+
+        // each pair of neighbors results in one candidate edge
+        std::vector< std::pair<unsigned int, unsigned int> > candidates;
+
+        for (size_t i = 0; i < neighbors.size(); i++)
+        {
+            for (size_t j = 0; j < neighbors[i].size(); j++)
+            {
+                unsigned int n = (unsigned int)neighbors[i][j];
+                candidates.push_back(std::make_pair(std::min((unsigned int)i, n), std::max((unsigned int)i, n)));
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        edges.resize(candidates.size());
+
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            edges[i].node1 = candidates[i].first;
+            edges[i].node2 = candidates[i].second;
+            edges[i].length = 0.0f;
+            edges[i].state = eUnchecked;
+        }
+
+        // CHECK EDGES
+        {
+            boost::thread_group threads;
+
+            for (unsigned int i = 0; i < nrThreads; i++)
+            {
+                threads.create_thread(boost::bind(&Prm::checkEdges, this, i, nrThreads));
+            }
+
+            threads.join_all();
+        }
+
+        cspace->enableThreadLocalCollisionContexts(threadLocalContexts);
+
+        // only the valid edges are stored
+        std::vector<RoadmapEdge> candidateEdges;
+        candidateEdges.swap(edges);
+
+        for (size_t i = 0; i < candidateEdges.size(); i++)
+        {
+            if (candidateEdges[i].state == eValid)
+            {
+                addEdge(candidateEdges[i].node1, candidateEdges[i].node2, eValid);
+            }
+        }
+
+        nrRoadmapEdges = (unsigned int)edges.size();
+
+        boost::posix_time::time_duration d = boost::posix_time::microsec_clock::local_time() - startTime;
+        long diffTime = (long)d.total_milliseconds();
+
+        if (!bQuiet)
+        {
+            SABA_INFO << "Needed " << diffTime << " ms." << std::endl;
+            SABA_INFO << "Created " << nrRoadmapNodes << " nodes and " << nrRoadmapEdges << " edges (" << candidateEdges.size() - nrRoadmapEdges << " invalid edges discarded)." << std::endl;
+            SABA_INFO << "Collision Checks: " << (cspace->performaceVars_collisionCheck - colChecksStart) << std::endl;
+        }
+
+        if (stopSearch)
+        {
+            SABA_WARNING << " roadmap construction was stopped..." << std::endl;
+            return false;
+        }
+
+        return nrRoadmapNodes > 0;
+    }
+
+    void Prm::sampleNodes(unsigned int threadIndex, unsigned int nrThreads, unsigned int nrNodes, const std::vector<unsigned int>* seeds, std::vector< std::vector<Eigen::VectorXf> >* storeChunks)
+    {
+        const double randMult = 1.0 / (double)(boost::mt19937::max)();
+        Eigen::VectorXf config(dimension);
+
+        for (unsigned int c = threadIndex; c < storeChunks->size() && !stopSearch; c += nrThreads)
+        {
+            boost::mt19937 generator((*seeds)[c]);
+            unsigned int nrChunkNodes = std::min(nodesPerChunk, nrNodes - c * nodesPerChunk);
+            (*storeChunks)[c].reserve(nrChunkNodes);
+
+            // the invalid samples are counted per chunk, so the result does not depend on the number of threads
+            unsigned int invalidSamples = 0;
+
+            while ((*storeChunks)[c].size() < nrChunkNodes && !stopSearch)
+            {
+                if (invalidSamples >= maxCycles)
+                {
+                    // buildRoadmap detects the incomplete chunk
+                    break;
+                }
+
+                for (unsigned int i = 0; i < dimension; i++)
+                {
+                    float r = (float)((double)generator() * randMult);
+                    config[i] = cspace->getBoundaryMin(i) + (cspace->getBoundaryMax(i) - cspace->getBoundaryMin(i)) * r;
+                }
+
+                if (cspace->isConfigValid(config, false, true, true))
+                {
+                    (*storeChunks)[c].push_back(config);
+                }
+                else
+                {
+                    invalidSamples++;
+                }
+            }
+        }
+    }
+
+    void Prm::searchNeighbors(unsigned int threadIndex, unsigned int nrThreads, std::vector< std::vector<int> >* storeNeighbors)
+    {
+        std::vector<int> ids;
+
+        for (unsigned int i = threadIndex; i < nrRoadmapNodes && !stopSearch; i += nrThreads)
+        {
+            // the node itself is found, too
+            kdTree->getKNearestNeighborIDs(nodes[i]->configuration, nrNeighbors + 1, ids);
+
+            for (size_t j = 0; j < ids.size(); j++)
+            {
+                if (ids[j] == (int)i)
+                {
+                    continue;
+                }
+
+                if (maxEdgeLength > 0 && cspace->calcDist(nodes[i]->configuration, nodes[ids[j]]->configuration) > maxEdgeLength)
+                {
+                    continue;
+                }
+
+                (*storeNeighbors)[i].push_back(ids[j]);
+            }
+        }
+    }
+
+    void Prm::checkEdges(unsigned int threadIndex, unsigned int nrThreads)
+    {
+        for (size_t i = threadIndex; i < edges.size() && !stopSearch; i += nrThreads)
+        {
+            bool valid = cspaceSampled->isPathValid(nodes[edges[i].node1]->configuration, nodes[edges[i].node2]->configuration);
+            edges[i].state = valid ? eValid : eInvalid;
+        }
+    }
+
+    CSpaceNodePtr Prm::addNode(const Eigen::VectorXf& config, unsigned char state)
+    {
+        CSpaceNodePtr n(new CSpaceNode());
+        n->configuration = config;
+        n->ID = (unsigned int)nodes.size();
+        n->parentID = -1;
+        n->allocated = false;
+        n->lazy = false;
+        n->status = state;
+        n->obstacleDistance = -1.0f;
+        n->dynDomRadius = 0.0f;
+        nodes.push_back(n);
+        nodeEdges.push_back(std::vector<unsigned int>());
+        return n;
+    }
+
+    void Prm::addEdge(unsigned int node1, unsigned int node2, unsigned char state)
+    {
+        SABA_ASSERT(node1 < nodes.size() && node2 < nodes.size());
+
+        RoadmapEdge e;
+        e.node1 = node1;
+        e.node2 = node2;
+        e.length = cspace->calcDist(nodes[node1]->configuration, nodes[node2]->configuration);
+        e.state = state;
+        nodeEdges[node1].push_back((unsigned int)edges.size());
+        nodeEdges[node2].push_back((unsigned int)edges.size());
+        edges.push_back(e);
+    }
+
+    void Prm::connectQueryNode(CSpaceNodePtr n)
+    {
+        if (!kdTree)
+        {
+            return;
+        }
+
+        std::vector<int> ids;
+        kdTree->getKNearestNeighborIDs(n->configuration, nrNeighbors, ids);
+
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            if (maxEdgeLength > 0 && cspace->calcDist(n->configuration, nodes[ids[i]]->configuration) > maxEdgeLength)
+            {
+                continue;
+            }
+
+            addEdge(n->ID, (unsigned int)ids[i], eUnchecked);
+        }
+    }
+
+    void Prm::removeQueryNodes()
+    {
+        // the edges of the query nodes have been appended to the edge lists of the roadmap nodes
+        for (unsigned int i = 0; i < nrRoadmapNodes; i++)
+        {
+            while (!nodeEdges[i].empty() && nodeEdges[i].back() >= nrRoadmapEdges)
+            {
+                nodeEdges[i].pop_back();
+            }
+        }
+
+        nodes.resize(nrRoadmapNodes);
+        nodeEdges.resize(nrRoadmapNodes);
+        edges.resize(nrRoadmapEdges);
+    }
+
+    bool Prm::plan(bool bQuiet)
+    {
+        if (!bQuiet)
+        {
+            SABA_INFO << "Starting Prm query" << std::endl;
+        }
+
+        if (!isInitialized())
+        {
+            SABA_ERROR << " planner: not initialized..." << std::endl;
+            return false;
+        }
+
+        if (nrRoadmapNodes == 0)
+        {
+            SABA_WARNING << " empty roadmap, only the direct connection is checked..." << std::endl;
+        }
+
+        cycles = 0;
+        lazyChecks = 0;
+        stopSearch = false;
+        solution.reset();
+        solutionNodes.clear();
+
+        int colChecksStart = cspace->performaceVars_collisionCheck;
+        clock_t startClock = clock();
+
+        // ADD START AND GOAL TO THE ROADMAP (temporarily)
+        CSpaceNodePtr startNode = addNode(startConfig, eValid);
+        CSpaceNodePtr goalNode = addNode(goalConfig, eValid);
+        connectQueryNode(startNode);
+        connectQueryNode(goalNode);
+
+        if (maxEdgeLength <= 0 || cspace->calcDist(startConfig, goalConfig) <= maxEdgeLength)
+        {
+            addEdge(startNode->ID, goalNode->ID, eUnchecked);
+        }
+
+        // SEARCH AND CHECK CANDIDATE PATHS
+        bool found = false;
+        std::vector<unsigned int> pathNodes;
+        std::vector<unsigned int> pathEdges;
+
+        while (!found && !stopSearch && cycles < maxCycles)
+        {
+            cycles++;
+
+            if (!searchPath(startNode->ID, goalNode->ID, pathNodes, pathEdges))
+            {
+                break;
+            }
+
+            // the invalid parts are marked and skipped by the next search
+            found = checkPath(pathNodes, pathEdges);
+        }
+
+        if (found)
+        {
+            solutionNodes = pathNodes;
+            createSolution(bQuiet);
+        }
+
+        removeQueryNodes();
+
+        clock_t endClock = clock();
+        long diffClock = (long)(((float)(endClock - startClock) / (float)CLOCKS_PER_SEC) * 1000.0);
+        planningTime = (float)diffClock;
+
+        if (!bQuiet)
+        {
+            SABA_INFO << "Needed " << diffClock << " ms of processor time." << std::endl;
+            SABA_INFO << "Searched " << cycles << " candidate paths, " << lazyChecks << " lazy checks." << std::endl;
+            SABA_INFO << "Collision Checks: " << (cspace->performaceVars_collisionCheck - colChecksStart) << std::endl;
+        }
+
+        if (found)
+        {
+            return true;
+        }
+
+        if (cycles >= maxCycles)
+        {
+            SABA_WARNING << " maxCycles exceeded..." << std::endl;
+        }
+
+        if (stopSearch)
+        {
+            SABA_WARNING << " search was stopped..." << std::endl;
+        }
+
+        return false;
+    }
+
+    bool Prm::searchPath(unsigned int start, unsigned int goal, std::vector<unsigned int>& storeNodes, std::vector<unsigned int>& storeEdges)
+    {
+        storeNodes.clear();
+        storeEdges.clear();
+
+        const Eigen::VectorXf& goalConf = nodes[goal]->configuration;
+        std::vector<float> costs(nodes.size(), FLT_MAX);
+        std::vector<int> predecessorEdges(nodes.size(), -1);
+        std::vector<bool> closed(nodes.size(), false);
+
+        // open list, sorted by the estimated costs (costs + distance to the goal)
+        typedef std::pair<float, unsigned int> OpenEntry;
+        std::priority_queue< OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry> > open;
+
+        costs[start] = 0.0f;
+        open.push(OpenEntry(cspace->calcDist(nodes[start]->configuration, goalConf), start));
+
+        while (!open.empty())
+        {
+            unsigned int n = open.top().second;
+            open.pop();
+
+            if (closed[n])
+            {
+                continue;
+            }
+
+            if (n == goal)
+            {
+                break;
+            }
+
+            closed[n] = true;
+
+            for (size_t i = 0; i < nodeEdges[n].size(); i++)
+            {
+                const RoadmapEdge& e = edges[nodeEdges[n][i]];
+
+                if (e.state == eInvalid)
+                {
+                    continue;
+                }
+
+                unsigned int m = (e.node1 == n) ? e.node2 : e.node1;
+
+                if (closed[m] || nodes[m]->status == eInvalid)
+                {
+                    continue;
+                }
+
+                float c = costs[n] + e.length;
+
+                if (c < costs[m])
+                {
+                    costs[m] = c;
+                    predecessorEdges[m] = (int)nodeEdges[n][i];
+                    open.push(OpenEntry(c + cspace->calcDist(nodes[m]->configuration, goalConf), m));
+                }
+            }
+        }
+
+        if (predecessorEdges[goal] < 0)
+        {
+            return false;
+        }
+
+        unsigned int n = goal;
+        storeNodes.push_back(n);
+
+        while (n != start)
+        {
+            const RoadmapEdge& e = edges[predecessorEdges[n]];
+            storeEdges.push_back((unsigned int)predecessorEdges[n]);
+            n = (e.node1 == n) ? e.node2 : e.node1;
+            storeNodes.push_back(n);
+        }
+
+        std::reverse(storeNodes.begin(), storeNodes.end());
+        std::reverse(storeEdges.begin(), storeEdges.end());
+        return true;
+    }
+
+    bool Prm::checkPath(const std::vector<unsigned int>& pathNodes, const std::vector<unsigned int>& pathEdges)
+    {
+        // the nodes are cheaper to check than the edges
+        for (size_t i = 0; i < pathNodes.size(); i++)
+        {
+            CSpaceNodePtr n = nodes[pathNodes[i]];
+
+            if (n->status != eUnchecked)
+            {
+                continue;
+            }
+
+            lazyChecks++;
+            n->status = cspace->isConfigValid(n->configuration, false, true, true) ? eValid : eInvalid;
+
+            if (n->status == eInvalid)
+            {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < pathEdges.size(); i++)
+        {
+            RoadmapEdge& e = edges[pathEdges[i]];
+
+            if (e.state != eUnchecked)
+            {
+                continue;
+            }
+
+            lazyChecks++;
+            e.state = cspace->isPathValid(nodes[e.node1]->configuration, nodes[e.node2]->configuration) ? eValid : eInvalid;
+
+            if (e.state == eInvalid)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool Prm::createSolution(bool bQuiet)
+    {
+        if (solutionNodes.size() < 2)
+        {
+            SABA_WARNING << " no path to goal..." << std::endl;
+            return false;
+        }
+
+        solution.reset(new CSpacePath(cspace));
+
+        for (size_t i = 0; i < solutionNodes.size(); i++)
+        {
+            solution->addPoint(nodes[solutionNodes[i]]->configuration);
+        }
+
+        if (!bQuiet)
+        {
+            SABA_INFO << "Created solution with " << solution->getNrOfPoints() << " nodes." << std::endl;
+        }
+
+        return true;
+    }
+
+    bool Prm::saveRoadmap(const std::string& filename)
+    {
+        std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+
+        if (!file.is_open())
+        {
+            SABA_ERROR << " could not open file " << filename << std::endl;
+            return false;
+        }
+
+        FileIO::writeString(file, fileTypeString);
+        FileIO::write<int32_t>(file, (int32_t)fileVersionMajor);
+        FileIO::write<int32_t>(file, (int32_t)fileVersionMinor);
+
+        // robot type and node set, used for a consistency check when loading the file
+        FileIO::writeString(file, cspace->getRobot()->getType());
+        FileIO::writeString(file, cspace->getRobotNodeSet()->getName());
+        FileIO::write<int32_t>(file, (int32_t)dimension);
+
+        // nodes: configuration and check state
+        FileIO::write<int32_t>(file, (int32_t)nrRoadmapNodes);
+
+        for (unsigned int i = 0; i < nrRoadmapNodes; i++)
+        {
+            FileIO::writeArray<float>(file, nodes[i]->configuration.data(), (int)dimension);
+            FileIO::write<unsigned char>(file, (unsigned char)nodes[i]->status);
+        }
+
+        // edges: node indices and check state (the lengths are recomputed when loading)
+        FileIO::write<int32_t>(file, (int32_t)nrRoadmapEdges);
+
+        for (unsigned int i = 0; i < nrRoadmapEdges; i++)
+        {
+            FileIO::write<uint32_t>(file, edges[i].node1);
+            FileIO::write<uint32_t>(file, edges[i].node2);
+            FileIO::write<unsigned char>(file, edges[i].state);
+        }
+
+        FileIO::writeString(file, "End");
+
+        if (!file.good())
+        {
+            SABA_ERROR << " error while writing file " << filename << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Prm::loadRoadmap(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+
+        if (!file.is_open())
+        {
+            SABA_ERROR << " could not open file " << filename << std::endl;
+            return false;
+        }
+
+        clearRoadmap();
+
+        std::string tmpString;
+
+        if (!FileIO::readString(tmpString, file) || tmpString != fileTypeString)
+        {
+            SABA_ERROR << " wrong file format: " << filename << std::endl;
+            return false;
+        }
+
+        int version[2];
+        version[0] = (int)FileIO::read<int32_t>(file);
+        version[1] = (int)FileIO::read<int32_t>(file);
+
+        if (version[0] != fileVersionMajor || version[1] > fileVersionMinor)
+        {
+            SABA_ERROR << " wrong file format version: " << version[0] << "." << version[1] << std::endl;
+            return false;
+        }
+
+        std::string robotType;
+        std::string nodeSetName;
+        FileIO::readString(robotType, file);
+        FileIO::readString(nodeSetName, file);
+
+        if (robotType != cspace->getRobot()->getType() || nodeSetName != cspace->getRobotNodeSet()->getName())
+        {
+            SABA_WARNING << " the roadmap was created for robot " << robotType << " / " << nodeSetName << std::endl;
+        }
+
+        int dim = (int)FileIO::read<int32_t>(file);
+
+        if (dim != (int)dimension)
+        {
+            SABA_ERROR << " wrong dimension: " << dim << " (expected " << dimension << ")" << std::endl;
+            return false;
+        }
+
+        int nrNodes = (int)FileIO::read<int32_t>(file);
+
+        // each node is stored with its configuration and state, the number of edges follows
+        const uint64_t nodeSize = (uint64_t)dimension * sizeof(float) + 1;
+
+        if (!file || nrNodes < 0 || (uint64_t)nrNodes * nodeSize + sizeof(int32_t) > getRemainingBytes(file))
+        {
+            SABA_ERROR << " corrupted file: " << filename << std::endl;
+            return false;
+        }
+
+        Eigen::VectorXf config(dimension);
+
+        for (int i = 0; i < nrNodes; i++)
+        {
+            FileIO::readArray<float>(config.data(), (int)dimension, file);
+            unsigned char state = FileIO::read<unsigned char>(file);
+
+            if (!file || state > eInvalid)
+            {
+                SABA_ERROR << " corrupted file: " << filename << std::endl;
+                clearRoadmap();
+                return false;
+            }
+
+            addNode(config, state);
+        }
+
+        int nrEdges = (int)FileIO::read<int32_t>(file);
+
+        // two node indices and the state per edge
+        if (!file || nrEdges < 0 || (uint64_t)nrEdges * (2 * sizeof(uint32_t) + 1) > getRemainingBytes(file))
+        {
+            SABA_ERROR << " corrupted file: " << filename << std::endl;
+            clearRoadmap();
+            return false;
+        }
+
+        for (int i = 0; i < nrEdges; i++)
+        {
+            unsigned int node1 = FileIO::read<uint32_t>(file);
+            unsigned int node2 = FileIO::read<uint32_t>(file);
+            unsigned char state = FileIO::read<unsigned char>(file);
+
+            if (!file || node1 >= (unsigned int)nrNodes || node2 >= (unsigned int)nrNodes || state > eInvalid)
+            {
+                SABA_ERROR << " corrupted file: " << filename << std::endl;
+                clearRoadmap();
+                return false;
+            }
+
+            addEdge(node1, node2, state);
+        }
+
+        if (!FileIO::readString(tmpString, file) || tmpString != "End")
+        {
+            SABA_ERROR << " corrupted file: " << filename << std::endl;
+            clearRoadmap();
+            return false;
+        }
+
+        nrRoadmapNodes = (unsigned int)nodes.size();
+        nrRoadmapEdges = (unsigned int)edges.size();
+        kdTree.reset(new CSpaceKdTree(cspace, false));
+        kdTree->build(nodes);
+        return true;
+    }
+
+    void Prm::setRoadmapUnchecked()
+    {
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            nodes[i]->status = eUnchecked;
+        }
+
+        for (size_t i = 0; i < edges.size(); i++)
+        {
+            edges[i].state = eUnchecked;
+        }
+    }
+
+    void Prm::clearRoadmap()
+    {
+        nodes.clear();
+        edges.clear();
+        nodeEdges.clear();
+        kdTree.reset();
+        nrRoadmapNodes = 0;
+        nrRoadmapEdges = 0;
+    }
+
+    unsigned int Prm::getNrOfRoadmapNodes() const
+    {
+        return nrRoadmapNodes;
+    }
+
+    unsigned int Prm::getNrOfRoadmapEdges() const
+    {
+        return nrRoadmapEdges;
+    }
+
+    const std::vector<CSpaceNodePtr>& Prm::getRoadmapNodes() const
+    {
+        return nodes;
+    }
+
+    const std::vector<Prm::RoadmapEdge>& Prm::getRoadmapEdges() const
+    {
+        return edges;
+    }
+
+    unsigned int Prm::getNrOfLazyChecks() const
+    {
+        return lazyChecks;
+    }
+
+    void Prm::reset()
+    {
+        MotionPlanner::reset();
+        solutionNodes.clear();
+        lazyChecks = 0;
+    }
+
+    void Prm::printConfig(bool printOnlyParams)
+    {
+        if (!printOnlyParams)
+        {
+            std::cout << "-- Prm config --" << std::endl;
+            std::cout << "------------------------------" << std::endl;
+        }
+
+        std::cout << "-- Neighbors: " << nrNeighbors << std::endl;
+        std::cout << "-- Max edge length: " << maxEdgeLength << std::endl;
+        std::cout << "-- Roadmap: " << nrRoadmapNodes << " nodes, " << nrRoadmapEdges << " edges" << std::endl;
+        MotionPlanner::printConfig(true);
+
+        if (!printOnlyParams)
+        {
+            std::cout << "------------------------------" << std::endl;
+        }
+    }
+
+} // namespace
@@ -0,0 +1,189 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef _Saba_Prm_h
+#define _Saba_Prm_h
+
+#include "../Saba.h"
+#include "../CSpace/CSpaceSampled.h"
+#include "../CSpace/CSpacePath.h"
+#include "../CSpace/CSpaceKdTree.h"
+#include "MotionPlanner.h"
+
+#include <string>
+#include <vector>
+
+namespace Saba
+{
+
+    /*!
+     * A multi-query planner based on a probabilistic roadmap (PRM).
+     * The roadmap is built once for a static environment (@see buildRoadmap) and can be stored to and loaded from
+     * a binary file (@see saveRoadmap, loadRoadmap). A query is answered by connecting the start and the goal configuration
+     * to their nearest roadmap nodes and searching the shortest path in the roadmap (A*).
+     *
+     * Queries are checked lazily: Nodes and edges that have not been checked yet (e.g. the connections of start and goal)
+     * are only checked when they are part of a candidate path. Invalid nodes and edges are marked and the search is repeated.
+     * The results of these checks are kept in the roadmap, hence subsequent queries benefit from them.
+     * When the environment changes, call setRoadmapUnchecked(), so that all nodes and edges are re-checked lazily during the next queries.
+     *
+     * The nodes of the roadmap are not allocated from the cspace, so the number of nodes is not limited by the cspace's maximal number of nodes.
+     */
+    class SABA_IMPORT_EXPORT Prm : public MotionPlanner
+    {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        //! The collision state of roadmap nodes (CSpaceNode::status) and edges.
+        enum CheckState
+        {
+            eUnchecked = 0,
+            eValid = 1,
+            eInvalid = 2
+        };
+
+        //! An edge of the roadmap.
+        struct RoadmapEdge
+        {
+            unsigned int node1;
+            unsigned int node2;
+            float length;               //!< the length according to the cspace metric
+            unsigned char state;        //!< @see CheckState
+        };
+
+        /*!
+            Constructor
+            \param cspace An initialized cspace object.
+            \param nrNeighbors The number of nearest neighbors a node is connected to.
+            \param maxEdgeLength Neighbors farther away are not connected (<=0: no limit).
+        */
+        Prm(CSpaceSampledPtr cspace, unsigned int nrNeighbors = 10, float maxEdgeLength = -1.0f);
+        virtual ~Prm();
+
+        /*!
+            Creates a new roadmap (an existing one is removed).
+            Sampling, the neighbor search and the validation of the edges are done by several threads, using
+            thread local collision contexts of the cspace (@see CSpace::enableThreadLocalCollisionContexts).
+            The result does only depend on the random seed of the cspace, not on the number of threads.
+            Only valid nodes and edges are stored.
+            The nodes are sampled in chunks. If maxCycles invalid samples are drawn for one chunk (@see setMaxCycles),
+            the cspace is considered to have (nearly) no valid configurations and the construction is aborted.
+            \param nrNodes The number of (valid) roadmap nodes.
+            \param nrThreads The number of threads. If 0, the number of hardware threads is used.
+            \param bQuiet Print some info or not.
+            \return true on success
+        */
+        bool buildRoadmap(unsigned int nrNodes, unsigned int nrThreads = 0, bool bQuiet = false);
+
+        /*!
+            Answer a query with the current roadmap (blocking method). The roadmap is not extended.
+            \param bQuiet Print some info or not.
+            \return true if solution was found, otherwise false
+        */
+        virtual bool plan(bool bQuiet = false);
+
+        /*!
+            Stores the roadmap in a compact binary file (including the check states of the nodes and edges).
+        */
+        bool saveRoadmap(const std::string& filename);
+
+        /*!
+            Loads a roadmap from a binary file. The dimension must match the cspace.
+        */
+        bool loadRoadmap(const std::string& filename);
+
+        /*!
+            Marks all nodes and edges as unchecked. Call this method when the environment has changed, then the
+            roadmap is re-checked lazily during the next queries.
+        */
+        void setRoadmapUnchecked();
+
+        //! Removes the roadmap.
+        void clearRoadmap();
+
+        unsigned int getNrOfRoadmapNodes() const;
+        unsigned int getNrOfRoadmapEdges() const;
+        const std::vector<CSpaceNodePtr>& getRoadmapNodes() const;
+        const std::vector<RoadmapEdge>& getRoadmapEdges() const;
+
+        //! The number of nodes and edges that have been checked during the last query.
+        unsigned int getNrOfLazyChecks() const;
+
+        virtual void printConfig(bool printOnlyParams = false);
+
+        //! Resets the query, the roadmap is kept.
+        virtual void reset();
+
+    protected:
+
+        virtual bool createSolution(bool bQuiet = false);
+
+        //! Samples the valid configurations of every nrThreads-th chunk, starting at threadIndex (@see buildRoadmap).
+        void sampleNodes(unsigned int threadIndex, unsigned int nrThreads, unsigned int nrNodes, const std::vector<unsigned int>* seeds, std::vector< std::vector<Eigen::VectorXf> >* storeChunks);
+
+        //! Computes the neighbors of every nrThreads-th node, starting at threadIndex.
+        void searchNeighbors(unsigned int threadIndex, unsigned int nrThreads, std::vector< std::vector<int> >* storeNeighbors);
+
+        //! Checks every nrThreads-th edge, starting at threadIndex.
+        void checkEdges(unsigned int threadIndex, unsigned int nrThreads);
+
+        CSpaceNodePtr addNode(const Eigen::VectorXf& config, unsigned char state);
+        void addEdge(unsigned int node1, unsigned int node2, unsigned char state);
+
+        //! Connects a temporary query node to its nearest roadmap nodes (unchecked edges).
+        void connectQueryNode(CSpaceNodePtr n);
+
+        //! Removes the nodes and edges that have been added for the current query.
+        void removeQueryNodes();
+
+        /*!
+            A* search from start to goal, invalid nodes and edges are skipped.
+            \param storeNodes The node IDs of the path are stored here.
+            \param storeEdges The edge indices of the path are stored here.
+        */
+        bool searchPath(unsigned int start, unsigned int goal, std::vector<unsigned int>& storeNodes, std::vector<unsigned int>& storeEdges);
+
+        //! Checks the unchecked nodes and edges of the path and marks them. Returns true if the complete path is valid.
+        bool checkPath(const std::vector<unsigned int>& pathNodes, const std::vector<unsigned int>& pathEdges);
+
+        CSpaceSampledPtr cspaceSampled;
+        unsigned int nrNeighbors;
+        float maxEdgeLength;
+
+        std::vector<CSpaceNodePtr> nodes;                       //!< the roadmap nodes (ID == index, the check state is stored in the status)
+        std::vector<RoadmapEdge> edges;
+        std::vector< std::vector<unsigned int> > nodeEdges;     //!< the edge indices of each node
+        CSpaceKdTreePtr kdTree;                                 //!< nearest neighbor search (roadmap nodes only)
+
+        unsigned int nrRoadmapNodes;                            //!< the nodes/edges behind these numbers belong to the current query
+        unsigned int nrRoadmapEdges;
+
+        std::vector<unsigned int> solutionNodes;
+        unsigned int lazyChecks;
+
+        static const int fileVersionMajor = 1;
+        static const int fileVersionMinor = 0;
+    };
+
+} // namespace
+
+#endif // _Saba_Prm_h
@@ -36,6 +36,7 @@ namespace Saba
         this->extendStepSize = cspace->getSamplingSize();
         tmpConfig.setZero(dimension);
         lastAddedID = -1;
+        lazyCollisionChecking = false;
     }
 
     Rrt::~Rrt()
@@ -108,22 +109,35 @@ namespace Saba
 
             if (r <= extendGoToGoal)
             {
-                switch (rrtMode)
+                if (lazyCollisionChecking)
                 {
-                    case eExtend:
-                        extResult = extend(goalConfig, tree, lastAddedID);
-                        break;
+                    extResult = extendLazy(goalConfig, tree, rrtMode, lastAddedID);
+                }
+                else
+                {
+                    switch (rrtMode)
+                    {
+                        case eExtend:
+                            extResult = extend(goalConfig, tree, lastAddedID);
+                            break;
 
-                    case eConnect:
-                        extResult = connectUntilCollision(goalConfig, tree, lastAddedID);
-                        break;
+                        case eConnect:
+                            extResult = connectUntilCollision(goalConfig, tree, lastAddedID);
+                            break;
 
-                    case eConnectCompletePath:
-                        extResult = connectComplete(goalConfig, tree, lastAddedID);
-                        break;
+                        case eConnectCompletePath:
+                            extResult = connectComplete(goalConfig, tree, lastAddedID);
+                            break;
+
+                        default:
+                            break;
+                    }
+                }
 
-                    default:
-                        break;
+                if (extResult == eSuccess && lazyCollisionChecking && !checkLazyPath(tree, lastAddedID))
+                {
+                    // the invalid part of the tree has been removed, resume the search
+                    extResult = eFailed;
                 }
 
                 if (extResult == eSuccess)
@@ -157,22 +171,29 @@ namespace Saba
                 // extend randomly, create a random position in config space
                 cspace->getRandomConfig(tmpConfig);
 
-                switch (rrtMode)
+                if (lazyCollisionChecking)
                 {
-                    case eExtend:
-                        extResult = extend(tmpConfig, tree, lastAddedID);
-                        break;
+                    extResult = extendLazy(tmpConfig, tree, rrtMode, lastAddedID);
+                }
+                else
+                {
+                    switch (rrtMode)
+                    {
+                        case eExtend:
+                            extResult = extend(tmpConfig, tree, lastAddedID);
+                            break;
 
-                    case eConnect:
-                        extResult = connectUntilCollision(tmpConfig, tree, lastAddedID);
-                        break;
+                        case eConnect:
+                            extResult = connectUntilCollision(tmpConfig, tree, lastAddedID);
+                            break;
 
-                    case eConnectCompletePath:
-                        extResult = connectComplete(tmpConfig, tree, lastAddedID);
-                        break;
+                        case eConnectCompletePath:
+                            extResult = connectComplete(tmpConfig, tree, lastAddedID);
+                            break;
 
-                    default:
-                        break;
+                        default:
+                            break;
+                    }
                 }
 
                 if (extResult == eError)
@@ -336,6 +357,112 @@ namespace Saba
         }
     }
 
+    Rrt::ExtensionResult Rrt::extendLazy(const Eigen::VectorXf& c, CSpaceTreePtr tree, RrtMethod mode, int& storeLastAddedID)
+    {
+        // NEAREST NEIGHBOR OF RANDOM CONFIGURATION
+        CSpaceNodePtr nn = tree->getNearestNeighbor(c);
+
+        SABA_ASSERT(nn);
+
+        float totalLength = cspace->calcDist(nn->configuration, c);
+
+        if (totalLength == 0.0f)
+        {
+            // already in tree
+            storeLastAddedID = nn->ID;
+            return eSuccess;
+        }
+
+        Eigen::VectorXf target = c;
+        bool reached = true;
+
+        if (mode == eExtend && totalLength > extendStepSize)
+        {
+            // go a specific length in the direction of c
+            float factor = extendStepSize / totalLength;
+            target = nn->configuration + ((c - nn->configuration) * factor);
+            reached = false;
+        }
+
+        if (mode == eConnect)
+        {
+            // CHECK THE CONFIGURATIONS IN STEPS OF extendStepSize (the edges in between are checked lazily)
+            CSpaceSampledPtr cs = boost::dynamic_pointer_cast<CSpaceSampled>(cspace);
+            SABA_ASSERT(cs);
+            unsigned int nrSamples = 0;
+            int invalid = cs->getFirstInvalidPathConfig(nn->configuration, target, CSpace::eSequentialOrder, true, extendStepSize, &nrSamples);
+
+            if (invalid >= 0)
+            {
+                if (invalid <= 1)
+                {
+                    return eFailed; // CONNECT FAILS
+                }
+
+                target = cspace->interpolate(nn->configuration, target, (float)(invalid - 1) / (float)nrSamples);
+                reached = false;
+            }
+        }
+        else if (!cspace->isConfigValid(target, false, true, true))
+        {
+            return eFailed; // EXTEND FAILS
+        }
+
+        // ADD IT TO RRT TREE (without checking the edge)
+        if (!tree->appendPath(nn, target, &storeLastAddedID))
+        {
+            return eError;
+        }
+
+        CSpaceNodePtr n = tree->getNode(storeLastAddedID);
+
+        while (n && n != nn)
+        {
+            n->lazy = true;
+            n = tree->getNode(n->parentID);
+        }
+
+        if (reached)
+        {
+            return eSuccess;
+        }
+
+        return ePartial;
+    }
+
+    bool Rrt::checkLazyPath(CSpaceTreePtr tree, int nodeID)
+    {
+        std::vector<CSpaceNodePtr> path;
+        CSpaceNodePtr n = tree->getNode(nodeID);
+
+        while (n && n->parentID >= 0)
+        {
+            path.push_back(n);
+            n = tree->getNode(n->parentID);
+        }
+
+        // start at the root, so that the removed subtree is as large as possible
+        for (int i = (int)path.size() - 1; i >= 0; i--)
+        {
+            if (!path[i]->lazy)
+            {
+                continue;
+            }
+
+            CSpaceNodePtr parent = tree->getNode(path[i]->parentID);
+
+            if (!cspace->isPathValid(parent->configuration, path[i]->configuration))
+            {
+                tree->removeSubTree(path[i]);
+                return false;
+            }
+
+            path[i]->lazy = false;
+        }
+
+        return true;
+    }
+
     void Rrt::printConfig(bool printOnlyParams)
     {
         if (!printOnlyParams)
@@ -358,6 +485,7 @@ namespace Saba
         std::cout << "-- C-Space: Add new Paths sampling size: " << Pathsize << std::endl;
         std::cout << "-- C-Space: DCD sampling size: " << DCDsize << std::endl;
         std::cout << "-- Probability: extend to goal: " << extendGoToGoal << std::endl;
+        std::cout << "-- Lazy collision checking: " << (lazyCollisionChecking ? "enabled" : "disabled") << std::endl;
 
         MotionPlanner::printConfig(true);
 
@@ -521,6 +649,16 @@ namespace Saba
         }
     }
 
+    void Rrt::enableLazyCollisionChecking(bool enable)
+    {
+        lazyCollisionChecking = enable;
+    }
+
+    bool Rrt::isLazyCollisionCheckingEnabled() const
+    {
+        return lazyCollisionChecking;
+    }
+
     Saba::CSpaceTreePtr Rrt::getTree()
     {
         return tree;
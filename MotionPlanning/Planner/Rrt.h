@@ -93,6 +93,19 @@ namespace Saba
 
         void setProbabilityExtendToGoal(float p);
 
+        /*!
+            Enable/Disable lazy collision checking (standard: disabled).
+            In lazy mode, only the new configurations are checked when the tree is extended, the edges to these configurations are added
+            without checking the intermediate samples. In connect mode (eConnect), the configurations on the way to the target are checked
+            in steps of the extend step size instead of the DCD sampling size.
+            When a candidate solution is found, the unchecked edges of the solution path are checked, starting at the root.
+            The subtree behind an invalid edge is removed and the search is resumed.
+            Since most edges never become part of a solution, the number of collision checks is considerably reduced in cluttered scenes.
+            Lazy collision checking is performed by the plan() methods of Rrt and BiRrt.
+        */
+        void enableLazyCollisionChecking(bool enable);
+        bool isLazyCollisionCheckingEnabled() const;
+
         CSpaceTreePtr getTree();
 
     protected:
@@ -106,6 +119,16 @@ namespace Saba
         virtual ExtensionResult connectComplete(Eigen::VectorXf& c, CSpaceTreePtr tree, int& storeLastAddedID);
         virtual ExtensionResult connectUntilCollision(Eigen::VectorXf& c, CSpaceTreePtr tree, int& storeLastAddedID);
 
+        //! Extends tree towards c with the given method, the new edges are not checked (@see enableLazyCollisionChecking).
+        virtual ExtensionResult extendLazy(const Eigen::VectorXf& c, CSpaceTreePtr tree, RrtMethod mode, int& storeLastAddedID);
+
+        /*!
+            Checks the unchecked edges on the path from the root of tree to the node with the given id.
+            The subtree behind the first invalid edge is removed from tree.
+            \return True if the complete path is valid.
+        */
+        virtual bool checkLazyPath(CSpaceTreePtr tree, int nodeID);
+
         CSpaceNodePtr startNode;        //!< start node (root of RRT)
         CSpaceNodePtr goalNode;         //!< goal node (set when RRT weas successfully connected to goalConfig)
 
@@ -117,6 +140,8 @@ namespace Saba
         int lastAddedID;                //!< ID of last added node
 
         RrtMethod rrtMode;
+
+        bool lazyCollisionChecking;
     };
 
 } // namespace
@@ -0,0 +1,289 @@
+
+#include "ParallelShortcutProcessor.h"
+#include "MotionPlanning/CSpace/CSpaceSampled.h"
+#include "MotionPlanning/CSpace/CSpacePath.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace Saba
+{
+
+    namespace
+    {
+        // fixed, so that the result does not depend on the number of threads
+        const int defaultCandidatesPerRound = 16;
+
+        bool compareStartIndex(const ParallelShortcutProcessor::ShortcutCandidate& a, const ParallelShortcutProcessor::ShortcutCandidate& b)
+        {
+            return a.startIndex < b.startIndex || (a.startIndex == b.startIndex && a.endIndex < b.endIndex);
+        }
+
+        bool compareEndIndex(const ParallelShortcutProcessor::ShortcutCandidate& a, const ParallelShortcutProcessor::ShortcutCandidate& b)
+        {
+            return a.endIndex < b.endIndex || (a.endIndex == b.endIndex && a.startIndex < b.startIndex);
+        }
+
+        bool equalIndices(const ParallelShortcutProcessor::ShortcutCandidate& a, const ParallelShortcutProcessor::ShortcutCandidate& b)
+        {
+            return a.startIndex == b.startIndex && a.endIndex == b.endIndex;
+        }
+    }
+
+    ParallelShortcutProcessor::ParallelShortcutProcessor(CSpacePathPtr path, CSpaceSampledPtr cspace, unsigned int nrThreads, unsigned int randomSeed, bool verbose)
+        : ShortcutProcessor(path, cspace, verbose), generator(randomSeed)
+    {
+        setNrThreads(nrThreads);
+    }
+
+    ParallelShortcutProcessor::~ParallelShortcutProcessor()
+    {
+    }
+
+    void ParallelShortcutProcessor::setNrThreads(unsigned int nrThreads)
+    {
+        if (nrThreads == 0)
+        {
+            nrThreads = std::max(1u, boost::thread::hardware_concurrency());
+        }
+
+        this->nrThreads = nrThreads;
+    }
+
+    unsigned int ParallelShortcutProcessor::getNrThreads() const
+    {
+        return nrThreads;
+    }
+
+    CSpacePathPtr ParallelShortcutProcessor::optimize(int optimizeSteps)
+    {
+        return shortenSolutionParallel(optimizeSteps);
+    }
+
+    CSpacePathPtr ParallelShortcutProcessor::shortenSolutionParallel(int shortenLoops, int candidatesPerRound, int maxSolutionPathDist)
+    {
+        stopOptimization = false;
+        THROW_VR_EXCEPTION_IF((!cspace || !path), "NULL data");
+        THROW_VR_EXCEPTION_IF(!initSolution(), "Could not init...");
+
+        if (optimizedPath->getNrOfPoints() <= 2)
+        {
+            return optimizedPath;
+        }
+
+        if (candidatesPerRound <= 0)
+        {
+            candidatesPerRound = defaultCandidatesPerRound;
+        }
+
+        int beforeCount = (int)optimizedPath->getNrOfPoints();
+        float beforeLength = optimizedPath->getLength();
+
+        if (verbose)
+        {
+            SABA_INFO << ": solution size before shortenSolutionParallel:" << beforeCount << std::endl;
+            SABA_INFO << ": solution length before shortenSolutionParallel:" << beforeLength << std::endl;
+        }
+
+        // processor time would sum up the time of all threads
+        boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::local_time();
+
+        bool threadLocalContexts = cspace->hasThreadLocalCollisionContexts();
+
+        if (nrThreads > 1)
+        {
+            cspace->enableThreadLocalCollisionContexts(true);
+        }
+
+        std::vector<ShortcutCandidate> candidates;
+        std::vector<ShortcutCandidate> subset;
+        int counter = 0;
+        int rounds = 0;
+        int shortcuts = 0;
+
+        while (counter < shortenLoops && !stopOptimization && optimizedPath->getNrOfPoints() > 2)
+        {
+            int nrCandidates = std::min(candidatesPerRound, shortenLoops - counter);
+            counter += nrCandidates;
+            rounds++;
+
+            selectCandidates(nrCandidates, maxSolutionPathDist, candidates);
+
+            if (candidates.empty())
+            {
+                continue;
+            }
+
+            unsigned int nrWorkers = std::min(nrThreads, (unsigned int)candidates.size());
+
+            if (nrWorkers <= 1)
+            {
+                validateCandidates(0, 1, &candidates);
+            }
+            else
+            {
+                boost::thread_group threads;
+
+                for (unsigned int i = 0; i < nrWorkers; i++)
+                {
+                    threads.create_thread(boost::bind(&ParallelShortcutProcessor::validateCandidates, this, i, nrWorkers, &candidates));
+                }
+
+                threads.join_all();
+            }
+
+            selectBestSubset(candidates, subset);
+
+            // start with the last shortcut, so that the indices of the others stay valid
+            for (int i = (int)subset.size() - 1; i >= 0; i--)
+            {
+                doShortcut(subset[i].startIndex, subset[i].endIndex);
+                shortcuts++;
+            }
+        }
+
+        cspace->enableThreadLocalCollisionContexts(threadLocalContexts);
+
+        if (stopOptimization)
+        {
+            SABA_INFO << "optimization was stopped" << std::endl;
+        }
+
+        if (verbose)
+        {
+            boost::posix_time::time_duration d = boost::posix_time::microsec_clock::local_time() - startTime;
+            SABA_INFO << ": shorten rounds: " << rounds << ", candidates: " << counter << ", shortcuts: " << shortcuts << std::endl;
+            SABA_INFO << ": shorten time: " << d.total_milliseconds() << " ms " << std::endl;
+            SABA_INFO << ": solution size after shortenSolutionParallel (nr of positions) : " << optimizedPath->getNrOfPoints() << std::endl;
+            SABA_INFO << ": solution length after shortenSolutionParallel : " << optimizedPath->getLength() << std::endl;
+        }
+
+        return optimizedPath;
+    }
+
+    void ParallelShortcutProcessor::selectCandidates(int nrCandidates, int maxSolutionPathDist, std::vector<ShortcutCandidate>& storeCandidates)
+    {
+        storeCandidates.clear();
+        int nrPoints = (int)optimizedPath->getNrOfPoints();
+
+        if (nrPoints <= 2)
+        {
+            return;
+        }
+
+        if (maxSolutionPathDist < 2)
+        {
+            maxSolutionPathDist = 2;
+        }
+
+        for (int i = 0; i < nrCandidates; i++)
+        {
+            // same distribution as selectCandidatesRandom
+            ShortcutCandidate c;
+            c.startIndex = (int)(generator() % (unsigned int)(nrPoints - 2));
+            int remaining = std::min(nrPoints - 2 - c.startIndex, maxSolutionPathDist);
+
+            if (remaining <= 0)
+            {
+                continue;
+            }
+
+            c.endIndex = c.startIndex + 2 + (int)(generator() % (unsigned int)remaining);
+            c.valid = false;
+            storeCandidates.push_back(c);
+        }
+
+        // each shortcut is checked only once
+        std::sort(storeCandidates.begin(), storeCandidates.end(), compareStartIndex);
+        storeCandidates.erase(std::unique(storeCandidates.begin(), storeCandidates.end(), equalIndices), storeCandidates.end());
+
+        // only shortcuts that shorten the path need to be checked (@see validShortcut)
+        std::vector<ShortcutCandidate> shorter;
+
+        for (size_t i = 0; i < storeCandidates.size(); i++)
+        {
+            ShortcutCandidate& c = storeCandidates[i];
+            float distShortcut = (optimizedPath->getPoint(c.endIndex) - optimizedPath->getPoint(c.startIndex)).norm();
+            float distPath = optimizedPath->getLength(c.startIndex, c.endIndex);
+
+            if (distShortcut < distPath * 0.99f)
+            {
+                c.reduction = distPath - distShortcut;
+                shorter.push_back(c);
+            }
+        }
+
+        storeCandidates.swap(shorter);
+    }
+
+    void ParallelShortcutProcessor::validateCandidates(unsigned int threadIndex, unsigned int nrWorkers, std::vector<ShortcutCandidate>* candidates)
+    {
+        for (size_t i = threadIndex; i < candidates->size() && !stopOptimization; i += nrWorkers)
+        {
+            ShortcutCandidate& c = (*candidates)[i];
+            c.valid = cspace->isPathValid(optimizedPath->getPoint(c.startIndex), optimizedPath->getPoint(c.endIndex));
+        }
+    }
+
+    void ParallelShortcutProcessor::selectBestSubset(const std::vector<ShortcutCandidate>& candidates, std::vector<ShortcutCandidate>& storeSubset)
+    {
+        storeSubset.clear();
+        std::vector<ShortcutCandidate> valid;
+
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            if (candidates[i].valid)
+            {
+                valid.push_back(candidates[i]);
+            }
+        }
+
+        if (valid.empty())
+        {
+            return;
+        }
+
+        // weighted interval scheduling, two shortcuts may share their start/end points
+        std::sort(valid.begin(), valid.end(), compareEndIndex);
+        size_t n = valid.size();
+        std::vector<int> ends(n);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            ends[i] = valid[i].endIndex;
+        }
+
+        // best[i]: the largest reduction with the first i candidates
+        std::vector<float> best(n + 1, 0.0f);
+        std::vector<int> previous(n);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            // number of candidates that end before this one starts
+            previous[i] = (int)(std::upper_bound(ends.begin(), ends.end(), valid[i].startIndex) - ends.begin());
+            best[i + 1] = std::max(best[i], best[previous[i]] + valid[i].reduction);
+        }
+
+        int i = (int)n;
+
+        while (i > 0)
+        {
+            if (best[i] == best[i - 1])
+            {
+                i--;
+            }
+            else
+            {
+                storeSubset.push_back(valid[i - 1]);
+                i = previous[i - 1];
+            }
+        }
+
+        std::sort(storeSubset.begin(), storeSubset.end(), compareStartIndex);
+    }
+
+}// namespace
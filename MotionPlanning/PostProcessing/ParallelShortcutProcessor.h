@@ -0,0 +1,104 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef __Saba_ParallelShortcutProcessor_h__
+#define __Saba_ParallelShortcutProcessor_h__
+
+#include "../Saba.h"
+#include "ShortcutProcessor.h"
+
+#include <vector>
+#include <boost/random/mersenne_twister.hpp>
+
+namespace Saba
+{
+    /*!
+     *
+     * \brief A shortcut processor that validates many shortcut candidates concurrently.
+     *
+     * In each round, a set of random shortcut candidates is selected (with the same distribution as selectCandidatesRandom()).
+     * Candidates that would not shorten the path are skipped, the remaining ones are checked for collisions by several threads,
+     * using the thread local collision contexts of the cspace (@see CSpace::enableThreadLocalCollisionContexts).
+     * Since the candidates of one round may overlap, the non-overlapping subset of valid candidates with the largest length reduction
+     * is applied (weighted interval scheduling).
+     *
+     * The candidates are sampled with an own random number generator, hence the result only depends on the random seed and
+     * not on the number of threads.
+     */
+    class SABA_IMPORT_EXPORT ParallelShortcutProcessor : public ShortcutProcessor
+    {
+    public:
+
+        //! A shortcut between two points of the path.
+        struct ShortcutCandidate
+        {
+            int startIndex;
+            int endIndex;
+            float reduction;    //!< the length that is saved by this shortcut
+            bool valid;
+        };
+
+        /*!
+            Constructor
+            \param path The path to optimize.
+            \param cspace The cspace.
+            \param nrThreads The number of threads. If 0, the number of hardware threads is used.
+            \param randomSeed The seed for the selection of the shortcut candidates.
+            \param verbose Print some info.
+        */
+        ParallelShortcutProcessor(CSpacePathPtr path, CSpaceSampledPtr cspace, unsigned int nrThreads = 0, unsigned int randomSeed = 0, bool verbose = false);
+        virtual ~ParallelShortcutProcessor();
+
+        //! A wrapper to the standard interface. Calls shortenSolutionParallel(), optimizeSteps is the total number of candidates.
+        virtual CSpacePathPtr optimize(int optimizeSteps);
+
+        /*!
+            Creates a shortened CSpace path.
+            \param shortenLoops The total number of shortcut candidates (as in shortenSolutionRandom()).
+            \param candidatesPerRound The number of candidates that are checked concurrently. If 0, 16 candidates are used.
+                   The result depends on this value and the random seed, but not on the number of threads.
+            \param maxSolutionPathDist The max solution path dist.
+            \return The local instance of the optimized solution.
+        */
+        CSpacePathPtr shortenSolutionParallel(int shortenLoops = 300, int candidatesPerRound = 0, int maxSolutionPathDist = 30);
+
+        void setNrThreads(unsigned int nrThreads);
+        unsigned int getNrThreads() const;
+
+    protected:
+
+        //! Selects nrCandidates random candidates, only candidates that shorten the path are stored.
+        void selectCandidates(int nrCandidates, int maxSolutionPathDist, std::vector<ShortcutCandidate>& storeCandidates);
+
+        //! Checks every nrWorkers-th candidate, starting at threadIndex.
+        void validateCandidates(unsigned int threadIndex, unsigned int nrWorkers, std::vector<ShortcutCandidate>* candidates);
+
+        //! Selects the non-overlapping subset of valid candidates with the largest total reduction (sorted by the start index).
+        void selectBestSubset(const std::vector<ShortcutCandidate>& candidates, std::vector<ShortcutCandidate>& storeSubset);
+
+        unsigned int nrThreads;
+        boost::mt19937 generator;
+    };
+
+}// namespace
+
+#endif // __Saba_ParallelShortcutProcessor_h__
@@ -0,0 +1,368 @@
+
+#include "TimeOptimalTrajectory.h"
+#include "MotionPlanning/CSpace/CSpace.h"
+#include "MotionPlanning/CSpace/CSpacePath.h"
+#include <VirtualRobot/RobotNodeSet.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Saba
+{
+
+    TimeOptimalTrajectory::TimeOptimalTrajectory(CSpacePathPtr path)
+        : path(path), junctionTime(0.0f), duration(0.0f)
+    {
+        THROW_VR_EXCEPTION_IF((!path || !path->getCSpace()), "NULL data");
+        dimension = path->getCSpace()->getDimension();
+        maxVelocities.setConstant(dimension, -1.0f);
+        maxAcceleration.setConstant(dimension, -1.0f);
+
+        VirtualRobot::RobotNodeSetPtr rns = path->getCSpace()->getRobotNodeSet();
+
+        if (!rns || rns->getSize() != dimension)
+        {
+            SABA_WARNING << "Could not determine the joint limits, use setMaxVelocities and setMaxAccelerations." << std::endl;
+            return;
+        }
+
+        for (unsigned int i = 0; i < dimension; i++)
+        {
+            VirtualRobot::RobotNodePtr rn = rns->getNode(i);
+
+            // the limits are given in m/s and m/s^2, but translational joint values are given in mm
+            float factor = rn->isTranslationalJoint() ? 1000.0f : 1.0f;
+
+            if (rn->getMaxVelocity() > 0)
+            {
+                maxVelocities[i] = rn->getMaxVelocity() * factor;
+            }
+
+            if (rn->getMaxAcceleration() > 0)
+            {
+                maxAcceleration[i] = rn->getMaxAcceleration() * factor;
+            }
+        }
+    }
+
+    TimeOptimalTrajectory::~TimeOptimalTrajectory()
+    {
+    }
+
+    void TimeOptimalTrajectory::setMaxVelocities(const Eigen::VectorXf& maxVel)
+    {
+        THROW_VR_EXCEPTION_IF(maxVel.rows() != (int)dimension, "Dimension mismatch");
+        maxVelocities = maxVel;
+    }
+
+    Eigen::VectorXf TimeOptimalTrajectory::getMaxVelocities() const
+    {
+        return maxVelocities;
+    }
+
+    void TimeOptimalTrajectory::setMaxAccelerations(const Eigen::VectorXf& maxAcc)
+    {
+        THROW_VR_EXCEPTION_IF(maxAcc.rows() != (int)dimension, "Dimension mismatch");
+        maxAcceleration = maxAcc;
+    }
+
+    Eigen::VectorXf TimeOptimalTrajectory::getMaxAccelerations() const
+    {
+        return maxAcceleration;
+    }
+
+    void TimeOptimalTrajectory::setJunctionTime(float t)
+    {
+        junctionTime = std::max(0.0f, t);
+    }
+
+    float TimeOptimalTrajectory::getJunctionTime() const
+    {
+        return junctionTime;
+    }
+
+    bool TimeOptimalTrajectory::compute()
+    {
+        lineStarts.clear();
+        lineDirections.clear();
+        lineLengths.clear();
+        pieces.clear();
+        pieceStartTimes.clear();
+        duration = 0.0f;
+
+        if (path->getNrOfPoints() == 0)
+        {
+            SABA_ERROR << "Empty path" << std::endl;
+            return false;
+        }
+
+        CSpacePtr cspace = path->getCSpace();
+        borderless.assign(dimension, false);
+        borderlessMin.setZero(dimension);
+
+        for (unsigned int j = 0; j < dimension; j++)
+        {
+            if (cspace->isBorderlessDimensionEnabled(j))
+            {
+                borderless[j] = true;
+                borderlessMin[j] = cspace->getBoundaryMin(j);
+            }
+        }
+
+        startConfig = path->getPoint(0);
+        Eigen::VectorXf last = startConfig;
+
+        // the lines are continuous, i.e. borderless dimensions are not wrapped here (see getState)
+        Eigen::VectorXf lineStart = startConfig;
+
+        for (unsigned int i = 1; i < path->getNrOfPoints(); i++)
+        {
+            Eigen::VectorXf p = path->getPoint(i);
+            Eigen::VectorXf delta = p - last;
+
+            for (unsigned int j = 0; j < dimension; j++)
+            {
+                // the short way, as in CSpace::interpolate
+                if (borderless[j])
+                {
+                    delta[j] = (float)fmod((double)delta[j], 2.0 * M_PI);
+
+                    if (delta[j] > M_PI)
+                    {
+                        delta[j] -= 2.0f * (float)M_PI;
+                    }
+                    else if (delta[j] < -M_PI)
+                    {
+                        delta[j] += 2.0f * (float)M_PI;
+                    }
+                }
+            }
+
+            float length = delta.norm();
+
+            // duplicated points
+            if (length <= 1e-6f)
+            {
+                continue;
+            }
+
+            lineStarts.push_back(lineStart);
+            lineDirections.push_back(delta / length);
+            lineLengths.push_back(length);
+            lineStart += delta;
+            last = p;
+        }
+
+        size_t nrLines = lineLengths.size();
+
+        // velocity and acceleration limits along each line
+        std::vector<float> lineMaxVel(nrLines);
+        std::vector<float> lineMaxAcc(nrLines);
+
+        for (size_t k = 0; k < nrLines; k++)
+        {
+            float v = FLT_MAX;
+            float a = FLT_MAX;
+
+            for (unsigned int j = 0; j < dimension; j++)
+            {
+                float c = fabs(lineDirections[k][j]);
+
+                if (c <= 1e-6f)
+                {
+                    continue;
+                }
+
+                if (maxVelocities[j] > 0)
+                {
+                    v = std::min(v, maxVelocities[j] / c);
+                }
+
+                if (maxAcceleration[j] > 0)
+                {
+                    a = std::min(a, maxAcceleration[j] / c);
+                }
+            }
+
+            if (v == FLT_MAX || a == FLT_MAX)
+            {
+                SABA_ERROR << "No velocity or acceleration limit for the joints that are moved between path point " << k << " and " << k + 1 << std::endl;
+                lineStarts.clear();
+                lineDirections.clear();
+                lineLengths.clear();
+                return false;
+            }
+
+            lineMaxVel[k] = v;
+            lineMaxAcc[k] = a;
+        }
+
+        // the velocities at the start/end of the lines, standing still at start and goal
+        std::vector<float> junctionVel(nrLines + 1, 0.0f);
+
+        for (size_t k = 1; k < nrLines; k++)
+        {
+            float v = std::min(lineMaxVel[k - 1], lineMaxVel[k]);
+            Eigen::VectorXf jump = lineDirections[k] - lineDirections[k - 1];
+
+            for (unsigned int j = 0; j < dimension; j++)
+            {
+                float c = fabs(jump[j]);
+
+                // the joint velocity jumps by c*v, which has to be achieved within the junction time
+                if (c > 1e-5f && maxAcceleration[j] > 0)
+                {
+                    v = std::min(v, maxAcceleration[j] * junctionTime / c);
+                }
+            }
+
+            junctionVel[k] = v;
+        }
+
+        // backward pass: we must be able to decelerate to the next junction velocity
+        for (int k = (int)nrLines - 1; k >= 0; k--)
+        {
+            junctionVel[k] = std::min(junctionVel[k], sqrtf(junctionVel[k + 1] * junctionVel[k + 1] + 2.0f * lineMaxAcc[k] * lineLengths[k]));
+        }
+
+        // forward pass: we must be able to accelerate to the next junction velocity
+        for (size_t k = 0; k < nrLines; k++)
+        {
+            junctionVel[k + 1] = std::min(junctionVel[k + 1], sqrtf(junctionVel[k] * junctionVel[k] + 2.0f * lineMaxAcc[k] * lineLengths[k]));
+        }
+
+        // accelerate, cruise and decelerate on each line
+        for (size_t k = 0; k < nrLines; k++)
+        {
+            float v0 = junctionVel[k];
+            float v1 = junctionVel[k + 1];
+            float a = lineMaxAcc[k];
+            float l = lineLengths[k];
+
+            float peak = std::min(lineMaxVel[k], sqrtf((2.0f * a * l + v0 * v0 + v1 * v1) * 0.5f));
+            peak = std::max(peak, std::max(v0, v1));
+
+            float accDist = (peak * peak - v0 * v0) / (2.0f * a);
+            float decDist = (peak * peak - v1 * v1) / (2.0f * a);
+            float cruiseDist = std::max(0.0f, l - accDist - decDist);
+
+            addPiece((peak - v0) / a, 0.0f, v0, a, (unsigned int)k);
+            addPiece(cruiseDist / peak, accDist, peak, 0.0f, (unsigned int)k);
+            addPiece((peak - v1) / a, accDist + cruiseDist, peak, -a, (unsigned int)k);
+        }
+
+        return true;
+    }
+
+    void TimeOptimalTrajectory::addPiece(float duration, float startPos, float startVelocity, float acceleration, unsigned int line)
+    {
+        if (duration <= 0)
+        {
+            return;
+        }
+
+        Piece p;
+        p.startTime = this->duration;
+        p.startPos = startPos;
+        p.startVelocity = startVelocity;
+        p.acceleration = acceleration;
+        p.line = line;
+        pieces.push_back(p);
+        pieceStartTimes.push_back(p.startTime);
+        this->duration += duration;
+    }
+
+    float TimeOptimalTrajectory::getDuration() const
+    {
+        return duration;
+    }
+
+    unsigned int TimeOptimalTrajectory::getNrOfPieces() const
+    {
+        return (unsigned int)pieces.size();
+    }
+
+    void TimeOptimalTrajectory::getState(float t, Eigen::VectorXf& storePos, Eigen::VectorXf* storeVel, Eigen::VectorXf* storeAcc) const
+    {
+        if (pieces.empty())
+        {
+            storePos = startConfig;
+
+            if (storeVel)
+            {
+                storeVel->setZero(startConfig.rows());
+            }
+
+            if (storeAcc)
+            {
+                storeAcc->setZero(startConfig.rows());
+            }
+
+            return;
+        }
+
+        t = std::max(0.0f, std::min(t, duration));
+
+        // the last piece that starts before t (the first piece starts at 0)
+        size_t index = std::upper_bound(pieceStartTimes.begin(), pieceStartTimes.end(), t) - pieceStartTimes.begin() - 1;
+        const Piece& p = pieces[index];
+
+        float dt = t - p.startTime;
+        float s = p.startPos + (p.startVelocity + 0.5f * p.acceleration * dt) * dt;
+        s = std::max(0.0f, std::min(s, lineLengths[p.line]));
+
+        storePos = lineStarts[p.line] + lineDirections[p.line] * s;
+
+        for (unsigned int j = 0; j < dimension; j++)
+        {
+            if (borderless[j])
+            {
+                float v = (float)fmod((double)(storePos[j] - borderlessMin[j]), 2.0 * M_PI);
+
+                if (v < 0)
+                {
+                    v += 2.0f * (float)M_PI;
+                }
+
+                storePos[j] = v + borderlessMin[j];
+            }
+        }
+
+        if (storeVel)
+        {
+            *storeVel = lineDirections[p.line] * std::max(0.0f, p.startVelocity + p.acceleration * dt);
+        }
+
+        if (storeAcc)
+        {
+            *storeAcc = lineDirections[p.line] * p.acceleration;
+        }
+    }
+
+    CSpacePathPtr TimeOptimalTrajectory::createSampledPath(float timeStep) const
+    {
+        CSpacePathPtr res(new CSpacePath(path->getCSpace(), path->getName() + " (time sampled)"));
+
+        if (timeStep <= 0)
+        {
+            SABA_ERROR << "Invalid time step " << timeStep << std::endl;
+            return res;
+        }
+
+        Eigen::VectorXf c;
+        int nrSteps = (int)ceil(duration / timeStep);
+
+        for (int i = 0; i < nrSteps; i++)
+        {
+            getState((float)i * timeStep, c);
+            res->addPoint(c);
+        }
+
+        getState(duration, c);
+        res->addPoint(c);
+        return res;
+    }
+
+}// namespace
@@ -0,0 +1,150 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef __Saba_TimeOptimalTrajectory_h__
+#define __Saba_TimeOptimalTrajectory_h__
+
+#include "../Saba.h"
+
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+namespace Saba
+{
+    /*!
+     *
+     * \brief A time parameterization of a CSpacePath that respects the velocity and acceleration limits of the joints.
+     *
+     * The path is followed exactly, i.e. the configuration moves along the straight lines between the path points.
+     * Since each line has a constant direction, the joint limits result in constant bounds for the velocity and acceleration along the line,
+     * hence the time optimal motion on a line consists of (at most) an acceleration, a cruising and a deceleration phase.
+     * The velocities at the path points are computed with a backward and a forward pass over the path.
+     * A path point at which the direction changes has to be passed with zero velocity in order to keep the acceleration bounded,
+     * unless a junction time is set (@see setJunctionTime). Consecutive collinear lines (e.g. the sampled nodes of an RRT path) are passed without stopping.
+     *
+     * The result is stored as piecewise quadratic function of the path length, each piece covers one phase of one line.
+     * A configuration at an arbitrary time is computed with a binary search over the pieces (O(log n)).
+     *
+     * Borderless dimensions of the cspace (@see CSpace::isBorderlessDimensionEnabled) are followed the short way, as done by CSpace::interpolate,
+     * i.e. a line between two path points never covers more than PI in such a dimension and the resulting configurations are wrapped to [lo, lo + 2PI).
+     *
+     * Translational joint values are given in mm, so the limits of these joints (m/s, m/s^2) are converted accordingly.
+     * Torque limits are not considered, since no dynamic model of the robot is available here.
+     * They can be approximated by reducing the acceleration limits (@see setMaxAccelerations).
+     */
+    class SABA_IMPORT_EXPORT TimeOptimalTrajectory
+    {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        /*!
+            Constructor. The limits are initialized with the max velocity and acceleration of the robot nodes of the path (@see VirtualRobot::RobotNode::setMaxVelocity).
+            Call compute() to create the time parameterization.
+            \param path The path.
+        */
+        TimeOptimalTrajectory(CSpacePathPtr path);
+        virtual ~TimeOptimalTrajectory();
+
+        /*!
+            Set the velocity limits (one entry per dimension, in rad/s or mm/s). Values <= 0 disable the limit of the corresponding joint.
+        */
+        void setMaxVelocities(const Eigen::VectorXf& maxVel);
+        Eigen::VectorXf getMaxVelocities() const;
+
+        /*!
+            Set the acceleration limits (one entry per dimension, in rad/s^2 or mm/s^2). Values <= 0 disable the limit of the corresponding joint.
+        */
+        void setMaxAccelerations(const Eigen::VectorXf& maxAcc);
+        Eigen::VectorXf getMaxAccelerations() const;
+
+        /*!
+            At a path point where the direction changes, a jump of the joint velocities is allowed as long as it can be realized with the
+            acceleration limits in the given time, e.g. the cycle time of the joint controller (standard: 0, i.e. stop at each corner).
+        */
+        void setJunctionTime(float t);
+        float getJunctionTime() const;
+
+        /*!
+            Computes the time parameterization.
+            \return false, if a line of the path can not be executed, because no velocity or acceleration limit is set for its joints.
+        */
+        bool compute();
+
+        //! The duration of the trajectory in seconds.
+        float getDuration() const;
+
+        /*!
+            Compute the state at time t (in seconds, values outside of [0, getDuration()] are clamped).
+            \param t The time.
+            \param storePos The configuration is stored here.
+            \param storeVel If given, the joint velocities are stored here.
+            \param storeAcc If given, the joint accelerations are stored here.
+        */
+        void getState(float t, Eigen::VectorXf& storePos, Eigen::VectorXf* storeVel = NULL, Eigen::VectorXf* storeAcc = NULL) const;
+
+        /*!
+            Creates a path with the configurations at equidistant times (the first point at 0, the last one at getDuration()).
+        */
+        CSpacePathPtr createSampledPath(float timeStep) const;
+
+        //! The number of pieces of the piecewise quadratic representation.
+        unsigned int getNrOfPieces() const;
+
+    protected:
+
+        //! One phase with constant acceleration along a line of the path.
+        struct Piece
+        {
+            float startTime;
+            float startPos;                 //!< position on the line
+            float startVelocity;            //!< velocity along the line
+            float acceleration;             //!< acceleration along the line
+            unsigned int line;
+        };
+
+        void addPiece(float duration, float startPos, float startVelocity, float acceleration, unsigned int line);
+
+        CSpacePathPtr path;
+        unsigned int dimension;
+        Eigen::VectorXf maxVelocities;
+        Eigen::VectorXf maxAcceleration;
+        float junctionTime;
+
+        Eigen::VectorXf startConfig;
+
+        std::vector<bool> borderless;       //!< the borderless dimensions of the cspace
+        Eigen::VectorXf borderlessMin;      //!< the lower boundary of these dimensions
+
+        // the lines of the path (zero length lines are skipped)
+        std::vector<Eigen::VectorXf, Eigen::aligned_allocator<Eigen::VectorXf> > lineStarts;
+        std::vector<Eigen::VectorXf, Eigen::aligned_allocator<Eigen::VectorXf> > lineDirections;    //!< normalized
+        std::vector<float> lineLengths;
+
+        std::vector<Piece> pieces;
+        std::vector<float> pieceStartTimes;     //!< copy of the start times for the binary search
+        float duration;
+    };
+
+}// namespace
+
+#endif // __Saba_TimeOptimalTrajectory_h__
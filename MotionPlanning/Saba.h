@@ -79,16 +79,21 @@ namespace Saba
     class CSpaceSampled;
     class CSpacePath;
     class CSpaceTree;
+    class CSpaceKdTree;
     class CSpaceNode;
     class Sampler;
     class ConfigurationConstraint;
     class Rrt;
     class MotionPlanner;
     class BiRrt;
+    class ParallelBiRrt;
+    class Prm;
     class GraspIkRrt;
     class GraspRrt;
     class PathProcessor;
     class ShortcutProcessor;
+    class ParallelShortcutProcessor;
+    class TimeOptimalTrajectory;
     class ApproachDiscretization;
     class PlanningThread;
     class PathProcessingThread;
@@ -98,14 +103,19 @@ namespace Saba
     typedef boost::shared_ptr<CSpacePath> CSpacePathPtr;
     typedef boost::shared_ptr<Sampler> SamplerPtr;
     typedef boost::shared_ptr<CSpaceTree> CSpaceTreePtr;
+    typedef boost::shared_ptr<CSpaceKdTree> CSpaceKdTreePtr;
     typedef boost::shared_ptr<CSpaceNode> CSpaceNodePtr;
     typedef boost::shared_ptr<MotionPlanner> MotionPlannerPtr;
     typedef boost::shared_ptr<Rrt> RrtPtr;
     typedef boost::shared_ptr<BiRrt> BiRrtPtr;
+    typedef boost::shared_ptr<ParallelBiRrt> ParallelBiRrtPtr;
+    typedef boost::shared_ptr<Prm> PrmPtr;
     typedef boost::shared_ptr<GraspIkRrt> GraspIkRrtPtr;
     typedef boost::shared_ptr<GraspRrt> GraspRrtPtr;
     typedef boost::shared_ptr<PathProcessor> PathProcessorPtr;
     typedef boost::shared_ptr<ShortcutProcessor> ShortcutProcessorPtr;
+    typedef boost::shared_ptr<ParallelShortcutProcessor> ParallelShortcutProcessorPtr;
+    typedef boost::shared_ptr<TimeOptimalTrajectory> TimeOptimalTrajectoryPtr;
     typedef boost::shared_ptr<ConfigurationConstraint> ConfigurationConstraintPtr;
     typedef boost::shared_ptr<ApproachDiscretization> ApproachDiscretizationPtr;
     typedef boost::shared_ptr<PlanningThread> PlanningThreadPtr;
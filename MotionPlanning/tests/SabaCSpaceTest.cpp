@@ -14,6 +14,7 @@
 #include <VirtualRobot/CollisionDetection/CollisionModel.h>
 #include <VirtualRobot/Obstacle.h>
 #include <CSpace/CSpaceSampled.h>
+#include <CSpace/ConfigurationConstraint.h>
 #include <VirtualRobot/CollisionDetection/CDManager.h>
 #include <string>
 
@@ -23,6 +24,41 @@
 
 BOOST_AUTO_TEST_SUITE(CSpace)
 
+namespace
+{
+    // valid for values <= maxValue (dimension 0)
+    class MaxValueConstraint : public Saba::ConfigurationConstraint
+    {
+    public:
+        MaxValueConstraint(float maxValue) : Saba::ConfigurationConstraint(1), maxValue(maxValue), nrChecks(0) {}
+
+        virtual bool isValid(const Eigen::VectorXf& c)
+        {
+            nrChecks++;
+            return c(0) <= maxValue;
+        }
+
+        float maxValue;
+        int nrChecks;
+    };
+
+    // collision free for values <= maxValue (dimension 0), without using a collision model
+    class MaxValueCSpace : public Saba::CSpaceSampled
+    {
+    public:
+        MaxValueCSpace(VirtualRobot::RobotPtr robot, VirtualRobot::CDManagerPtr collisionManager, VirtualRobot::RobotNodeSetPtr robotNodes, float maxValue) :
+            Saba::CSpaceSampled(robot, collisionManager, robotNodes), maxValue(maxValue), nrChecks(0) {}
+
+        virtual bool isCollisionFree(const Eigen::VectorXf& config)
+        {
+            nrChecks++;
+            return Saba::CSpaceSampled::isCollisionFree(config) && config(0) <= maxValue;
+        }
+
+        float maxValue;
+        int nrChecks;
+    };
+}
 
 BOOST_AUTO_TEST_CASE(testCSpace)
 {
@@ -135,4 +171,116 @@ BOOST_AUTO_TEST_CASE(testCSpace)
 
 }
 
+BOOST_AUTO_TEST_CASE(testCSpaceBatchCheck)
+{
+    const std::string robotString =
+        "<Robot Type='MyDemoRobotType' StandardName='ExampleRobo' RootNode='Joint1'>"
+        " <RobotNode name='Joint1'>"
+        "   <Joint type='revolute'>"
+        "    <Limits unit='degree' lo='-90' hi='90'/>"
+        "	  <Axis x='1' y='0' z='0'/>"
+        "   </Joint>"
+        " </RobotNode>"
+        "</Robot>";
+    VirtualRobot::RobotPtr rob = VirtualRobot::RobotIO::createRobotFromString(robotString);
+    BOOST_REQUIRE(rob);
+    std::vector< std::string > nodes;
+    nodes.push_back(std::string("Joint1"));
+    VirtualRobot::RobotNodeSetPtr rns = VirtualRobot::RobotNodeSet::createRobotNodeSet(rob, "nodeSet", nodes);
+    VirtualRobot::CDManagerPtr cdm(new VirtualRobot::CDManager());
+    Saba::CSpaceSampledPtr cspace(new Saba::CSpaceSampled(rob, cdm, rns));
+    BOOST_REQUIRE(cspace);
+
+    // ---batch of configurations, index 5 and 9 are out of bounds---
+    std::vector<Eigen::VectorXf> configs(12, Eigen::VectorXf::Zero(1));
+
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        configs[i](0) = 0.1f * (float)i;
+    }
+
+    configs[5](0) = 2.0f;
+    configs[9](0) = -2.0f;
+
+    BOOST_CHECK_EQUAL(cspace->getFirstInvalidConfig(configs, Saba::CSpace::eSequentialOrder), 5);
+    BOOST_CHECK_EQUAL(cspace->getFirstInvalidConfig(configs, Saba::CSpace::eVanDerCorputOrder), 5);
+    int res = cspace->getFirstInvalidConfig(configs, Saba::CSpace::eVanDerCorputOrder, false);
+    BOOST_CHECK(res == 5 || res == 9);
+
+    configs[5](0) = 0.5f;
+    configs[9](0) = 0.9f;
+    BOOST_CHECK_EQUAL(cspace->getFirstInvalidConfig(configs, Saba::CSpace::eVanDerCorputOrder), -1);
+    BOOST_CHECK_EQUAL(cspace->getFirstInvalidConfig(std::vector<Eigen::VectorXf>()), -1);
+
+    // ---path segments---
+    boost::shared_ptr<MaxValueConstraint> constraint(new MaxValueConstraint(0.55f));
+    cspace->addConstraintCheck(constraint);
+    cspace->setSamplingSizeDCD(0.1f);
+
+    Eigen::VectorXf p1(1);
+    Eigen::VectorXf p2(1);
+    p1(0) = 0;
+    p2(0) = 0.5f;
+    BOOST_CHECK(cspace->isPathValid(p1, p2));
+
+    p2(0) = 1.0f;
+    unsigned int nrSamples = 0;
+    res = cspace->getFirstInvalidPathConfig(p1, p2, Saba::CSpace::eVanDerCorputOrder, true, -1.0f, &nrSamples);
+    BOOST_CHECK_EQUAL(nrSamples, 10u);
+    BOOST_CHECK_EQUAL(res, 6);
+    res = cspace->getFirstInvalidPathConfig(p1, p2, Saba::CSpace::eSequentialOrder, true, -1.0f, &nrSamples);
+    BOOST_CHECK_EQUAL(res, 6);
+
+    // the first sample in van der Corput order (0.9) is invalid -> detected with the first check
+    constraint->nrChecks = 0;
+    BOOST_CHECK(!cspace->isPathValid(p1, p2));
+    BOOST_CHECK_EQUAL(constraint->nrChecks, 1);
+}
+
+BOOST_AUTO_TEST_CASE(testCSpaceBatchCheckCollisionOverride)
+{
+    const std::string robotString =
+        "<Robot Type='MyDemoRobotType' StandardName='ExampleRobo' RootNode='Joint1'>"
+        " <RobotNode name='Joint1'>"
+        "   <Joint type='revolute'>"
+        "    <Limits unit='degree' lo='-90' hi='90'/>"
+        "	  <Axis x='1' y='0' z='0'/>"
+        "   </Joint>"
+        " </RobotNode>"
+        "</Robot>";
+    VirtualRobot::RobotPtr rob = VirtualRobot::RobotIO::createRobotFromString(robotString);
+    BOOST_REQUIRE(rob);
+    std::vector< std::string > nodes;
+    nodes.push_back(std::string("Joint1"));
+    VirtualRobot::RobotNodeSetPtr rns = VirtualRobot::RobotNodeSet::createRobotNodeSet(rob, "nodeSet", nodes);
+    VirtualRobot::CDManagerPtr cdm(new VirtualRobot::CDManager());
+    boost::shared_ptr<MaxValueCSpace> cspace(new MaxValueCSpace(rob, cdm, rns, 0.55f));
+
+    // the batch holds the collision mutex while calling the overridden isCollisionFree
+    cspace->exclusiveRobotAccess(true);
+
+    std::vector<Eigen::VectorXf> configs(12, Eigen::VectorXf::Zero(1));
+
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        configs[i](0) = 0.1f * (float)i;
+    }
+
+    BOOST_CHECK_EQUAL(cspace->getFirstInvalidConfig(configs, Saba::CSpace::eSequentialOrder), 6);
+    BOOST_CHECK_EQUAL(cspace->getFirstInvalidConfig(configs, Saba::CSpace::eVanDerCorputOrder), 6);
+    BOOST_CHECK_EQUAL(cspace->getFirstInvalidConfig(configs, Saba::CSpace::eSequentialOrder, true, true, false), -1);
+
+    cspace->setSamplingSizeDCD(0.1f);
+    Eigen::VectorXf p1(1);
+    Eigen::VectorXf p2(1);
+    p1(0) = 0;
+    p2(0) = 0.5f;
+    BOOST_CHECK(cspace->isPathValid(p1, p2));
+
+    p2(0) = 1.0f;
+    cspace->nrChecks = 0;
+    BOOST_CHECK(!cspace->isPathValid(p1, p2));
+    BOOST_CHECK_EQUAL(cspace->nrChecks, 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
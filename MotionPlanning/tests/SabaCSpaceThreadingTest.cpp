@@ -0,0 +1,104 @@
+/**
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE Saba_SabaCSpaceThreadingTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/XML/SceneIO.h>
+#include <VirtualRobot/Scene.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/RobotNodeSet.h>
+#include <VirtualRobot/RuntimeEnvironment.h>
+#include <VirtualRobot/CollisionDetection/CDManager.h>
+#include <CSpace/CSpaceSampled.h>
+#include <string>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+BOOST_AUTO_TEST_SUITE(CSpaceThreading)
+
+namespace
+{
+    // checks the configurations [start,end) and stores the results
+    void checkConfigs(Saba::CSpaceSampledPtr cspace, const std::vector<Eigen::VectorXf>* configs, std::vector<char>* results, size_t start, size_t end)
+    {
+        for (size_t i = start; i < end; i++)
+        {
+            (*results)[i] = cspace->isCollisionFree((*configs)[i]) ? 1 : 0;
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testThreadLocalCollisionContexts)
+{
+    std::string filename = "scenes/examples/RrtGui/planning.xml";
+    bool fileOK = VirtualRobot::RuntimeEnvironment::getDataFileAbsolute(filename);
+    BOOST_REQUIRE(fileOK);
+    VirtualRobot::ScenePtr scene;
+    BOOST_REQUIRE_NO_THROW(scene = VirtualRobot::SceneIO::loadScene(filename));
+    BOOST_REQUIRE(scene);
+    std::vector<VirtualRobot::RobotPtr> robots = scene->getRobots();
+    BOOST_REQUIRE_EQUAL(robots.size(), 1);
+    VirtualRobot::RobotPtr robot = robots[0];
+    VirtualRobot::RobotNodeSetPtr rns = robot->getRobotNodeSet("Planning");
+    BOOST_REQUIRE(rns);
+
+    VirtualRobot::CDManagerPtr cdm(new VirtualRobot::CDManager());
+    cdm->addCollisionModel(robot->getRobotNodeSet("ColModel Robot Moving"));
+    cdm->addCollisionModel(robot->getRobotNodeSet("ColModel Robot Body"));
+    cdm->addCollisionModel(scene->getSceneObjectSet("ColModel Obstacles"));
+    Saba::CSpaceSampledPtr cspace(new Saba::CSpaceSampled(robot, cdm, rns, 1000, 42));
+
+    const size_t nrConfigs = 4000;
+    std::vector<Eigen::VectorXf> configs(nrConfigs, Eigen::VectorXf(cspace->getDimension()));
+
+    for (size_t i = 0; i < nrConfigs; i++)
+    {
+        cspace->getRandomConfig(configs[i]);
+    }
+
+    // reference: standard collision checking
+    std::vector<char> reference(nrConfigs, 0);
+    clock_t t = clock();
+    checkConfigs(cspace, &configs, &reference, 0, nrConfigs);
+    float refTime = (float)(clock() - t) / (float)CLOCKS_PER_SEC * 1000.0f;
+    std::cout << "Collision checks, standard mode: " << refTime << " ms" << std::endl;
+
+    cspace->enableThreadLocalCollisionContexts(true);
+    BOOST_REQUIRE(cspace->hasThreadLocalCollisionContexts());
+
+    unsigned int maxThreads = std::max(1u, boost::thread::hardware_concurrency());
+
+    for (unsigned int nrThreads = 1; nrThreads <= maxThreads; nrThreads *= 2)
+    {
+        std::vector<char> results(nrConfigs, 0);
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+        boost::thread_group threads;
+        size_t chunk = nrConfigs / nrThreads;
+
+        for (unsigned int i = 0; i < nrThreads; i++)
+        {
+            size_t end = (i == nrThreads - 1) ? nrConfigs : (i + 1) * chunk;
+            threads.create_thread(boost::bind(&checkConfigs, cspace, &configs, &results, i * chunk, end));
+        }
+
+        threads.join_all();
+        boost::posix_time::time_duration d = boost::posix_time::microsec_clock::local_time() - start;
+
+        // the first run includes the creation of the contexts
+        std::cout << "Collision checks, thread local contexts, " << nrThreads << " thread(s): " << d.total_milliseconds() << " ms" << std::endl;
+
+        for (size_t i = 0; i < nrConfigs; i++)
+        {
+            BOOST_CHECK_EQUAL(results[i], reference[i]);
+        }
+    }
+
+    BOOST_CHECK_GE(cspace->getNrOfCollisionContexts(), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,278 @@
+/**
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE Saba_SabaCSpaceTreeTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/RobotNodeSet.h>
+#include <VirtualRobot/CollisionDetection/CDManager.h>
+#include <CSpace/CSpaceSampled.h>
+#include <CSpace/CSpaceTree.h>
+#include <CSpace/CSpaceNode.h>
+#include <CSpace/CSpaceKdTree.h>
+#include <algorithm>
+#include <string>
+#include <time.h>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+BOOST_AUTO_TEST_SUITE(CSpaceTree)
+
+namespace
+{
+    // 6 joints, the first and the last one are borderless
+    Saba::CSpaceSampledPtr createCSpace(unsigned int maxNodes)
+    {
+        const std::string robotString =
+            "<Robot Type='MyDemoRobotType' StandardName='ExampleRobo' RootNode='Joint1'>"
+            " <RobotNode name='Joint1'>"
+            "  <Joint type='revolute'><Limits unit='degree' lo='-180' hi='180'/><Axis x='0' y='0' z='1'/></Joint>"
+            "  <Child name='Joint2'/>"
+            " </RobotNode>"
+            " <RobotNode name='Joint2'>"
+            "  <Joint type='revolute'><Limits unit='degree' lo='-90' hi='90'/><Axis x='1' y='0' z='0'/></Joint>"
+            "  <Child name='Joint3'/>"
+            " </RobotNode>"
+            " <RobotNode name='Joint3'>"
+            "  <Joint type='revolute'><Limits unit='degree' lo='-90' hi='90'/><Axis x='1' y='0' z='0'/></Joint>"
+            "  <Child name='Joint4'/>"
+            " </RobotNode>"
+            " <RobotNode name='Joint4'>"
+            "  <Joint type='prismatic'><Limits unit='mm' lo='0' hi='2'/><TranslationDirection x='0' y='0' z='1'/></Joint>"
+            "  <Child name='Joint5'/>"
+            " </RobotNode>"
+            " <RobotNode name='Joint5'>"
+            "  <Joint type='revolute'><Limits unit='degree' lo='-45' hi='45'/><Axis x='0' y='1' z='0'/></Joint>"
+            "  <Child name='Joint6'/>"
+            " </RobotNode>"
+            " <RobotNode name='Joint6'>"
+            "  <Joint type='revolute'><Limits unit='degree' lo='-180' hi='180'/><Axis x='0' y='0' z='1'/></Joint>"
+            " </RobotNode>"
+            "</Robot>";
+        VirtualRobot::RobotPtr rob = VirtualRobot::RobotIO::createRobotFromString(robotString);
+        BOOST_REQUIRE(rob);
+        std::vector< std::string > nodes;
+        nodes.push_back(std::string("Joint1"));
+        nodes.push_back(std::string("Joint2"));
+        nodes.push_back(std::string("Joint3"));
+        nodes.push_back(std::string("Joint4"));
+        nodes.push_back(std::string("Joint5"));
+        nodes.push_back(std::string("Joint6"));
+        VirtualRobot::RobotNodeSetPtr rns = VirtualRobot::RobotNodeSet::createRobotNodeSet(rob, "nodeSet", nodes);
+        VirtualRobot::CDManagerPtr cdm(new VirtualRobot::CDManager());
+        Saba::CSpaceSampledPtr cspace(new Saba::CSpaceSampled(rob, cdm, rns, maxNodes, 42));
+        return cspace;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testKdTreeNearestNeighbor)
+{
+    Saba::CSpaceSampledPtr cspace = createCSpace(4000);
+    BOOST_REQUIRE(cspace->isBorderlessDimensionEnabled(0));
+    BOOST_REQUIRE(!cspace->isBorderlessDimensionEnabled(1));
+
+    Saba::CSpaceTreePtr kdTree(new Saba::CSpaceTree(cspace));
+    kdTree->setNearestNeighborSearch(Saba::CSpaceTree::eKdTreeSearch);
+    BOOST_REQUIRE_EQUAL(kdTree->getNearestNeighborSearch(), Saba::CSpaceTree::eKdTreeSearch);
+
+    Eigen::VectorXf c(cspace->getDimension());
+    std::vector<Saba::CSpaceNodePtr> kdNodes;
+
+    for (int i = 0; i < 1500; i++)
+    {
+        cspace->getRandomConfig(c);
+        kdNodes.push_back(kdTree->appendNode(c, -1));
+    }
+
+    // remove some nodes (triggers a rebuild of the kd-tree)
+    for (int i = 0; i < 800; i++)
+    {
+        kdTree->removeNode(kdNodes[i]);
+    }
+
+    Saba::CSpaceTreePtr linearTree(new Saba::CSpaceTree(cspace));
+    std::vector<Saba::CSpaceNodePtr> n = kdTree->getNodes();
+
+    for (size_t i = 0; i < n.size(); i++)
+    {
+        linearTree->appendNode(n[i]->configuration, -1);
+    }
+
+    for (int i = 0; i < 500; i++)
+    {
+        cspace->getRandomConfig(c);
+        float dLinear, dKd;
+        linearTree->getNearestNeighborID(c, &dLinear);
+        unsigned int id = kdTree->getNearestNeighborID(c, &dKd);
+        BOOST_REQUIRE(kdTree->getNode(id));
+        BOOST_CHECK_CLOSE(dKd, dLinear, 0.01f);
+        BOOST_CHECK_CLOSE(cspace->calcDist(c, kdTree->getNode(id)->configuration, true), dLinear, 0.01f);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testKdTreeKNearestNeighbors)
+{
+    Saba::CSpaceSampledPtr cspace = createCSpace(2000);
+    Eigen::VectorXf c(cspace->getDimension());
+    std::vector<Saba::CSpaceNodePtr> nodes;
+
+    for (unsigned int i = 0; i < 1000; i++)
+    {
+        Saba::CSpaceNodePtr n(new Saba::CSpaceNode());
+        cspace->getRandomConfig(c);
+        n->configuration = c;
+        n->ID = i;
+        nodes.push_back(n);
+    }
+
+    Saba::CSpaceKdTree kdTree(cspace, false);
+    kdTree.build(nodes);
+
+    const unsigned int k = 8;
+    std::vector<int> ids;
+    std::vector<float> dists;
+
+    for (int i = 0; i < 200; i++)
+    {
+        cspace->getRandomConfig(c);
+        std::vector<float> allDists;
+
+        for (size_t j = 0; j < nodes.size(); j++)
+        {
+            allDists.push_back(cspace->calcDist2(c, nodes[j]->configuration, true));
+        }
+
+        std::sort(allDists.begin(), allDists.end());
+
+        BOOST_REQUIRE_EQUAL(kdTree.getKNearestNeighborIDs(c, k, ids, &dists), k);
+        BOOST_REQUIRE_EQUAL(ids.size(), k);
+
+        for (unsigned int j = 0; j < k; j++)
+        {
+            BOOST_CHECK_CLOSE(dists[j], allDists[j], 0.01f);
+            BOOST_CHECK_CLOSE(cspace->calcDist2(c, nodes[ids[j]]->configuration, true), allDists[j], 0.01f);
+        }
+
+        // all neighbors within the maximal distance
+        unsigned int nrInRange = (unsigned int)(std::upper_bound(allDists.begin(), allDists.end(), allDists[3]) - allDists.begin());
+        BOOST_CHECK_EQUAL(kdTree.getKNearestNeighborIDs(c, 100, ids, NULL, allDists[3] * 1.0001f), nrInRange);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testKdTreeBenchmark)
+{
+    const int nrNodes = 20000;
+    const int nrQueries = 1000;
+    Saba::CSpaceSampledPtr cspace = createCSpace(2 * nrNodes + 10);
+    Saba::CSpaceTreePtr linearTree(new Saba::CSpaceTree(cspace));
+    Saba::CSpaceTreePtr kdTree(new Saba::CSpaceTree(cspace));
+    kdTree->setNearestNeighborSearch(Saba::CSpaceTree::eKdTreeSearch);
+
+    // rrt like: chains of nearby configurations
+    Eigen::VectorXf c(cspace->getDimension());
+    Eigen::VectorXf r(cspace->getDimension());
+    cspace->getRandomConfig(c);
+
+    for (int i = 0; i < nrNodes; i++)
+    {
+        if (i % 20 == 0)
+        {
+            cspace->getRandomConfig(r);
+        }
+
+        c = cspace->interpolate(c, r, 0.1f);
+        linearTree->appendNode(c, -1);
+        kdTree->appendNode(c, -1);
+    }
+
+    std::vector<Eigen::VectorXf> queries(nrQueries, c);
+
+    for (int i = 0; i < nrQueries; i++)
+    {
+        cspace->getRandomConfig(queries[i]);
+    }
+
+    float sumLinear = 0;
+    float sumKd = 0;
+    float d;
+    clock_t t1 = clock();
+
+    for (int i = 0; i < nrQueries; i++)
+    {
+        linearTree->getNearestNeighborID(queries[i], &d);
+        sumLinear += d;
+    }
+
+    clock_t t2 = clock();
+
+    for (int i = 0; i < nrQueries; i++)
+    {
+        kdTree->getNearestNeighborID(queries[i], &d);
+        sumKd += d;
+    }
+
+    clock_t t3 = clock();
+
+    BOOST_CHECK_CLOSE(sumKd, sumLinear, 0.01f);
+    std::cout << "Nearest neighbor benchmark (" << nrNodes << " nodes, " << nrQueries << " queries): linear: "
+              << (float)(t2 - t1) / (float)CLOCKS_PER_SEC * 1000.0f << " ms, kd-tree: "
+              << (float)(t3 - t2) / (float)CLOCKS_PER_SEC * 1000.0f << " ms" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(testRemoveSubTree)
+{
+    Saba::CSpaceSampledPtr cspace = createCSpace(100);
+    Saba::CSpaceTreePtr tree(new Saba::CSpaceTree(cspace));
+    tree->setNearestNeighborSearch(Saba::CSpaceTree::eKdTreeSearch);
+    tree->setUpdateChildren(true);
+
+    // root -> a -> b -> c
+    //           -> d
+    //      -> e
+    Eigen::VectorXf c(cspace->getDimension());
+    cspace->getRandomConfig(c);
+    Saba::CSpaceNodePtr root = tree->appendNode(c, -1);
+    cspace->getRandomConfig(c);
+    Saba::CSpaceNodePtr a = tree->appendNode(c, root->ID);
+    cspace->getRandomConfig(c);
+    Saba::CSpaceNodePtr b = tree->appendNode(c, a->ID);
+    cspace->getRandomConfig(c);
+    Saba::CSpaceNodePtr n = tree->appendNode(c, b->ID);
+    cspace->getRandomConfig(c);
+    Saba::CSpaceNodePtr d = tree->appendNode(c, a->ID);
+    cspace->getRandomConfig(c);
+    Saba::CSpaceNodePtr e = tree->appendNode(c, root->ID);
+    BOOST_REQUIRE_EQUAL(tree->getNrOfNodes(), 6u);
+    BOOST_CHECK(!a->lazy);
+
+    int idA = a->ID;
+    int idB = b->ID;
+    int idC = n->ID;
+    int idD = d->ID;
+    BOOST_CHECK_EQUAL(tree->removeSubTree(a), 4u);
+    BOOST_CHECK_EQUAL(tree->getNrOfNodes(), 2u);
+    BOOST_CHECK(!tree->getNode(idA));
+    BOOST_CHECK(!tree->getNode(idB));
+    BOOST_CHECK(!tree->getNode(idC));
+    BOOST_CHECK(!tree->getNode(idD));
+    BOOST_CHECK(tree->getNode(root->ID));
+    BOOST_CHECK(tree->getNode(e->ID));
+    BOOST_REQUIRE_EQUAL(root->children.size(), 1u);
+    BOOST_CHECK(root->children[0] == e);
+
+    // the nearest neighbor search only considers the remaining nodes
+    for (int i = 0; i < 20; i++)
+    {
+        cspace->getRandomConfig(c);
+        Saba::CSpaceNodePtr nn = tree->getNearestNeighbor(c);
+        BOOST_CHECK(nn == root || nn == e);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
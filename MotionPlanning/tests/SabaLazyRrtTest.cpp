@@ -0,0 +1,146 @@
+/**
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE Saba_SabaLazyRrtTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/RobotNodeSet.h>
+#include <VirtualRobot/Obstacle.h>
+#include <VirtualRobot/SceneObjectSet.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/CollisionDetection/CDManager.h>
+#include <VirtualRobot/CollisionDetection/CollisionModel.h>
+#include <CSpace/CSpaceSampled.h>
+#include <CSpace/CSpacePath.h>
+#include <CSpace/CSpaceTree.h>
+#include <Planner/Rrt.h>
+#include <Planner/BiRrt.h>
+#include <string>
+#include <sstream>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+using namespace VirtualRobot;
+using namespace VirtualRobotTest;
+
+namespace
+{
+    // a box that moves in the plane between a grid of pillars
+    Saba::CSpaceSampledPtr createClutteredCSpace()
+    {
+        RobotPtr robot = createPlanarBoxRobot();
+        BOOST_REQUIRE(robot);
+
+        // 7x7 pillars of 150mm with gaps of 100mm
+        SceneObjectSetPtr obstacles(new SceneObjectSet("Obstacles"));
+
+        for (int x = -3; x <= 3; x++)
+        {
+            for (int y = -3; y <= 3; y++)
+            {
+                std::stringstream ss;
+                ss << "Pillar_" << x << "_" << y;
+                Eigen::Vector3f center((float)x * 250.0f, (float)y * 250.0f, 0.0f);
+                CollisionModelPtr c = createBox(center - Eigen::Vector3f(75.0f, 75.0f, 100.0f), center + Eigen::Vector3f(75.0f, 75.0f, 100.0f), ss.str());
+                obstacles->addSceneObject(ObstaclePtr(new Obstacle(ss.str(), c->getVisualization(), c)));
+            }
+        }
+
+        CDManagerPtr cdm(new CDManager());
+        cdm->addCollisionModelPair(robot->getRobotNodeSet("ColModel"), obstacles);
+        Saba::CSpaceSampledPtr cspace(new Saba::CSpaceSampled(robot, cdm, robot->getRobotNodeSet("Planning"), 500000, 42));
+        cspace->setSamplingSize(50.0f);
+        cspace->setSamplingSizeDCD(5.0f);
+        return cspace;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(LazyRrt)
+
+BOOST_AUTO_TEST_CASE(testLazyBiRrt)
+{
+    Saba::CSpaceSampledPtr cspace = createClutteredCSpace();
+
+    Eigen::VectorXf start(2);
+    Eigen::VectorXf goal(2);
+    start << -875.0f, -875.0f;
+    goal << 875.0f, 875.0f;
+    BOOST_REQUIRE(cspace->isConfigValid(start));
+    BOOST_REQUIRE(cspace->isConfigValid(goal));
+    BOOST_REQUIRE(!cspace->isPathValid(start, goal));
+
+    const int nrQueries = 10;
+    long timeMS[2] = {0, 0};
+    int colChecks[2] = {0, 0};
+
+    for (int lazy = 0; lazy < 2; lazy++)
+    {
+        for (int i = 0; i < nrQueries; i++)
+        {
+            Saba::BiRrtPtr planner(new Saba::BiRrt(cspace));
+            planner->enableLazyCollisionChecking(lazy == 1);
+            BOOST_CHECK_EQUAL(planner->isLazyCollisionCheckingEnabled(), lazy == 1);
+            BOOST_REQUIRE(planner->setStart(start));
+            BOOST_REQUIRE(planner->setGoal(goal));
+            int colChecksStart = cspace->performaceVars_collisionCheck;
+            boost::posix_time::ptime t = boost::posix_time::microsec_clock::local_time();
+            BOOST_REQUIRE(planner->plan(true));
+            timeMS[lazy] += (boost::posix_time::microsec_clock::local_time() - t).total_milliseconds();
+            colChecks[lazy] += cspace->performaceVars_collisionCheck - colChecksStart;
+
+            Saba::CSpacePathPtr solution = planner->getSolution();
+            BOOST_REQUIRE(solution);
+            BOOST_CHECK(solution->getPoint(0).isApprox(start));
+            BOOST_CHECK(solution->getPoint(solution->getNrOfPoints() - 1).isApprox(goal));
+            BOOST_CHECK(cspace->checkSolution(solution));
+        }
+    }
+
+    std::cout << "BiRrt: " << timeMS[0] / nrQueries << " ms, " << colChecks[0] / nrQueries << " collision checks (average of " << nrQueries << " queries)" << std::endl;
+    std::cout << "BiRrt (lazy): " << timeMS[1] / nrQueries << " ms, " << colChecks[1] / nrQueries << " collision checks (average of " << nrQueries << " queries)" << std::endl;
+    BOOST_CHECK_LT(colChecks[1], colChecks[0]);
+}
+
+BOOST_AUTO_TEST_CASE(testLazyRrt)
+{
+    Saba::CSpaceSampledPtr cspace = createClutteredCSpace();
+
+    Eigen::VectorXf start(2);
+    Eigen::VectorXf goal(2);
+    start << -875.0f, -875.0f;
+    goal << 875.0f, 875.0f;
+
+    const int nrQueries = 10;
+    long timeMS[2] = {0, 0};
+    int colChecks[2] = {0, 0};
+
+    for (int lazy = 0; lazy < 2; lazy++)
+    {
+        for (int i = 0; i < nrQueries; i++)
+        {
+            Saba::RrtPtr planner(new Saba::Rrt(cspace));
+            planner->enableLazyCollisionChecking(lazy == 1);
+            BOOST_REQUIRE(planner->setStart(start));
+            BOOST_REQUIRE(planner->setGoal(goal));
+            int colChecksStart = cspace->performaceVars_collisionCheck;
+            boost::posix_time::ptime t = boost::posix_time::microsec_clock::local_time();
+            BOOST_REQUIRE(planner->plan(true));
+            timeMS[lazy] += (boost::posix_time::microsec_clock::local_time() - t).total_milliseconds();
+            colChecks[lazy] += cspace->performaceVars_collisionCheck - colChecksStart;
+            BOOST_CHECK(cspace->checkSolution(planner->getSolution()));
+        }
+    }
+
+    std::cout << "Rrt: " << timeMS[0] / nrQueries << " ms, " << colChecks[0] / nrQueries << " collision checks (average of " << nrQueries << " queries)" << std::endl;
+    std::cout << "Rrt (lazy): " << timeMS[1] / nrQueries << " ms, " << colChecks[1] / nrQueries << " collision checks (average of " << nrQueries << " queries)" << std::endl;
+    BOOST_CHECK_LT(colChecks[1], colChecks[0]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,141 @@
+/**
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE Saba_SabaParallelBiRrtTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
+#include <MotionPlanning/tests/SabaTestConstraints.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/RobotNodeSet.h>
+#include <VirtualRobot/Obstacle.h>
+#include <VirtualRobot/SceneObjectSet.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/CollisionDetection/CDManager.h>
+#include <VirtualRobot/CollisionDetection/CollisionModel.h>
+#include <CSpace/CSpaceSampled.h>
+#include <CSpace/CSpacePath.h>
+#include <CSpace/CSpaceTree.h>
+#include <Planner/BiRrt.h>
+#include <Planner/ParallelBiRrt.h>
+#include <string>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+using namespace VirtualRobot;
+using namespace VirtualRobotTest;
+
+BOOST_AUTO_TEST_SUITE(ParallelBiRrt)
+
+BOOST_AUTO_TEST_CASE(testParallelBiRrtNarrowPassage)
+{
+    // a box that moves in the plane
+    RobotPtr robot = createPlanarBoxRobot();
+    BOOST_REQUIRE(robot);
+    RobotNodeSetPtr rns = robot->getRobotNodeSet("Planning");
+    BOOST_REQUIRE(rns);
+
+    // a wall with a narrow gap (120mm for the 50mm box)
+    SceneObjectSetPtr obstacles(new SceneObjectSet("Obstacles"));
+    CollisionModelPtr c1 = createBox(Eigen::Vector3f(-50.0f, 60.0f, -100.0f), Eigen::Vector3f(50.0f, 1100.0f, 100.0f), "Wall1");
+    CollisionModelPtr c2 = createBox(Eigen::Vector3f(-50.0f, -1100.0f, -100.0f), Eigen::Vector3f(50.0f, -60.0f, 100.0f), "Wall2");
+    obstacles->addSceneObject(ObstaclePtr(new Obstacle("Wall1", c1->getVisualization(), c1)));
+    obstacles->addSceneObject(ObstaclePtr(new Obstacle("Wall2", c2->getVisualization(), c2)));
+
+    CDManagerPtr cdm(new CDManager());
+    cdm->addCollisionModelPair(robot->getRobotNodeSet("ColModel"), obstacles);
+    Saba::CSpaceSampledPtr cspace(new Saba::CSpaceSampled(robot, cdm, rns, 500000, 42));
+    cspace->setSamplingSize(20.0f);
+    cspace->setSamplingSizeDCD(5.0f);
+
+    Eigen::VectorXf start(2);
+    Eigen::VectorXf goal(2);
+    start << -700.0f, 700.0f;
+    goal << 700.0f, -700.0f;
+    BOOST_REQUIRE(cspace->isConfigValid(start));
+    BOOST_REQUIRE(cspace->isConfigValid(goal));
+    BOOST_REQUIRE(!cspace->isPathValid(start, goal));
+
+    const int nrQueries = 5;
+    long timeMS = 0;
+    unsigned int nrNodes = 0;
+
+    // reference: standard BiRrt
+    for (int i = 0; i < nrQueries; i++)
+    {
+        Saba::BiRrtPtr planner(new Saba::BiRrt(cspace));
+        BOOST_REQUIRE(planner->setStart(start));
+        BOOST_REQUIRE(planner->setGoal(goal));
+        boost::posix_time::ptime t = boost::posix_time::microsec_clock::local_time();
+        BOOST_REQUIRE(planner->plan(true));
+        timeMS += (boost::posix_time::microsec_clock::local_time() - t).total_milliseconds();
+        nrNodes += planner->getTree()->getNrOfNodes() + planner->getTree2()->getNrOfNodes();
+        BOOST_CHECK(cspace->checkSolution(planner->getSolution()));
+    }
+
+    std::cout << "BiRrt: " << timeMS / nrQueries << " ms, " << nrNodes / nrQueries << " nodes (average of " << nrQueries << " queries)" << std::endl;
+
+    // 1, 2 and 4 threads, independent of the number of cores
+    for (unsigned int nrThreads = 1; nrThreads <= 4; nrThreads *= 2)
+    {
+        timeMS = 0;
+        nrNodes = 0;
+
+        for (int i = 0; i < nrQueries; i++)
+        {
+            Saba::ParallelBiRrtPtr planner(new Saba::ParallelBiRrt(cspace, nrThreads));
+            BOOST_CHECK_EQUAL(planner->getNrThreads(), nrThreads);
+            BOOST_REQUIRE(planner->setStart(start));
+            BOOST_REQUIRE(planner->setGoal(goal));
+            boost::posix_time::ptime t = boost::posix_time::microsec_clock::local_time();
+            BOOST_REQUIRE(planner->plan(true));
+            timeMS += (boost::posix_time::microsec_clock::local_time() - t).total_milliseconds();
+            nrNodes += planner->getTree()->getNrOfNodes() + planner->getTree2()->getNrOfNodes();
+
+            Saba::CSpacePathPtr solution = planner->getSolution();
+            BOOST_REQUIRE(solution);
+            BOOST_REQUIRE_GE(solution->getNrOfPoints(), 2u);
+            BOOST_CHECK(solution->getPoint(0).isApprox(start));
+            BOOST_CHECK(solution->getPoint(solution->getNrOfPoints() - 1).isApprox(goal));
+            BOOST_CHECK(cspace->checkSolution(solution));
+        }
+
+        // on a single core machine, no speedup can be expected
+        std::cout << "ParallelBiRrt, " << nrThreads << " thread(s): " << timeMS / nrQueries << " ms, " << nrNodes / nrQueries << " nodes (average of " << nrQueries << " queries)" << std::endl;
+    }
+
+    // the previous state of the collision contexts is restored
+    BOOST_CHECK(!cspace->hasThreadLocalCollisionContexts());
+}
+
+BOOST_AUTO_TEST_CASE(testParallelBiRrtNoValidSamples)
+{
+    RobotPtr robot = createPlanarBoxRobot();
+    BOOST_REQUIRE(robot);
+    RobotNodeSetPtr rns = robot->getRobotNodeSet("Planning");
+    BOOST_REQUIRE(rns);
+
+    CDManagerPtr cdm(new CDManager());
+    Saba::CSpaceSampledPtr cspace(new Saba::CSpaceSampled(robot, cdm, rns, 500000, 42));
+
+    Eigen::VectorXf start(2);
+    Eigen::VectorXf goal(2);
+    start << -700.0f, 700.0f;
+    goal << 700.0f, -700.0f;
+    cspace->addConstraintCheck(Saba::ConfigurationConstraintPtr(new SabaTest::TwoPointConstraint(start, goal)));
+
+    // (nearly) all random samples are invalid, the rejected samples are counted as cycles
+    Saba::ParallelBiRrtPtr planner(new Saba::ParallelBiRrt(cspace, 2));
+    planner->setMaxCycles(1000);
+    BOOST_REQUIRE(planner->setStart(start));
+    BOOST_REQUIRE(planner->setGoal(goal));
+    BOOST_CHECK(!planner->plan(true));
+    BOOST_CHECK_GE(planner->getNrOfCycles(), 1000u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
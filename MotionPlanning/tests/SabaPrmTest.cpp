@@ -0,0 +1,350 @@
+/**
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE Saba_SabaPrmTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
+#include <MotionPlanning/tests/SabaTestConstraints.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/RobotNodeSet.h>
+#include <VirtualRobot/Obstacle.h>
+#include <VirtualRobot/SceneObjectSet.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/CollisionDetection/CDManager.h>
+#include <VirtualRobot/CollisionDetection/CollisionModel.h>
+#include <CSpace/CSpaceSampled.h>
+#include <CSpace/CSpacePath.h>
+#include <CSpace/CSpaceNode.h>
+#include <Planner/BiRrt.h>
+#include <Planner/Prm.h>
+#include <boost/filesystem.hpp>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+using namespace VirtualRobot;
+using namespace VirtualRobotTest;
+
+namespace
+{
+    // a box that moves in the plane between a grid of pillars
+    Saba::CSpaceSampledPtr createCSpace(unsigned int randomSeed)
+    {
+        RobotPtr robot = createPlanarBoxRobot();
+        BOOST_REQUIRE(robot);
+
+        // 4x4 pillars of 250mm with gaps of 150mm
+        SceneObjectSetPtr obstacles(new SceneObjectSet("Obstacles"));
+
+        for (int x = 0; x < 4; x++)
+        {
+            for (int y = 0; y < 4; y++)
+            {
+                std::stringstream ss;
+                ss << "Pillar_" << x << "_" << y;
+                Eigen::Vector3f center(-600.0f + (float)x * 400.0f, -600.0f + (float)y * 400.0f, 0.0f);
+                CollisionModelPtr c = createBox(center - Eigen::Vector3f(125.0f, 125.0f, 100.0f), center + Eigen::Vector3f(125.0f, 125.0f, 100.0f), ss.str());
+                obstacles->addSceneObject(ObstaclePtr(new Obstacle(ss.str(), c->getVisualization(), c)));
+            }
+        }
+
+        CDManagerPtr cdm(new CDManager());
+        cdm->addCollisionModelPair(robot->getRobotNodeSet("ColModel"), obstacles);
+        Saba::CSpaceSampledPtr cspace(new Saba::CSpaceSampled(robot, cdm, robot->getRobotNodeSet("Planning"), 500000, randomSeed));
+        cspace->setSamplingSize(50.0f);
+        cspace->setSamplingSizeDCD(5.0f);
+        return cspace;
+    }
+
+    // the collision check of the meshes does not detect a box that is completely inside a pillar
+    bool isInsidePillar(const Eigen::VectorXf& c)
+    {
+        for (int x = 0; x < 4; x++)
+        {
+            for (int y = 0; y < 4; y++)
+            {
+                if (fabs(c(0) - (-600.0f + (float)x * 400.0f)) < 150.0f && fabs(c(1) - (-600.0f + (float)y * 400.0f)) < 150.0f)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    // random valid query configurations
+    void createQueries(Saba::CSpaceSampledPtr cspace, int nrQueries, std::vector<Eigen::VectorXf>& storeStarts, std::vector<Eigen::VectorXf>& storeGoals)
+    {
+        Eigen::VectorXf c(cspace->getDimension());
+
+        while ((int)storeGoals.size() < nrQueries)
+        {
+            do
+            {
+                cspace->getRandomConfig(c);
+            }
+            while (isInsidePillar(c) || !cspace->isConfigValid(c));
+
+            if (storeStarts.size() == storeGoals.size())
+            {
+                storeStarts.push_back(c);
+            }
+            else
+            {
+                storeGoals.push_back(c);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(Prm)
+
+BOOST_AUTO_TEST_CASE(testPrmBuildDeterministic)
+{
+    // the roadmap only depends on the random seed, not on the number of threads
+    Saba::CSpaceSampledPtr cspace1 = createCSpace(42);
+    Saba::PrmPtr prm1(new Saba::Prm(cspace1, 8));
+    BOOST_REQUIRE(prm1->buildRoadmap(500, 1, true));
+
+    Saba::CSpaceSampledPtr cspace2 = createCSpace(42);
+    Saba::PrmPtr prm2(new Saba::Prm(cspace2, 8));
+    BOOST_REQUIRE(prm2->buildRoadmap(500, 3, true));
+
+    BOOST_REQUIRE_EQUAL(prm1->getNrOfRoadmapNodes(), 500u);
+    BOOST_REQUIRE_EQUAL(prm1->getNrOfRoadmapNodes(), prm2->getNrOfRoadmapNodes());
+    BOOST_REQUIRE_EQUAL(prm1->getNrOfRoadmapEdges(), prm2->getNrOfRoadmapEdges());
+    BOOST_CHECK_GT(prm1->getNrOfRoadmapEdges(), 500u);
+
+    for (unsigned int i = 0; i < prm1->getNrOfRoadmapNodes(); i++)
+    {
+        BOOST_CHECK(prm1->getRoadmapNodes()[i]->configuration.isApprox(prm2->getRoadmapNodes()[i]->configuration));
+    }
+
+    for (unsigned int i = 0; i < prm1->getNrOfRoadmapEdges(); i++)
+    {
+        BOOST_CHECK_EQUAL(prm1->getRoadmapEdges()[i].node1, prm2->getRoadmapEdges()[i].node1);
+        BOOST_CHECK_EQUAL(prm1->getRoadmapEdges()[i].node2, prm2->getRoadmapEdges()[i].node2);
+        BOOST_CHECK(cspace1->isPathValid(prm1->getRoadmapNodes()[prm1->getRoadmapEdges()[i].node1]->configuration, prm1->getRoadmapNodes()[prm1->getRoadmapEdges()[i].node2]->configuration));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testPrmQueries)
+{
+    Saba::CSpaceSampledPtr cspace = createCSpace(42);
+    Saba::PrmPtr prm(new Saba::Prm(cspace, 10));
+    boost::posix_time::ptime t = boost::posix_time::microsec_clock::local_time();
+    BOOST_REQUIRE(prm->buildRoadmap(1000, 0, true));
+    std::cout << "Prm: roadmap with " << prm->getNrOfRoadmapNodes() << " nodes and " << prm->getNrOfRoadmapEdges() << " edges built in " << (boost::posix_time::microsec_clock::local_time() - t).total_milliseconds() << " ms" << std::endl;
+
+    const int nrQueries = 20;
+    std::vector<Eigen::VectorXf> starts;
+    std::vector<Eigen::VectorXf> goals;
+    createQueries(cspace, nrQueries, starts, goals);
+
+    long timeMS[2] = {0, 0};
+    int solved = 0;
+
+    for (int i = 0; i < nrQueries; i++)
+    {
+        BOOST_REQUIRE(prm->setStart(starts[i]));
+        BOOST_REQUIRE(prm->setGoal(goals[i]));
+        t = boost::posix_time::microsec_clock::local_time();
+        bool ok = prm->plan(true);
+        timeMS[0] += (boost::posix_time::microsec_clock::local_time() - t).total_milliseconds();
+
+        if (ok)
+        {
+            solved++;
+            Saba::CSpacePathPtr solution = prm->getSolution();
+            BOOST_REQUIRE(solution);
+            BOOST_CHECK(solution->getPoint(0).isApprox(starts[i]));
+            BOOST_CHECK(solution->getPoint(solution->getNrOfPoints() - 1).isApprox(goals[i]));
+            BOOST_CHECK(cspace->checkSolution(solution));
+        }
+
+        // the query nodes are removed
+        BOOST_CHECK_EQUAL(prm->getRoadmapNodes().size(), prm->getNrOfRoadmapNodes());
+        BOOST_CHECK_EQUAL(prm->getRoadmapEdges().size(), prm->getNrOfRoadmapEdges());
+
+        // reference: a new BiRrt for each query
+        Saba::BiRrtPtr rrt(new Saba::BiRrt(cspace));
+        BOOST_REQUIRE(rrt->setStart(starts[i]));
+        BOOST_REQUIRE(rrt->setGoal(goals[i]));
+        t = boost::posix_time::microsec_clock::local_time();
+        BOOST_CHECK(rrt->plan(true));
+        timeMS[1] += (boost::posix_time::microsec_clock::local_time() - t).total_milliseconds();
+    }
+
+    // the free space is connected and the roadmap is dense enough
+    BOOST_CHECK_EQUAL(solved, nrQueries);
+    std::cout << "Prm: " << (float)timeMS[0] / (float)nrQueries << " ms per query, BiRrt: " << (float)timeMS[1] / (float)nrQueries << " ms per query (average of " << nrQueries << " queries)" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(testPrmSaveLoad)
+{
+    Saba::CSpaceSampledPtr cspace = createCSpace(42);
+    Saba::PrmPtr prm(new Saba::Prm(cspace, 10));
+    BOOST_REQUIRE(prm->buildRoadmap(300, 0, true));
+
+    boost::filesystem::path tmpFile = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("saba_roadmap_%%%%%%%%.bin");
+    BOOST_REQUIRE(prm->saveRoadmap(tmpFile.string()));
+
+    Saba::PrmPtr prm2(new Saba::Prm(cspace, 10));
+    BOOST_REQUIRE(prm2->loadRoadmap(tmpFile.string()));
+    BOOST_CHECK(!prm2->loadRoadmap((tmpFile.string() + ".missing")));
+    BOOST_REQUIRE(prm2->loadRoadmap(tmpFile.string()));
+    boost::filesystem::remove(tmpFile);
+
+    BOOST_REQUIRE_EQUAL(prm2->getNrOfRoadmapNodes(), prm->getNrOfRoadmapNodes());
+    BOOST_REQUIRE_EQUAL(prm2->getNrOfRoadmapEdges(), prm->getNrOfRoadmapEdges());
+
+    for (unsigned int i = 0; i < prm->getNrOfRoadmapNodes(); i++)
+    {
+        BOOST_CHECK(prm2->getRoadmapNodes()[i]->configuration == prm->getRoadmapNodes()[i]->configuration);
+        BOOST_CHECK_EQUAL(prm2->getRoadmapNodes()[i]->status, (int)Saba::Prm::eValid);
+    }
+
+    for (unsigned int i = 0; i < prm->getNrOfRoadmapEdges(); i++)
+    {
+        BOOST_CHECK_EQUAL(prm2->getRoadmapEdges()[i].node1, prm->getRoadmapEdges()[i].node1);
+        BOOST_CHECK_EQUAL(prm2->getRoadmapEdges()[i].node2, prm->getRoadmapEdges()[i].node2);
+        BOOST_CHECK_CLOSE(prm2->getRoadmapEdges()[i].length, prm->getRoadmapEdges()[i].length, 0.001f);
+        BOOST_CHECK_EQUAL(prm2->getRoadmapEdges()[i].state, (unsigned char)Saba::Prm::eValid);
+    }
+
+    Eigen::VectorXf start(2);
+    Eigen::VectorXf goal(2);
+    start << -800.0f, -800.0f;
+    goal << 800.0f, 800.0f;
+    BOOST_REQUIRE(prm2->setStart(start));
+    BOOST_REQUIRE(prm2->setGoal(goal));
+    BOOST_REQUIRE(prm2->plan(true));
+    BOOST_CHECK(cspace->checkSolution(prm2->getSolution()));
+}
+
+BOOST_AUTO_TEST_CASE(testPrmLoadCorruptedRoadmap)
+{
+    Saba::CSpaceSampledPtr cspace = createCSpace(42);
+    Saba::PrmPtr prm(new Saba::Prm(cspace, 10));
+    BOOST_REQUIRE(prm->buildRoadmap(50, 0, true));
+    const unsigned int nrNodes = prm->getNrOfRoadmapNodes();
+    const unsigned int nrEdges = prm->getNrOfRoadmapEdges();
+
+    boost::filesystem::path tmpFile = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("saba_roadmap_%%%%%%%%.bin");
+    BOOST_REQUIRE(prm->saveRoadmap(tmpFile.string()));
+
+    std::string data;
+    {
+        std::ifstream in(tmpFile.string().c_str(), std::ios::in | std::ios::binary);
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        data = buffer.str();
+    }
+
+    // layout behind the header: nrNodes, nodes (2 floats, state), nrEdges, edges (2 indices, state), "End"
+    const size_t endSize = 4 + 3;
+    const size_t edgesOffset = data.size() - endSize - nrEdges * 9;
+    const size_t nrEdgesOffset = edgesOffset - 4;
+    const size_t nodesOffset = nrEdgesOffset - nrNodes * 9;
+    const size_t nrNodesOffset = nodesOffset - 4;
+    int32_t v;
+    memcpy(&v, &data[nrNodesOffset], 4);
+    BOOST_REQUIRE_EQUAL(v, (int32_t)nrNodes);
+    memcpy(&v, &data[nrEdgesOffset], 4);
+    BOOST_REQUIRE_EQUAL(v, (int32_t)nrEdges);
+
+    std::vector<std::string> corrupted;
+    const int32_t hugeCount = 0x7fffffff;
+    corrupted.push_back(data);
+    memcpy(&corrupted.back()[nrNodesOffset], &hugeCount, 4);
+    corrupted.push_back(data);
+    memcpy(&corrupted.back()[nrEdgesOffset], &hugeCount, 4);
+    corrupted.push_back(data);
+    corrupted.back()[nodesOffset + 8] = 3; // state of the first node
+    corrupted.push_back(data);
+    corrupted.back()[edgesOffset + 8] = 100; // state of the first edge
+    corrupted.push_back(data.substr(0, nodesOffset + nrNodes * 9 / 2));
+
+    Saba::PrmPtr prm2(new Saba::Prm(cspace, 10));
+
+    for (size_t i = 0; i < corrupted.size(); i++)
+    {
+        {
+            std::ofstream out(tmpFile.string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write(corrupted[i].data(), corrupted[i].size());
+        }
+
+        BOOST_CHECK(!prm2->loadRoadmap(tmpFile.string()));
+        BOOST_CHECK_EQUAL(prm2->getNrOfRoadmapNodes(), 0u);
+        BOOST_CHECK_EQUAL(prm2->getNrOfRoadmapEdges(), 0u);
+    }
+
+    boost::filesystem::remove(tmpFile);
+}
+
+BOOST_AUTO_TEST_CASE(testPrmNoValidSamples)
+{
+    RobotPtr robot = createPlanarBoxRobot();
+    BOOST_REQUIRE(robot);
+    CDManagerPtr cdm(new CDManager());
+    Saba::CSpaceSampledPtr cspace(new Saba::CSpaceSampled(robot, cdm, robot->getRobotNodeSet("Planning"), 500000, 42));
+
+    Eigen::VectorXf start(2);
+    Eigen::VectorXf goal(2);
+    start << -700.0f, 700.0f;
+    goal << 700.0f, -700.0f;
+    cspace->addConstraintCheck(Saba::ConfigurationConstraintPtr(new SabaTest::TwoPointConstraint(start, goal)));
+
+    // (nearly) all random samples are invalid, the construction is aborted after maxCycles invalid samples
+    Saba::PrmPtr prm(new Saba::Prm(cspace));
+    prm->setMaxCycles(1000);
+    BOOST_CHECK(!prm->buildRoadmap(200, 2, true));
+    BOOST_CHECK_EQUAL(prm->getNrOfRoadmapNodes(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(testPrmEnvironmentChange)
+{
+    Saba::CSpaceSampledPtr cspace = createCSpace(42);
+    Saba::PrmPtr prm(new Saba::Prm(cspace, 10));
+    BOOST_REQUIRE(prm->buildRoadmap(1000, 0, true));
+
+    Eigen::VectorXf start(2);
+    Eigen::VectorXf goal(2);
+    start << -800.0f, 0.0f;
+    goal << 800.0f, 0.0f;
+    BOOST_REQUIRE(prm->setStart(start));
+    BOOST_REQUIRE(prm->setGoal(goal));
+    BOOST_REQUIRE(prm->plan(true));
+    Saba::CSpacePathPtr solution = prm->getSolution();
+
+    // block the passage of the old solution in the middle (between the central pillars)
+    SceneObjectSetPtr newObstacles(new SceneObjectSet("NewObstacles"));
+    CollisionModelPtr c = createBox(Eigen::Vector3f(-75.0f, -1000.0f, -100.0f), Eigen::Vector3f(75.0f, 325.0f, 100.0f), "Blocker");
+    newObstacles->addSceneObject(ObstaclePtr(new Obstacle("Blocker", c->getVisualization(), c)));
+    cspace->getCDManager()->addCollisionModelPair(cspace->getRobot()->getRobotNodeSet("ColModel"), newObstacles);
+    BOOST_REQUIRE(!cspace->checkSolution(solution));
+
+    prm->setRoadmapUnchecked();
+    BOOST_REQUIRE(prm->plan(true));
+    BOOST_CHECK_GT(prm->getNrOfLazyChecks(), 0u);
+    BOOST_CHECK(cspace->checkSolution(prm->getSolution()));
+    unsigned int lazyChecks = prm->getNrOfLazyChecks();
+
+    // the check results are kept, a second query needs less checks
+    BOOST_REQUIRE(prm->plan(true));
+    BOOST_CHECK_LT(prm->getNrOfLazyChecks(), lazyChecks);
+    BOOST_CHECK(cspace->checkSolution(prm->getSolution()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,7 @@
 #define BOOST_TEST_MODULE Saba_SabaShortcutProcessorTest
 
 #include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
 #include <VirtualRobot/XML/RobotIO.h>
 #include <VirtualRobot/Robot.h>
 #include <VirtualRobot/RobotNodeSet.h>
@@ -16,12 +17,19 @@
 #include <CSpace/CSpaceSampled.h>
 #include <CSpace/CSpacePath.h>
 #include <PostProcessing/ShortcutProcessor.h>
+#include <PostProcessing/ParallelShortcutProcessor.h>
+#include <Planner/BiRrt.h>
 #include <VirtualRobot/CollisionDetection/CDManager.h>
+#include <VirtualRobot/SceneObjectSet.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
 #include <string>
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 
+using namespace VirtualRobot;
+using namespace VirtualRobotTest;
+
 
 BOOST_AUTO_TEST_SUITE(CSpaceShortcutProcessor)
 
@@ -128,4 +136,80 @@ BOOST_AUTO_TEST_CASE(testShortcutProcessor)
 
 }
 
+BOOST_AUTO_TEST_CASE(testParallelShortcutProcessor)
+{
+    // a box that moves in the plane, a wall with a narrow gap
+    RobotPtr robot = createPlanarBoxRobot();
+    BOOST_REQUIRE(robot);
+
+    SceneObjectSetPtr obstacles(new SceneObjectSet("Obstacles"));
+    CollisionModelPtr c1 = createBox(Eigen::Vector3f(-50.0f, 60.0f, -100.0f), Eigen::Vector3f(50.0f, 1100.0f, 100.0f), "Wall1");
+    CollisionModelPtr c2 = createBox(Eigen::Vector3f(-50.0f, -1100.0f, -100.0f), Eigen::Vector3f(50.0f, -60.0f, 100.0f), "Wall2");
+    obstacles->addSceneObject(ObstaclePtr(new Obstacle("Wall1", c1->getVisualization(), c1)));
+    obstacles->addSceneObject(ObstaclePtr(new Obstacle("Wall2", c2->getVisualization(), c2)));
+
+    CDManagerPtr cdm(new CDManager());
+    cdm->addCollisionModelPair(robot->getRobotNodeSet("ColModel"), obstacles);
+    Saba::CSpaceSampledPtr cspace(new Saba::CSpaceSampled(robot, cdm, robot->getRobotNodeSet("Planning"), 500000, 42));
+    cspace->setSamplingSize(20.0f);
+    cspace->setSamplingSizeDCD(5.0f);
+
+    Eigen::VectorXf start(2);
+    Eigen::VectorXf goal(2);
+    start << -700.0f, 700.0f;
+    goal << 700.0f, -700.0f;
+    Saba::BiRrtPtr planner(new Saba::BiRrt(cspace));
+    BOOST_REQUIRE(planner->setStart(start));
+    BOOST_REQUIRE(planner->setGoal(goal));
+    BOOST_REQUIRE(planner->plan(true));
+    Saba::CSpacePathPtr path = planner->getSolution();
+    BOOST_REQUIRE(cspace->checkSolution(path));
+
+    const int loops = 300;
+
+    // reference: the sequential shortcut processor
+    Saba::ShortcutProcessorPtr sc(new Saba::ShortcutProcessor(path, cspace));
+    boost::posix_time::ptime t = boost::posix_time::microsec_clock::local_time();
+    Saba::CSpacePathPtr reference = sc->optimize(loops);
+    long timeMS = (boost::posix_time::microsec_clock::local_time() - t).total_milliseconds();
+    BOOST_CHECK(cspace->checkSolution(reference));
+    std::cout << "Path length: " << path->getLength() << ", ShortcutProcessor: " << reference->getLength() << " (" << timeMS << " ms)" << std::endl;
+
+    // the result only depends on the seed, not on the number of threads
+    Saba::CSpacePathPtr firstResult;
+
+    for (unsigned int nrThreads = 1; nrThreads <= 4; nrThreads *= 2)
+    {
+        Saba::ParallelShortcutProcessorPtr psc(new Saba::ParallelShortcutProcessor(path, cspace, nrThreads, 7));
+        BOOST_CHECK_EQUAL(psc->getNrThreads(), nrThreads);
+        t = boost::posix_time::microsec_clock::local_time();
+        Saba::CSpacePathPtr result = psc->optimize(loops);
+        timeMS = (boost::posix_time::microsec_clock::local_time() - t).total_milliseconds();
+        BOOST_REQUIRE(result);
+        BOOST_CHECK(cspace->checkSolution(result));
+        BOOST_CHECK_LT(result->getLength(), path->getLength());
+        BOOST_CHECK(result->getPoint(0).isApprox(start));
+        BOOST_CHECK(result->getPoint(result->getNrOfPoints() - 1).isApprox(goal));
+
+        // on a single core machine, no speedup can be expected
+        std::cout << "ParallelShortcutProcessor, " << nrThreads << " thread(s): " << result->getLength() << " (" << timeMS << " ms)" << std::endl;
+
+        if (!firstResult)
+        {
+            firstResult = result;
+            continue;
+        }
+
+        BOOST_REQUIRE_EQUAL(result->getNrOfPoints(), firstResult->getNrOfPoints());
+
+        for (unsigned int i = 0; i < result->getNrOfPoints(); i++)
+        {
+            BOOST_CHECK(result->getPoint(i) == firstResult->getPoint(i));
+        }
+    }
+
+    // the previous state of the collision contexts is restored
+    BOOST_CHECK(!cspace->hasThreadLocalCollisionContexts());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,55 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef _Saba_TestConstraints_h_
+#define _Saba_TestConstraints_h_
+
+#include <CSpace/ConfigurationConstraint.h>
+
+#include <Eigen/Core>
+
+/*
+    Configuration constraints for the Saba tests.
+*/
+namespace SabaTest
+{
+    //! Only the configurations close to a and b are valid, i.e. (nearly) all random samples are invalid.
+    class TwoPointConstraint : public Saba::ConfigurationConstraint
+    {
+    public:
+        TwoPointConstraint(const Eigen::VectorXf& a, const Eigen::VectorXf& b)
+            : Saba::ConfigurationConstraint((unsigned int)a.rows()), a(a), b(b)
+        {
+        }
+
+        virtual bool isValid(const Eigen::VectorXf& c)
+        {
+            return (c - a).norm() < 1.0f || (c - b).norm() < 1.0f;
+        }
+
+    protected:
+        Eigen::VectorXf a;
+        Eigen::VectorXf b;
+    };
+}
+
+#endif /* _Saba_TestConstraints_h_ */
@@ -0,0 +1,279 @@
+/**
+* @package    Saba
+* @author     Nikolaus Vahrenkamp
+* @copyright  2012 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE Saba_SabaTimeOptimalTrajectoryTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/RobotNodeSet.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/CollisionDetection/CDManager.h>
+#include <CSpace/CSpaceSampled.h>
+#include <CSpace/CSpacePath.h>
+#include <PostProcessing/TimeOptimalTrajectory.h>
+#include <string>
+#include <iostream>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <Eigen/Core>
+
+using namespace VirtualRobot;
+
+namespace
+{
+    // a revolute and a prismatic joint
+    Saba::CSpaceSampledPtr createCSpace()
+    {
+        const std::string robotString =
+            "<Robot Type='MyDemoRobotType' StandardName='ExampleRobo' RootNode='Joint1'>"
+            " <RobotNode name='Joint1'>"
+            "  <Joint type='revolute'><Limits unit='degree' lo='-180' hi='180'/><Axis x='0' y='0' z='1'/></Joint>"
+            "  <Child name='Joint2'/>"
+            " </RobotNode>"
+            " <RobotNode name='Joint2'>"
+            "  <Joint type='prismatic'><Limits unit='mm' lo='-1000' hi='1000'/><TranslationDirection x='1' y='0' z='0'/></Joint>"
+            " </RobotNode>"
+            " <RobotNodeSet name='rns1'><Node name='Joint1'/><Node name='Joint2'/></RobotNodeSet>"
+            "</Robot>";
+        RobotPtr rob = RobotIO::createRobotFromString(robotString);
+        BOOST_REQUIRE(rob);
+        RobotNodeSetPtr rns = rob->getRobotNodeSet("rns1");
+        BOOST_REQUIRE(rns);
+
+        // rad/s, m/s
+        rob->getRobotNode("Joint1")->setMaxVelocity(1.0f);
+        rob->getRobotNode("Joint1")->setMaxAcceleration(2.0f);
+        rob->getRobotNode("Joint2")->setMaxVelocity(0.5f);
+        rob->getRobotNode("Joint2")->setMaxAcceleration(1.0f);
+
+        CDManagerPtr cdm(new CDManager());
+        return Saba::CSpaceSampledPtr(new Saba::CSpaceSampled(rob, cdm, rns));
+    }
+
+    Eigen::VectorXf config(float a, float b)
+    {
+        Eigen::VectorXf c(2);
+        c << a, b;
+        return c;
+    }
+
+    // checks the limits and the continuity of the trajectory
+    void checkTrajectory(Saba::TimeOptimalTrajectoryPtr traj, Saba::CSpacePathPtr path)
+    {
+        Eigen::VectorXf maxVel = traj->getMaxVelocities();
+        Eigen::VectorXf maxAcc = traj->getMaxAccelerations();
+        Eigen::VectorXf pos, vel, acc, lastPos;
+        const float dt = 0.001f;
+
+        traj->getState(0, lastPos, &vel);
+        BOOST_CHECK_SMALL((lastPos - path->getPoint(0)).norm(), 1e-4f);
+        BOOST_CHECK_SMALL(vel.norm(), 1e-4f);
+
+        int steps = (int)(traj->getDuration() / dt);
+
+        for (int i = 1; i <= steps; i++)
+        {
+            traj->getState((float)i * dt, pos, &vel, &acc);
+
+            for (int j = 0; j < 2; j++)
+            {
+                BOOST_CHECK_LE(fabs(vel[j]), maxVel[j] * 1.001f);
+                BOOST_CHECK_LE(fabs(acc[j]), maxAcc[j] * 1.001f);
+                BOOST_CHECK_LE(fabs(pos[j] - lastPos[j]), maxVel[j] * dt * 1.01f);
+            }
+
+            lastPos = pos;
+        }
+
+        traj->getState(traj->getDuration(), pos, &vel);
+        BOOST_CHECK_SMALL((pos - path->getPoint(path->getNrOfPoints() - 1)).norm(), 1e-3f);
+        BOOST_CHECK_SMALL(vel.norm(), 1e-3f);
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE(TimeOptimalTrajectory)
+
+BOOST_AUTO_TEST_CASE(testTimeOptimalTrajectoryLimits)
+{
+    Saba::CSpaceSampledPtr cspace = createCSpace();
+    Saba::CSpacePathPtr path(new Saba::CSpacePath(cspace, "test_path"));
+    path->addPoint(config(0, 0));
+    path->addPoint(config(1.0f, 0));
+
+    Saba::TimeOptimalTrajectoryPtr traj(new Saba::TimeOptimalTrajectory(path));
+
+    // translational limits are converted to mm
+    Eigen::VectorXf maxVel = traj->getMaxVelocities();
+    Eigen::VectorXf maxAcc = traj->getMaxAccelerations();
+    BOOST_CHECK_CLOSE(maxVel[0], 1.0f, 1e-3f);
+    BOOST_CHECK_CLOSE(maxVel[1], 500.0f, 1e-3f);
+    BOOST_CHECK_CLOSE(maxAcc[0], 2.0f, 1e-3f);
+    BOOST_CHECK_CLOSE(maxAcc[1], 1000.0f, 1e-3f);
+
+    // trapezoidal profile: 0.5s acceleration, 0.5s cruising, 0.5s deceleration
+    BOOST_REQUIRE(traj->compute());
+    BOOST_CHECK_CLOSE(traj->getDuration(), 1.5f, 1e-2f);
+    BOOST_CHECK_EQUAL(traj->getNrOfPieces(), 3);
+    checkTrajectory(traj, path);
+
+    Eigen::VectorXf pos, vel;
+    traj->getState(0.75f, pos, &vel);
+    BOOST_CHECK_CLOSE(pos[0], 0.5f, 1e-2f);
+    BOOST_CHECK_CLOSE(vel[0], 1.0f, 1e-2f);
+
+    // triangular profile: the max velocity is not reached
+    path->addPoint(config(1.0f, 100.0f));
+    traj.reset(new Saba::TimeOptimalTrajectory(path));
+    BOOST_REQUIRE(traj->compute());
+    BOOST_CHECK_CLOSE(traj->getDuration(), 1.5f + 2.0f * sqrtf(0.1f), 1e-2f);
+    checkTrajectory(traj, path);
+
+    // a joint without limits
+    Eigen::VectorXf noLimits = maxVel;
+    noLimits[1] = -1.0f;
+    traj->setMaxVelocities(noLimits);
+    BOOST_CHECK(!traj->compute());
+}
+
+BOOST_AUTO_TEST_CASE(testTimeOptimalTrajectoryJunctions)
+{
+    Saba::CSpaceSampledPtr cspace = createCSpace();
+
+    // collinear points are passed without stopping
+    Saba::CSpacePathPtr dense(new Saba::CSpacePath(cspace, "dense"));
+
+    for (int i = 0; i <= 100; i++)
+    {
+        dense->addPoint(config((float)i * 0.01f, (float)i * 1.0f));
+    }
+
+    // duplicated points are skipped
+    dense->addPoint(config(1.0f, 100.0f));
+
+    Saba::CSpacePathPtr line(new Saba::CSpacePath(cspace, "line"));
+    line->addPoint(config(0, 0));
+    line->addPoint(config(1.0f, 100.0f));
+
+    Saba::TimeOptimalTrajectoryPtr trajDense(new Saba::TimeOptimalTrajectory(dense));
+    Saba::TimeOptimalTrajectoryPtr trajLine(new Saba::TimeOptimalTrajectory(line));
+    BOOST_REQUIRE(trajDense->compute());
+    BOOST_REQUIRE(trajLine->compute());
+    BOOST_CHECK_CLOSE(trajDense->getDuration(), trajLine->getDuration(), 1e-1f);
+    checkTrajectory(trajDense, dense);
+
+    // corners are passed with zero velocity
+    Saba::CSpacePathPtr corner(new Saba::CSpacePath(cspace, "corner"));
+    corner->addPoint(config(0, 0));
+    corner->addPoint(config(1.0f, 0));
+    corner->addPoint(config(1.0f, 100.0f));
+    corner->addPoint(config(0, 200.0f));
+
+    Saba::TimeOptimalTrajectoryPtr trajCorner(new Saba::TimeOptimalTrajectory(corner));
+    BOOST_REQUIRE(trajCorner->compute());
+    checkTrajectory(trajCorner, corner);
+
+    float sum = 0;
+
+    for (unsigned int i = 0; i < corner->getNrOfPoints() - 1; i++)
+    {
+        Saba::CSpacePathPtr part(new Saba::CSpacePath(cspace, "part"));
+        part->addPoint(corner->getPoint(i));
+        part->addPoint(corner->getPoint(i + 1));
+        Saba::TimeOptimalTrajectory trajPart(part);
+        BOOST_REQUIRE(trajPart.compute());
+        sum += trajPart.getDuration();
+    }
+
+    BOOST_CHECK_CLOSE(trajCorner->getDuration(), sum, 1e-2f);
+
+    // a junction time allows passing the corners with a bounded velocity jump
+    trajCorner->setJunctionTime(0.01f);
+    BOOST_REQUIRE(trajCorner->compute());
+    BOOST_CHECK_LT(trajCorner->getDuration(), sum);
+
+    Saba::CSpacePathPtr sampled = trajCorner->createSampledPath(0.01f);
+    BOOST_REQUIRE(sampled);
+    BOOST_CHECK_EQUAL(sampled->getNrOfPoints(), (unsigned int)ceil(trajCorner->getDuration() / 0.01f) + 1);
+    BOOST_CHECK_SMALL((sampled->getPoint(0) - corner->getPoint(0)).norm(), 1e-4f);
+    BOOST_CHECK_SMALL((sampled->getPoint(sampled->getNrOfPoints() - 1) - corner->getPoint(3)).norm(), 1e-3f);
+}
+
+BOOST_AUTO_TEST_CASE(testTimeOptimalTrajectoryBorderless)
+{
+    Saba::CSpaceSampledPtr cspace = createCSpace();
+    BOOST_REQUIRE(cspace->isBorderlessDimensionEnabled(0));
+
+    // the revolute joint crosses the border at +-PI
+    Saba::CSpacePathPtr path(new Saba::CSpacePath(cspace, "border"));
+    path->addPoint(config(3.0f, 0));
+    path->addPoint(config(-3.0f, 0));
+
+    Saba::TimeOptimalTrajectoryPtr traj(new Saba::TimeOptimalTrajectory(path));
+    BOOST_REQUIRE(traj->compute());
+
+    // triangular profile over the short way
+    float dist = 2.0f * (float)M_PI - 6.0f;
+    BOOST_CHECK_CLOSE(traj->getDuration(), 2.0f * sqrtf(dist / 2.0f), 1e-2f);
+
+    Eigen::VectorXf pos;
+    int steps = 100;
+
+    for (int i = 0; i <= steps; i++)
+    {
+        traj->getState(traj->getDuration() * (float)i / (float)steps, pos);
+        BOOST_CHECK_GE(fabs(pos[0]), 3.0f - 1e-4f);
+        BOOST_CHECK_LE(fabs(pos[0]), (float)M_PI + 1e-4f);
+    }
+
+    traj->getState(traj->getDuration(), pos);
+    BOOST_CHECK_SMALL((pos - path->getPoint(1)).norm(), 1e-3f);
+
+    // without borderless dimensions the long way is taken
+    cspace->checkForBorderlessDimensions(false);
+    BOOST_REQUIRE(traj->compute());
+    BOOST_CHECK_CLOSE(traj->getDuration(), 6.5f, 1e-2f);
+    checkTrajectory(traj, path);
+}
+
+BOOST_AUTO_TEST_CASE(testTimeOptimalTrajectoryPerformance)
+{
+    Saba::CSpaceSampledPtr cspace = createCSpace();
+    Saba::CSpacePathPtr path(new Saba::CSpacePath(cspace, "zigzag"));
+
+    for (int i = 0; i < 10000; i++)
+    {
+        path->addPoint(config((float)(i % 2) * 0.1f, (float)i * 1.0f));
+    }
+
+    Saba::TimeOptimalTrajectoryPtr traj(new Saba::TimeOptimalTrajectory(path));
+
+    boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::local_time();
+    BOOST_REQUIRE(traj->compute());
+    boost::posix_time::time_duration computeTime = boost::posix_time::microsec_clock::local_time() - startTime;
+
+    const int nrSamples = 1000000;
+    Eigen::VectorXf pos, vel;
+    float sum = 0;
+    startTime = boost::posix_time::microsec_clock::local_time();
+
+    for (int i = 0; i < nrSamples; i++)
+    {
+        traj->getState(traj->getDuration() * (float)i / (float)nrSamples, pos, &vel);
+        sum += pos[0];
+    }
+
+    boost::posix_time::time_duration sampleTime = boost::posix_time::microsec_clock::local_time() - startTime;
+
+    std::cout << "TimeOptimalTrajectory: " << path->getNrOfPoints() << " path points, " << traj->getNrOfPieces() << " pieces, duration " << traj->getDuration() << " s" << std::endl;
+    std::cout << "compute: " << computeTime.total_microseconds() / 1000.0 << " ms, getState: " << (double)sampleTime.total_microseconds() * 1000.0 / (double)nrSamples << " ns per sample (" << sum << ")" << std::endl;
+
+    BOOST_CHECK_GT(traj->getDuration(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,393 @@
+
+#include "AllowedCollisionMatrix.h"
+#include "CollisionChecker.h"
+#include "CollisionModel.h"
+#include "../Robot.h"
+#include "../Nodes/RobotNode.h"
+#include "../RuntimeEnvironment.h"
+#include "../VirtualRobotException.h"
+#include "../XML/BaseIO.h"
+#include "../XML/rapidxml.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+
+#include <boost/filesystem.hpp>
+
+using namespace std;
+
+namespace VirtualRobot
+{
+
+    AllowedCollisionMatrix::AllowedCollisionMatrix(const std::string& robotName)
+    {
+        this->robotName = robotName;
+    }
+
+    AllowedCollisionMatrix::~AllowedCollisionMatrix()
+    {
+    }
+
+    std::pair<std::string, std::string> AllowedCollisionMatrix::makeKey(const std::string& name1, const std::string& name2)
+    {
+        if (name2 < name1)
+        {
+            return std::make_pair(name2, name1);
+        }
+
+        return std::make_pair(name1, name2);
+    }
+
+    void AllowedCollisionMatrix::disablePair(const std::string& name1, const std::string& name2, Reason reason)
+    {
+        disabledPairs[makeKey(name1, name2)] = reason;
+    }
+
+    void AllowedCollisionMatrix::enablePair(const std::string& name1, const std::string& name2)
+    {
+        disabledPairs.erase(makeKey(name1, name2));
+    }
+
+    bool AllowedCollisionMatrix::isDisabled(const std::string& name1, const std::string& name2) const
+    {
+        return disabledPairs.find(makeKey(name1, name2)) != disabledPairs.end();
+    }
+
+    bool AllowedCollisionMatrix::isDisabled(SceneObjectPtr object1, SceneObjectPtr object2) const
+    {
+        RobotNodePtr node1 = boost::dynamic_pointer_cast<RobotNode>(object1);
+        RobotNodePtr node2 = boost::dynamic_pointer_cast<RobotNode>(object2);
+
+        if (!node1 || !node2)
+        {
+            return false;
+        }
+
+        RobotPtr robot = node1->getRobot();
+
+        if (!robot || robot != node2->getRobot() || (!robotName.empty() && robot->getName() != robotName))
+        {
+            return false;
+        }
+
+        return isDisabled(node1->getName(), node2->getName());
+    }
+
+    bool AllowedCollisionMatrix::getReason(const std::string& name1, const std::string& name2, Reason& storeReason) const
+    {
+        std::map< std::pair<std::string, std::string>, Reason >::const_iterator it = disabledPairs.find(makeKey(name1, name2));
+
+        if (it == disabledPairs.end())
+        {
+            return false;
+        }
+
+        storeReason = it->second;
+        return true;
+    }
+
+    std::vector< std::pair<std::string, std::string> > AllowedCollisionMatrix::getDisabledPairs() const
+    {
+        std::vector< std::pair<std::string, std::string> > result;
+        std::map< std::pair<std::string, std::string>, Reason >::const_iterator it = disabledPairs.begin();
+
+        while (it != disabledPairs.end())
+        {
+            result.push_back(it->first);
+            it++;
+        }
+
+        return result;
+    }
+
+    unsigned int AllowedCollisionMatrix::getNrOfDisabledPairs() const
+    {
+        return (unsigned int)disabledPairs.size();
+    }
+
+    void AllowedCollisionMatrix::clear()
+    {
+        disabledPairs.clear();
+    }
+
+    std::string AllowedCollisionMatrix::getRobotName() const
+    {
+        return robotName;
+    }
+
+    std::string AllowedCollisionMatrix::getReasonString(Reason r)
+    {
+        switch (r)
+        {
+            case eAdjacent:
+                return "adjacent";
+
+            case eNeverColliding:
+                return "never";
+
+            case eAlwaysColliding:
+                return "always";
+
+            default:
+                return "user";
+        }
+    }
+
+    void AllowedCollisionMatrix::print()
+    {
+        cout << "AllowedCollisionMatrix of robot " << robotName << ", " << disabledPairs.size() << " disabled pairs:" << endl;
+        std::map< std::pair<std::string, std::string>, Reason >::iterator it = disabledPairs.begin();
+
+        while (it != disabledPairs.end())
+        {
+            cout << " * " << it->first.first << " <-> " << it->first.second << " (" << getReasonString(it->second) << ")" << endl;
+            it++;
+        }
+    }
+
+    AllowedCollisionMatrixPtr AllowedCollisionMatrix::compute(RobotPtr robot, unsigned int nrSamples, float alwaysCollidingRatio, bool checkAdjacent)
+    {
+        THROW_VR_EXCEPTION_IF(!robot, "NULL robot");
+
+        AllowedCollisionMatrixPtr result(new AllowedCollisionMatrix(robot->getName()));
+        std::vector<RobotNodePtr> allNodes = robot->getRobotNodes();
+        std::vector<RobotNodePtr> nodes;
+        std::vector<RobotNodePtr> joints;
+        std::vector<float> originalValues;
+
+        for (size_t i = 0; i < allNodes.size(); i++)
+        {
+            if (allNodes[i]->getCollisionModel())
+            {
+                nodes.push_back(allNodes[i]);
+            }
+
+            if (allNodes[i]->isTranslationalJoint() || allNodes[i]->isRotationalJoint())
+            {
+                joints.push_back(allNodes[i]);
+                originalValues.push_back(allNodes[i]->getJointValue());
+            }
+        }
+
+        if (nodes.size() < 2)
+        {
+            return result;
+        }
+
+        // adjacent nodes: the next node with a collision model on the path to the root
+        if (checkAdjacent)
+        {
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                RobotNodePtr parent = boost::dynamic_pointer_cast<RobotNode>(nodes[i]->getParent());
+
+                while (parent)
+                {
+                    if (parent->getCollisionModel())
+                    {
+                        result->disablePair(nodes[i]->getName(), parent->getName(), eAdjacent);
+                        break;
+                    }
+
+                    parent = boost::dynamic_pointer_cast<RobotNode>(parent->getParent());
+                }
+            }
+        }
+
+        size_t n = nodes.size();
+        std::vector<unsigned int> collisions(n * n, 0);
+        std::vector<char> checkPair(n * n, 0);
+        std::vector<CollisionModelPtr> models(n);
+
+        for (size_t a = 0; a < n; a++)
+        {
+            models[a] = nodes[a]->getCollisionModel();
+
+            for (size_t b = a + 1; b < n; b++)
+            {
+                checkPair[a * n + b] = result->isDisabled(nodes[a]->getName(), nodes[b]->getName()) ? 0 : 1;
+            }
+        }
+
+        CollisionCheckerPtr colChecker = models[0]->getCollisionChecker();
+        std::vector<float> values(joints.size());
+
+        for (unsigned int s = 0; s < nrSamples; s++)
+        {
+            for (size_t j = 0; j < joints.size(); j++)
+            {
+                float lo = joints[j]->getJointLimitLo();
+                float hi = joints[j]->getJointLimitHi();
+                values[j] = lo + (hi - lo) * float(rand()) / float(RAND_MAX);
+            }
+
+            if (joints.size() > 0)
+            {
+                robot->setJointValues(joints, values);
+            }
+
+            for (size_t a = 0; a < n; a++)
+            {
+                for (size_t b = a + 1; b < n; b++)
+                {
+                    if (checkPair[a * n + b] && colChecker->checkCollision(models[a], models[b]))
+                    {
+                        collisions[a * n + b]++;
+                    }
+                }
+            }
+        }
+
+        if (joints.size() > 0)
+        {
+            robot->setJointValues(joints, originalValues);
+        }
+
+        for (size_t a = 0; a < n; a++)
+        {
+            for (size_t b = a + 1; b < n; b++)
+            {
+                if (!checkPair[a * n + b])
+                {
+                    continue;
+                }
+
+                if (collisions[a * n + b] == 0)
+                {
+                    result->disablePair(nodes[a]->getName(), nodes[b]->getName(), eNeverColliding);
+                }
+                else if (nrSamples > 0 && float(collisions[a * n + b]) >= alwaysCollidingRatio * float(nrSamples))
+                {
+                    result->disablePair(nodes[a]->getName(), nodes[b]->getName(), eAlwaysColliding);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    std::string AllowedCollisionMatrix::getDefaultFilename(RobotPtr robot)
+    {
+        THROW_VR_EXCEPTION_IF(!robot, "NULL robot");
+        boost::filesystem::path p(robot->getFilename());
+        THROW_VR_EXCEPTION_IF(p.empty(), "Robot " << robot->getName() << " was not loaded from a file");
+        p.replace_extension(".acm.xml");
+        return p.string();
+    }
+
+    std::string AllowedCollisionMatrix::toXML()
+    {
+        std::stringstream ss;
+        ss << "<?xml version='1.0' encoding='UTF-8'?>\n\n";
+        ss << "<AllowedCollisionMatrix Robot='" << robotName << "'>\n";
+        std::map< std::pair<std::string, std::string>, Reason >::iterator it = disabledPairs.begin();
+
+        while (it != disabledPairs.end())
+        {
+            ss << "\t<DisabledPair node1='" << it->first.first << "' node2='" << it->first.second << "' reason='" << getReasonString(it->second) << "'/>\n";
+            it++;
+        }
+
+        ss << "</AllowedCollisionMatrix>\n";
+        return ss.str();
+    }
+
+    bool AllowedCollisionMatrix::save(const std::string& filename)
+    {
+        return BaseIO::writeXMLFile(filename, toXML(), true);
+    }
+
+    AllowedCollisionMatrixPtr AllowedCollisionMatrix::load(const std::string& filename)
+    {
+        std::string fullFile = filename;
+
+        if (!RuntimeEnvironment::getDataFileAbsolute(fullFile))
+        {
+            VR_ERROR << "Could not open XML file:" << filename << endl;
+            return AllowedCollisionMatrixPtr();
+        }
+
+        std::ifstream in(fullFile.c_str());
+
+        if (!in.is_open())
+        {
+            VR_ERROR << "Could not open XML file:" << fullFile << endl;
+            return AllowedCollisionMatrixPtr();
+        }
+
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        std::string xmlString(buffer.str());
+        in.close();
+
+        // copy string content to char array
+        char* y = new char[xmlString.size() + 1];
+        strncpy(y, xmlString.c_str(), xmlString.size() + 1);
+
+        AllowedCollisionMatrixPtr result;
+
+        try
+        {
+            rapidxml::xml_document<char> doc;
+            doc.parse<0>(y);
+            rapidxml::xml_node<char>* acmXMLNode = doc.first_node("allowedcollisionmatrix", 0, false);
+            THROW_VR_EXCEPTION_IF(!acmXMLNode, "No <AllowedCollisionMatrix> tag in " << fullFile);
+
+            rapidxml::xml_attribute<>* attr = acmXMLNode->first_attribute("robot", 0, false);
+            result.reset(new AllowedCollisionMatrix(attr ? attr->value() : ""));
+
+            rapidxml::xml_node<char>* pairXMLNode = acmXMLNode->first_node("disabledpair", 0, false);
+
+            while (pairXMLNode)
+            {
+                std::string name1 = BaseIO::processStringAttribute("node1", pairXMLNode, true);
+                std::string name2 = BaseIO::processStringAttribute("node2", pairXMLNode, true);
+                THROW_VR_EXCEPTION_IF(name1.empty() || name2.empty(), "Expecting 'node1' and 'node2' attributes in <DisabledPair> tag");
+
+                Reason r = eUser;
+                attr = pairXMLNode->first_attribute("reason", 0, false);
+
+                if (attr)
+                {
+                    std::string reason = BaseIO::getLowerCase(attr->value());
+
+                    if (reason == "adjacent")
+                    {
+                        r = eAdjacent;
+                    }
+                    else if (reason == "never")
+                    {
+                        r = eNeverColliding;
+                    }
+                    else if (reason == "always")
+                    {
+                        r = eAlwaysColliding;
+                    }
+                }
+
+                result->disablePair(name1, name2, r);
+                pairXMLNode = pairXMLNode->next_sibling("disabledpair", 0, false);
+            }
+        }
+        catch (rapidxml::parse_error& e)
+        {
+            delete[] y;
+            THROW_VR_EXCEPTION("Could not parse data in xml definition" << endl
+                               << "Error message:" << e.what() << endl
+                               << "Position: " << endl << e.where<char>() << endl);
+            return AllowedCollisionMatrixPtr();
+        }
+        catch (VirtualRobot::VirtualRobotException&)
+        {
+            delete[] y;
+            throw;
+        }
+
+        delete[] y;
+        return result;
+    }
+
+} // namespace VirtualRobot
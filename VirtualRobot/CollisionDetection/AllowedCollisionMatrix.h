@@ -0,0 +1,121 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    VirtualRobot
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef _VirtualRobot_AllowedCollisionMatrix_h_
+#define _VirtualRobot_AllowedCollisionMatrix_h_
+
+#include "../VirtualRobotImportExport.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+
+namespace VirtualRobot
+{
+    /*!
+        A set of object pairs that do not need to be checked for collisions.
+
+        Pairs are identified by the names of the RobotNodes of one robot, the order of the names does not matter.
+        Typical disabled pairs are adjacent links (which are always in contact) or pairs of links that can never collide,
+        since they are out of reach across the whole joint range.
+        Such a matrix can be computed offline with compute() and stored next to the robot's XML file (\see getDefaultFilename()).
+        CDManager skips all disabled pairs when checking for collisions (\see CDManager::setAllowedCollisionMatrix()).
+    */
+    class VIRTUAL_ROBOT_IMPORT_EXPORT AllowedCollisionMatrix
+    {
+    public:
+        enum Reason
+        {
+            eUser,              //!< disabled manually
+            eAdjacent,          //!< the objects are connected by a joint
+            eNeverColliding,    //!< no collision was detected in any sampled configuration
+            eAlwaysColliding    //!< the objects collide in (nearly) all sampled configurations, e.g. overlapping models of a rigid body
+        };
+
+        AllowedCollisionMatrix(const std::string& robotName = "");
+        virtual ~AllowedCollisionMatrix();
+
+        /*!
+            Samples the configuration space of robot and disables all pairs of RobotNodes (with collision models) that are adjacent,
+            never collide or (nearly) always collide.
+            The joint values are set to random values within the joint limits, the original configuration is restored afterwards.
+            Since the analysis is based on sampling, a pair that only collides in a small region of the configuration space may be missed.
+            Hence a sufficiently large number of samples should be used.
+            \param robot The robot.
+            \param nrSamples The number of random configurations.
+            \param alwaysCollidingRatio Pairs that collide in at least this fraction of all samples are disabled.
+            \param checkAdjacent If set, adjacent nodes are disabled (i.e. a node and the next node with a collision model on the path to the root).
+        */
+        static AllowedCollisionMatrixPtr compute(RobotPtr robot, unsigned int nrSamples = 10000, float alwaysCollidingRatio = 0.95f, bool checkAdjacent = true);
+
+        /*!
+            The default location of the matrix of a robot: The robot's filename with the extension ".acm.xml" instead of ".xml".
+        */
+        static std::string getDefaultFilename(RobotPtr robot);
+
+        //! Loads a matrix from an XML file. Returns an empty pointer if the file cannot be opened, throws a VirtualRobotException if it cannot be parsed.
+        static AllowedCollisionMatrixPtr load(const std::string& filename);
+
+        //! Stores the matrix to an XML file.
+        bool save(const std::string& filename);
+
+        std::string toXML();
+
+        void disablePair(const std::string& name1, const std::string& name2, Reason reason = eUser);
+        void enablePair(const std::string& name1, const std::string& name2);
+
+        //! Returns true if the pair does not need to be checked.
+        bool isDisabled(const std::string& name1, const std::string& name2) const;
+
+        /*!
+            Returns true if both objects are RobotNodes of the same robot, the name of the robot matches (unless no robot name is set)
+            and the pair of node names is disabled. Other objects (e.g. obstacles that have the same name as a RobotNode) are never disabled.
+        */
+        bool isDisabled(SceneObjectPtr object1, SceneObjectPtr object2) const;
+
+        //! Returns true if the pair is disabled and stores the reason.
+        bool getReason(const std::string& name1, const std::string& name2, Reason& storeReason) const;
+
+        //! All disabled pairs.
+        std::vector< std::pair<std::string, std::string> > getDisabledPairs() const;
+
+        unsigned int getNrOfDisabledPairs() const;
+
+        void clear();
+
+        std::string getRobotName() const;
+
+        void print();
+
+        static std::string getReasonString(Reason r);
+
+    protected:
+        static std::pair<std::string, std::string> makeKey(const std::string& name1, const std::string& name2);
+
+        std::string robotName;
+        std::map< std::pair<std::string, std::string>, Reason > disabledPairs;
+    };
+
+} // namespace VirtualRobot
+
+#endif // _VirtualRobot_AllowedCollisionMatrix_h_
@@ -4,7 +4,9 @@
 #include <iostream>
 #include <set>
 #include <float.h>
+#include <algorithm>
 #include "../Robot.h"
+#include "../Nodes/RobotNode.h"
 
 
 using namespace std;
@@ -16,6 +18,8 @@ namespace VirtualRobot
 
     CDManager::CDManager(CollisionCheckerPtr colChecker)
     {
+        pairCacheValid = false;
+
         if (colChecker == NULL)
         {
             this->colChecker = VirtualRobot::CollisionChecker::getGlobalCollisionChecker();
@@ -77,7 +81,7 @@ namespace VirtualRobot
         {
             if (m != colModels[i])
             {
-                if (colChecker->checkCollision(colModels[i], m))
+                if (checkCollision(colModels[i], m))
                 {
                     return true;
                 }
@@ -88,6 +92,41 @@ namespace VirtualRobot
         return false;
     }
 
+    bool CDManager::checkCollision(SceneObjectSetPtr m1, SceneObjectSetPtr m2)
+    {
+        if (!allowedCollisionMatrix)
+        {
+            return colChecker->checkCollision(m1, m2);
+        }
+
+        for (unsigned int i = 0; i < m1->getSize(); i++)
+        {
+            SceneObjectPtr o1 = m1->getSceneObject(i);
+
+            if (!o1->getCollisionModel())
+            {
+                continue;
+            }
+
+            for (unsigned int j = 0; j < m2->getSize(); j++)
+            {
+                SceneObjectPtr o2 = m2->getSceneObject(j);
+
+                if (!o2->getCollisionModel() || allowedCollisionMatrix->isDisabled(o1, o2))
+                {
+                    continue;
+                }
+
+                if (colChecker->checkCollision(o1->getCollisionModel(), o2->getCollisionModel()))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
 
     float CDManager::getDistance(SceneObjectSetPtr m)
     {
@@ -274,7 +313,7 @@ namespace VirtualRobot
     {
         for (size_t i = 0; i < sets.size(); i++)
         {
-            if (colChecker->checkCollision(m, sets[i]))
+            if (checkCollision(m, sets[i]))
             {
                 return true;
             }
@@ -290,21 +329,175 @@ namespace VirtualRobot
             return false;
         }
 
-        std::map<SceneObjectSetPtr, std::vector<SceneObjectSetPtr>  >::iterator i = colModelPairs.begin();
+        updatePairCache();
 
-        while (i != colModelPairs.end())
+        for (size_t i = 0; i < pairCache.size(); i++)
         {
-            if (isInCollision(i->first, i->second))
+            CollisionModelPtr m1 = pairCache[i].object1->getCollisionModel();
+            CollisionModelPtr m2 = pairCache[i].object2->getCollisionModel();
+
+            if (!m1 || !m2 || !colChecker->checkCollision(m1, m2))
             {
-                return true;
+                continue;
             }
 
-            i++;
+            // move the pair towards the front, so that frequently colliding pairs are checked first
+            pairCache[i].nrCollisions++;
+
+            while (i > 0 && pairCache[i - 1].nrCollisions < pairCache[i].nrCollisions)
+            {
+                std::swap(pairCache[i - 1], pairCache[i]);
+                i--;
+            }
+
+            return true;
         }
 
         return false;
     }
 
+    void CDManager::updatePairCache()
+    {
+        if (pairCacheValid)
+        {
+            // check if the objects of the sets have been changed
+            for (size_t i = 0; i < pairCacheSets.size() && pairCacheValid; i++)
+            {
+                SceneObjectSetPtr set = pairCacheSets[i].first;
+                const std::vector<SceneObjectPtr>& objects = pairCacheSets[i].second;
+
+                if (set->getSize() != objects.size())
+                {
+                    pairCacheValid = false;
+                    break;
+                }
+
+                for (unsigned int j = 0; j < objects.size(); j++)
+                {
+                    if (set->getSceneObject(j) != objects[j])
+                    {
+                        pairCacheValid = false;
+                        break;
+                    }
+                }
+            }
+
+            if (pairCacheValid)
+            {
+                return;
+            }
+        }
+
+        // keep the statistics of pairs that are still present
+        std::map< std::pair<SceneObject*, SceneObject*>, unsigned int > statistics;
+
+        for (size_t i = 0; i < pairCache.size(); i++)
+        {
+            statistics[std::make_pair(pairCache[i].object1.get(), pairCache[i].object2.get())] = pairCache[i].nrCollisions;
+        }
+
+        pairCache.clear();
+        pairCacheSets.clear();
+        std::set< std::pair<SceneObject*, SceneObject*> > added;
+        std::set<SceneObjectSetPtr> sets;
+        std::map<SceneObjectSetPtr, std::vector<SceneObjectSetPtr>  >::iterator it = colModelPairs.begin();
+
+        while (it != colModelPairs.end())
+        {
+            SceneObjectSetPtr m1 = it->first;
+            sets.insert(m1);
+
+            for (size_t k = 0; k < it->second.size(); k++)
+            {
+                SceneObjectSetPtr m2 = it->second[k];
+                sets.insert(m2);
+
+                for (unsigned int i = 0; i < m1->getSize(); i++)
+                {
+                    for (unsigned int j = 0; j < m2->getSize(); j++)
+                    {
+                        ObjectPair p;
+                        p.object1 = m1->getSceneObject(i);
+                        p.object2 = m2->getSceneObject(j);
+
+                        // pairs may be covered by multiple sets
+                        std::pair<SceneObject*, SceneObject*> key(std::min(p.object1.get(), p.object2.get()), std::max(p.object1.get(), p.object2.get()));
+
+                        if (added.find(key) != added.end())
+                        {
+                            continue;
+                        }
+
+                        added.insert(key);
+
+                        if (allowedCollisionMatrix && allowedCollisionMatrix->isDisabled(p.object1, p.object2))
+                        {
+                            continue;
+                        }
+
+                        std::map< std::pair<SceneObject*, SceneObject*>, unsigned int >::iterator s = statistics.find(std::make_pair(p.object1.get(), p.object2.get()));
+                        p.nrCollisions = (s != statistics.end()) ? s->second : 0;
+                        pairCache.push_back(p);
+                    }
+                }
+            }
+
+            it++;
+        }
+
+        // stable: pairs without statistics are checked in the order they have been added
+        for (size_t i = 1; i < pairCache.size(); i++)
+        {
+            size_t j = i;
+
+            while (j > 0 && pairCache[j - 1].nrCollisions < pairCache[j].nrCollisions)
+            {
+                std::swap(pairCache[j - 1], pairCache[j]);
+                j--;
+            }
+        }
+
+        std::set<SceneObjectSetPtr>::iterator si = sets.begin();
+
+        while (si != sets.end())
+        {
+            pairCacheSets.push_back(std::make_pair(*si, (*si)->getSceneObjects()));
+            si++;
+        }
+
+        pairCacheValid = true;
+    }
+
+    void CDManager::invalidatePairCache()
+    {
+        pairCacheValid = false;
+    }
+
+    unsigned int CDManager::getNrOfCheckedPairs()
+    {
+        updatePairCache();
+        return (unsigned int)pairCache.size();
+    }
+
+    void CDManager::resetCollisionStatistics()
+    {
+        for (size_t i = 0; i < pairCache.size(); i++)
+        {
+            pairCache[i].nrCollisions = 0;
+        }
+    }
+
+    void CDManager::setAllowedCollisionMatrix(AllowedCollisionMatrixPtr acm)
+    {
+        allowedCollisionMatrix = acm;
+        pairCacheValid = false;
+    }
+
+    AllowedCollisionMatrixPtr CDManager::getAllowedCollisionMatrix()
+    {
+        return allowedCollisionMatrix;
+    }
+
 
     std::vector<SceneObjectSetPtr> CDManager::getSceneObjectSets()
     {
@@ -316,6 +509,92 @@ namespace VirtualRobot
         return colChecker;
     }
 
+    CDManagerPtr CDManager::clone(CollisionCheckerPtr newColChecker, std::map<RobotPtr, RobotPtr>& robotMapping)
+    {
+        CDManagerPtr result(new CDManager(newColChecker));
+
+        // all sets (sets with single objects may be used in colModelPairs without being part of colModels)
+        std::vector<SceneObjectSetPtr> allSets = colModels;
+        std::map<SceneObjectSetPtr, std::vector<SceneObjectSetPtr> >::iterator it = colModelPairs.begin();
+
+        while (it != colModelPairs.end())
+        {
+            allSets.push_back(it->first);
+            allSets.insert(allSets.end(), it->second.begin(), it->second.end());
+            it++;
+        }
+
+        // objects may be part of multiple sets, so we clone each object only once
+        std::map<SceneObjectPtr, SceneObjectPtr> objectMapping;
+        std::map<SceneObjectSetPtr, SceneObjectSetPtr> setMapping;
+
+        for (size_t i = 0; i < allSets.size(); i++)
+        {
+            SceneObjectSetPtr set = allSets[i];
+
+            if (setMapping.find(set) != setMapping.end())
+            {
+                continue;
+            }
+
+            SceneObjectSetPtr newSet(new SceneObjectSet(set->getName(), result->colChecker));
+
+            for (unsigned int j = 0; j < set->getSize(); j++)
+            {
+                SceneObjectPtr so = set->getSceneObject(j);
+
+                if (objectMapping.find(so) == objectMapping.end())
+                {
+                    SceneObjectPtr newSo;
+                    RobotNodePtr rn = boost::dynamic_pointer_cast<RobotNode>(so);
+
+                    if (rn)
+                    {
+                        RobotPtr r = rn->getRobot();
+                        THROW_VR_EXCEPTION_IF(!r, "RobotNode " << rn->getName() << " is not linked to a robot");
+
+                        if (robotMapping.find(r) == robotMapping.end())
+                        {
+                            robotMapping[r] = r->clone(r->getName(), result->colChecker);
+                        }
+
+                        newSo = robotMapping[r]->getRobotNode(rn->getName());
+                    }
+                    else
+                    {
+                        newSo = so->clone(so->getName(), result->colChecker);
+                    }
+
+                    THROW_VR_EXCEPTION_IF(!newSo, "Could not clone " << so->getName());
+                    objectMapping[so] = newSo;
+                }
+
+                newSet->addSceneObject(objectMapping[so]);
+            }
+
+            setMapping[set] = newSet;
+        }
+
+        for (size_t i = 0; i < colModels.size(); i++)
+        {
+            result->colModels.push_back(setMapping[colModels[i]]);
+        }
+
+        for (it = colModelPairs.begin(); it != colModelPairs.end(); it++)
+        {
+            std::vector<SceneObjectSetPtr>& sets = result->colModelPairs[setMapping[it->first]];
+
+            for (size_t i = 0; i < it->second.size(); i++)
+            {
+                sets.push_back(setMapping[it->second[i]]);
+            }
+        }
+
+        result->allowedCollisionMatrix = allowedCollisionMatrix;
+
+        return result;
+    }
+
     bool CDManager::hasSceneObjectSet(SceneObjectSetPtr m)
     {
         for (size_t i = 0; i < colModels.size(); i++)
@@ -378,6 +657,7 @@ namespace VirtualRobot
         }
 
         colModelPairs[m1].push_back(m2);
+        pairCacheValid = false;
     }
 
     void CDManager::addCollisionModelPair(SceneObjectPtr m1, SceneObjectSetPtr m2)
@@ -31,6 +31,7 @@
 #include "CollisionModel.h"
 #include "../SceneObjectSet.h"
 #include "CollisionChecker.h"
+#include "AllowedCollisionMatrix.h"
 
 #include <vector>
 #include <set>
@@ -50,6 +51,13 @@ namespace VirtualRobot
     *
     * The methods can be safely mixed.
     *
+    * isInCollision() checks the collision models pair by pair. Pairs that are disabled in an AllowedCollisionMatrix
+    * are skipped (\see setAllowedCollisionMatrix()) and pairs that collided more often in previous queries are checked first.
+    * Hence, the CDManager is not thread safe, use clone() to set up independent instances for parallel collision checking.
+    *
+    * The getDistance() methods use the distance cache and the distance tolerance of the collision checker, which should be enabled
+    * when the distances are queried repeatedly with small changes of the poses (\see CollisionChecker::enableDistanceCache()).
+    *
     * @see CollsionModelSet
     */
     class VIRTUAL_ROBOT_IMPORT_EXPORT CDManager
@@ -118,8 +126,40 @@ namespace VirtualRobot
         //! All SceneObjectSets that have been added.
         std::vector<SceneObjectSetPtr> getSceneObjectSets();
 
+        /*!
+            Pairs of SceneObjects that are disabled in acm are not checked by isInCollision().
+            Distance calculations are not affected.
+            Pass an empty pointer in order to check all pairs.
+        */
+        void setAllowedCollisionMatrix(AllowedCollisionMatrixPtr acm);
+        AllowedCollisionMatrixPtr getAllowedCollisionMatrix();
+
+        /*!
+            The object pairs that are checked by isInCollision() are created on first use and updated automatically
+            when SceneObjectSets are added or the objects of an added set change.
+            Call this method if the AllowedCollisionMatrix has been modified after it was set.
+        */
+        void invalidatePairCache();
+
+        //! The number of object pairs that are checked by isInCollision() (disabled pairs are not counted).
+        unsigned int getNrOfCheckedPairs();
+
+        //! Forget how often the pairs collided.
+        void resetCollisionStatistics();
+
         CollisionCheckerPtr getCollisionChecker();
 
+        /*!
+            Creates a deep copy of this collision manager that is linked to newColChecker.
+            This can be used to set up independent collision detection contexts, e.g. for parallel collision checking.
+            RobotNodes are replaced by the corresponding nodes (same name) of the cloned robots, as specified in robotMapping.
+            Robots that are not covered by robotMapping are cloned and the new clones are added to robotMapping.
+            All other SceneObjects are cloned and linked to newColChecker.
+            \param newColChecker The collision checker of the new collision manager. All robots in robotMapping must be linked to it.
+            \param robotMapping Maps original robots to their clones.
+        */
+        CDManagerPtr clone(CollisionCheckerPtr newColChecker, std::map<RobotPtr, RobotPtr>& robotMapping);
+
     protected:
         /*!
             Performs also a check for sets with only one object added in order to cover potentionally added single SceneObjects.
@@ -134,6 +174,24 @@ namespace VirtualRobot
 
         std::map<SceneObjectSetPtr, std::vector<SceneObjectSetPtr> > colModelPairs;
 
+        //! Checks all objects of m1 against all objects of m2, skips disabled pairs.
+        bool checkCollision(SceneObjectSetPtr m1, SceneObjectSetPtr m2);
+
+        struct ObjectPair
+        {
+            SceneObjectPtr object1;
+            SceneObjectPtr object2;
+            unsigned int nrCollisions;
+        };
+
+        //! Creates the pair cache if needed.
+        void updatePairCache();
+
+        std::vector<ObjectPair> pairCache;                                      //!< ordered by nrCollisions (descending)
+        std::vector< std::pair<SceneObjectSetPtr, std::vector<SceneObjectPtr> > > pairCacheSets; //!< the sets and their objects, the cache was built of
+        bool pairCacheValid;
+
+        AllowedCollisionMatrixPtr allowedCollisionMatrix;
     };
 
 }
@@ -381,6 +381,27 @@ namespace VirtualRobot
         collisionCheckerImplementation->setAutomaticSizeCheck(automaticSizeCheck);
     }
 
+    void CollisionChecker::enableDistanceCache(bool enable)
+    {
+        collisionCheckerImplementation->enableDistanceCache(enable);
+    }
+
+    bool CollisionChecker::isDistanceCacheEnabled()
+    {
+        return collisionCheckerImplementation->isDistanceCacheEnabled();
+    }
+
+    void CollisionChecker::clearDistanceCache()
+    {
+        collisionCheckerImplementation->clearDistanceCache();
+    }
+
+    void CollisionChecker::setDistanceTolerance(float relError, float absError)
+    {
+        THROW_VR_EXCEPTION_IF(relError < 0 || absError < 0, "Negative distance tolerance");
+        collisionCheckerImplementation->setDistanceTolerance(relError, absError);
+    }
+
     /*
     bool CollisionChecker::checkCollision( SbXfBox3f& box1, SbXfBox3f& box2 )
     {
@@ -116,6 +116,27 @@ namespace VirtualRobot
         */
         void setAutomaticSizeCheck(bool checkSizeOnColModelCreation);
 
+        /*!
+            Enables a cache that accelerates repeated distance queries of the same pairs of collision models, e.g. in planners or
+            potential field controllers where the models only move slightly between two queries. The closest triangles of each pair are
+            stored and the next query of this pair is started with them, so most of the bounding volume hierarchies can be pruned.
+            The cache is used by all calculateDistance() methods and hence by CDManager::getDistance(). The results are not affected.
+            Like the collision checker itself, the cache is not thread safe. (Standard: false)
+        */
+        void enableDistanceCache(bool enable);
+        bool isDistanceCacheEnabled();
+
+        //! Removes all entries of the distance cache.
+        void clearDistanceCache();
+
+        /*!
+            Allows approximated distances, which lets the distance calculations stop early.
+            The reported distance d satisfies d <= (1 + relError) * dExact and d <= dExact + absError,
+            a value of zero disables the corresponding bound. If both values are zero (standard), the exact distance is calculated.
+            The reported points and triangle IDs correspond to d.
+        */
+        void setDistanceTolerance(float relError, float absError);
+
         void enableDebugOutput(bool e)
         {
             debugOutput = e;
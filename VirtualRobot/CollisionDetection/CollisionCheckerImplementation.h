@@ -43,6 +43,9 @@ namespace VirtualRobot
         {
             automaticSizeCheck = true;
             debugOutput = false;
+            distanceCacheEnabled = false;
+            distanceRelError = 0.0f;
+            distanceAbsError = 0.0f;
         }
         virtual ~CollisionCheckerImplementation() {}
 
@@ -59,10 +62,32 @@ namespace VirtualRobot
             debugOutput = e;
         }
 
+        virtual void enableDistanceCache(bool enable)
+        {
+            distanceCacheEnabled = enable;
+        }
+
+        bool isDistanceCacheEnabled()
+        {
+            return distanceCacheEnabled;
+        }
+
+        virtual void clearDistanceCache() {}
+
+        virtual void setDistanceTolerance(float relError, float absError)
+        {
+            distanceRelError = relError;
+            distanceAbsError = absError;
+        }
+
         bool debugOutput;
 
     protected:
         bool automaticSizeCheck;
+
+        bool distanceCacheEnabled;
+        float distanceRelError;
+        float distanceAbsError;
     };
 
 } // namespace
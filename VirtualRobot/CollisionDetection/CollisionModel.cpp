@@ -36,6 +36,43 @@ namespace VirtualRobot
     }
 
 
+#if defined(VR_COLLISION_DETECTION_PQP)
+    CollisionModel::CollisionModel(const CollisionModel& source, const VisualizationNodePtr visu, CollisionCheckerPtr colChecker)
+    {
+        globalPose = Eigen::Matrix4f::Identity();
+        id = source.id;
+        name = source.name;
+
+        this->colChecker = colChecker;
+
+        if (!this->colChecker)
+        {
+            this->colChecker = CollisionChecker::getGlobalCollisionChecker();
+        }
+
+        updateVisualization = true;
+        visualization = visu;
+
+        // the triangle data can be accessed (and modified) via getTriMeshModel(), hence each model gets its own copy
+        if (source.model)
+        {
+            model = source.model->clone();
+        }
+
+        bbox = source.bbox;
+
+        if (source.collisionModelImplementation)
+        {
+            collisionModelImplementation.reset(new CollisionModelPQP(*source.collisionModelImplementation, model, this->colChecker));
+        }
+        else
+        {
+            collisionModelImplementation.reset(new CollisionModelPQP(model, this->colChecker, id));
+        }
+    }
+#endif
+
+
     CollisionModel::~CollisionModel()
     {
         destroyData();
@@ -79,7 +116,20 @@ namespace VirtualRobot
         std::string nameNew = name;
         int idNew = id;
 
-        CollisionModelPtr p(new CollisionModel(visuNew, nameNew, colChecker, idNew));
+        CollisionModelPtr p;
+
+#if defined(VR_COLLISION_DETECTION_PQP)
+
+        if (scaling == 1.0f)
+        {
+            p.reset(new CollisionModel(*this, visuNew, colChecker));
+        }
+        else
+#endif
+        {
+            p.reset(new CollisionModel(visuNew, nameNew, colChecker, idNew));
+        }
+
         p->setGlobalPose(getGlobalPose());
         p->setUpdateVisualization(getUpdateVisualizationStatus());
         return p;
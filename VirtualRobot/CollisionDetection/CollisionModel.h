@@ -105,6 +105,12 @@ namespace VirtualRobot
 #endif
 
 
+        /*!
+            Clones this model. If the model is not scaled, the collision data structures are not rebuilt,
+            but shared with the clone (they are not modified by collision queries). The TriMeshModel is copied.
+            \param colChecker The collision checker of the clone. If not set, the global collision checker is used.
+            \param scaling Scale the model (the collision data structures are rebuilt).
+        */
         CollisionModelPtr clone(CollisionCheckerPtr colChecker = CollisionCheckerPtr(), float scaling = 1.0f);
 
         void setVisualization(const VisualizationNodePtr visu);
@@ -159,6 +165,10 @@ namespace VirtualRobot
         virtual void scale(Eigen::Vector3f& scaleFactor);
 
     protected:
+#if defined(VR_COLLISION_DETECTION_PQP)
+        //! Creates a model with the visualization visu, that shares the triangle data and the collision data structures of source.
+        CollisionModel(const CollisionModel& source, const VisualizationNodePtr visu, CollisionCheckerPtr colChecker);
+#endif
 
         //! delete all data
         void destroyData();
@@ -52,6 +52,7 @@ namespace VirtualRobot
         {
             this->modelData = modelData;
             this->id = id;
+            globalPose.setIdentity();
         };
 
         /*!Standard Destructor
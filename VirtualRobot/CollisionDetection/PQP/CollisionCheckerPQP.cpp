@@ -8,6 +8,8 @@
 #include "PQP.h"
 #include "../../VirtualRobotException.h"
 
+#include <cfloat>
+
 namespace VirtualRobot
 {
 
@@ -228,11 +230,76 @@ namespace VirtualRobot
         PQP::PQP_REAL Translation2[3];
         __convEigen2Ar(matrix1, Rotation1, Translation1);
         __convEigen2Ar(matrix2, Rotation2, Translation2);
+
+        // PQP guarantees both error bounds, so a bound that is not set must be large
+        PQP::PQP_REAL relError = 0;
+        PQP::PQP_REAL absError = 0;
+
+        if (distanceRelError > 0 || distanceAbsError > 0)
+        {
+            relError = distanceRelError > 0 ? distanceRelError : FLT_MAX;
+            absError = distanceAbsError > 0 ? distanceAbsError : FLT_MAX;
+        }
+
+        std::map< ModelPair, std::pair<int, int> >::iterator cached = distanceCache.end();
+
+        if (distanceCacheEnabled)
+        {
+            cached = distanceCache.find(ModelPair(model1.get(), model2.get()));
+
+            // the entry may be outdated if a model was deleted and another one was created at the same address, so check the range
+            if (cached != distanceCache.end() && cached->second.first < model1->num_tris && cached->second.second < model2->num_tris)
+            {
+                model1->last_tri = model1->tris + cached->second.first;
+                model2->last_tri = model2->tris + cached->second.second;
+            }
+        }
+
         pqpChecker->PQP_Distance(&pqpResult,
                                  Rotation1, Translation1, model1.get(),
                                  Rotation2, Translation2, model2.get(),
-                                 0, 0); // default: 0 error
+                                 relError, absError); // default: 0 error
+
+        if (distanceCacheEnabled)
+        {
+            std::pair<int, int> closestTris((int)(model1->last_tri - model1->tris), (int)(model2->last_tri - model2->tris));
+
+            if (cached != distanceCache.end())
+            {
+                cached->second = closestTris;
+            }
+            else
+            {
+                if (distanceCache.size() >= maxDistanceCacheSize)
+                {
+                    distanceCache.clear();
+                }
+
+                distanceCache[ModelPair(model1.get(), model2.get())] = closestTris;
+            }
+        }
     }
+
+    void CollisionCheckerPQP::enableDistanceCache(bool enable)
+    {
+        CollisionCheckerImplementation::enableDistanceCache(enable);
+
+        if (!enable)
+        {
+            clearDistanceCache();
+        }
+    }
+
+    void CollisionCheckerPQP::clearDistanceCache()
+    {
+        distanceCache.clear();
+    }
+
+    unsigned int CollisionCheckerPQP::getDistanceCacheSize()
+    {
+        return (unsigned int)distanceCache.size();
+    }
+
     /*
     void CollisionCheckerPQP::PQP2Transform(PQP::PQP_REAL R[3][3], PQP::PQP_REAL T[3], Transform &t)
     {
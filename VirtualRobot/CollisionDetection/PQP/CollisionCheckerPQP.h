@@ -30,6 +30,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 
 #include "PQP++/PQP_Compile.h"
 #include "PQP++/PQP.h"
@@ -66,6 +67,18 @@ namespace VirtualRobot
 
         void GetPQPDistance(const boost::shared_ptr<PQP::PQP_Model>& model1, const boost::shared_ptr<PQP::PQP_Model>& model2, const Eigen::Matrix4f& matrix1, const Eigen::Matrix4f& matrix2, PQP::PQP_DistanceResult& pqpResult);
 
+        /*!
+            PQP starts each distance query with the distance of the closest triangles of the last query (PQP_Model::last_tri), which is a tight
+            upper bound when the models moved only slightly. Since last_tri is stored per model, it is worthless when a model is queried against
+            several other models in turn. The distance cache stores the closest triangles per pair of models, so that each query of a pair
+            is warm-started with the result of the last query of this pair. The results are not affected.
+        */
+        virtual void enableDistanceCache(bool enable);
+        virtual void clearDistanceCache();
+
+        //! The number of model pairs in the distance cache.
+        unsigned int getDistanceCacheSize();
+
 
         /*!
         Does the underlying collision detection library support discrete collision detection.
@@ -111,6 +124,12 @@ namespace VirtualRobot
 
     protected:
         PQP::PQP_Checker* pqpChecker;
+
+        //! The cache is cleared when it exceeds this size, which limits the memory spent for pairs of models that are not used any more.
+        static const unsigned int maxDistanceCacheSize = 100000;
+
+        typedef std::pair<const PQP::PQP_Model*, const PQP::PQP_Model*> ModelPair;
+        std::map< ModelPair, std::pair<int, int> > distanceCache; // indices of the closest triangles of the last query
     };
 
 } // namespace
@@ -5,8 +5,337 @@
 #include "CollisionCheckerPQP.h"
 #include "../../Visualization/TriMeshModel.h"
 
+#include <map>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 namespace VirtualRobot
 {
+    namespace
+    {
+        //! Identifies the triangle data of a model: number of triangles, triangle id and two independent hashes of the vertices.
+        struct SharedModelKey
+        {
+            int nrTris;
+            int id;
+            boost::uint64_t hash;
+            boost::uint64_t digest;
+
+            bool operator<(const SharedModelKey& rhs) const
+            {
+                if (nrTris != rhs.nrTris)
+                {
+                    return nrTris < rhs.nrTris;
+                }
+
+                if (id != rhs.id)
+                {
+                    return id < rhs.id;
+                }
+
+                if (hash != rhs.hash)
+                {
+                    return hash < rhs.hash;
+                }
+
+                return digest < rhs.digest;
+            }
+        };
+
+        typedef std::map< SharedModelKey, boost::weak_ptr<PQP::PQP_Model> > SharedModelMap;
+
+        SharedModelMap sharedModels;
+        boost::mutex sharedModelsMutex;
+        // guarded by sharedModelsMutex
+        bool triangleValidation = false;
+
+        // FNV-1a
+        inline void hashValue(boost::uint64_t& hash, const PQP::PQP_REAL& v)
+        {
+            unsigned char bytes[sizeof(PQP::PQP_REAL)];
+            memcpy(bytes, &v, sizeof(PQP::PQP_REAL));
+
+            for (size_t i = 0; i < sizeof(PQP::PQP_REAL); i++)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        // splitmix64 finalizer, chained over the values (independent of the FNV-1a hash)
+        inline void digestValue(boost::uint64_t& digest, const PQP::PQP_REAL& v)
+        {
+            boost::uint64_t x = 0;
+            memcpy(&x, &v, sizeof(PQP::PQP_REAL));
+            x += digest + 0x9E3779B97F4A7C15ULL;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+            digest = x ^ (x >> 31);
+        }
+
+        //! The vertices of a triangle, compared bytewise.
+        struct TriangleData
+        {
+            PQP::PQP_REAL v[9];
+
+            bool operator<(const TriangleData& rhs) const
+            {
+                return memcmp(v, rhs.v, sizeof(v)) < 0;
+            }
+        };
+
+        //! The triangles of modelData as they are passed to PQP, sorted.
+        std::vector<TriangleData> getSortedTriangles(TriMeshModelPtr modelData)
+        {
+            std::vector<TriangleData> result(modelData->faces.size());
+
+            for (size_t i = 0; i < modelData->faces.size(); i++)
+            {
+                const unsigned int ids[3] = { modelData->faces[i].id1, modelData->faces[i].id2, modelData->faces[i].id3 };
+
+                for (int k = 0; k < 3; k++)
+                {
+                    for (int j = 0; j < 3; j++)
+                    {
+                        result[i].v[k * 3 + j] = modelData->vertices[ids[k]][j];
+                    }
+                }
+            }
+
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        /*!
+            Checks if the (reordered) triangles of the processed model m are exactly the given triangles.
+            Only used when the triangle validation is enabled (\see CollisionModelPQP::setTriangleValidation()).
+        */
+        bool hasTriangles(const PQP::PQP_Model& m, const std::vector<TriangleData>& sortedTriangles, int id)
+        {
+            if (m.num_tris != (int)sortedTriangles.size())
+            {
+                return false;
+            }
+
+            std::vector<TriangleData> tris(m.num_tris);
+
+            for (int i = 0; i < m.num_tris; i++)
+            {
+                if (m.tris[i].id != id)
+                {
+                    return false;
+                }
+
+                for (int j = 0; j < 3; j++)
+                {
+                    tris[i].v[j] = m.tris[i].p1[j];
+                    tris[i].v[3 + j] = m.tris[i].p2[j];
+                    tris[i].v[6 + j] = m.tris[i].p3[j];
+                }
+            }
+
+            std::sort(tris.begin(), tris.end());
+            return tris.empty() || memcmp(&tris[0], &sortedTriangles[0], tris.size() * sizeof(TriangleData)) == 0;
+        }
+
+        // guarded by sharedModelsMutex
+        std::string cacheDirectory;
+        bool cacheDirectoryInitialized = false;
+
+        /*
+            Cache file layout:
+            magic (8 bytes), version, sizeof(Tri), sizeof(BV), PQP_BV_TYPE (uint32 each),
+            number of faces, id (int32 each), hash, digest (uint64 each), number of triangles, number of BVs (int32 each),
+            offset of the triangles, offset of the BVs (uint64 each),
+            followed by the aligned triangle and BV arrays of the processed PQP_Model.
+        */
+        const char cacheMagic[8] = { 'V', 'R', 'P', 'Q', 'P', 'B', 'V', 'H' };
+        const boost::uint32_t cacheVersion = 2;
+        const boost::uint64_t cacheHeaderSize = 128;
+        // the key part of the header that has to match exactly
+        const size_t cacheKeySize = 48;
+        const boost::uint64_t cacheAlignment = 64;
+
+        inline boost::uint64_t alignCacheOffset(boost::uint64_t offset)
+        {
+            return (offset + cacheAlignment - 1) / cacheAlignment * cacheAlignment;
+        }
+
+        void writeCacheKey(unsigned char* header, const SharedModelKey& key)
+        {
+            boost::uint32_t v[4] = { cacheVersion, (boost::uint32_t)sizeof(PQP::Tri), (boost::uint32_t)sizeof(PQP::BV), (boost::uint32_t)(PQP_BV_TYPE) };
+            boost::int32_t k[2] = { key.nrTris, key.id };
+            memcpy(header, cacheMagic, 8);
+            memcpy(header + 8, v, 16);
+            memcpy(header + 24, k, 8);
+            memcpy(header + 32, &key.hash, 8);
+            memcpy(header + 40, &key.digest, 8);
+        }
+
+        std::string getCacheFilename(const std::string& directory, const SharedModelKey& key)
+        {
+            std::stringstream ss;
+            ss << std::hex << std::setw(16) << std::setfill('0') << key.hash << std::dec << "_" << key.nrTris << "_" << key.id << ".pqp";
+            return (boost::filesystem::path(directory) / ss.str()).string();
+        }
+
+        //! A PQP model that references the data of a memory mapped cache file.
+        class MappedPQPModel : public PQP::PQP_Model
+        {
+        public:
+            MappedPQPModel(const std::string& filename)
+                : mapping(filename.c_str(), boost::interprocess::read_only),
+                  region(mapping, boost::interprocess::read_only)
+            {
+            }
+
+            boost::interprocess::file_mapping mapping;
+            boost::interprocess::mapped_region region;
+        };
+
+        //! Returns an empty pointer if there is no valid cache file for key.
+        boost::shared_ptr<PQP::PQP_Model> loadCachedModel(const std::string& filename, const SharedModelKey& key)
+        {
+            boost::system::error_code ec;
+
+            if (!boost::filesystem::exists(filename, ec))
+            {
+                return boost::shared_ptr<PQP::PQP_Model>();
+            }
+
+            boost::shared_ptr<MappedPQPModel> m;
+
+            try
+            {
+                m.reset(new MappedPQPModel(filename));
+            }
+            catch (const std::exception& e)
+            {
+                VR_WARNING << "Could not map file " << filename << ": " << e.what() << endl;
+                return boost::shared_ptr<PQP::PQP_Model>();
+            }
+
+            unsigned char* data = static_cast<unsigned char*>(m->region.get_address());
+            boost::uint64_t size = (boost::uint64_t)m->region.get_size();
+
+            if (size < cacheHeaderSize)
+            {
+                return boost::shared_ptr<PQP::PQP_Model>();
+            }
+
+            unsigned char expected[cacheKeySize];
+            writeCacheKey(expected, key);
+
+            if (memcmp(data, expected, cacheKeySize) != 0)
+            {
+                return boost::shared_ptr<PQP::PQP_Model>();
+            }
+
+            boost::int32_t numTris, numBVs;
+            boost::uint64_t trisOffset, bvsOffset;
+            memcpy(&numTris, data + 48, 4);
+            memcpy(&numBVs, data + 52, 4);
+            memcpy(&trisOffset, data + 56, 8);
+            memcpy(&bvsOffset, data + 64, 8);
+
+            if (numTris <= 0 || numBVs <= 0 || trisOffset % cacheAlignment != 0 || bvsOffset % cacheAlignment != 0
+                || trisOffset < cacheHeaderSize || trisOffset + (boost::uint64_t)numTris * sizeof(PQP::Tri) > bvsOffset
+                || bvsOffset + (boost::uint64_t)numBVs * sizeof(PQP::BV) > size)
+            {
+                return boost::shared_ptr<PQP::PQP_Model>();
+            }
+
+            // the hierarchy is traversed without any checks: children are stored behind their parent (which also excludes cycles), leafs reference a triangle
+            const PQP::BV* bvs = reinterpret_cast<const PQP::BV*>(data + bvsOffset);
+
+            for (boost::int32_t i = 0; i < numBVs; i++)
+            {
+                int child = bvs[i].first_child;
+
+                if ((child >= 0 && (child <= i || child >= numBVs - 1)) || (child < 0 && -(boost::int64_t)child - 1 >= numTris))
+                {
+                    VR_WARNING << "Invalid bounding volume hierarchy in " << filename << ", rebuilding..." << endl;
+                    return boost::shared_ptr<PQP::PQP_Model>();
+                }
+            }
+
+            if (m->ReferenceData(reinterpret_cast<PQP::Tri*>(data + trisOffset), numTris, reinterpret_cast<PQP::BV*>(data + bvsOffset), numBVs) != PQP::PQP_OK)
+            {
+                return boost::shared_ptr<PQP::PQP_Model>();
+            }
+
+            return m;
+        }
+
+        //! Writes to a temporary file, which is renamed afterwards, so that concurrent processes never see partial files.
+        bool saveCachedModel(const std::string& filename, const SharedModelKey& key, const PQP::PQP_Model& m)
+        {
+            boost::system::error_code ec;
+            boost::filesystem::path target(filename);
+            boost::filesystem::path tmp = target.parent_path() / boost::filesystem::unique_path("%%%%-%%%%-%%%%-%%%%.tmp", ec);
+
+            if (ec)
+            {
+                return false;
+            }
+
+            unsigned char header[cacheHeaderSize];
+            memset(header, 0, cacheHeaderSize);
+            writeCacheKey(header, key);
+            boost::int32_t numTris = m.num_tris;
+            boost::int32_t numBVs = m.num_bvs;
+            boost::uint64_t trisOffset = alignCacheOffset(cacheHeaderSize);
+            boost::uint64_t bvsOffset = alignCacheOffset(trisOffset + (boost::uint64_t)numTris * sizeof(PQP::Tri));
+            memcpy(header + 48, &numTris, 4);
+            memcpy(header + 52, &numBVs, 4);
+            memcpy(header + 56, &trisOffset, 8);
+            memcpy(header + 64, &bvsOffset, 8);
+
+            const char padding[cacheAlignment] = { 0 };
+            std::ofstream out(tmp.string().c_str(), std::ios::out | std::ios::binary);
+
+            if (!out.is_open())
+            {
+                VR_WARNING << "Could not write BVH cache file " << tmp.string() << endl;
+                return false;
+            }
+
+            out.write(reinterpret_cast<const char*>(header), cacheHeaderSize);
+            out.write(padding, trisOffset - cacheHeaderSize);
+            out.write(reinterpret_cast<const char*>(m.tris), (std::streamsize)numTris * sizeof(PQP::Tri));
+            out.write(padding, bvsOffset - (trisOffset + (boost::uint64_t)numTris * sizeof(PQP::Tri)));
+            out.write(reinterpret_cast<const char*>(m.b), (std::streamsize)numBVs * sizeof(PQP::BV));
+            out.close();
+
+            if (out.fail())
+            {
+                boost::filesystem::remove(tmp, ec);
+                return false;
+            }
+
+            boost::filesystem::rename(tmp, target, ec);
+
+            if (ec)
+            {
+                // e.g. the target is currently mapped by another process (Windows)
+                boost::filesystem::remove(tmp, ec);
+                return false;
+            }
+
+            return true;
+        }
+    }
 
     CollisionModelPQP::CollisionModelPQP(TriMeshModelPtr modelData, CollisionCheckerPtr colChecker, int id)
         : CollisionModelImplementation(modelData, colChecker, id)
@@ -28,6 +357,33 @@ namespace VirtualRobot
         createPQPModel();
     }
 
+    CollisionModelPQP::CollisionModelPQP(const CollisionModelPQP& source, TriMeshModelPtr modelData, CollisionCheckerPtr colChecker)
+        : CollisionModelImplementation(modelData, colChecker, source.id)
+    {
+        if (!colChecker)
+        {
+            colChecker = CollisionChecker::getGlobalCollisionChecker();
+        }
+
+        if (!colChecker)
+        {
+            VR_WARNING << "no col checker..." << endl;
+        }
+        else
+        {
+            colCheckerPQP = colChecker->getCollisionCheckerImplementation();
+        }
+
+        globalPose = source.globalPose;
+        pqpModelData = source.pqpModelData;
+
+        if (pqpModelData)
+        {
+            pqpModel.reset(new PQP::PQP_Model());
+            pqpModel->ShareModel(pqpModelData.get());
+        }
+    }
+
 
     CollisionModelPQP::~CollisionModelPQP()
     {
@@ -38,6 +394,7 @@ namespace VirtualRobot
     void CollisionModelPQP::destroyData()
     {
         pqpModel.reset();
+        pqpModelData.reset();
     }
 
     void CollisionModelPQP::createPQPModel()
@@ -47,28 +404,225 @@ namespace VirtualRobot
             return;
         }
 
-        PQP::PQP_REAL a[3];
-        PQP::PQP_REAL b[3];
-        PQP::PQP_REAL c[3];
-
+        pqpModelData = getSharedModel();
         pqpModel.reset(new PQP::PQP_Model());
-        pqpModel->BeginModel();
+        pqpModel->ShareModel(pqpModelData.get());
+    }
+
+    boost::shared_ptr<PQP::PQP_Model> CollisionModelPQP::getSharedModel()
+    {
+        SharedModelKey key;
+        key.nrTris = (int)modelData->faces.size();
+        key.id = id;
+        key.hash = 14695981039346656037ULL;
+        key.digest = 0;
 
         for (unsigned int i = 0; i < modelData->faces.size(); i++)
         {
-            a[0] = modelData->vertices[modelData->faces[i].id1][0];
-            a[1] = modelData->vertices[modelData->faces[i].id1][1];
-            a[2] = modelData->vertices[modelData->faces[i].id1][2];
-            b[0] = modelData->vertices[modelData->faces[i].id2][0];
-            b[1] = modelData->vertices[modelData->faces[i].id2][1];
-            b[2] = modelData->vertices[modelData->faces[i].id2][2];
-            c[0] = modelData->vertices[modelData->faces[i].id3][0];
-            c[1] = modelData->vertices[modelData->faces[i].id3][1];
-            c[2] = modelData->vertices[modelData->faces[i].id3][2];
-            pqpModel->AddTri(a, b, c, this->id);
+            const unsigned int ids[3] = { modelData->faces[i].id1, modelData->faces[i].id2, modelData->faces[i].id3 };
+
+            for (int k = 0; k < 3; k++)
+            {
+                for (int j = 0; j < 3; j++)
+                {
+                    hashValue(key.hash, modelData->vertices[ids[k]][j]);
+                    digestValue(key.digest, modelData->vertices[ids[k]][j]);
+                }
+            }
+        }
+
+        // only needed to validate existing data
+        std::vector<TriangleData> sortedTriangles;
+        boost::shared_ptr<PQP::PQP_Model> m;
+        bool validate;
+
+        {
+            boost::mutex::scoped_lock lock(sharedModelsMutex);
+            validate = triangleValidation;
+            SharedModelMap::iterator it = sharedModels.find(key);
+
+            if (it != sharedModels.end())
+            {
+                m = it->second.lock();
+            }
+        }
+
+        if (m)
+        {
+            if (!validate)
+            {
+                return m;
+            }
+
+            sortedTriangles = getSortedTriangles(modelData);
+
+            if (hasTriangles(*m, sortedTriangles, id))
+            {
+                return m;
+            }
+
+            VR_WARNING << "Registered model with the same key has different triangles, building a separate model..." << endl;
+            m.reset();
+        }
+
+        // load or build the model without holding the lock
+        std::string cacheFile;
+        std::string directory = getCacheDirectory();
+
+        if (!directory.empty())
+        {
+            cacheFile = getCacheFilename(directory, key);
+            m = loadCachedModel(cacheFile, key);
+
+            if (m && validate)
+            {
+                if (sortedTriangles.empty())
+                {
+                    sortedTriangles = getSortedTriangles(modelData);
+                }
+
+                if (!hasTriangles(*m, sortedTriangles, id))
+                {
+                    VR_WARNING << "Triangles in " << cacheFile << " do not match the mesh, rebuilding..." << endl;
+                    m.reset();
+                }
+            }
+        }
+
+        if (!m)
+        {
+            PQP::PQP_REAL a[3];
+            PQP::PQP_REAL b[3];
+            PQP::PQP_REAL c[3];
+
+            m.reset(new PQP::PQP_Model());
+            m->BeginModel();
+
+            for (unsigned int i = 0; i < modelData->faces.size(); i++)
+            {
+                a[0] = modelData->vertices[modelData->faces[i].id1][0];
+                a[1] = modelData->vertices[modelData->faces[i].id1][1];
+                a[2] = modelData->vertices[modelData->faces[i].id1][2];
+                b[0] = modelData->vertices[modelData->faces[i].id2][0];
+                b[1] = modelData->vertices[modelData->faces[i].id2][1];
+                b[2] = modelData->vertices[modelData->faces[i].id2][2];
+                c[0] = modelData->vertices[modelData->faces[i].id3][0];
+                c[1] = modelData->vertices[modelData->faces[i].id3][1];
+                c[2] = modelData->vertices[modelData->faces[i].id3][2];
+                m->AddTri(a, b, c, this->id);
+            }
+
+            if (m->EndModel() == PQP::PQP_OK && !cacheFile.empty())
+            {
+                saveCachedModel(cacheFile, key, *m);
+            }
+        }
+
+        boost::mutex::scoped_lock lock(sharedModelsMutex);
+        boost::shared_ptr<PQP::PQP_Model> registered = sharedModels[key].lock();
+
+        if (registered)
+        {
+            lock.unlock();
+
+            if (!validate)
+            {
+                // another thread built the same data in the meantime
+                return registered;
+            }
+
+            if (sortedTriangles.empty())
+            {
+                sortedTriangles = getSortedTriangles(modelData);
+            }
+
+            // another thread built the same data in the meantime, or the hash collides and m is not registered
+            return hasTriangles(*registered, sortedTriangles, id) ? registered : m;
+        }
+
+        sharedModels[key] = m;
+
+        // remove entries of models that are not used any more
+        SharedModelMap::iterator it = sharedModels.begin();
+
+        while (it != sharedModels.end())
+        {
+            if (it->second.expired())
+            {
+                sharedModels.erase(it++);
+            }
+            else
+            {
+                it++;
+            }
+        }
+
+        return m;
+    }
+
+    unsigned int CollisionModelPQP::getNrOfSharedModels()
+    {
+        boost::mutex::scoped_lock lock(sharedModelsMutex);
+        unsigned int result = 0;
+
+        for (SharedModelMap::iterator it = sharedModels.begin(); it != sharedModels.end(); it++)
+        {
+            if (!it->second.expired())
+            {
+                result++;
+            }
+        }
+
+        return result;
+    }
+
+    void CollisionModelPQP::setCacheDirectory(const std::string& directory)
+    {
+        if (!directory.empty())
+        {
+            boost::system::error_code ec;
+            boost::filesystem::create_directories(directory, ec);
+
+            if (ec)
+            {
+                VR_WARNING << "Could not create BVH cache directory " << directory << ": " << ec.message() << endl;
+            }
+        }
+
+        boost::mutex::scoped_lock lock(sharedModelsMutex);
+        cacheDirectory = directory;
+        cacheDirectoryInitialized = true;
+    }
+
+    void CollisionModelPQP::setTriangleValidation(bool enable)
+    {
+        boost::mutex::scoped_lock lock(sharedModelsMutex);
+        triangleValidation = enable;
+    }
+
+    bool CollisionModelPQP::getTriangleValidation()
+    {
+        boost::mutex::scoped_lock lock(sharedModelsMutex);
+        return triangleValidation;
+    }
+
+    std::string CollisionModelPQP::getCacheDirectory()
+    {
+        boost::mutex::scoped_lock lock(sharedModelsMutex);
+
+        if (!cacheDirectoryInitialized)
+        {
+            char* directory = getenv("VIRTUAL_ROBOT_BVH_CACHE");
+
+            if (directory)
+            {
+                cacheDirectory = directory;
+            }
+
+            cacheDirectoryInitialized = true;
         }
 
-        pqpModel->EndModel();
+        return cacheDirectory;
     }
 
     void CollisionModelPQP::print()
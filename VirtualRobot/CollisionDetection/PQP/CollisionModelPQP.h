@@ -43,6 +43,16 @@ namespace VirtualRobot
 
     /*!
         A PQP related implementation of a collision model.
+
+        The triangles and the bounding volume hierarchy are immutable once they are built. Hence they are shared by all models
+        with identical triangle data (e.g. clones of a robot): Models are registered by two independent 64 bit hashes of their
+        (scaled) triangle data and a new model reuses the data of an existing model with the same key instead of building the hierarchy again.
+        Optionally, the triangles are compared bytewise before the data is shared (\see setTriangleValidation()).
+        Each model owns a lightweight PQP_Model that references the shared data and holds the per-instance query state.
+
+        Optionally, the hierarchies can be stored in a cache directory (\see setCacheDirectory()). Cached files are keyed by the
+        hashes of the triangle data and are memory mapped on load, so a hierarchy is only built again when the mesh has changed.
+        The header and the indices of the hierarchy are checked before a cached file is used.
     */
     class VIRTUAL_ROBOT_IMPORT_EXPORT CollisionModelPQP : public CollisionModelImplementation
     {
@@ -54,6 +64,12 @@ namespace VirtualRobot
         */
         CollisionModelPQP(TriMeshModelPtr modelData, CollisionCheckerPtr colChecker, int id);
 
+        /*!
+            Creates a model that shares the triangle data and the bounding volume hierarchy of source.
+            \param modelData The triangle data of the new model, has to be equal to the data of source (e.g. a copy).
+        */
+        CollisionModelPQP(const CollisionModelPQP& source, TriMeshModelPtr modelData, CollisionCheckerPtr colChecker);
+
         /*!Standard Destructor
         */
         virtual ~CollisionModelPQP();
@@ -63,6 +79,32 @@ namespace VirtualRobot
             return pqpModel;
         }
 
+        //! The data that is shared with all models with the same triangle data.
+        boost::shared_ptr<const PQP::PQP_Model> getSharedPQPModel() const
+        {
+            return pqpModelData;
+        }
+
+        //! Number of distinct triangle data sets that are currently registered (for testing / statistics).
+        static unsigned int getNrOfSharedModels();
+
+        /*!
+            Sets the directory in which the bounding volume hierarchies are stored. The directory is created if needed.
+            An empty string disables the cache. By default, the environment variable VIRTUAL_ROBOT_BVH_CACHE is used if set,
+            otherwise the cache is disabled.
+            Files that do not fit the current mesh or PQP build (e.g. a different BV type) are ignored and overwritten.
+        */
+        static void setCacheDirectory(const std::string& directory);
+        static std::string getCacheDirectory();
+
+        /*!
+            Enables the bytewise comparison of the triangles before registered or cached data is shared (disabled by default).
+            Without validation, data is shared when the number of triangles, the id and both hashes of the triangle data match.
+            This is meant for debugging, e.g. to detect cache files that were modified after they have been written.
+        */
+        static void setTriangleValidation(bool enable);
+        static bool getTriangleValidation();
+
         virtual void print();
 
     protected:
@@ -71,7 +113,11 @@ namespace VirtualRobot
         virtual void destroyData();
         void createPQPModel();
 
-        boost::shared_ptr<PQP::PQP_Model> pqpModel;
+        //! Builds the shared PQP model of modelData or returns the registered model with the same content.
+        boost::shared_ptr<PQP::PQP_Model> getSharedModel();
+
+        boost::shared_ptr<PQP::PQP_Model> pqpModel;     // per-instance view on pqpModelData
+        boost::shared_ptr<PQP::PQP_Model> pqpModelData; // shared, must not be modified
 
         boost::shared_ptr<CollisionCheckerPQP> colCheckerPQP;
     };
@@ -399,6 +399,35 @@ namespace PQP
 #endif
     }
 
+    int
+    BV_Processor::BV_Overlap_Batch(int n, PQP_REAL R[][3][3], PQP_REAL T[][3], BV* b1[], BV* b2[])
+    {
+#if PQP_BV_TYPE & OBB_TYPE
+        PQP_REAL* a[PQP_MAX_BATCH];
+        PQP_REAL* b[PQP_MAX_BATCH];
+
+        for (int i = 0; i < n; i++)
+        {
+            a[i] = b1[i]->d;
+            b[i] = b2[i]->d;
+        }
+
+        return o.obb_overlap_batch(n, R, T, a, b);
+#else
+        int mask = 0;
+
+        for (int i = 0; i < n; i++)
+        {
+            if (BV_Overlap(R[i], T[i], b1[i], b2[i]))
+            {
+                mask |= (1 << i);
+            }
+        }
+
+        return mask;
+#endif
+    }
+
 #if PQP_BV_TYPE & RSS_TYPE
     PQP_REAL
     BV_Processor::BV_Distance(PQP_REAL R[3][3], PQP_REAL T[3], BV* b1, BV* b2)
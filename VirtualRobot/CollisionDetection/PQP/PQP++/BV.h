@@ -100,6 +100,11 @@ namespace PQP
         int
         BV_Overlap(PQP_REAL R[3][3], PQP_REAL T[3], BV* b1, BV* b2);
 
+        // Tests n (at most PQP_MAX_BATCH) BV pairs at once, returns a bit mask
+        // of the overlapping pairs (bit i is set if b1[i] and b2[i] overlap).
+        int
+        BV_Overlap_Batch(int n, PQP_REAL R[][3][3], PQP_REAL T[][3], BV* b1[], BV* b2[]);
+
 #if PQP_BV_TYPE & RSS_TYPE
         PQP_REAL
         BV_Distance(PQP_REAL R[3][3], PQP_REAL T[3], BV* b1, BV* b2);
@@ -44,6 +44,10 @@
 #include "MatVec.h"
 #include "PQP_Compile.h"
 
+#ifdef PQP_USE_SSE
+#include <xmmintrin.h>
+#endif
+
 namespace PQP
 {
 
@@ -283,8 +287,149 @@ namespace PQP
 
             return 0;  // should equal 0
         }
+
+        // int
+        // obb_overlap_batch(int n, PQP_REAL B[][3][3], PQP_REAL T[][3], PQP_REAL* a[], PQP_REAL* b[]);
+        //
+        // Performs n (at most PQP_MAX_BATCH) box tests at once, box pair i is
+        // given by B[i], T[i], a[i] and b[i] as in obb_disjoint().  Returns a
+        // bit mask, bit i is set if the boxes of pair i overlap.  The results
+        // are identical to the ones of obb_disjoint().
+        inline
+        int
+        obb_overlap_batch(int n, PQP_REAL B[][3][3], PQP_REAL T[][3], PQP_REAL* a[], PQP_REAL* b[])
+        {
+#ifdef PQP_USE_SSE
+            // the boxes are processed in SoA layout, one box pair per lane.
+            // Unused lanes are filled with the first pair and masked out.
+            float Bs[3][3][4], Ts[3][4], as[3][4], bs[3][4];
+
+            for (int k = 0; k < 4; k++)
+            {
+                int l = (k < n) ? k : 0;
+
+                for (int i = 0; i < 3; i++)
+                {
+                    Bs[i][0][k] = B[l][i][0];
+                    Bs[i][1][k] = B[l][i][1];
+                    Bs[i][2][k] = B[l][i][2];
+                    Ts[i][k] = T[l][i];
+                    as[i][k] = a[l][i];
+                    bs[i][k] = b[l][i];
+                }
+            }
+
+            const __m128 signMask = _mm_set1_ps(-0.0f);
+            const __m128 reps = _mm_set1_ps(1e-6f);
+            __m128 Bv[3][3], Bf[3][3], Tv[3], av[3], bv[3];
+
+            for (int i = 0; i < 3; i++)
+            {
+                for (int j = 0; j < 3; j++)
+                {
+                    Bv[i][j] = _mm_loadu_ps(Bs[i][j]);
+                    Bf[i][j] = _mm_add_ps(_mm_andnot_ps(signMask, Bv[i][j]), reps);
+                }
+
+                Tv[i] = _mm_loadu_ps(Ts[i]);
+                av[i] = _mm_loadu_ps(as[i]);
+                bv[i] = _mm_loadu_ps(bs[i]);
+            }
+
+            // a lane is separated if t <= r does not hold (same semantics as the scalar test, incl. NaNs)
+            __m128 sep, s, t, r;
+
+            // A0, A1, A2
+            t = _mm_andnot_ps(signMask, Tv[0]);
+            r = _mm_add_ps(_mm_add_ps(_mm_add_ps(av[0], _mm_mul_ps(bv[0], Bf[0][0])), _mm_mul_ps(bv[1], Bf[0][1])), _mm_mul_ps(bv[2], Bf[0][2]));
+            sep = _mm_cmpnle_ps(t, r);
+            t = _mm_andnot_ps(signMask, Tv[1]);
+            r = _mm_add_ps(_mm_add_ps(_mm_add_ps(av[1], _mm_mul_ps(bv[0], Bf[1][0])), _mm_mul_ps(bv[1], Bf[1][1])), _mm_mul_ps(bv[2], Bf[1][2]));
+            sep = _mm_or_ps(sep, _mm_cmpnle_ps(t, r));
+            t = _mm_andnot_ps(signMask, Tv[2]);
+            r = _mm_add_ps(_mm_add_ps(_mm_add_ps(av[2], _mm_mul_ps(bv[0], Bf[2][0])), _mm_mul_ps(bv[1], Bf[2][1])), _mm_mul_ps(bv[2], Bf[2][2]));
+            sep = _mm_or_ps(sep, _mm_cmpnle_ps(t, r));
+
+            if (_mm_movemask_ps(sep) == 0xF)
+            {
+                return 0;
+            }
+
+            // B0, B1, B2
+            for (int j = 0; j < 3; j++)
+            {
+                s = _mm_add_ps(_mm_add_ps(_mm_mul_ps(Tv[0], Bv[0][j]), _mm_mul_ps(Tv[1], Bv[1][j])), _mm_mul_ps(Tv[2], Bv[2][j]));
+                t = _mm_andnot_ps(signMask, s);
+                r = _mm_add_ps(_mm_add_ps(_mm_add_ps(bv[j], _mm_mul_ps(av[0], Bf[0][j])), _mm_mul_ps(av[1], Bf[1][j])), _mm_mul_ps(av[2], Bf[2][j]));
+                sep = _mm_or_ps(sep, _mm_cmpnle_ps(t, r));
+            }
+
+            if (_mm_movemask_ps(sep) == 0xF)
+            {
+                return 0;
+            }
+
+            // Ai x Bj, j1 and j2 are the remaining axes of B
+            static const int o1[3] = { 1, 0, 0 };
+            static const int o2[3] = { 2, 2, 1 };
+
+            for (int i = 0; i < 3; i++)
+            {
+                for (int j = 0; j < 3; j++)
+                {
+                    int j1 = o1[j], j2 = o2[j];
+
+                    // same evaluation order as in obb_disjoint
+                    switch (i)
+                    {
+                        case 0:
+                            s = _mm_sub_ps(_mm_mul_ps(Tv[2], Bv[1][j]), _mm_mul_ps(Tv[1], Bv[2][j]));
+                            r = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(av[1], Bf[2][j]), _mm_mul_ps(av[2], Bf[1][j])), _mm_mul_ps(bv[j1], Bf[0][j2])), _mm_mul_ps(bv[j2], Bf[0][j1]));
+                            break;
+
+                        case 1:
+                            s = _mm_sub_ps(_mm_mul_ps(Tv[0], Bv[2][j]), _mm_mul_ps(Tv[2], Bv[0][j]));
+                            r = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(av[0], Bf[2][j]), _mm_mul_ps(av[2], Bf[0][j])), _mm_mul_ps(bv[j1], Bf[1][j2])), _mm_mul_ps(bv[j2], Bf[1][j1]));
+                            break;
+
+                        default:
+                            s = _mm_sub_ps(_mm_mul_ps(Tv[1], Bv[0][j]), _mm_mul_ps(Tv[0], Bv[1][j]));
+                            r = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(av[0], Bf[1][j]), _mm_mul_ps(av[1], Bf[0][j])), _mm_mul_ps(bv[j1], Bf[2][j2])), _mm_mul_ps(bv[j2], Bf[2][j1]));
+                            break;
+                    }
+
+                    t = _mm_andnot_ps(signMask, s);
+                    sep = _mm_or_ps(sep, _mm_cmpnle_ps(t, r));
+                }
+
+                if (_mm_movemask_ps(sep) == 0xF)
+                {
+                    return 0;
+                }
+            }
+
+            return (~_mm_movemask_ps(sep)) & ((1 << n) - 1);
+#else
+            int mask = 0;
+
+            for (int i = 0; i < n; i++)
+            {
+                if (obb_disjoint(B[i], T[i], a[i], b[i]) == 0)
+                {
+                    mask |= (1 << i);
+                }
+            }
+
+            return mask;
+#endif
+        }
     };
 
+#ifdef PQP_USE_SSE
+    // the SSE implementation requires single precision
+    typedef char PQP_SSE_requires_float_precision[(sizeof(PQP_REAL) == sizeof(float)) ? 1 : -1];
+#endif
+
 } // namespace
 #endif
 
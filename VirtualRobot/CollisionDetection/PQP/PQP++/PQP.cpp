@@ -75,11 +75,18 @@ namespace PQP
 
         last_tri = 0;
 
+        owns_data = true;
+
         build_state = PQP_BUILD_STATE_EMPTY;
     }
 
     PQP_Model::~PQP_Model()
     {
+        if (!owns_data)
+        {
+            return;
+        }
+
         if (b != NULL)
         {
             delete [] b;
@@ -98,9 +105,15 @@ namespace PQP
 
         if (build_state != PQP_BUILD_STATE_EMPTY)
         {
-            delete [] b;
-            delete [] tris;
+            if (owns_data)
+            {
+                delete [] b;
+                delete [] tris;
+            }
 
+            b = 0;
+            tris = 0;
+            owns_data = true;
             num_tris = num_bvs = num_tris_alloced = num_bvs_alloced = 0;
         }
 
@@ -261,6 +274,42 @@ namespace PQP
         return PQP_OK;
     }
 
+    int
+    PQP_Model::ShareModel(const PQP_Model* source)
+    {
+        if (!source || source->build_state != PQP_BUILD_STATE_PROCESSED)
+        {
+            return PQP_ERR_UNPROCESSED_MODEL;
+        }
+
+        return ReferenceData(source->tris, source->num_tris, source->b, source->num_bvs);
+    }
+
+    int
+    PQP_Model::ReferenceData(Tri* tris, int num_tris, BV* b, int num_bvs)
+    {
+        if (!tris || !b || num_tris <= 0 || num_bvs <= 0)
+        {
+            return PQP_ERR_UNPROCESSED_MODEL;
+        }
+
+        if (owns_data)
+        {
+            delete [] this->b;
+            delete [] this->tris;
+        }
+
+        this->tris = tris;
+        this->num_tris = this->num_tris_alloced = num_tris;
+        this->b = b;
+        this->num_bvs = this->num_bvs_alloced = num_bvs;
+        last_tri = tris;
+        owns_data = false;
+        build_state = PQP_BUILD_STATE_PROCESSED;
+
+        return PQP_OK;
+    }
+
     int
     PQP_Model::MemUsage(int msg)
     {
@@ -620,17 +669,7 @@ namespace PQP
                                 PQP_Model* o1, int b1,
                                 PQP_Model* o2, int b2, int flag)
     {
-        // first thing, see if we're overlapping
-
-        res->num_bv_tests++;
-        BV_Processor p;
-
-        if (!p.BV_Overlap(R, T, o1->child(b1), o2->child(b2)))
-        {
-            return;
-        }
-
-        // if we are, see if we test triangles next
+        // b1 and b2 are known to overlap, see if we test triangles next
 
         int l1 = o1->child(b1)->Leaf();
         int l2 = o2->child(b2)->Leaf();
@@ -677,66 +716,91 @@ namespace PQP
             return;
         }
 
-        // we dont, so decide whose children to visit next
+        // we dont, so decide whose children to visit next.  If both BVs are
+        // of similar size, the children of both are visited, resulting in
+        // four BV pairs that are tested in one batch.
 
         PQP_REAL sz1 = o1->child(b1)->GetSize();
         PQP_REAL sz2 = o2->child(b2)->GetSize();
 
-        PQP_REAL Rc[3][3], Tc[3], Ttemp[3];
+        int visit1 = l2 || (!l1 && (sz1 > sz2));
+        int visit2 = !visit1;
 
-        if (l2 || (!l1 && (sz1 > sz2)))
+        if (!l1 && !l2 && (sz1 < 2 * sz2) && (sz2 < 2 * sz1))
         {
-            int c1 = o1->child(b1)->first_child;
-            int c2 = c1 + 1;
+            visit1 = visit2 = 1;
+        }
+
+        // the BV pairs of the next level, b2's children relative to b1's children
+
+        PQP_REAL Rc[PQP_MAX_BATCH][3][3], Tc[PQP_MAX_BATCH][3], Rb[3][3], Tb[3], Ttemp[3];
+        BV* bv1[PQP_MAX_BATCH];
+        BV* bv2[PQP_MAX_BATCH];
+        int c1[PQP_MAX_BATCH], c2[PQP_MAX_BATCH];
+        int n = 0;
 
-            pqp_math.MTxM(Rc, o1->child(c1)->R, R);
+        int first2 = visit2 ? o2->child(b2)->first_child : b2;
+        int num2 = visit2 ? 2 : 1;
+        int first1 = visit1 ? o1->child(b1)->first_child : b1;
+        int num1 = visit1 ? 2 : 1;
+
+        for (int j = first2; j < first2 + num2; j++)
+        {
+            if (visit2)
+            {
+                pqp_math.MxM(Rb, R, o2->child(j)->R);
 #if PQP_BV_TYPE & OBB_TYPE
-            pqp_math.VmV(Ttemp, T, o1->child(c1)->To);
+                pqp_math.MxVpV(Tb, R, o2->child(j)->To, T);
 #else
-            pqp_math.VmV(Ttemp, T, o1->child(c1)->Tr);
+                pqp_math.MxVpV(Tb, R, o2->child(j)->Tr, T);
 #endif
-            pqp_math.MTxV(Tc, o1->child(c1)->R, Ttemp);
-            CollideRecurse(res, Rc, Tc, o1, c1, o2, b2, flag);
-
-            if ((flag == PQP_FIRST_CONTACT) && (res->num_pairs > 0))
+            }
+            else
             {
-                return;
+                pqp_math.McM(Rb, R);
+                pqp_math.VcV(Tb, T);
             }
 
-            pqp_math.MTxM(Rc, o1->child(c2)->R, R);
+            for (int i = first1; i < first1 + num1; i++)
+            {
+                if (visit1)
+                {
+                    pqp_math.MTxM(Rc[n], o1->child(i)->R, Rb);
 #if PQP_BV_TYPE & OBB_TYPE
-            pqp_math.VmV(Ttemp, T, o1->child(c2)->To);
+                    pqp_math.VmV(Ttemp, Tb, o1->child(i)->To);
 #else
-            pqp_math.VmV(Ttemp, T, o1->child(c2)->Tr);
+                    pqp_math.VmV(Ttemp, Tb, o1->child(i)->Tr);
 #endif
-            pqp_math.MTxV(Tc, o1->child(c2)->R, Ttemp);
-            CollideRecurse(res, Rc, Tc, o1, c2, o2, b2, flag);
+                    pqp_math.MTxV(Tc[n], o1->child(i)->R, Ttemp);
+                }
+                else
+                {
+                    pqp_math.McM(Rc[n], Rb);
+                    pqp_math.VcV(Tc[n], Tb);
+                }
+
+                c1[n] = i;
+                c2[n] = j;
+                bv1[n] = o1->child(i);
+                bv2[n] = o2->child(j);
+                n++;
+            }
         }
-        else
-        {
-            int c1 = o2->child(b2)->first_child;
-            int c2 = c1 + 1;
 
-            pqp_math.MxM(Rc, R, o2->child(c1)->R);
-#if PQP_BV_TYPE & OBB_TYPE
-            pqp_math.MxVpV(Tc, R, o2->child(c1)->To, T);
-#else
-            pqp_math.MxVpV(Tc, R, o2->child(c1)->Tr, T);
-#endif
-            CollideRecurse(res, Rc, Tc, o1, b1, o2, c1, flag);
+        res->num_bv_tests += n;
+        int overlap = bvProcessor.BV_Overlap_Batch(n, Rc, Tc, bv1, bv2);
 
-            if ((flag == PQP_FIRST_CONTACT) && (res->num_pairs > 0))
+        for (int k = 0; k < n; k++)
+        {
+            if (overlap & (1 << k))
             {
-                return;
-            }
+                CollideRecurse(res, Rc[k], Tc[k], o1, c1[k], o2, c2[k], flag);
 
-            pqp_math.MxM(Rc, R, o2->child(c2)->R);
-#if PQP_BV_TYPE & OBB_TYPE
-            pqp_math.MxVpV(Tc, R, o2->child(c2)->To, T);
-#else
-            pqp_math.MxVpV(Tc, R, o2->child(c2)->Tr, T);
-#endif
-            CollideRecurse(res, Rc, Tc, o1, b1, o2, c2, flag);
+                if ((flag == PQP_FIRST_CONTACT) && (res->num_pairs > 0))
+                {
+                    return;
+                }
+            }
         }
     }
 
@@ -798,7 +862,12 @@ namespace PQP
 
         // now start with both top level BVs
 
-        CollideRecurse(res, R, T, o1, 0, o2, 0, flag);
+        res->num_bv_tests++;
+
+        if (bvProcessor.BV_Overlap(R, T, o1->child(0), o2->child(0)))
+        {
+            CollideRecurse(res, R, T, o1, 0, o2, 0, flag);
+        }
 
         double t2 = ti.GetTime();
         res->query_time_secs = t2 - t1;
@@ -105,6 +105,25 @@ namespace PQP
 
 #define PQP_BV_TYPE  RSS_TYPE | OBB_TYPE
 
+    //-------------------------------------------------------------------------
+    //
+    // PQP_USE_SSE
+    //
+    // During collision queries, the children of a BV pair are tested in
+    // batches: the transformations of all child pairs are computed first,
+    // then all overlap tests are evaluated at once.  On x86, the batched
+    // tests are evaluated with SSE instructions, 4 BV pairs per instruction.
+    // Define PQP_NO_SSE to use the scalar implementation instead.  The SSE
+    // path requires PQP_REAL to be float.
+    //
+    //-------------------------------------------------------------------------
+
+#if !defined(PQP_NO_SSE) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define PQP_USE_SSE
+#endif
+
+#define PQP_MAX_BATCH 4
+
 } // namespace
 
 #endif
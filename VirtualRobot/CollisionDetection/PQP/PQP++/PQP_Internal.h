@@ -62,6 +62,8 @@ namespace PQP
 
         Tri* last_tri;       // closest tri on this model in last distance test
 
+        bool owns_data;      // false if tris and b belong to another model
+
         BV* child(int n)
         {
             return &b[n];
@@ -76,6 +78,13 @@ namespace PQP
         int AddTri(const PQP_REAL* p1, const PQP_REAL* p2, const PQP_REAL* p3,
                    int id);
         int EndModel();
+        int ShareModel(const PQP_Model* source); // use the triangles and the BV
+        // tree of a processed model. The data is not copied, so source must
+        // stay alive and unmodified as long as this model is used.
+        // Only last_tri is private to this model.
+        int ReferenceData(Tri* tris, int num_tris, BV* b, int num_bvs); // use
+        // externally owned triangles and BV tree, e.g. a processed model that
+        // was stored to disk. The data is not copied and not released.
         int MemUsage(int msg);  // returns model mem usage.
         // prints message to stderr if msg == TRUE
     };
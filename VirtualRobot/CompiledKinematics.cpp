@@ -0,0 +1,460 @@
+
+#include "CompiledKinematics.h"
+#include "Robot.h"
+#include "VirtualRobotException.h"
+#include "Nodes/RobotNode.h"
+#include "Nodes/RobotNodeFixed.h"
+#include "Nodes/RobotNodeRevolute.h"
+#include "Nodes/RobotNodePrismatic.h"
+#include "CollisionDetection/CollisionModel.h"
+#include "Visualization/VisualizationNode.h"
+
+#include <typeinfo>
+
+#include <Eigen/Geometry>
+
+namespace VirtualRobot
+{
+
+    CompiledKinematics::CompiledKinematics(RobotPtr robot)
+    {
+        THROW_VR_EXCEPTION_IF(!robot, "NULL robot");
+        this->robot = robot;
+        updateVisualization = robot->getUpdateVisualizationStatus();
+        updateCollisionModels = true;
+        compile();
+    }
+
+    CompiledKinematics::~CompiledKinematics()
+    {
+    }
+
+    void CompiledKinematics::compile()
+    {
+        nodes.clear();
+        parents.clear();
+        subtreeEnd.clear();
+        jointTypes.clear();
+        jointValueOffsets.clear();
+        jointAxes.clear();
+        localTransformations.clear();
+        globalPoses.clear();
+        attachedObjects.clear();
+        propagations.clear();
+        hasPropagations.clear();
+        nameIndexMapping.clear();
+        nodeIndexMapping.clear();
+
+        RobotPtr r = robot.lock();
+        THROW_VR_EXCEPTION_IF(!r, "Robot has been deleted");
+        RobotNodePtr root = r->getRootNode();
+
+        if (!root)
+        {
+            return;
+        }
+
+        compileRecursive(root, -1);
+        hasPropagations.resize(nodes.size(), 0);
+
+        // resolve propagated joint values
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            std::map< std::string, float >::const_iterator it = nodes[i]->propagatedJointValues.begin();
+
+            while (it != nodes[i]->propagatedJointValues.end())
+            {
+                std::map<std::string, int>::const_iterator target = nameIndexMapping.find(it->first);
+
+                if (target == nameIndexMapping.end())
+                {
+                    VR_WARNING << "Could not propagate joint value from " << nodes[i]->getName() << " to " << it->first << " because dependent joint does not exist...";
+                }
+                else
+                {
+                    Propagation p;
+                    p.source = (int)i;
+                    p.target = target->second;
+                    p.factor = it->second;
+                    propagations.push_back(p);
+                    hasPropagations[i] = 1;
+                }
+
+                it++;
+            }
+        }
+
+        computePoses();
+    }
+
+    void CompiledKinematics::compileRecursive(RobotNodePtr node, int parentIndex)
+    {
+        unsigned int index = (unsigned int)nodes.size();
+        RobotNode* n = node.get();
+
+        nodes.push_back(n);
+        parents.push_back(parentIndex);
+        subtreeEnd.push_back(index + 1);
+        jointValueOffsets.push_back(n->jointValueOffset);
+        localTransformations.push_back(n->localTransformation);
+        globalPoses.push_back(n->globalPose);
+        nameIndexMapping[n->getName()] = (int)index;
+        nodeIndexMapping[n] = (int)index;
+
+        // only handle the known node types, derived classes may compute their poses differently
+        JointType t = eGeneric;
+        Eigen::Vector3f axis = Eigen::Vector3f::Zero();
+
+        if (typeid(*n) == typeid(RobotNodeFixed))
+        {
+            t = eFixed;
+        }
+        else if (typeid(*n) == typeid(RobotNodeRevolute))
+        {
+            t = eRevolute;
+            axis = static_cast<RobotNodeRevolute*>(n)->jointRotationAxis;
+        }
+        else if (typeid(*n) == typeid(RobotNodePrismatic))
+        {
+            RobotNodePrismatic* p = static_cast<RobotNodePrismatic*>(n);
+
+            // visualization scaling is done by the node
+            if (!p->visuScaling)
+            {
+                t = ePrismatic;
+                axis = p->jointTranslationDirection;
+            }
+        }
+
+        jointTypes.push_back(t);
+        jointAxes.push_back(axis);
+        attachedObjects.push_back(std::vector<SceneObjectPtr>());
+
+        std::vector<SceneObjectPtr> children = n->getChildren();
+
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            RobotNodePtr rn = boost::dynamic_pointer_cast<RobotNode>(children[i]);
+
+            if (rn)
+            {
+                compileRecursive(rn, (int)index);
+            }
+            else
+            {
+                attachedObjects[index].push_back(children[i]);
+            }
+        }
+
+        subtreeEnd[index] = (unsigned int)nodes.size();
+    }
+
+    void CompiledKinematics::applyPropagations(int source)
+    {
+        // same behavior as RobotNode::updatePose: the values of the source are propagated, the targets propagate their values again
+        propagationTargets.clear();
+        propagationSources.clear();
+        propagationSources.push_back(source);
+
+        for (size_t k = 0; k < propagationSources.size() && k <= propagations.size(); k++)
+        {
+            int current = propagationSources[k];
+
+            for (size_t i = 0; i < propagations.size(); i++)
+            {
+                const Propagation& p = propagations[i];
+
+                if (p.source != current)
+                {
+                    continue;
+                }
+
+                RobotNode* target = nodes[p.target];
+                float v = nodes[p.source]->jointValue * p.factor;
+
+                if (v < target->jointLimitLo)
+                {
+                    v = target->jointLimitLo;
+                }
+
+                if (v > target->jointLimitHi)
+                {
+                    v = target->jointLimitHi;
+                }
+
+                if (target->jointValue != v)
+                {
+                    target->poseDirty = true;
+                }
+
+                target->jointValue = v;
+                propagationTargets.push_back(p.target);
+                propagationSources.push_back(p.target);
+            }
+        }
+    }
+
+    void CompiledKinematics::computePoses()
+    {
+        computePoses(0, (unsigned int)nodes.size());
+    }
+
+    void CompiledKinematics::computePoses(unsigned int begin, unsigned int end)
+    {
+        if (begin >= end)
+        {
+            return;
+        }
+
+        // the pose of the parent of the first node is taken from the robot, since it may have been updated externally (e.g. by a RobotNodeActuator)
+        Eigen::Matrix4f rootPose;
+
+        if (parents[begin] < 0)
+        {
+            RobotPtr r = robot.lock();
+            VR_ASSERT(r);
+            rootPose = r->getGlobalPose();
+        }
+        else
+        {
+            rootPose = nodes[parents[begin]]->globalPose;
+        }
+
+        Eigen::Matrix4f tmp;
+
+        for (unsigned int i = begin; i < end; i++)
+        {
+            const Eigen::Matrix4f& parentPose = (i == begin || parents[i] < 0) ? rootPose : globalPoses[parents[i]];
+            Eigen::Matrix4f& pose = globalPoses[i];
+
+            switch (jointTypes[i])
+            {
+                case eFixed:
+                    pose.noalias() = parentPose * localTransformations[i];
+                    break;
+
+                case eRevolute:
+                {
+                    tmp.noalias() = parentPose * localTransformations[i];
+                    Eigen::Matrix3f rot = Eigen::AngleAxisf(nodes[i]->jointValue + jointValueOffsets[i], jointAxes[i]).toRotationMatrix();
+                    pose.block<3, 3>(0, 0).noalias() = tmp.block<3, 3>(0, 0) * rot;
+                    pose.block<4, 1>(0, 3) = tmp.block<4, 1>(0, 3);
+                    pose.block<1, 3>(3, 0).setZero();
+                }
+                break;
+
+                case ePrismatic:
+                {
+                    tmp.noalias() = parentPose * localTransformations[i];
+                    Eigen::Vector3f t = (nodes[i]->jointValue + jointValueOffsets[i]) * jointAxes[i];
+                    pose.block<4, 3>(0, 0) = tmp.block<4, 3>(0, 0);
+                    pose.block<3, 1>(0, 3).noalias() = tmp.block<3, 3>(0, 0) * t;
+                    pose.block<3, 1>(0, 3) += tmp.block<3, 1>(0, 3);
+                    pose(3, 3) = 1.0f;
+                }
+                break;
+
+                default:
+                    nodes[i]->updateTransformationMatrices(parentPose);
+                    pose = nodes[i]->globalPose;
+                    break;
+            }
+        }
+    }
+
+    void CompiledKinematics::applyPoses()
+    {
+        applyPoses(0, (unsigned int)nodes.size());
+    }
+
+    void CompiledKinematics::applyPoses(unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; i++)
+        {
+            RobotNode* n = nodes[i];
+            n->globalPose = globalPoses[i];
+            n->poseDirty = false;
+
+            if (n->lazyPoseUpdates)
+            {
+                n->modelPosesDirty = true;
+            }
+            else
+            {
+                if (updateCollisionModels && n->collisionModel)
+                {
+                    n->collisionModel->setGlobalPose(globalPoses[i]);
+                }
+
+                if (updateVisualization && n->visualizationModel)
+                {
+                    n->visualizationModel->setGlobalPose(globalPoses[i]);
+                }
+            }
+
+            for (size_t j = 0; j < attachedObjects[i].size(); j++)
+            {
+                attachedObjects[i][j]->updatePose(globalPoses[i], true);
+            }
+        }
+    }
+
+    void CompiledKinematics::update()
+    {
+        computePoses();
+        applyPoses();
+    }
+
+    void CompiledKinematics::update(RobotNodePtr node)
+    {
+        int index = getIndex(node);
+
+        if (index < 0)
+        {
+            update();
+            return;
+        }
+
+        unsigned int end = subtreeEnd[index];
+
+        if (hasPropagations[index])
+        {
+            applyPropagations(index);
+        }
+        else
+        {
+            propagationTargets.clear();
+        }
+
+        computePoses((unsigned int)index, end);
+        applyPoses((unsigned int)index, end);
+        updatePropagationTargets((unsigned int)index, end);
+    }
+
+    void CompiledKinematics::updateIncremental(RobotNodePtr node)
+    {
+        int index = getIndex(node);
+
+        if (index < 0)
+        {
+            update();
+            return;
+        }
+
+        unsigned int begin = (unsigned int)index;
+        unsigned int end = subtreeEnd[index];
+
+        if (hasPropagations[index])
+        {
+            applyPropagations(index);
+        }
+        else
+        {
+            propagationTargets.clear();
+        }
+
+        bool dirty = nodes[begin]->poseDirty;
+        Eigen::Matrix4f oldPose = globalPoses[begin];
+        computePoses(begin, begin + 1);
+        applyPoses(begin, begin + 1);
+
+        if (dirty || globalPoses[begin] != oldPose)
+        {
+            // the pose of node has changed, update the whole subtree
+            computePoses(begin + 1, end);
+            applyPoses(begin + 1, end);
+        }
+        else
+        {
+            // depth first order: a modified joint is updated together with its subtree, which is skipped afterwards
+            unsigned int i = begin + 1;
+
+            while (i < end)
+            {
+                if (nodes[i]->poseDirty)
+                {
+                    computePoses(i, subtreeEnd[i]);
+                    applyPoses(i, subtreeEnd[i]);
+                    i = subtreeEnd[i];
+                }
+                else
+                {
+                    i++;
+                }
+            }
+        }
+
+        updatePropagationTargets(begin, end);
+    }
+
+    void CompiledKinematics::updatePropagationTargets(unsigned int begin, unsigned int end)
+    {
+        // update the subtrees of dependent joints which are not part of [begin,end)
+        for (size_t i = 0; i < propagationTargets.size(); i++)
+        {
+            unsigned int t = (unsigned int)propagationTargets[i];
+
+            if (t < begin || t >= end)
+            {
+                computePoses(t, subtreeEnd[t]);
+                applyPoses(t, subtreeEnd[t]);
+            }
+        }
+    }
+
+    void CompiledKinematics::setUpdateVisualization(bool enable)
+    {
+        updateVisualization = enable;
+    }
+
+    bool CompiledKinematics::getUpdateVisualization() const
+    {
+        return updateVisualization;
+    }
+
+    void CompiledKinematics::setUpdateCollisionModels(bool enable)
+    {
+        updateCollisionModels = enable;
+    }
+
+    bool CompiledKinematics::getUpdateCollisionModels() const
+    {
+        return updateCollisionModels;
+    }
+
+    unsigned int CompiledKinematics::getNrOfNodes() const
+    {
+        return (unsigned int)nodes.size();
+    }
+
+    int CompiledKinematics::getIndex(const std::string& nodeName) const
+    {
+        std::map<std::string, int>::const_iterator it = nameIndexMapping.find(nodeName);
+
+        if (it == nameIndexMapping.end())
+        {
+            return -1;
+        }
+
+        return it->second;
+    }
+
+    int CompiledKinematics::getIndex(RobotNodePtr node) const
+    {
+        std::map<const RobotNode*, int>::const_iterator it = nodeIndexMapping.find(node.get());
+
+        if (it == nodeIndexMapping.end())
+        {
+            return -1;
+        }
+
+        return it->second;
+    }
+
+    const Eigen::Matrix4f& CompiledKinematics::getGlobalPose(unsigned int index) const
+    {
+        THROW_VR_EXCEPTION_IF(index >= globalPoses.size(), "Index out of bounds:" << index);
+        return globalPoses[index];
+    }
+
+} // namespace VirtualRobot
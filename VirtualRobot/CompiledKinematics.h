@@ -0,0 +1,166 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    VirtualRobot
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef _VirtualRobot_CompiledKinematics_h_
+#define _VirtualRobot_CompiledKinematics_h_
+
+#include "VirtualRobotImportExport.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+namespace VirtualRobot
+{
+
+    /*!
+        \brief A flat representation of the forward kinematics of a robot.
+
+        The kinematic tree of the robot is compiled into contiguous arrays, the nodes are stored in depth-first order,
+        so that parents are processed before their children and each subtree covers a contiguous range of entries.
+        The global poses of all nodes are computed in one linear pass, without recursion, without locking and without virtual calls
+        (RobotNodes of unknown types fall back to their own implementation). The dependencies of propagated joint values are resolved on compilation.
+
+        The computed poses can be written back to the robot nodes, including the global poses of the collision models.
+        Updating the visualizations can be disabled completely, which speeds up headless applications (e.g. planning, workspace sampling).
+
+        Usually this class is used via Robot::setUseCompiledKinematics, which routes all joint value updates of the robot through this implementation.
+        Since the structure of the robot is copied, compile() has to be called again when the kinematic structure of the robot changes
+        (e.g. when RobotNodes are attached or local transformations are modified).
+
+        \see Robot::setUseCompiledKinematics
+    */
+    class VIRTUAL_ROBOT_IMPORT_EXPORT CompiledKinematics
+    {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        /*!
+            Compiles the kinematic structure of robot.
+            The robot is not owned by this object.
+        */
+        CompiledKinematics(RobotPtr robot);
+        virtual ~CompiledKinematics();
+
+        //! (Re-)Builds the flat representation from the current structure of the robot.
+        void compile();
+
+        /*!
+            Computes the global poses of all nodes according to the current joint values of the robot nodes.
+            The results are not written to the robot (@see getGlobalPose, applyPoses).
+            As with Robot::applyJointValues, no joint values are propagated.
+        */
+        void computePoses();
+
+        /*!
+            Writes the computed poses to the robot nodes and updates the collision models (and visualizations, if enabled).
+            Nodes with lazy pose updates (\see SceneObject::setLazyPoseUpdates) just mark their models as outdated.
+        */
+        void applyPoses();
+
+        //! Computes and applies all poses.
+        void update();
+
+        /*!
+            Computes and applies the poses of node and all its children (same behavior as RobotNode::updatePose).
+            The joint value of node is propagated and the subtrees of the dependent joints are updated.
+            If node is not part of the compiled structure, all poses are updated.
+        */
+        void update(RobotNodePtr node);
+
+        /*!
+            Same as update(node), but within the subtree of node only the subtrees of joints with modified joint values are updated
+            (\see RobotNode::updatePoseIncremental).
+        */
+        void updateIncremental(RobotNodePtr node);
+
+        /*!
+            Enable/Disable the visualization updates. When disabled, visualization models are not touched at all.
+            (standard: the visualization update status of the robot)
+        */
+        void setUpdateVisualization(bool enable);
+        bool getUpdateVisualization() const;
+
+        //! Enable/Disable the updates of the global poses of the collision models (standard: enabled).
+        void setUpdateCollisionModels(bool enable);
+        bool getUpdateCollisionModels() const;
+
+        //! Number of compiled robot nodes.
+        unsigned int getNrOfNodes() const;
+
+        //! The index of the node or -1 if the node is not known.
+        int getIndex(const std::string& nodeName) const;
+        int getIndex(RobotNodePtr node) const;
+
+        //! The computed global pose of the node with the given index.
+        const Eigen::Matrix4f& getGlobalPose(unsigned int index) const;
+
+    protected:
+        enum JointType
+        {
+            eFixed,
+            eRevolute,
+            ePrismatic,
+            eGeneric        //!< unknown node type, the pose is computed by the node itself
+        };
+
+        struct Propagation
+        {
+            int source;
+            int target;
+            float factor;
+        };
+
+        void compileRecursive(RobotNodePtr node, int parentIndex);
+        void computePoses(unsigned int begin, unsigned int end);
+        void applyPoses(unsigned int begin, unsigned int end);
+        void applyPropagations(int source);
+        void updatePropagationTargets(unsigned int begin, unsigned int end);
+
+        RobotWeakPtr robot;
+        bool updateVisualization;
+        bool updateCollisionModels;
+
+        // flat storage, depth-first order
+        std::vector<RobotNode*> nodes;                                                      //!< not owned, the robot holds the nodes
+        std::vector<int> parents;                                                           //!< index of parent (-1 for the root)
+        std::vector<unsigned int> subtreeEnd;                                               //!< the subtree of node i is [i,subtreeEnd[i])
+        std::vector<JointType> jointTypes;
+        std::vector<float> jointValueOffsets;
+        std::vector<Eigen::Vector3f> jointAxes;                                             //!< rotation axis or translation direction
+        std::vector< Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > localTransformations;
+        std::vector< Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > globalPoses;
+        std::vector< std::vector<SceneObjectPtr> > attachedObjects;                         //!< children that are no RobotNodes (e.g. sensors)
+        std::vector<Propagation> propagations;                                              //!< ordered by source
+        std::vector<char> hasPropagations;                                                  //!< true, if the joint value of node i is propagated
+        std::vector<int> propagationSources, propagationTargets;                            //!< temporary data for applyPropagations
+
+        std::map<std::string, int> nameIndexMapping;
+        std::map<const RobotNode*, int> nodeIndexMapping;
+    };
+
+} // namespace VirtualRobot
+
+#endif // _VirtualRobot_CompiledKinematics_h_
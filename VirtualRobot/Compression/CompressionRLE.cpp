@@ -350,4 +350,82 @@ namespace VirtualRobot
         while (inpos < insize);
     }
 
+    int CompressionRLE::RLE_Uncompress(const unsigned char* in, unsigned char* out,
+                                       unsigned int insize, unsigned int outsize)
+    {
+        unsigned char marker, symbol;
+        unsigned int  i, inpos, outpos, count;
+
+        if (insize < 1)
+        {
+            return 0;
+        }
+
+        inpos = 0;
+        marker = in[ inpos ++ ];
+        outpos = 0;
+
+        while (inpos < insize)
+        {
+            symbol = in[ inpos ++ ];
+
+            if (symbol == marker)
+            {
+                if (inpos >= insize)
+                {
+                    return -1;
+                }
+
+                count = in[ inpos ++ ];
+
+                if (count > 2)
+                {
+                    if (count & 0x80)
+                    {
+                        if (inpos >= insize)
+                        {
+                            return -1;
+                        }
+
+                        count = ((count & 0x7f) << 8) + in[ inpos ++ ];
+                    }
+
+                    if (inpos >= insize)
+                    {
+                        return -1;
+                    }
+
+                    symbol = in[ inpos ++ ];
+                }
+                else
+                {
+                    /* Counts 0, 1 and 2 are used for marker byte repetition
+                       only */
+                    symbol = marker;
+                }
+
+                if (count >= outsize - outpos)
+                {
+                    return -1;
+                }
+
+                for (i = 0; i <= count; ++ i)
+                {
+                    out[ outpos ++ ] = symbol;
+                }
+            }
+            else
+            {
+                if (outpos >= outsize)
+                {
+                    return -1;
+                }
+
+                out[ outpos ++ ] = symbol;
+            }
+        }
+
+        return (int)outpos;
+    }
+
 }
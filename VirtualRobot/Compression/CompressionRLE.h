@@ -55,6 +55,18 @@ namespace VirtualRobot
         *************************************************************************/
         static void RLE_Uncompress(const unsigned char* in, unsigned char* out, unsigned int insize);
 
+        /*************************************************************************
+        * RLE_Uncompress() - Uncompress a block of data using an RLE decoder,
+        *                    neither the input nor the output buffer is overrun.
+        *  in      - Input (compressed) buffer.
+        *  out     - Output (uncompressed) buffer.
+        *  insize  - Number of input bytes.
+        *  outsize - Size of the output buffer.
+        * The function returns the size of the uncompressed data or -1 if the
+        * input is malformed or does not fit into the output buffer.
+        *************************************************************************/
+        static int RLE_Uncompress(const unsigned char* in, unsigned char* out, unsigned int insize, unsigned int outsize);
+
     protected:
         static void _RLE_WriteRep(unsigned char* out, unsigned int* outpos, unsigned char marker, unsigned char symbol, unsigned int count);
         static void _RLE_WriteNonRep(unsigned char* out, unsigned int* outpos, unsigned char marker, unsigned char symbol);
@@ -14,6 +14,8 @@
 #include "../RobotConfig.h"
 #include "../CollisionDetection/CollisionChecker.h"
 
+#include <boost/date_time/posix_time/posix_time.hpp>
+
 
 
 namespace VirtualRobot
@@ -24,7 +26,11 @@ namespace VirtualRobot
         actors(actorsVector),
         statics(staticPartVector),
         baseNode(baseNodePtr),
-        tcpNode(tcpNodePtr)
+        tcpNode(tcpNodePtr),
+        closingMode(eClosingFixedStep),
+        coarseStepFactor(8),
+        closingCalls(0),
+        closingTimeMS(0.0f)
     {
         THROW_VR_EXCEPTION_IF(!baseNode, "NULL base node not allowed!");
         THROW_VR_EXCEPTION_IF(!tcpNode, "NULL tcp node not allowed!");
@@ -88,6 +94,7 @@ namespace VirtualRobot
 
 
         EndEffectorPtr eef(new EndEffector(name, newActors, newStatics, newBase, newTCP, newGCP, newPreshapes));
+        eef->setClosingMode(closingMode, coarseStepFactor);
         newRobot->registerEndEffector(eef);
 
         // set current config to new eef
@@ -115,6 +122,7 @@ namespace VirtualRobot
 
     EndEffector::ContactInfoVector EndEffector::closeActors(SceneObjectSetPtr obstacles, float stepSize)
     {
+        boost::posix_time::ptime startTime = boost::posix_time::microsec_clock::universal_time();
         std::vector<bool> actorCollisionStatus(actors.size(), false);
         EndEffector::ContactInfoVector result;
 
@@ -133,7 +141,18 @@ namespace VirtualRobot
                 {
                     finished = false;
 
-                    if (actors[i]->moveActorCheckCollision(shared_from_this(), result, obstacles, stepSize))
+                    bool blocked;
+
+                    if (closingMode == eClosingBisection)
+                    {
+                        blocked = actors[i]->moveActorCheckCollisionBisection(shared_from_this(), result, obstacles, stepSize, coarseStepFactor);
+                    }
+                    else
+                    {
+                        blocked = actors[i]->moveActorCheckCollision(shared_from_this(), result, obstacles, stepSize);
+                    }
+
+                    if (blocked)
                     {
                         actorCollisionStatus[i] = true;
                     }
@@ -154,6 +173,8 @@ namespace VirtualRobot
             }
         }
 
+        closingCalls++;
+        closingTimeMS += (float)(boost::posix_time::microsec_clock::universal_time() - startTime).total_microseconds() / 1000.0f;
         return result;
     }
 
@@ -176,6 +197,44 @@ namespace VirtualRobot
         closeActors(obstacles, -stepSize);
     }
 
+    void EndEffector::setClosingMode(ClosingMode mode, int coarseStepFactor)
+    {
+        THROW_VR_EXCEPTION_IF(coarseStepFactor < 1, "The coarse step factor must be at least 1");
+        closingMode = mode;
+        this->coarseStepFactor = coarseStepFactor;
+    }
+
+    EndEffector::ClosingMode EndEffector::getClosingMode()
+    {
+        return closingMode;
+    }
+
+    EndEffector::ClosingStatistics EndEffector::getClosingStatistics()
+    {
+        ClosingStatistics res;
+        res.nrCalls = closingCalls;
+        res.nrCollisionQueries = 0;
+        res.timeMS = closingTimeMS;
+
+        for (size_t i = 0; i < actors.size(); i++)
+        {
+            res.nrCollisionQueries += actors[i]->getNrCollisionQueries();
+        }
+
+        return res;
+    }
+
+    void EndEffector::resetClosingStatistics()
+    {
+        closingCalls = 0;
+        closingTimeMS = 0.0f;
+
+        for (size_t i = 0; i < actors.size(); i++)
+        {
+            actors[i]->resetNrCollisionQueries();
+        }
+    }
+
     VirtualRobot::SceneObjectSetPtr EndEffector::createSceneObjectSet(CollisionCheckerPtr colChecker)
     {
         SceneObjectSetPtr cms(new SceneObjectSet(name, colChecker));
@@ -59,6 +59,29 @@ namespace VirtualRobot
         //! We need an Eigen::aligned_allocator here, otherwise access to a std::vector could crash
         typedef std::vector< ContactInfo, Eigen::aligned_allocator<ContactInfo> > ContactInfoVector;
 
+        /*!
+            The strategies that can be used by closeActors() for detecting the contacts.
+            - eClosingFixedStep: All actors are moved step by step and each step is checked for collisions (standard).
+            - eClosingBisection: The actors are moved with coarse steps (a multiple of the step size). If a coarse step results in a collision,
+              the contact is bracketed by bisection until the step size is reached. The actors stop at the same positions as with eClosingFixedStep
+              (as long as no obstacle is thinner than a coarse step), but considerably fewer collision queries are needed.
+        */
+        enum ClosingMode
+        {
+            eClosingFixedStep,
+            eClosingBisection
+        };
+
+        /*!
+            Performance counters of closeActors().
+        */
+        struct ClosingStatistics
+        {
+            int nrCalls;                // number of closeActors() calls
+            int nrCollisionQueries;     // number of actor configurations that have been checked for collisions
+            float timeMS;               // accumulated time spent in closeActors() [ms]
+        };
+
         EndEffector(const std::string& nameString, const std::vector<EndEffectorActorPtr>& actorsVector, const std::vector<RobotNodePtr>& staticPartVector, RobotNodePtr baseNodePtr, RobotNodePtr tcpNodePtr, RobotNodePtr gcpNodePtr = RobotNodePtr(), std::vector< RobotConfigPtr > preshapes = std::vector< RobotConfigPtr >());
 
         virtual ~EndEffector();
@@ -108,6 +131,7 @@ namespace VirtualRobot
         /*!
             Closes each actor until a joint limit is hit or a collision occurred.
             This method is intended for gripper or hand-like end-effectors.
+            The contacts are located with an accuracy of stepSize, the strategy can be selected with setClosingMode().
         */
         ContactInfoVector closeActors(SceneObjectSetPtr obstacles = SceneObjectSetPtr(), float stepSize = 0.02);
         ContactInfoVector closeActors(SceneObjectPtr obstacle, float stepSize = 0.02);
@@ -119,6 +143,21 @@ namespace VirtualRobot
         */
         void openActors(SceneObjectSetPtr obstacles = SceneObjectSetPtr(), float stepSize = 0.02);
 
+        /*!
+            Select the strategy that is used by closeActors() and openActors().
+            \param mode The closing mode, see ClosingMode.
+            \param coarseStepFactor Only used with eClosingBisection: The coarse steps are coarseStepFactor times the step size.
+                   Should be chosen such that no obstacle can be passed within one coarse step.
+        */
+        void setClosingMode(ClosingMode mode, int coarseStepFactor = 8);
+        ClosingMode getClosingMode();
+
+        /*!
+            Returns the accumulated performance counters of closeActors() since the last call of resetClosingStatistics().
+        */
+        ClosingStatistics getClosingStatistics();
+        void resetClosingStatistics();
+
         /*!
             Build a SceneObjectSet that covers all RobotNodes of this EndEffector.
             \note The set can be used for collision detection, e.g. to check if the eef is in collision with an obstacle.
@@ -190,6 +229,11 @@ namespace VirtualRobot
         RobotNodePtr baseNode;
         RobotNodePtr tcpNode;
         RobotNodePtr gcpNode;
+
+        ClosingMode closingMode;
+        int coarseStepFactor;
+        int closingCalls;
+        float closingTimeMS;
     };
 
 } // namespace VirtualRobot
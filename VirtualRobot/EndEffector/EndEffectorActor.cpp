@@ -21,7 +21,8 @@ namespace VirtualRobot
 
     EndEffectorActor::EndEffectorActor(const std::string& name, const std::vector< ActorDefinition >& a, CollisionCheckerPtr colChecker) :
         name(name),
-        actors(a)
+        actors(a),
+        nrCollisionQueries(0)
     {
         this->colChecker = colChecker;
 
@@ -111,58 +112,164 @@ namespace VirtualRobot
                 robot->setJointValue(n->robotNode, v);
                 //n->robotNode->setJointValue(v);
 
-                // check collision
-                bool collision = false;
-
-                // obstacles (store contacts)
-                if ((/*n->colMode!=eNone &&*/ obstacles && isColliding(eef, obstacles, newContacts)))
+                if (!isCollidingStep(eef, obstacles, eefActors, eefStatic, &newContacts))
                 {
-                    collision = true;
+                    res = false;
                 }
-
-                // actors (don't store contacts)
-                if (!collision)
+                else
                 {
-                    for (std::vector<EndEffectorActorPtr>::iterator a = eefActors.begin(); a != eefActors.end(); a++)
-                    {
-                        // Don't check for collisions with the actor itself (don't store contacts)
-                        if (((*a)->getName() != name) && isColliding(*a))   //isColliding(eef,*a,newContacts) )
-                        {
-                            collision = true;
-                        }
-                    }
+                    // reset last position
+                    //n->robotNode->setJointValue(oldV);
+                    robot->setJointValue(n->robotNode, oldV);
                 }
+            }
+        }
+
+        updateContacts(storeContacts, newContacts, angle);
+
+        return res;
+    }
 
-                // static (don't store contacts)
-                if (!collision)
+    bool EndEffectorActor::moveActorCheckCollisionBisection(EndEffectorPtr eef, EndEffector::ContactInfoVector& storeContacts, SceneObjectSetPtr obstacles, float angle, int coarseStepFactor)
+    {
+        VR_ASSERT(eef);
+        RobotPtr robot = eef->getRobot();
+        VR_ASSERT(robot);
+        bool res = true;
+        std::vector<EndEffectorActorPtr> eefActors;
+        eef->getActors(eefActors);
+        std::vector<RobotNodePtr> eefStatic;
+        eef->getStatics(eefStatic);
+        EndEffector::ContactInfoVector newContacts;
+
+        for (std::vector<ActorDefinition>::iterator n = actors.begin(); n != actors.end(); n++)
+        {
+            float oldV =  n->robotNode->getJointValue();
+            float step = angle * n->directionAndSpeed;
+
+            // the number of steps we can go without violating the joint limits
+            int nrSteps = coarseStepFactor;
+
+            while (nrSteps > 0 && (oldV + step * nrSteps > n->robotNode->getJointLimitHi() || oldV + step * nrSteps < n->robotNode->getJointLimitLo()))
+            {
+                nrSteps--;
+            }
+
+            if (nrSteps == 0)
+            {
+                continue;
+            }
+
+            // coarse step (contacts are only needed if this is the first step)
+            EndEffector::ContactInfoVector stepContacts;
+            bool contactsValid = (nrSteps == 1);
+            robot->setJointValue(n->robotNode, oldV + step * nrSteps);
+
+            if (!isCollidingStep(eef, obstacles, eefActors, eefStatic, contactsValid ? &stepContacts : NULL))
+            {
+                res = false;
+                continue;
+            }
+
+            // bracket the first colliding step: stepFree is collision free, stepCol is in collision
+            int stepFree = 0;
+            int stepCol = nrSteps;
+
+            // blocked joints are checked again and again while closing, so check the first step before bisecting
+            if (nrSteps > 1)
+            {
+                robot->setJointValue(n->robotNode, oldV + step);
+
+                if (isCollidingStep(eef, obstacles, eefActors, eefStatic, &stepContacts))
                 {
-                    for (std::vector<RobotNodePtr>::iterator node = eefStatic.begin(); node != eefStatic.end(); node++)
-                    {
-                        SceneObjectPtr so = boost::dynamic_pointer_cast<SceneObject>(*node);
-
-                        //(don't store contacts)
-                        //if( isColliding(eef,so,newContacts,eStatic) )
-                        if (isColliding(so, eStatic))
-                        {
-                            collision = true;
-                        }
-                    }
+                    stepCol = 1;
+                    contactsValid = true;
                 }
+                else
+                {
+                    stepFree = 1;
+                }
+            }
+
+            while (stepCol - stepFree > 1)
+            {
+                int s = (stepFree + stepCol) / 2;
+                robot->setJointValue(n->robotNode, oldV + step * s);
 
-                if (!collision)
+                if (isCollidingStep(eef, obstacles, eefActors, eefStatic, NULL))
                 {
-                    res = false;
+                    stepCol = s;
                 }
                 else
                 {
-                    // reset last position
-                    //n->robotNode->setJointValue(oldV);
-                    robot->setJointValue(n->robotNode, oldV);
+                    stepFree = s;
                 }
             }
+
+            // the contacts are reported for the first colliding step, as done by moveActorCheckCollision
+            if (!contactsValid)
+            {
+                robot->setJointValue(n->robotNode, oldV + step * stepCol);
+                isCollidingStep(eef, obstacles, eefActors, eefStatic, &stepContacts);
+            }
+
+            newContacts.insert(newContacts.end(), stepContacts.begin(), stepContacts.end());
+
+            // go to last collision free position, the joint is blocked since we know that the next step results in a collision
+            robot->setJointValue(n->robotNode, oldV + step * stepFree);
+        }
+
+        updateContacts(storeContacts, newContacts, angle);
+
+        return res;
+    }
+
+    bool EndEffectorActor::isCollidingStep(EndEffectorPtr eef, SceneObjectSetPtr obstacles, const std::vector<EndEffectorActorPtr>& eefActors, const std::vector<RobotNodePtr>& eefStatic, EndEffector::ContactInfoVector* storeContacts)
+    {
+        nrCollisionQueries++;
+
+        // obstacles (store contacts)
+        if (obstacles)
+        {
+            if (storeContacts && isColliding(eef, obstacles, *storeContacts))
+            {
+                return true;
+            }
+
+            if (!storeContacts && isColliding(obstacles))
+            {
+                return true;
+            }
+        }
+
+        // actors (don't store contacts)
+        for (std::vector<EndEffectorActorPtr>::const_iterator a = eefActors.begin(); a != eefActors.end(); a++)
+        {
+            // Don't check for collisions with the actor itself (don't store contacts)
+            if (((*a)->getName() != name) && isColliding(*a))   //isColliding(eef,*a,newContacts) )
+            {
+                return true;
+            }
+        }
+
+        // static (don't store contacts)
+        for (std::vector<RobotNodePtr>::const_iterator node = eefStatic.begin(); node != eefStatic.end(); node++)
+        {
+            SceneObjectPtr so = boost::dynamic_pointer_cast<SceneObject>(*node);
+
+            //(don't store contacts)
+            //if( isColliding(eef,so,newContacts,eStatic) )
+            if (isColliding(so, eStatic))
+            {
+                return true;
+            }
         }
 
-        // update contacts
+        return false;
+    }
+
+    void EndEffectorActor::updateContacts(EndEffector::ContactInfoVector& storeContacts, EndEffector::ContactInfoVector& newContacts, float angle)
+    {
         for (size_t i = 0; i < newContacts.size(); i++)
         {
             // check for double entries (this may happen since we move all actors to the end and may detecting contacts multiple times)
@@ -186,6 +293,7 @@ namespace VirtualRobot
 
                 // compute approach direction
                 // todo: this could be done more elegantly (Jacobian)
+                RobotPtr robot = newContacts[i].robotNode->getRobot();
                 RobotConfigPtr config = getConfiguration();
                 Eigen::Vector3f contGlobal1 = newContacts[i].contactPointFingerGlobal;
                 Eigen::Vector3f contFinger = newContacts[i].robotNode->toLocalCoordinateSystemVec(contGlobal1);
@@ -198,10 +306,17 @@ namespace VirtualRobot
                 storeContacts.push_back(newContacts[i]);
             }
         }
+    }
 
-        return res;
+    int EndEffectorActor::getNrCollisionQueries()
+    {
+        return nrCollisionQueries;
     }
 
+    void EndEffectorActor::resetNrCollisionQueries()
+    {
+        nrCollisionQueries = 0;
+    }
 
     bool EndEffectorActor::isColliding(EndEffectorPtr eef, SceneObjectSetPtr obstacles, EndEffector::ContactInfoVector& storeContacts, CollisionMode checkColMode)
     {
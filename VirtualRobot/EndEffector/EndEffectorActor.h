@@ -79,6 +79,22 @@ namespace VirtualRobot
         */
         bool moveActorCheckCollision(EndEffectorPtr eef, EndEffector::ContactInfoVector& storeContacts, SceneObjectSetPtr obstacles = SceneObjectSetPtr(), float angle = 0.02);
 
+        /*!
+            Moves the actor like moveActorCheckCollision, but with a coarse step of coarseStepFactor*angle per joint.
+            If the coarse step results in a collision, the first colliding step of size angle is searched by bisection and the joint is set to the last collision free step.
+            Hence, the joints end up at the same positions as with repeated calls of moveActorCheckCollision (as long as no obstacle can be passed within one coarse step),
+            but only about 2+log2(coarseStepFactor) collision queries are needed to locate a contact. Contact information is only computed for the first colliding step.
+            Returns true if all joints do either hit their limit or are blocked (i.e. the next step results in a collision), e.g. the actor cannot be moved any further.
+        */
+        bool moveActorCheckCollisionBisection(EndEffectorPtr eef, EndEffector::ContactInfoVector& storeContacts, SceneObjectSetPtr obstacles, float angle, int coarseStepFactor);
+
+        /*!
+            The number of collision queries (i.e. actor configurations that have been checked against obstacles, other actors and the static part of the eef)
+            that were performed by moveActorCheckCollision and moveActorCheckCollisionBisection.
+        */
+        int getNrCollisionQueries();
+        void resetNrCollisionQueries();
+
         /*!
             Checks if the actor collides with one of the given obstacles
         */
@@ -127,10 +143,18 @@ namespace VirtualRobot
 
     private:
 
+        //! Checks the current configuration for collisions with obstacles, the other actors and the static part of the eef. If storeContacts is given, the contacts with the obstacles are stored.
+        bool isCollidingStep(EndEffectorPtr eef, SceneObjectSetPtr obstacles, const std::vector<EndEffectorActorPtr>& eefActors, const std::vector<RobotNodePtr>& eefStatic, EndEffector::ContactInfoVector* storeContacts);
+
+        //! Adds the new contacts to storeContacts (if not already present) and computes the distances and approach directions.
+        void updateContacts(EndEffector::ContactInfoVector& storeContacts, EndEffector::ContactInfoVector& newContacts, float angle);
+
         std::string name;
         std::vector<ActorDefinition> actors;
 
         CollisionCheckerPtr colChecker;
+
+        int nrCollisionQueries;
     };
 
 } // namespace VirtualRobot
@@ -1,4 +1,6 @@
 #include <Eigen/Geometry>
+#include <Eigen/Cholesky>
+#include <Eigen/SVD>
 #include "DifferentialIK.h"
 #include "../Robot.h"
 #include "../VirtualRobotException.h"
@@ -27,12 +29,44 @@ namespace VirtualRobot
 
         checkImprovement = false;
         nodes =  rns->getAllRobotNodes();
+        jointTypes.resize(nodes.size(), eFixedJoint);
+        jointAxes.resize(nodes.size(), Eigen::Vector3f::Zero());
 
         for (size_t i = 0; i < nodes.size(); i++)
         {
             std::vector<RobotNodePtr> p = nodes[i]->getAllParents(rns);
             p.push_back(nodes[i]);// if the tcp is not fixed, it must be considered for calculating the Jacobian
             parents[nodes[i]] = p;
+
+            // the joint axes do not change, so we can avoid the casts when computing the Jacobian
+            if (nodes[i]->isRotationalJoint())
+            {
+                RobotNodeRevolutePtr revolute = boost::dynamic_pointer_cast<RobotNodeRevolute>(nodes[i]);
+
+                if (revolute)
+                {
+                    jointTypes[i] = eRevoluteJoint;
+                    jointAxes[i] = revolute->getJointRotationAxisInJointCoordSystem();
+                }
+                else
+                {
+                    jointTypes[i] = eUnknownJoint;
+                }
+            }
+            else if (nodes[i]->isTranslationalJoint())
+            {
+                RobotNodePrismaticPtr prismatic = boost::dynamic_pointer_cast<RobotNodePrismatic>(nodes[i]);
+
+                if (prismatic)
+                {
+                    jointTypes[i] = ePrismaticJoint;
+                    jointAxes[i] = prismatic->getJointTranslationDirectionJointCoordSystem();
+                }
+                else
+                {
+                    jointTypes[i] = eUnknownJoint;
+                }
+            }
         }
 
         convertMMtoM = false;
@@ -80,12 +114,8 @@ namespace VirtualRobot
             }
         }
 
-        // check if we already computed the parents for tcp
-        if (parents.find(tcpRN) == parents.end())
-        {
-            parents[tcpRN] = tcpRN->getAllParents(rns);
-            parents[tcpRN].push_back(tcpRN);
-        }
+        // compute the parents of tcp in advance
+        getJointMask(tcpRN);
 
         // tcp not in list yet?
         /*if (find(tcp_set.begin(), tcp_set.end(), tcp) == tcp_set.end())
@@ -336,12 +366,19 @@ namespace VirtualRobot
             }
         }
 
-        if (parents.find(tcpRN) == parents.end())
+        const std::vector<bool>& jointMask = getJointMask(tcpRN);
+
+        // Only directions and differences of positions are needed, hence the rotation is sufficient to express them in coordSystem.
+        // Poses are rigid transformations, so the inverse rotation is the transposed one.
+        Eigen::Matrix3f toCoordSystem = Eigen::Matrix3f::Identity();
+
+        if (coordSystem)
         {
-            parents[tcpRN] = tcpRN->getAllParents(rns);
-            parents[tcpRN].push_back(tcpRN);
+            toCoordSystem = coordSystem->getGlobalPose().block<3, 3>(0, 0).transpose();
         }
 
+        Eigen::Vector3f tcpPosition = tcp->getGlobalPose().block<3, 1>(0, 3);
+        Eigen::Matrix4f dofPose;
         Eigen::Vector3f axis;
         Eigen::Vector3f toTCP;
         tmpUpdateJacobianPosition.setZero();
@@ -356,69 +393,45 @@ namespace VirtualRobot
             clock_t startT = clock();
 #endif
 
-            RobotNodePtr dof = this->nodes[i];
-            //std::vector<RobotNodePtr> parents = parents[tcp];//tcp->getAllParents(this->rns);
-
             //check if the tcp is affected by this DOF
-            if (find(parents[tcpRN].begin(), parents[tcpRN].end(), dof) != parents[tcpRN].end())
+            if (jointMask[i] && jointTypes[i] != eFixedJoint)
             {
+                THROW_VR_EXCEPTION_IF(jointTypes[i] == eUnknownJoint, "Internal error: expecting revolute or prismatic joint");
+                dofPose = this->nodes[i]->getGlobalPose();
+                axis = toCoordSystem * (dofPose.block<3, 3>(0, 0) * jointAxes[i]);
 
                 // Calculus for rotational joints is different as for prismatic joints.
-                if (dof->isRotationalJoint())
+                if (jointTypes[i] == eRevoluteJoint)
                 {
-                    // get axis
-                    boost::shared_ptr<RobotNodeRevolute> revolute
-                        = boost::dynamic_pointer_cast<RobotNodeRevolute>(dof);
-                    THROW_VR_EXCEPTION_IF(!revolute, "Internal error: expecting revolute joint");
-                    // todo: find a better way of handling different joint types
-                    axis = revolute->getJointRotationAxis(coordSystem);
-
                     // if necessary calculate the position part of the Jacobian
                     if (mode & IKSolver::Position)
                     {
-
-                        if (coordSystem)
-                        {
-                            toTCP = coordSystem->toLocalCoordinateSystem(tcp->getGlobalPose()).block(0, 3, 3, 1)
-                                    - coordSystem->toLocalCoordinateSystem(dof->getGlobalPose()).block(0, 3, 3, 1);
-                        }
-                        else
-                        {
-                            toTCP = tcp->getGlobalPose().block(0, 3, 3, 1)
-                                    - dof->getGlobalPose().block(0, 3, 3, 1);
-                        }
+                        toTCP = toCoordSystem * (tcpPosition - dofPose.block<3, 1>(0, 3));
 
                         if (convertMMtoM)
                         {
                             toTCP /= 1000.0f;
                         }
 
-                        //cout << "toTCP: " << tcp->getName() << endl;
-                        //cout << toTCP << endl;
-                        tmpUpdateJacobianPosition.block(0, i, 3, 1) = axis.cross(toTCP);
+                        tmpUpdateJacobianPosition.col(i) = axis.cross(toTCP);
                     }
 
                     // and the orientation part
                     if (mode & IKSolver::Orientation)
                     {
-                        tmpUpdateJacobianOrientation.block(0, i, 3, 1) = axis;
+                        tmpUpdateJacobianOrientation.col(i) = axis;
                     }
                 }
-                else if (dof->isTranslationalJoint())
+                else
                 {
                     // -> prismatic joint
-                    boost::shared_ptr<RobotNodePrismatic> prismatic
-                        = boost::dynamic_pointer_cast<RobotNodePrismatic>(dof);
-                    THROW_VR_EXCEPTION_IF(!prismatic, "Internal error: expecting prismatic joint");
-                    // todo: find a better way of handling different joint types
-                    axis = prismatic->getJointTranslationDirection(coordSystem);
 
                     //if (!convertMMtoM)
                     //  axis *= 1000.0f; // we have a mm jacobian -> no, we say how much the joint moves when applying 1 'unit', this can be mm or m and depends only on the error vector
                     // if necessary calculate the position part of the Jacobian
                     if (mode & IKSolver::Position)
                     {
-                        tmpUpdateJacobianPosition.block(0, i, 3, 1) = axis;
+                        tmpUpdateJacobianPosition.col(i) = axis;
                     }
 
                     // no orientation part required with prismatic joints
@@ -431,7 +444,7 @@ namespace VirtualRobot
 
             if (diffClock > 0.0f)
             {
-                cout << "Jacobi Loop " << i << ": RobotNode: " << dof->getName() << ", time:" << diffClock << endl;
+                cout << "Jacobi Loop " << i << ": RobotNode: " << nodes[i]->getName() << ", time:" << diffClock << endl;
             }
 
 #endif
@@ -644,8 +657,8 @@ namespace VirtualRobot
 
         if (mode & IKSolver::Orientation)
         {
-            tmpDeltaOrientation = goal * current.inverse();
-            tmpDeltaAA = tmpDeltaOrientation.block<3, 3>(0, 0);
+            tmpDeltaOrientation = goal.block<3, 3>(0, 0) * current.block<3, 3>(0, 0).transpose();
+            tmpDeltaAA = tmpDeltaOrientation;
             //AngleAxis<float> aa(orientation.block<3, 3>(0, 0));
             // TODO: make sure that angle is >0!?
             delta.tail(3) = tmpDeltaAA.axis() * tmpDeltaAA.angle();
@@ -660,6 +673,12 @@ namespace VirtualRobot
         updateJacobianMatrix(currentJacobian);
         //VectorXf dTheta(nDoF);
 
+        // small problems: no explicit pseudo inverse and no heap allocations
+        if (!verbose && updateStepFixedSize(tmpComputeStepTheta))
+        {
+            return tmpComputeStepTheta;
+        }
+
         updatePseudoInverseJacobianMatrix(currentInvJacobian, currentJacobian);
 
         tmpComputeStepTheta = currentInvJacobian * currentError;
@@ -680,6 +699,138 @@ namespace VirtualRobot
         return tmpComputeStepTheta;
     }
 
+    bool DifferentialIK::updateStepFixedSize(Eigen::VectorXf& dTheta)
+    {
+        if (nRows == 0 || nDoF == 0 || nRows > (size_t)MaxFixedSizeRows || nDoF > (size_t)MaxFixedSizeDoF)
+        {
+            return false;
+        }
+
+        const bool weighted = (jointWeights.rows() == (int)nDoF);
+        FixedSizeJacobian jac = currentJacobian;
+        FixedSizeSquareMatrix a;
+        FixedSizeVector x;
+
+        switch (inverseMethod)
+        {
+            case eTranspose:
+            {
+                // J^+ = W^-1 J^T (J W^-1 J^T)^-1
+                FixedSizeJacobian jacW = jac;
+
+                if (weighted)
+                {
+                    for (size_t i = 0; i < nDoF; i++)
+                    {
+                        jacW.col(i) /= jointWeights(i);
+                    }
+                }
+
+                a = jacW.lazyProduct(jac.transpose());
+                x = a.ldlt().solve(currentError);
+                dTheta = jacW.transpose().lazyProduct(x);
+                break;
+            }
+
+            case eSVDDamped:
+            {
+                // same as MathTools::getPseudoInverseDamped: J^+ = J^T (J J^T + lambda^2 I)^-1 = (J^T J + lambda^2 I)^-1 J^T
+                const float lambda = 1.0f;
+
+                if (nRows <= nDoF)
+                {
+                    a = jac.lazyProduct(jac.transpose());
+                    a.diagonal().array() += lambda * lambda;
+                    x = a.ldlt().solve(currentError);
+                    dTheta = jac.transpose().lazyProduct(x);
+                }
+                else
+                {
+                    a = jac.transpose().lazyProduct(jac);
+                    a.diagonal().array() += lambda * lambda;
+                    x = jac.transpose().lazyProduct(currentError);
+                    dTheta = a.ldlt().solve(x);
+                }
+
+                break;
+            }
+
+            case eSVD:
+            {
+                // same as MathTools::getPseudoInverse, but the result is directly applied to the error vector
+                const float pinvtoler = 0.00001f;
+
+                if (weighted)
+                {
+                    for (size_t i = 0; i < nDoF; i++)
+                    {
+                        THROW_VR_EXCEPTION_IF(jointWeights(i) <= 0.f, "joint weights cannot be negative or zero");
+                        jac.col(i) *= sqrtf(1.0f / jointWeights(i));
+                    }
+                }
+
+                Eigen::JacobiSVD<FixedSizeJacobian> svd(jac, Eigen::ComputeThinU | Eigen::ComputeThinV);
+                x = svd.matrixU().transpose() * currentError;
+
+                for (int i = 0; i < x.rows(); i++)
+                {
+                    if (svd.singularValues()(i) > pinvtoler)
+                    {
+                        x(i) /= svd.singularValues()(i);
+                    }
+                    else
+                    {
+                        x(i) = 0;
+                    }
+                }
+
+                dTheta = svd.matrixV() * x;
+
+                if (weighted)
+                {
+                    for (size_t i = 0; i < nDoF; i++)
+                    {
+                        dTheta(i) *= sqrtf(1.0f / jointWeights(i));
+                    }
+                }
+
+                break;
+            }
+
+            default:
+                return false;
+        }
+
+        return true;
+    }
+
+    const std::vector<bool>& DifferentialIK::getJointMask(const RobotNodePtr& tcpRN)
+    {
+        std::map< RobotNodePtr, std::vector<bool> >::iterator it = jointMasks.find(tcpRN);
+
+        if (it != jointMasks.end())
+        {
+            return it->second;
+        }
+
+        if (parents.find(tcpRN) == parents.end())
+        {
+            parents[tcpRN] = tcpRN->getAllParents(rns);
+            parents[tcpRN].push_back(tcpRN);
+        }
+
+        const std::vector<RobotNodePtr>& p = parents[tcpRN];
+        std::vector<bool>& mask = jointMasks[tcpRN];
+        mask.resize(nodes.size());
+
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            mask[i] = (find(p.begin(), p.end(), nodes[i]) != p.end());
+        }
+
+        return mask;
+    }
+
     float DifferentialIK::getErrorPosition(SceneObjectPtr tcp)
     {
         if (modes[tcp] == IKSolver::Orientation)
@@ -725,8 +876,8 @@ namespace VirtualRobot
             tcp = getDefaultTCP();
         }
 
-        Matrix4f orientation = this->targets[tcp] * tcp->getGlobalPose().inverse();
-        AngleAxis<float> aa(orientation.block<3, 3>(0, 0));
+        Matrix3f orientation = this->targets[tcp].block<3, 3>(0, 0) * tcp->getGlobalPose().block<3, 3>(0, 0).transpose();
+        AngleAxis<float> aa(orientation);
         return aa.angle();
     }
 
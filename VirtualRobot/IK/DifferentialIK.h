@@ -110,6 +110,17 @@ namespace VirtualRobot
     public:
         EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
+        /*!
+            Small problems (up to MaxFixedSizeDoF joints and MaxFixedSizeRows rows, i.e. two TCPs with full 6D goals) are solved
+            in computeStep() with compile-time sized matrices, which avoids dynamic memory allocations.
+            In this case the pseudo inverse is not built explicitly: With eSVDDamped and eTranspose the linear system is solved via a LDLT decomposition.
+        */
+        enum
+        {
+            MaxFixedSizeDoF = 12,
+            MaxFixedSizeRows = 12
+        };
+
         /*!
             @brief Initialize a Jacobian object.
             \param rns The robotNodes (i.e., joints) for which the Jacobians should be calculated.
@@ -289,6 +300,27 @@ namespace VirtualRobot
     protected:
         virtual void setNRows();
 
+        typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MaxFixedSizeRows, MaxFixedSizeDoF> FixedSizeJacobian;
+        typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, MaxFixedSizeDoF, MaxFixedSizeDoF> FixedSizeSquareMatrix;
+        typedef Eigen::Matrix<float, Eigen::Dynamic, 1, Eigen::ColMajor, MaxFixedSizeDoF, 1> FixedSizeVector;
+
+        /*!
+            Computes the joint deltas from currentJacobian and currentError with fixed size matrices.
+            Returns false if the problem is too large or the inverse method is not supported, dTheta is not touched in this case.
+        */
+        bool updateStepFixedSize(Eigen::VectorXf& dTheta);
+
+        //! Entry i is set if the pose of tcpRN depends on nodes[i]. The mask is computed on first access.
+        const std::vector<bool>& getJointMask(const RobotNodePtr& tcpRN);
+
+        enum JointType
+        {
+            eFixedJoint,
+            eRevoluteJoint,
+            ePrismaticJoint,
+            eUnknownJoint
+        };
+
         float invParam;
         std::vector<SceneObjectPtr> tcp_set;
         RobotNodePtr coordSystem;
@@ -309,6 +341,9 @@ namespace VirtualRobot
 
         std::vector <RobotNodePtr> nodes;
         std::map< RobotNodePtr, std::vector<RobotNodePtr> > parents;
+        std::map< RobotNodePtr, std::vector<bool> > jointMasks;
+        std::vector<JointType> jointTypes;
+        std::vector<Eigen::Vector3f> jointAxes; //!< rotation axis or translation direction in the joint's coordinate system
 
         Eigen::VectorXf currentError;
         Eigen::MatrixXf currentJacobian;
@@ -316,7 +351,7 @@ namespace VirtualRobot
 
 
         // temporary variables
-        Eigen::Matrix4f tmpDeltaOrientation;
+        Eigen::Matrix3f tmpDeltaOrientation;
         Eigen::AngleAxis<float> tmpDeltaAA;
 
         Eigen::VectorXf tmpUpdateErrorDelta;
@@ -12,6 +12,11 @@
 #include "../CollisionDetection/CDManager.h"
 
 #include <algorithm>
+#include <sstream>
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/random/mersenne_twister.hpp>
 
 using namespace Eigen;
 
@@ -22,6 +27,7 @@ namespace VirtualRobot
         IKSolver(rns)
     {
         this->invJacMethod = invJacMethod;
+        nrParallelTries = 0;
         _init();
     }
 
@@ -70,6 +76,258 @@ namespace VirtualRobot
         return false;
     }
 
+    struct GenericIKSolver::SolveParallelState
+    {
+        boost::mutex mutex;
+        int nextTry;
+        int maxLoops;
+        unsigned int seed;
+        std::vector<float> startConfig;
+        bool stopAtFirstSolution;
+        bool canceled;
+        bool useDeadline;
+        boost::posix_time::ptime deadline;
+        std::vector< std::pair<int, std::vector<float> > > solutions; //!< the index of the try and the joint values, in the order they were found
+    };
+
+    bool GenericIKSolver::solveParallel(const Eigen::Matrix4f& globalPose, CartesianSelection selection, int maxLoops, unsigned int numThreads, unsigned int seed,
+                                        float timeBudgetMS, std::vector< std::vector<float> >* storeSolutions, float minSolutionDistance)
+    {
+        nrParallelTries = 0;
+
+        if (storeSolutions)
+        {
+            storeSolutions->clear();
+        }
+
+        if (!checkReachable(globalPose))
+        {
+            return false;
+        }
+
+        if (maxLoops < 1)
+        {
+            maxLoops = 1;
+        }
+
+        if (numThreads == 0)
+        {
+            numThreads = std::max(1u, boost::thread::hardware_concurrency());
+        }
+
+        numThreads = std::min(numThreads, (unsigned int)maxLoops);
+
+        RobotPtr robot = rns->getRobot();
+        THROW_VR_EXCEPTION_IF(!robot || !tcp, "IK solver not initialized");
+
+        SolveParallelState state;
+        state.nextTry = 0;
+        state.maxLoops = maxLoops;
+        state.seed = seed;
+        rns->getJointValues(state.startConfig);
+        state.stopAtFirstSolution = (storeSolutions == NULL);
+        state.canceled = false;
+        state.useDeadline = (timeBudgetMS > 0);
+        state.deadline = boost::posix_time::microsec_clock::universal_time() + boost::posix_time::microseconds((long)(timeBudgetMS * 1000.0f));
+
+        // setup the workers: the cloning reads the original robot, so this is done sequentially
+        std::vector<SolveThreadData> threadData(numThreads);
+
+        for (unsigned int t = 0; t < numThreads; t++)
+        {
+            SolveThreadData& d = threadData[t];
+            CollisionCheckerPtr colChecker(new CollisionChecker());
+            std::stringstream ss;
+            ss << robot->getName() << "_ik_thread_" << t;
+            d.robot = robot->clone(ss.str(), colChecker);
+            d.robot->setUpdateVisualization(false);
+
+            if (d.robot->hasRobotNodeSet(rns->getName()))
+            {
+                d.rns = d.robot->getRobotNodeSet(rns->getName());
+            }
+            else
+            {
+                d.rns = rns->clone(d.robot);
+            }
+
+            RobotNodePtr tcpClone = d.robot->getRobotNode(tcp->getName());
+            THROW_VR_EXCEPTION_IF(!tcpClone, "Could not clone TCP node " << tcp->getName());
+            RobotNodePtr coordSystemClone;
+
+            if (coordSystem)
+            {
+                coordSystemClone = d.robot->getRobotNode(coordSystem->getName());
+                THROW_VR_EXCEPTION_IF(!coordSystemClone, "Could not clone coordinate system " << coordSystem->getName());
+            }
+
+            d.jacobian.reset(new DifferentialIK(d.rns, coordSystemClone, invJacMethod));
+            d.jacobian->setGoal(globalPose, tcpClone, selection, maxErrorPositionMM, maxErrorOrientationRad);
+            d.jacobian->checkImprovements(true);
+
+            if (translationalJoint)
+            {
+                d.translationalJoint = d.robot->getRobotNode(translationalJoint->getName());
+            }
+
+            if (cdm)
+            {
+                std::map<RobotPtr, RobotPtr> robotMapping;
+                robotMapping[robot] = d.robot;
+                d.cdm = cdm->clone(colChecker, robotMapping);
+            }
+
+            d.error = false;
+        }
+
+        boost::thread_group threads;
+
+        for (unsigned int t = 0; t < numThreads; t++)
+        {
+            threads.create_thread(boost::bind(&GenericIKSolver::solveParallelThread, this, &threadData[t], &state));
+        }
+
+        threads.join_all();
+        nrParallelTries = state.nextTry;
+
+        for (unsigned int t = 0; t < numThreads; t++)
+        {
+            THROW_VR_EXCEPTION_IF(threadData[t].error, "Error while solving IK in worker thread " << t << ": " << threadData[t].errorMessage);
+        }
+
+        if (state.solutions.size() == 0)
+        {
+            return false;
+        }
+
+        if (!storeSolutions)
+        {
+            rns->setJointValues(state.solutions[0].second);
+            return true;
+        }
+
+        // the result does not depend on the thread scheduling (unless the time budget was exceeded)
+        std::sort(state.solutions.begin(), state.solutions.end());
+
+        for (size_t i = 0; i < state.solutions.size(); i++)
+        {
+            const std::vector<float>& c = state.solutions[i].second;
+            bool distinct = true;
+
+            for (size_t j = 0; j < storeSolutions->size() && distinct; j++)
+            {
+                float dist = 0;
+
+                for (size_t k = 0; k < c.size(); k++)
+                {
+                    dist += (c[k] - (*storeSolutions)[j][k]) * (c[k] - (*storeSolutions)[j][k]);
+                }
+
+                distinct = (sqrtf(dist) > minSolutionDistance);
+            }
+
+            if (distinct)
+            {
+                storeSolutions->push_back(c);
+            }
+        }
+
+        rns->setJointValues((*storeSolutions)[0]);
+        return true;
+    }
+
+    void GenericIKSolver::solveParallelThread(SolveThreadData* threadData, SolveParallelState* state)
+    {
+        VR_ASSERT(threadData && state);
+
+        try
+        {
+            const double randMult = 1.0 / (double)(boost::mt19937::max)();
+            std::vector<float> jv(threadData->rns->getSize());
+
+            while (true)
+            {
+                int tryIndex;
+
+                {
+                    boost::mutex::scoped_lock lock(state->mutex);
+
+                    if (state->canceled || state->nextTry >= state->maxLoops ||
+                        (state->useDeadline && boost::posix_time::microsec_clock::universal_time() > state->deadline))
+                    {
+                        break;
+                    }
+
+                    tryIndex = state->nextTry++;
+                }
+
+                // first try: start with current joint angles
+                if (tryIndex == 0)
+                {
+                    jv = state->startConfig;
+                    threadData->robot->setJointValues(threadData->rns, jv);
+                }
+                else
+                {
+                    boost::mt19937 generator(state->seed + (unsigned int)tryIndex);
+
+                    for (unsigned int i = 0; i < threadData->rns->getSize(); i++)
+                    {
+                        RobotNodePtr ro = threadData->rns->getNode(i);
+                        float r = (float)((double)generator() * randMult);
+                        jv[i] = ro->getJointLimitLo() + (ro->getJointLimitHi() - ro->getJointLimitLo()) * r;
+                    }
+
+                    threadData->robot->setJointValues(threadData->rns, jv);
+
+                    if (threadData->translationalJoint)
+                    {
+                        threadData->translationalJoint->setJointValue(initialTranslationalJointValue);
+                    }
+                }
+
+                if (!threadData->jacobian->solveIK(jacobianStepSize, 0.0, jacobianMaxLoops))
+                {
+                    continue;
+                }
+
+                if (threadData->cdm && threadData->cdm->isInCollision())
+                {
+                    continue;
+                }
+
+                threadData->rns->getJointValues(jv);
+                boost::mutex::scoped_lock lock(state->mutex);
+                state->solutions.push_back(std::make_pair(tryIndex, jv));
+
+                if (state->stopAtFirstSolution)
+                {
+                    state->canceled = true;
+                }
+            }
+        }
+        catch (VirtualRobotException& e)
+        {
+            threadData->error = true;
+            threadData->errorMessage = e.what();
+        }
+        catch (std::exception& e)
+        {
+            threadData->error = true;
+            threadData->errorMessage = e.what();
+        }
+        catch (...)
+        {
+            threadData->error = true;
+            threadData->errorMessage = "unknown exception";
+        }
+    }
+
+    int GenericIKSolver::getNrOfParallelTries() const
+    {
+        return nrParallelTries;
+    }
+
     VirtualRobot::GraspPtr GenericIKSolver::solve(ManipulationObjectPtr object, CartesianSelection selection /*= All*/, int maxLoops)
     {
         return IKSolver::solve(object, selection, maxLoops);
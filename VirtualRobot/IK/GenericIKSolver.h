@@ -28,6 +28,8 @@
 #include "DifferentialIK.h"
 #include "../ManipulationObject.h"
 
+#include <string>
+
 namespace VirtualRobot
 {
 
@@ -52,6 +54,32 @@ namespace VirtualRobot
         */
         virtual bool solve(const Eigen::Matrix4f& globalPose, CartesianSelection selection = All, int maxLoops = 1);
 
+        /*!
+            Multi-start IK solving with multiple threads.
+            Each worker thread operates on its own clone of the robot and of the collision detection setup (\see CDManager::clone) and performs
+            independent tries. The first try starts at the current configuration, all others at random configurations.
+            The random start configuration of a try only depends on seed and the index of the try.
+            The first collision-free solution cancels all remaining tries, unless storeSolutions is given: In this case the search continues until
+            all tries are done (or the time budget is exceeded) and all distinct solutions are reported.
+            The worker IK solvers use the settings of this solver (inverse Jacobi method, step size, max errors, translational joint).
+            Since the robot and the collision models are cloned on each call, the parallel mode pays off for many tries (e.g. 50-200 restarts).
+            \param globalPose The target pose given in global coordinate system.
+            \param selection Select the parts of the global pose that should be used for IK solving.
+            \param maxLoops The total number of tries.
+            \param numThreads The number of worker threads. If 0, the number of hardware threads is used.
+            \param seed The seed for the random start configurations.
+            \param timeBudgetMS If > 0, no further tries are started after this time (in milliseconds).
+            \param storeSolutions If given, all distinct solutions are stored (ordered by the index of the try that found them).
+            \param minSolutionDistance Two solutions are distinct if the euclidean distance of their joint values exceeds this value.
+            \return true on success. In this case, the joints of the RobotNodeSet are set to the first solution
+                    (the first one found or, if storeSolutions is given, the first one of storeSolutions). Otherwise the joints are not changed.
+        */
+        virtual bool solveParallel(const Eigen::Matrix4f& globalPose, CartesianSelection selection = All, int maxLoops = 100, unsigned int numThreads = 0, unsigned int seed = 0,
+                                   float timeBudgetMS = 0.0f, std::vector< std::vector<float> >* storeSolutions = NULL, float minSolutionDistance = 0.1f);
+
+        //! The number of tries that were started by the last call of solveParallel() (less than maxLoops, if the search was canceled or the time budget was exceeded).
+        int getNrOfParallelTries() const;
+
         /*!
             This method solves the IK up to the specified max error. On success, the joints of the the corresponding RobotNodeSet are set to the IK solution.
             \param object The grasps of this object are checked if the stored TCP is identical with teh TCP of teh current RobotNodeSet, and the an IK solution for one of remaining grasps is searched.
@@ -83,12 +111,32 @@ namespace VirtualRobot
         bool trySolve();
         void setJointsRandom();
 
+        //! Data of one worker thread of solveParallel()
+        struct SolveThreadData
+        {
+            RobotPtr robot;
+            RobotNodeSetPtr rns;
+            DifferentialIKPtr jacobian;
+            CDManagerPtr cdm;
+            RobotNodePtr translationalJoint;
+            bool error;
+            std::string errorMessage; //!< what() of the exception that stopped the thread (if error is set)
+        };
+
+        //! The state that is shared by the worker threads of solveParallel() (defined in GenericIKSolver.cpp)
+        struct SolveParallelState;
+
+        //! Thread method of solveParallel(). Performs tries until all tries are done or the search is canceled.
+        void solveParallelThread(SolveThreadData* threadData, SolveParallelState* state);
+
         DifferentialIKPtr jacobian;
         float jacobianStepSize;
         int jacobianMaxLoops;
 
         RobotNodePtr translationalJoint;
         float initialTranslationalJointValue;
+
+        int nrParallelTries;
     };
 
     typedef boost::shared_ptr<GenericIKSolver> GenericIKSolverPtr;
@@ -4,6 +4,7 @@
 #include <Eigen/Geometry>
 #include <Eigen/Dense>
 #include <float.h>
+#include <algorithm>
 
 
 
@@ -24,7 +25,6 @@ namespace VirtualRobot
         obstacle_beta = 1.0f;
 
         joints = rns->getAllRobotNodes();
-        tmpJac.resize(6, joints.size());
     }
 
     PoseQualityExtendedManipulability::~PoseQualityExtendedManipulability()
@@ -43,9 +43,11 @@ namespace VirtualRobot
 
     float PoseQualityExtendedManipulability::getPoseQuality(DifferentialIKPtr jac, RobotNodeSetPtr rns, PoseQualityManipulability::ManipulabilityIndexType i, int considerFirstSV)
     {
-        //extManipData d;
-        currentManipData.reset();
-        if (!getDetailedAnalysis(jac, rns, currentManipData, considerFirstSV))
+        // only the quality values are needed
+        extManipData d;
+        d.storeDecompositions = false;
+
+        if (!getDetailedAnalysis(jac, rns, d, considerFirstSV))
         {
             VR_ERROR << "ERROR" << endl;
             return 0;
@@ -55,13 +57,13 @@ namespace VirtualRobot
         {
             case eMultiplySV:
             {
-                return currentManipData.extManip_Volume;
+                return d.extManip_Volume;
             }
             break;
 
             case eMinMaxRatio:
             {
-                return currentManipData.extManip_InvCondNumber;
+                return d.extManip_InvCondNumber;
             }
             break;
 
@@ -376,10 +378,82 @@ namespace VirtualRobot
 
     bool PoseQualityExtendedManipulability::getDetailedAnalysis(DifferentialIKPtr jac, RobotNodeSetPtr rns, extManipData& storeData, bool (&dims)[6], int considerFirstSV)
     {
-        jac->updateJacobianMatrix(tmpJac, rns->getTCP(), IKSolver::All);
+        Eigen::MatrixXf j(6, joints.size());
+        jac->updateJacobianMatrix(j, rns->getTCP(), IKSolver::All);
 
-        //Eigen::MatrixXf j = jac->getJacobianMatrix(rns->getTCP());
-        return getDetailedAnalysis(tmpJac, joints, storeData, dims, considerFirstSV);
+        return getDetailedAnalysis(j, joints, storeData, dims, considerFirstSV);
+    }
+
+    void PoseQualityExtendedManipulability::evaluateSingularValues(const float* sv, int nrSV, int considerFirstSV, float& storeVolume, float& storeInvCondNumber, float& storeMinSV, float& storeMaxSV)
+    {
+        float tmpRes = 0;
+
+        // volume
+        if (nrSV >= 1)
+        {
+            tmpRes = sv[0] * sv[0];
+
+            for (int j = 1; j < considerFirstSV; j++)
+            {
+                tmpRes *= sv[j] * sv[j];
+            }
+
+            tmpRes = sqrtf(tmpRes);
+        }
+
+        if (tmpRes < storeVolume)
+        {
+            storeVolume = tmpRes;
+        }
+
+        // cond numb
+        if (nrSV >= 2)
+        {
+            float minSV_loc = FLT_MAX;
+            float maxSV_loc = 0.0f;
+
+            for (int j = 0; j < considerFirstSV; j++)
+            {
+                if (sv[j] < storeMinSV)
+                {
+                    storeMinSV = sv[j];
+                }
+
+                if (sv[j] > storeMaxSV)
+                {
+                    storeMaxSV = sv[j];
+                }
+
+                if (sv[j] < minSV_loc)
+                {
+                    minSV_loc = sv[j];
+                }
+
+                if (sv[j] > maxSV_loc)
+                {
+                    maxSV_loc = sv[j];
+                }
+            }
+
+            if (maxSV_loc != 0)
+            {
+                tmpRes = minSV_loc / maxSV_loc;
+            }
+            else
+            {
+                tmpRes = 0;
+            }
+
+            if (tmpRes < storeInvCondNumber)
+            {
+                storeInvCondNumber = tmpRes;
+
+                if (verbose)
+                {
+                    cout << "## -> minSV: " << minSV_loc << ", maxSV:" << maxSV_loc << endl;
+                }
+            }
+        }
     }
 
     bool PoseQualityExtendedManipulability::getDetailedAnalysis(const Eigen::MatrixXf& jac, const std::vector<RobotNodePtr>& joints, extManipData& storeData, bool (&dims)[6], int considerFirstSV)
@@ -398,7 +472,6 @@ namespace VirtualRobot
             getObstaclePenalizations(joints, obstacleDir, storeData.jac, storeData.penObstLo, storeData.penObstHi);
         }
 
-        //bool verbose = false;
         if (verbose)
         {
             cout << "considerFirstSV=" << considerFirstSV << endl;
@@ -406,37 +479,45 @@ namespace VirtualRobot
             MathTools::printMat(storeData.jac);
         }
 
-        for (int i = 0; i < 64; i++)
+        // The penalization of an entry only depends on the sign of the Cartesian direction of its row (and on the sign of the entry).
+        // Hence, each row of a penalized Jacobian is one of two variants and the 64 hyperoctants only differ in the selection of these variants.
+        // cartDimPermutations[0] covers the positive, cartDimPermutations[63] the negative directions.
+        Matrix6Xf jacPenPos;
+        Matrix6Xf jacPenNeg;
+
+        if (considerObstacle)
         {
-            if (considerObstacle)
-            {
-                storeData.jacPen[i] = getJacobianWeightedObstacles(storeData.jac, cartDimPermutations[i], storeData.penLo, storeData.penHi, storeData.penObstLo, storeData.penObstHi);
-            }
-            else
-            {
-                storeData.jacPen[i] = getJacobianWeighted(storeData.jac, cartDimPermutations[i], storeData.penLo, storeData.penHi);
-            }
+            jacPenPos = getJacobianWeightedObstacles(storeData.jac, cartDimPermutations[0], storeData.penLo, storeData.penHi, storeData.penObstLo, storeData.penObstHi);
+            jacPenNeg = getJacobianWeightedObstacles(storeData.jac, cartDimPermutations[63], storeData.penLo, storeData.penHi, storeData.penObstLo, storeData.penObstHi);
+        }
+        else
+        {
+            jacPenPos = getJacobianWeighted(storeData.jac, cartDimPermutations[0], storeData.penLo, storeData.penHi);
+            jacPenNeg = getJacobianWeighted(storeData.jac, cartDimPermutations[63], storeData.penLo, storeData.penHi);
+        }
+
+        // only the considered rows which differ in both directions have to be permuted
+        int permutedRows[6];
+        int nrPermutedRows = 0;
 
-            for (int j = 0; j < 6; j++)
+        for (int j = 0; j < 6; j++)
+        {
+            if (!dims[j])
             {
-                if (!dims[j])
-                {
-                    storeData.jacPen[i].block(j, 0, 1, storeData.jacPen[i].cols()).setConstant(0);
-                }
+                jacPenPos.row(j).setZero();
+                jacPenNeg.row(j).setZero();
             }
-
-            if (verbose && i < 4)
+            else if (jacPenPos.row(j) != jacPenNeg.row(j))
             {
-                cout << "JAC PEN:" << i << endl;
-                MathTools::printMat(storeData.jacPen[i]);
+                permutedRows[nrPermutedRows++] = j;
             }
-
-            analyzeJacobian(storeData.jacPen[i], storeData.sv[i], storeData.singVectors[i], storeData.U[i], storeData.V[i], (verbose && i < 4));
         }
 
-        if (considerFirstSV <= 0 || considerFirstSV > storeData.sv[0].rows())
+        int nrSV = std::min(6, storeData.nrJoints);
+
+        if (considerFirstSV <= 0 || considerFirstSV > nrSV)
         {
-            considerFirstSV = storeData.sv[0].rows();
+            considerFirstSV = nrSV;
         }
 
         storeData.consideFirstSV = considerFirstSV;
@@ -445,84 +526,97 @@ namespace VirtualRobot
         float minSV = FLT_MAX;
         float maxSV = 0.0f;
 
-        for (int k = 0; k < 64; k++)
+        if (storeData.storeDecompositions)
         {
-            Eigen::VectorXf sv = storeData.sv[k];//.block(0,k,svAll.rows(),1);
-            //cout << "k: sv:";
-            //VirtualRobot::MathTools::print(sv);
-            float tmpRes = 0;
-
-            // volume
-            if (sv.rows() >= 1)
+            for (int i = 0; i < 64; i++)
             {
-                tmpRes = sv(0) * sv(0);
+                // hyperoctants which only differ in rows that are not permuted share the penalized Jacobian
+                int representative = 0;
 
-                for (int j = 1; j < considerFirstSV; j++)
+                for (int k = 0; k < nrPermutedRows; k++)
                 {
-                    tmpRes *= sv(j) * sv(j);
+                    representative |= i & (1 << permutedRows[k]);
                 }
 
-                tmpRes = sqrtf(tmpRes);
-            }
-
-            if (tmpRes < result_v)
-            {
-                result_v = tmpRes;
-            }
-
-            //cout << "## k:" << k << " -> tmpRes: " << tmpRes << ", result:" << result << endl;
+                if (representative != i)
+                {
+                    // representative < i, hence it has already been analyzed
+                    storeData.jacPen[i] = storeData.jacPen[representative];
+                    storeData.sv[i] = storeData.sv[representative];
+                    storeData.singVectors[i] = storeData.singVectors[representative];
+                    storeData.U[i] = storeData.U[representative];
+                    storeData.V[i] = storeData.V[representative];
+                    continue;
+                }
 
-            // cond numb
-            if (sv.rows() >= 2)
-            {
-                float minSV_loc = FLT_MAX;
-                float maxSV_loc = 0.0f;
+                storeData.jacPen[i] = jacPenPos;
 
-                for (int j = 0; j < considerFirstSV; j++)
+                for (int k = 0; k < nrPermutedRows; k++)
                 {
-                    if (sv(j) < minSV)
+                    if (i & (1 << permutedRows[k]))
                     {
-                        minSV = sv(j);
+                        storeData.jacPen[i].row(permutedRows[k]) = jacPenNeg.row(permutedRows[k]);
                     }
+                }
 
-                    if (sv(j) > maxSV)
-                    {
-                        maxSV = sv(j);
-                    }
+                if (verbose && i < 4)
+                {
+                    cout << "JAC PEN:" << i << endl;
+                    MathTools::printMat(storeData.jacPen[i]);
+                }
 
-                    if (sv(j) < minSV_loc)
-                    {
-                        minSV_loc = sv(j);
-                    }
+                analyzeJacobian(storeData.jacPen[i], storeData.sv[i], storeData.singVectors[i], storeData.U[i], storeData.V[i], (verbose && i < 4));
+                evaluateSingularValues(storeData.sv[i].data(), storeData.sv[i].rows(), considerFirstSV, result_v, result_c, minSV, maxSV);
+            }
+        }
+        else
+        {
+            // The singular values of J_pen are the square roots of the eigenvalues of J_pen * J_pen^T.
+            // For all combinations, these 6x6 matrices can be assembled from the products of the row variants.
+            Eigen::Matrix<double, 12, Eigen::Dynamic> rowVariants(12, storeData.nrJoints);
+            rowVariants.topRows<6>() = jacPenPos.cast<double>();
+            rowVariants.bottomRows<6>() = jacPenNeg.cast<double>();
+            Eigen::Matrix<double, 12, 12> rowProducts = rowVariants * rowVariants.transpose();
 
-                    if (sv(j) > maxSV_loc)
-                    {
-                        maxSV_loc = sv(j);
-                    }
-                }
+            Eigen::Matrix<double, 6, 6> jjt;
+            Eigen::SelfAdjointEigenSolver< Eigen::Matrix<double, 6, 6> > eigenSolver;
+            int rowIndex[6];
+            float sv[6];
 
-                if (maxSV_loc != 0)
+            for (int c = 0; c < (1 << nrPermutedRows); c++)
+            {
+                for (int j = 0; j < 6; j++)
                 {
-                    tmpRes = minSV_loc / maxSV_loc;
+                    rowIndex[j] = j;
                 }
-                else
+
+                for (int k = 0; k < nrPermutedRows; k++)
                 {
-                    tmpRes = 0;
+                    if (c & (1 << k))
+                    {
+                        rowIndex[permutedRows[k]] += 6;
+                    }
                 }
 
-                if (tmpRes < result_c)
+                for (int a = 0; a < 6; a++)
                 {
-                    result_c = tmpRes;
-
-                    if (verbose)
+                    for (int b = 0; b < 6; b++)
                     {
-                        cout << "## k:" << k << " -> minSV: " << minSV_loc << ", maxSV:" << maxSV_loc << endl;
-                        cout << "## pen jac:\n" << endl;
-                        MathTools::printMat(storeData.jacPen[k]);
+                        jjt(a, b) = rowProducts(rowIndex[a], rowIndex[b]);
                     }
                 }
-            }
 
+                eigenSolver.compute(jjt, Eigen::EigenvaluesOnly);
+
+                // eigenvalues are sorted in increasing order
+                for (int j = 0; j < nrSV; j++)
+                {
+                    double ev = eigenSolver.eigenvalues()(5 - j);
+                    sv[j] = ev > 0 ? (float)sqrt(ev) : 0.0f;
+                }
+
+                evaluateSingularValues(sv, nrSV, considerFirstSV, result_v, result_c, minSV, maxSV);
+            }
         }
 
         storeData.extManip_InvCondNumber = result_c;
@@ -658,6 +752,22 @@ namespace VirtualRobot
         return true;
     }
 
+    PoseQualityMeasurementPtr PoseQualityExtendedManipulability::clone(RobotPtr newRobot)
+    {
+        PoseQualityExtendedManipulabilityPtr m(new PoseQualityExtendedManipulability(getCorrespondingRNS(newRobot), manipulabilityType));
+        m->considerObstacle = considerObstacle;
+        m->obstacleDir = obstacleDir;
+        m->obstacle_alpha = obstacle_alpha;
+        m->obstacle_beta = obstacle_beta;
+        m->verbose = verbose;
+        m->penJointLimits = penJointLimits;
+        m->penJointLimits_k = penJointLimits_k;
+        m->penalizeRotationFactor = penalizeRotationFactor;
+        m->convertMMtoM = convertMMtoM;
+        m->jacobian->convertModelScalingtoM(convertMMtoM);
+        return m;
+    }
+
     float PoseQualityExtendedManipulability::getManipulability(const Eigen::VectorXf& direction, int considerFirstSV)
     {
         VR_ASSERT(direction.rows() == 3 || direction.rows() == 6);
@@ -749,74 +859,11 @@ namespace VirtualRobot
         float result_c = FLT_MAX;
         float minSV = FLT_MAX;
         float maxSV = 0.0f;
-        float tmpRes = 0;
-
-        // volume
-        if (sv.rows() >= 1)
-        {
-            tmpRes = sv(0) * sv(0);
-
-            for (int j = 1; j < considerFirstSV; j++)
-            {
-                tmpRes *= sv(j) * sv(j);
-            }
-
-            tmpRes = sqrtf(tmpRes);
-        }
-
-        if (tmpRes < result_v)
-        {
-            result_v = tmpRes;
-        }
+        evaluateSingularValues(sv.data(), sv.rows(), considerFirstSV, result_v, result_c, minSV, maxSV);
 
-        // cond numb
-        if (sv.rows() >= 2)
+        if (verbose)
         {
-            float minSV_loc = FLT_MAX;
-            float maxSV_loc = 0.0f;
-
-            for (int j = 0; j < considerFirstSV; j++)
-            {
-                if (sv(j) < minSV)
-                {
-                    minSV = sv(j);
-                }
-
-                if (sv(j) > maxSV)
-                {
-                    maxSV = sv(j);
-                }
-
-                if (sv(j) < minSV_loc)
-                {
-                    minSV_loc = sv(j);
-                }
-
-                if (sv(j) > maxSV_loc)
-                {
-                    maxSV_loc = sv(j);
-                }
-            }
-
-            if (maxSV_loc != 0)
-            {
-                tmpRes = minSV_loc / maxSV_loc;
-            }
-            else
-            {
-                tmpRes = 0;
-            }
-
-            if (tmpRes < result_c)
-            {
-                result_c = tmpRes;
-
-                if (verbose)
-                {
-                    cout << "##  -> minSV: " << minSV_loc << ", maxSV:" << maxSV_loc << endl;
-                    cout << "## pen jac:\n" << jacPen << endl;
-                }
-            }
+            cout << "## pen jac:\n" << jacPen << endl;
         }
 
         return result * result_c;
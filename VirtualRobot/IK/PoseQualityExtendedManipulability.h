@@ -42,7 +42,13 @@ namespace VirtualRobot
         year = {2012}
         }
 
-        For performance reasons this class is not thread safe and cannot be used from different threads in parallel.
+        The penalized Jacobian is analyzed for all 2^6 hyperoctants of the Cartesian space. Since the penalization of a row only depends on the
+        sign of the corresponding Cartesian direction, only rows that differ in both directions have to be permuted. The singular values of these
+        combinations are computed from the 6x6 matrices J_pen * J_pen^T, which are assembled from precomputed row products.
+        The full decompositions of all hyperoctants are only computed, if requested via extManipData::storeDecompositions.
+
+        An instance must not be used by multiple threads in parallel, since it operates on the joint values of its robot.
+        In order to evaluate the quality in parallel, each thread has to use its own robot and measure (\see clone()).
     */
     class VIRTUAL_ROBOT_IMPORT_EXPORT PoseQualityExtendedManipulability :  public VirtualRobot::PoseQualityManipulability
     {
@@ -69,11 +75,13 @@ namespace VirtualRobot
         virtual float getPoseQuality(const Eigen::VectorXf& direction);
         virtual float getManipulability(const Eigen::VectorXf& direction, int considerFirstSV = -1);
 
+        virtual PoseQualityMeasurementPtr clone(RobotPtr newRobot);
 
         struct extManipData
         {
             extManipData()
             {
+                storeDecompositions = true;
                 reset();
             }
             void reset()
@@ -86,6 +94,10 @@ namespace VirtualRobot
                 nrJoints = -1;
                 consideFirstSV = -1;
             }
+            // If set, the SVD results and penalized Jacobians of all hyperoctants are stored (hyperoctants with identical penalized Jacobians share the results).
+            // Otherwise only the resulting quality values are computed, which is considerably faster.
+            bool storeDecompositions;
+
             // 2^6 = 64
             // for each hyperoctant, the SVD result is stored
             Eigen::MatrixXf U[64];
@@ -138,6 +150,7 @@ namespace VirtualRobot
 
 
     protected:
+        typedef Eigen::Matrix<float, 6, Eigen::Dynamic> Matrix6Xf;
 
         bool getDetailedAnalysis(DifferentialIKPtr jacobian, RobotNodeSetPtr rns, extManipData& storeData, int considerFirstSV = 0);
         bool getDetailedAnalysis(DifferentialIKPtr jacobian, RobotNodeSetPtr rns, extManipData& storeData, bool (&dims)[6], int considerFirstSV = 0);
@@ -175,12 +188,16 @@ namespace VirtualRobot
         void getObstaclePenalizations(const std::vector<RobotNodePtr>& joints, const Eigen::Vector3f& obstVect, const Eigen::MatrixXf& jac, Eigen::MatrixXf& penObstLo, Eigen::MatrixXf& penObstHi);
         Eigen::MatrixXf getJacobianWeightedObstacles(const Eigen::MatrixXf& jac, const std::vector<float>& directionVect, const Eigen::VectorXf& penLo, const Eigen::VectorXf& penHi, const Eigen::MatrixXf& penObstLo, const Eigen::MatrixXf& penObstHi);
 
+        /*!
+            Evaluates the first nrSV entries of the (descending) singular values sv. The volume and the inverted condition number are stored
+            if they are smaller than the current values of storeVolume and storeInvCondNumber. minSV and maxSV are updated accordingly.
+        */
+        void evaluateSingularValues(const float* sv, int nrSV, int considerFirstSV, float& storeVolume, float& storeInvCondNumber, float& storeMinSV, float& storeMaxSV);
+
         std::vector< std::vector<float> > cartDimPermutations;
 
         float obstacle_alpha, obstacle_beta;
 
-        extManipData currentManipData;
-        Eigen::MatrixXf tmpJac;
         std::vector<RobotNodePtr> joints;
     };
 
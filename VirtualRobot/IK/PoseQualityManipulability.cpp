@@ -11,7 +11,7 @@ namespace VirtualRobot
 
 
     PoseQualityManipulability::PoseQualityManipulability(VirtualRobot::RobotNodeSetPtr rns, ManipulabilityIndexType i)
-        : PoseQualityMeasurement(rns), manipulabilityType(i), penJointLimits(false), convertMMtoM(true)
+        : PoseQualityMeasurement(rns), manipulabilityType(i), penJointLimits(false), penJointLimits_k(50.0f), convertMMtoM(true)
     {
         name = getTypeName();
         jacobian.reset(new VirtualRobot::DifferentialIK(rns, rns->getTCP()));
@@ -239,4 +239,18 @@ namespace VirtualRobot
         return penJointLimits;
     }
 
+    PoseQualityMeasurementPtr PoseQualityManipulability::clone(RobotPtr newRobot)
+    {
+        boost::shared_ptr<PoseQualityManipulability> m(new PoseQualityManipulability(getCorrespondingRNS(newRobot), manipulabilityType));
+        m->considerObstacle = considerObstacle;
+        m->obstacleDir = obstacleDir;
+        m->verbose = verbose;
+        m->penJointLimits = penJointLimits;
+        m->penJointLimits_k = penJointLimits_k;
+        m->penalizeRotationFactor = penalizeRotationFactor;
+        m->convertMMtoM = convertMMtoM;
+        m->jacobian->convertModelScalingtoM(convertMMtoM);
+        return m;
+    }
+
 }
@@ -97,6 +97,8 @@ namespace VirtualRobot
 
         virtual bool consideringJointLimits();
 
+        virtual PoseQualityMeasurementPtr clone(RobotPtr newRobot);
+
         static std::string getTypeName();
     protected:
 
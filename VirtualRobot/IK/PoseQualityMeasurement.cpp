@@ -68,4 +68,22 @@ namespace VirtualRobot
         considerObstacle = false;
     }
 
+    RobotNodeSetPtr PoseQualityMeasurement::getCorrespondingRNS(RobotPtr newRobot)
+    {
+        THROW_VR_EXCEPTION_IF(!newRobot, "NULL robot");
+
+        if (newRobot->hasRobotNodeSet(rns->getName()))
+        {
+            return newRobot->getRobotNodeSet(rns->getName());
+        }
+
+        return rns->clone(newRobot);
+    }
+
+    PoseQualityMeasurementPtr PoseQualityMeasurement::clone(RobotPtr newRobot)
+    {
+        // derived measures that do not implement clone() must not be replaced by this base class
+        return PoseQualityMeasurementPtr();
+    }
+
 }
@@ -85,7 +85,18 @@ namespace VirtualRobot
         virtual void setObstacleDistanceVector(const Eigen::Vector3f& directionSurfaceToObstance);
         virtual void disableObstacleDistance();
 
+        /*!
+            Creates a copy of this measure (with all parameters) that operates on the corresponding RobotNodeSet of newRobot.
+            Since a measure modifies internal data (and queries the joint values of its robot), it must not be used by multiple threads in parallel.
+            Instead, each thread should operate on its own clone of the robot and the measure.
+            \return An empty pointer, if the measure can not be cloned (standard). Derived classes have to implement this method in order to support cloning.
+        */
+        virtual PoseQualityMeasurementPtr clone(RobotPtr newRobot);
+
     protected:
+        //! Returns the RobotNodeSet of newRobot with the same name as rns. If not present, rns is cloned.
+        RobotNodeSetPtr getCorrespondingRNS(RobotPtr newRobot);
+
         std::string name;
         VirtualRobot::RobotNodeSetPtr rns;
 
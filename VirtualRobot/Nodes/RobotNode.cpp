@@ -4,6 +4,7 @@
 #include "../VirtualRobotException.h"
 #include "../Robot.h"
 #include "../RobotNodeSet.h"
+#include "../CompiledKinematics.h"
 #include "../Visualization/VisualizationFactory.h"
 #include "../Visualization/Visualization.h"
 #include "../Visualization/TriMeshModel.h"
@@ -51,6 +52,7 @@ namespace VirtualRobot
         optionalDHParameter.isSet = false;
         //globalPosePostJoint = Eigen::Matrix4f::Identity();
         jointValue = 0.0f;
+        poseDirty = true;
     }
 
 
@@ -178,6 +180,12 @@ namespace VirtualRobot
             q = jointLimitHi;
         }
 
+        if (q != jointValue)
+        {
+            // the poses of this node and its subtree have to be updated
+            poseDirty = true;
+        }
+
         jointValue = q;
     }
 
@@ -215,12 +223,97 @@ namespace VirtualRobot
     {
         THROW_VR_EXCEPTION_IF(!initialized, "Not initialized");
 
+        if (updateChildren)
+        {
+            RobotPtr r = robot.lock();
+            CompiledKinematicsPtr ck;
+
+            if (r)
+            {
+                ck = r->getCompiledKinematics();
+            }
+
+            if (ck)
+            {
+                // flat update of this subtree
+                ck->update(boost::static_pointer_cast<RobotNode>(shared_from_this()));
+                return;
+            }
+        }
+
         updateTransformationMatrices();
 
+        if (updateChildren)
+        {
+            poseDirty = false;
+        }
+
         // update collision and visualization model and children
         SceneObject::updatePose(updateChildren);
 
-        // apply propagated joint values
+        applyPropagatedJointValues();
+    }
+
+    void RobotNode::updatePoseIncremental()
+    {
+        THROW_VR_EXCEPTION_IF(!initialized, "Not initialized");
+
+        RobotPtr r = robot.lock();
+        CompiledKinematicsPtr ck;
+
+        if (r)
+        {
+            ck = r->getCompiledKinematics();
+        }
+
+        if (ck)
+        {
+            ck->updateIncremental(boost::static_pointer_cast<RobotNode>(shared_from_this()));
+            return;
+        }
+
+        Eigen::Matrix4f oldPose = globalPose;
+        updateTransformationMatrices();
+
+        if (poseDirty || globalPose != oldPose)
+        {
+            // the pose of this node has changed, update the whole subtree
+            poseDirty = false;
+            SceneObject::updatePose(true);
+        }
+        else
+        {
+            updateChildrenIncremental();
+        }
+
+        applyPropagatedJointValues();
+    }
+
+    void RobotNode::updateChildrenIncremental()
+    {
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            // other children (e.g. sensors) only depend on the pose of this node, which has not changed
+            RobotNodePtr rn = dynamic_pointer_cast<RobotNode>(children[i]);
+
+            if (!rn)
+            {
+                continue;
+            }
+
+            if (rn->poseDirty)
+            {
+                rn->updatePose(globalPose, true);
+            }
+            else
+            {
+                rn->updateChildrenIncremental();
+            }
+        }
+    }
+
+    void RobotNode::applyPropagatedJointValues()
+    {
         if (propagatedJointValues.size() > 0)
         {
             RobotPtr r = robot.lock();
@@ -250,6 +343,11 @@ namespace VirtualRobot
 
         updateTransformationMatrices(globalPose);
 
+        if (updateChildren)
+        {
+            poseDirty = false;
+        }
+
         // update collision and visualization model and children
         SceneObject::updatePose(updateChildren);
     }
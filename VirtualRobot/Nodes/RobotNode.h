@@ -64,6 +64,7 @@ namespace VirtualRobot
         friend class RobotFactory;
         friend class RobotNodeActuator;
         friend class ColladaIO;
+        friend class CompiledKinematics;
 
         EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -288,6 +289,14 @@ namespace VirtualRobot
         */
         virtual void updatePose(bool updateChildren = true);
 
+        /*!
+            Update the transformations of this joint and of all child joints whose joint values have been changed
+            since the last update (e.g. via RobotNodeSet::setJointValues).
+            Subtrees without modified joints are skipped, i.e. their poses and the poses of their collision and visualization models are not touched.
+            The result is equal to updatePose(true), as long as the kinematic structure is only modified via joint values.
+        */
+        virtual void updatePoseIncremental();
+
 
         /*!
             Automatically propagate the joint value to another joint.
@@ -333,6 +342,12 @@ namespace VirtualRobot
         */
         virtual void updatePose(const Eigen::Matrix4f& parentPose, bool updateChildren = true);
 
+        //! Updates all subtrees below this node which contain modified joints. The pose of this node is assumed to be up to date.
+        void updateChildrenIncremental();
+
+        //! Sets the joint values of all dependent joints (\see propagateJointValue)
+        void applyPropagatedJointValues();
+
 
         /*!
             Can be called by a RobotNodeActuator in order to set the pose of the visualization, which means that the preJointTransform is ignored and
@@ -370,6 +385,7 @@ namespace VirtualRobot
         std::vector<SensorPtr> sensors;
 
         float jointValue;                           //< The joint value
+        bool poseDirty;                             //< The joint value has been changed since the last pose update, i.e. the poses of this node and its subtree are outdated
 
         /*!
             Derived classes must implement their clone method here.
@@ -42,6 +42,7 @@ namespace VirtualRobot
     {
     public:
         friend class RobotFactory;
+        friend class CompiledKinematics;
 
         EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
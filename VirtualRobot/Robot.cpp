@@ -2,6 +2,7 @@
 #include "Robot.h"
 #include "RobotConfig.h"
 #include "Trajectory.h"
+#include "CompiledKinematics.h"
 #include "VirtualRobotException.h"
 #include "CollisionDetection/CollisionChecker.h"
 #include "EndEffector/EndEffector.h"
@@ -409,6 +410,13 @@ namespace VirtualRobot
     void Robot::applyJointValues()
     {
         WriteLock(mutex, use_mutex);
+
+        if (compiledKinematics)
+        {
+            compiledKinematics->update();
+            return;
+        }
+
         this->getRootNode()->updatePose(this->getGlobalPose());
     }
 
@@ -417,6 +425,12 @@ namespace VirtualRobot
      */
     void Robot::applyJointValuesNoLock()
     {
+        if (compiledKinematics)
+        {
+            compiledKinematics->update();
+            return;
+        }
+
         this->getRootNode()->updatePose(this->getGlobalPose());
     }
 
@@ -466,6 +480,11 @@ namespace VirtualRobot
             (*iterator)->setUpdateVisualization(enable);
             ++iterator;
         }
+
+        if (compiledKinematics)
+        {
+            compiledKinematics->setUpdateVisualization(enable);
+        }
     }
 
     bool Robot::getUpdateVisualizationStatus()
@@ -473,6 +492,37 @@ namespace VirtualRobot
         return updateVisualization;
     }
 
+    void Robot::setLazyPoseUpdates(bool enable)
+    {
+        SceneObject::setLazyPoseUpdates(enable);
+
+        std::vector<RobotNodePtr> robotNodes = this->getRobotNodes();
+
+        for (size_t i = 0; i < robotNodes.size(); i++)
+        {
+            robotNodes[i]->setLazyPoseUpdates(enable);
+        }
+    }
+
+    void Robot::setUseCompiledKinematics(bool enable)
+    {
+        WriteLockPtr lock = getWriteLock();
+
+        if (enable)
+        {
+            compiledKinematics.reset(new CompiledKinematics(shared_from_this()));
+        }
+        else
+        {
+            compiledKinematics.reset();
+        }
+    }
+
+    CompiledKinematicsPtr Robot::getCompiledKinematics()
+    {
+        return compiledKinematics;
+    }
+
     RobotNodeSetPtr LocalRobot::getRobotNodeSet(const std::string& nodeSetName)
     {
         if (robotNodeSetMap.find(nodeSetName) == robotNodeSetMap.end())
@@ -132,6 +132,26 @@ namespace VirtualRobot
         void setUpdateVisualization(bool enable);
         bool getUpdateVisualizationStatus();
 
+        /*!
+            Enables/Disables lazy pose updates of the collision and visualization models of all robot nodes (\see SceneObject::setLazyPoseUpdates).
+            When enabled, the model poses are only updated when they are accessed, e.g. by a collision check.
+            Since Coin3D scene graphs are not updated until the visualization is queried again, this option should only be enabled when no viewer is attached.
+            The deferred update is done by the (otherwise read-only) model accessors, so the robot must not be accessed by several threads concurrently.
+        */
+        void setLazyPoseUpdates(bool enable);
+
+        /*!
+            Enables/Disables the compiled forward kinematics (\see CompiledKinematics).
+            When enabled, the poses of the robot nodes are updated by a flat, non-recursive implementation, which is considerably faster
+            than the standard update. Visualization updates follow the current visualization update status of the robot (\see setUpdateVisualization),
+            they can be disabled completely via getCompiledKinematics()->setUpdateVisualization(false).
+            The kinematic structure is compiled when enabling this option, hence it has to be enabled again after changing the structure of the robot.
+        */
+        void setUseCompiledKinematics(bool enable);
+
+        //! Returns the compiled kinematics, or an empty pointer if the compiled kinematics are not used.
+        CompiledKinematicsPtr getCompiledKinematics();
+
         boost::shared_ptr<Robot> shared_from_this()
         {
             return boost::static_pointer_cast<Robot>(SceneObject::shared_from_this());
@@ -394,6 +414,8 @@ namespace VirtualRobot
 
         bool updateVisualization;
 
+        CompiledKinematicsPtr compiledKinematics;
+
         boost::recursive_mutex mutex;
         bool use_mutex;
 
@@ -369,7 +369,7 @@ namespace VirtualRobot
 
         if (kinematicRoot)
         {
-            kinematicRoot->updatePose();
+            kinematicRoot->updatePoseIncremental();
         }
         else
         {
@@ -392,7 +392,7 @@ namespace VirtualRobot
 
         if (kinematicRoot)
         {
-            kinematicRoot->updatePose();
+            kinematicRoot->updatePoseIncremental();
         }
         else
         {
@@ -417,7 +417,7 @@ namespace VirtualRobot
 
         if (kinematicRoot)
         {
-            kinematicRoot->updatePose();
+            kinematicRoot->updatePoseIncremental();
         }
         else
         {
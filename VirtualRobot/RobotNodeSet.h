@@ -112,6 +112,7 @@ namespace VirtualRobot
         /*!
             Set joint values [rad].
             The subpart of the robot, defined by the start joint (kinematicRoot) of rns, is updated to apply the new joint values.
+            Only the subtrees of joints whose values have actually changed are updated (\see RobotNode::updatePoseIncremental).
             \param jointValues A vector with joint values, size must be equal to number of joints in this RobotNodeSet.
         */
         void setJointValues(const std::vector<float>& jointValues);
@@ -27,6 +27,8 @@ namespace VirtualRobot
         this->globalPose = Eigen::Matrix4f::Identity();
         this->initialized = false;
         updateVisualization = true;
+        lazyPoseUpdates = false;
+        modelPosesDirty = false;
 
         if (visualization)
         {
@@ -118,14 +120,14 @@ namespace VirtualRobot
 
     void SceneObject::updatePose(bool updateChildren)
     {
-        if (visualizationModel)
+        if (lazyPoseUpdates)
         {
-            visualizationModel->setGlobalPose(globalPose);
+            // the models are updated on first access
+            modelPosesDirty = true;
         }
-
-        if (collisionModel)
+        else
         {
-            collisionModel->setGlobalPose(globalPose);
+            updateModelPoses();
         }
 
         if (updateChildren)
@@ -146,8 +148,28 @@ namespace VirtualRobot
         return name;
     }
 
+    void SceneObject::updateModelPoses()
+    {
+        if (visualizationModel)
+        {
+            visualizationModel->setGlobalPose(globalPose);
+        }
+
+        if (collisionModel)
+        {
+            collisionModel->setGlobalPose(globalPose);
+        }
+
+        modelPosesDirty = false;
+    }
+
     VirtualRobot::CollisionModelPtr SceneObject::getCollisionModel()
     {
+        if (modelPosesDirty)
+        {
+            updateModelPoses();
+        }
+
         return collisionModel;
     }
 
@@ -158,6 +180,11 @@ namespace VirtualRobot
 
     VirtualRobot::VisualizationNodePtr SceneObject::getVisualization(SceneObject::VisualizationType visuType)
     {
+        if (modelPosesDirty)
+        {
+            updateModelPoses();
+        }
+
         if (visuType == SceneObject::Full)
         {
             return visualizationModel;
@@ -485,6 +512,21 @@ namespace VirtualRobot
         return updateVisualization;
     }
 
+    void SceneObject::setLazyPoseUpdates(bool enable)
+    {
+        lazyPoseUpdates = enable;
+
+        if (!enable && modelPosesDirty)
+        {
+            updateModelPoses();
+        }
+    }
+
+    bool SceneObject::getLazyPoseUpdatesStatus()
+    {
+        return lazyPoseUpdates;
+    }
+
     void SceneObject::setVisualization(VisualizationNodePtr visualization)
     {
         visualizationModel = visualization;
@@ -624,6 +666,12 @@ namespace VirtualRobot
 
     bool SceneObject::initializePhysics()
     {
+        // the CoM computations rely on the poses of the models
+        if (modelPosesDirty)
+        {
+            updateModelPoses();
+        }
+
         // check if physics node's CoM location has to be calculated
         if (physics.comLocation == SceneObject::Physics::eVisuBBoxCenter)
         {
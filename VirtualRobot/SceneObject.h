@@ -42,6 +42,7 @@ namespace VirtualRobot
 
     class VIRTUAL_ROBOT_IMPORT_EXPORT SceneObject : public boost::enable_shared_from_this<SceneObject>
     {
+        friend class CompiledKinematics;
     public:
         EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -266,6 +267,18 @@ namespace VirtualRobot
         void setUpdateVisualization(bool enable);
         bool getUpdateVisualizationStatus();
 
+        /*!
+            Enables/Disables lazy updates of the collision and visualization model poses.
+            When enabled, pose updates only mark the models as outdated, their global poses are set on the next access via
+            getCollisionModel() or getVisualization(). This saves time when many pose updates are performed without looking at the models
+            (e.g. sampling based planning, where only few configurations are checked for collisions).
+            Note, that a visualization which is already part of a scene graph is not updated until it is queried again.
+            Note, that in lazy mode getCollisionModel() and getVisualization() modify the models, hence concurrent calls on the same object
+            (e.g. collision checks of one robot in several threads) are not thread safe. Use one clone per thread instead.
+        */
+        void setLazyPoseUpdates(bool enable);
+        bool getLazyPoseUpdatesStatus();
+
         /*!
             Setup the visualization of this object.
             \param showVisualization If false, the visualization is disabled.
@@ -486,12 +499,14 @@ namespace VirtualRobot
 
         virtual void updatePose(const Eigen::Matrix4f& parentPose, bool updateChildren = true);
 
+        //! Sets the global pose of the collision and visualization model.
+        void updateModelPoses();
 
 
         std::string getFilenameReplacementVisuModel(const std::string standardExtension = ".wrl");
         std::string getFilenameReplacementColModel(const std::string standardExtension = ".wrl");
 
-        SceneObject() {}
+        SceneObject() : lazyPoseUpdates(false), modelPosesDirty(false) {}
 
         //! basic data, used by Obstacle and ManipulationObject
         std::string getSceneObjectXMLString(const std::string& basePath, int tabs);
@@ -510,6 +525,8 @@ namespace VirtualRobot
         VisualizationNodePtr visualizationModel;                                //< This is the main visualization
 
         bool updateVisualization;
+        bool lazyPoseUpdates;                                                   //< Update the poses of the models on first access
+        bool modelPosesDirty;                                                   //< The poses of the models are outdated
 
         virtual bool initializePhysics();
         Physics physics;
@@ -184,6 +184,7 @@ namespace VirtualRobot
     class RobotNodeFactory;
     class RobotNodeSet;
     class KinematicChain;
+    class CompiledKinematics;
     class Robot;
     class EndEffector;
     class EndEffectorActor;
@@ -202,6 +203,7 @@ namespace VirtualRobot
     class GraspSet;
     class ManipulationObject;
     class CDManager;
+    class AllowedCollisionMatrix;
     class Reachability;
     class WorkspaceRepresentation;
     class WorkspaceData;
@@ -212,6 +214,8 @@ namespace VirtualRobot
     class BasicGraspQualityMeasure;
     class WorkspaceGrid;
     class WorkspaceDataArray;
+    class WorkspaceDataMapped;
+    class WorkspaceDataSparse;
     class ForceTorqueSensor;
     class ContactSensor;
 
@@ -227,6 +231,7 @@ namespace VirtualRobot
     typedef boost::shared_ptr<RobotNodeRevolute> RobotNodeRevolutePtr;
     typedef boost::shared_ptr<RobotNodeSet> RobotNodeSetPtr;
     typedef boost::shared_ptr<KinematicChain> KinematicChainPtr;
+    typedef boost::shared_ptr<CompiledKinematics> CompiledKinematicsPtr;
     typedef boost::weak_ptr<RobotNode> RobotNodeWeakPtr;
     typedef boost::shared_ptr<RobotNodeFactory> RobotNodeFactoryPtr;
     typedef boost::shared_ptr<Robot> RobotPtr;
@@ -245,6 +250,8 @@ namespace VirtualRobot
     typedef boost::shared_ptr<VisualizationFactory> VisualizationFactoryPtr;
     typedef boost::shared_ptr<WorkspaceData> WorkspaceDataPtr;
     typedef boost::shared_ptr<WorkspaceDataArray> WorkspaceDataArrayPtr;
+    typedef boost::shared_ptr<WorkspaceDataMapped> WorkspaceDataMappedPtr;
+    typedef boost::shared_ptr<WorkspaceDataSparse> WorkspaceDataSparsePtr;
     typedef boost::shared_ptr<WorkspaceRepresentation> WorkspaceRepresentationPtr;
     typedef boost::shared_ptr<Reachability> ReachabilityPtr;
     typedef boost::shared_ptr<Scene> ScenePtr;
@@ -253,6 +260,7 @@ namespace VirtualRobot
     typedef boost::shared_ptr<GraspSet> GraspSetPtr;
     typedef boost::shared_ptr<ManipulationObject> ManipulationObjectPtr;
     typedef boost::shared_ptr<CDManager> CDManagerPtr;
+    typedef boost::shared_ptr<AllowedCollisionMatrix> AllowedCollisionMatrixPtr;
     typedef boost::shared_ptr<PoseQualityMeasurement> PoseQualityMeasurementPtr;
     typedef boost::shared_ptr<PoseQualityManipulability> PoseQualityManipulabilityPtr;
     typedef boost::shared_ptr<Trajectory> TrajectoryPtr;
@@ -32,6 +32,11 @@ namespace VirtualRobot
 
 
     void Manipulability::addPose(const Eigen::Matrix4f& pose)
+    {
+        addPose(pose, NULL);
+    }
+
+    void Manipulability::addPose(const Eigen::Matrix4f& pose, const float* manipulability)
     {
         Eigen::Matrix4f p = pose;
         toLocal(p);
@@ -60,7 +65,7 @@ namespace VirtualRobot
 
         if (getVoxelFromPose(x, v))
         {
-            float m = getCurrentManipulability();
+            float m = manipulability ? *manipulability : getCurrentManipulability();
             float mSc = m / maxManip;
 
             if (mSc > 1)
@@ -95,20 +100,94 @@ namespace VirtualRobot
         buildUpLoops++;
     }
 
-    float Manipulability::getCurrentManipulability()
+    void Manipulability::addSampledTCPPose(const Eigen::Matrix4f& tcpPoseGlobal, const Eigen::VectorXf& config, const float* value)
     {
+        if (value)
+        {
+            addPose(tcpPoseGlobal, value);
+            return;
+        }
+
+        nodeSet->setJointValues(config);
+        addPose(tcpNode->getGlobalPose());
+    }
+
+    void Manipulability::setupSampleThread(SampleThreadData& sampleData)
+    {
+        if (threadMeasures.size() <= sampleData.threadIndex)
+        {
+            threadMeasures.resize(sampleData.threadIndex + 1);
+        }
+
+        ThreadMeasure& t = threadMeasures[sampleData.threadIndex];
+        t = ThreadMeasure();
+
         if (!measure)
         {
-            return 0.0f;
+            return;
         }
 
         if (considerSelfDist && selfDistStatic && selfDistDynamic)
+        {
+            if (!sampleData.robot->hasRobotNodeSet(selfDistStatic->getName()) || !sampleData.robot->hasRobotNodeSet(selfDistDynamic->getName()))
+            {
+                // the self distance models cannot be cloned: evaluate sequentially
+                return;
+            }
+
+            t.selfDistStatic = sampleData.robot->getRobotNodeSet(selfDistStatic->getName());
+            t.selfDistDynamic = sampleData.robot->getRobotNodeSet(selfDistDynamic->getName());
+        }
+
+        // an empty clone (e.g. a custom measure that does not implement clone()) results in a sequential evaluation
+        t.measure = measure->clone(sampleData.robot);
+        t.tcpNode = t.measure ? sampleData.tcpNode : RobotNodePtr();
+    }
+
+    bool Manipulability::evaluateSampledTCPPose(SampleThreadData& sampleData, float& storeValue)
+    {
+        if (sampleData.threadIndex >= threadMeasures.size() || !threadMeasures[sampleData.threadIndex].measure)
+        {
+            return false;
+        }
+
+        ThreadMeasure& t = threadMeasures[sampleData.threadIndex];
+        storeValue = getCurrentManipulability(t.measure, t.tcpNode, t.selfDistStatic, t.selfDistDynamic);
+        return true;
+    }
+
+    void Manipulability::releaseSampleThread(SampleThreadData& sampleData)
+    {
+        if (sampleData.threadIndex < threadMeasures.size())
+        {
+            threadMeasures[sampleData.threadIndex] = ThreadMeasure();
+        }
+    }
+
+    float Manipulability::getCurrentManipulability()
+    {
+        if (considerSelfDist)
+        {
+            return getCurrentManipulability(measure, tcpNode, selfDistStatic, selfDistDynamic);
+        }
+
+        return getCurrentManipulability(measure, tcpNode, RobotNodeSetPtr(), RobotNodeSetPtr());
+    }
+
+    float Manipulability::getCurrentManipulability(PoseQualityMeasurementPtr m, RobotNodePtr tcp, RobotNodeSetPtr distStatic, RobotNodeSetPtr distDynamic)
+    {
+        if (!m)
+        {
+            return 0.0f;
+        }
+
+        if (distStatic && distDynamic)
         {
             int id1;
             int id2;
             Eigen::Vector3f p1;
             Eigen::Vector3f p2;
-            float d = selfDistStatic->getCollisionChecker()->calculateDistance(selfDistStatic, selfDistDynamic, p1, p2, &id1, &id2);
+            float d = distStatic->getCollisionChecker()->calculateDistance(distStatic, distDynamic, p1, p2, &id1, &id2);
             //cout << "#### dist:" << d << ", ";
             Eigen::Matrix4f obstDistPos1 = Eigen::Matrix4f::Identity();
             Eigen::Matrix4f obstDistPos2 = Eigen::Matrix4f::Identity();
@@ -116,11 +195,11 @@ namespace VirtualRobot
             obstDistPos2.block(0, 3, 3, 1) = p2;
 
             // transform to tcp
-            Eigen::Matrix4f p1_tcp = tcpNode->toLocalCoordinateSystem(obstDistPos1);
-            Eigen::Matrix4f p2_tcp = tcpNode->toLocalCoordinateSystem(obstDistPos2);
+            Eigen::Matrix4f p1_tcp = tcp->toLocalCoordinateSystem(obstDistPos1);
+            Eigen::Matrix4f p2_tcp = tcp->toLocalCoordinateSystem(obstDistPos2);
             Eigen::Vector3f minDistVector = p1_tcp.block(0, 3, 3, 1) - p2_tcp.block(0, 3, 3, 1);
 
-            measure->setObstacleDistanceVector(minDistVector);
+            m->setObstacleDistanceVector(minDistVector);
 
         }
 
@@ -129,9 +208,9 @@ namespace VirtualRobot
         Eigen::VectorXf p(6);
         p.setZero();
         p(2) = 1.0f;
-        return measure->getPoseQuality(p);
+        return m->getPoseQuality(p);
 #endif
-        return measure->getPoseQuality();
+        return m->getPoseQuality();
     }
 
     bool Manipulability::customStringRead(std::ifstream& file, std::string& res)
@@ -644,6 +723,8 @@ namespace VirtualRobot
         res->setOrientationType(this->orientationType);
         res->versionMajor = this->versionMajor;
         res->versionMinor = this->versionMinor;
+        res->blockCacheSize = this->blockCacheSize;
+        res->useSparseData = this->useSparseData;
         res->nodeSet = this->nodeSet;
         res->type = this->type;
 
@@ -169,7 +169,42 @@ namespace VirtualRobot
 
 
         float getCurrentManipulability();
+
+        /*!
+            Computes the manipulability of the current configuration with m. If self distances are considered, the distance between
+            the (cloned) self distance models is used.
+        */
+        float getCurrentManipulability(PoseQualityMeasurementPtr m, RobotNodePtr tcp, RobotNodeSetPtr distStatic, RobotNodeSetPtr distDynamic);
+
         void addPose(const Eigen::Matrix4f& p);
+
+        //! Adds the pose with the given manipulability. If manipulability is NULL, the manipulability of the current configuration is computed.
+        void addPose(const Eigen::Matrix4f& p, const float* manipulability);
+
+        /*!
+            If the manipulability was computed within the worker thread, it is used directly.
+            Otherwise the manipulability is computed with the robot, so the configuration is applied before the pose is added.
+        */
+        virtual void addSampledTCPPose(const Eigen::Matrix4f& tcpPoseGlobal, const Eigen::VectorXf& config, const float* value);
+
+        /*!
+            Each worker thread gets its own copy of the measure (and of the self distance models), which operates on the cloned robot.
+            If the measure can not be cloned (\see PoseQualityMeasurement::clone), the samples are evaluated sequentially.
+        */
+        virtual void setupSampleThread(SampleThreadData& sampleData);
+        virtual bool evaluateSampledTCPPose(SampleThreadData& sampleData, float& storeValue);
+        virtual void releaseSampleThread(SampleThreadData& sampleData);
+
+        //! The data that is used by a worker thread of addRandomTCPPosesMultiThreaded() in order to compute the manipulability
+        struct ThreadMeasure
+        {
+            PoseQualityMeasurementPtr measure;
+            RobotNodePtr tcpNode;
+            RobotNodeSetPtr selfDistStatic;
+            RobotNodeSetPtr selfDistDynamic;
+        };
+        std::vector<ThreadMeasure> threadMeasures;
+
         PoseQualityMeasurementPtr measure;
 
         float maxManip;
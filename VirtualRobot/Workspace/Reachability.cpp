@@ -82,6 +82,8 @@ namespace VirtualRobot
         res->setOrientationType(this->orientationType);
         res->versionMajor = this->versionMajor;
         res->versionMinor = this->versionMinor;
+        res->blockCacheSize = this->blockCacheSize;
+        res->useSparseData = this->useSparseData;
         res->nodeSet = this->nodeSet;
         res->type = this->type;
 
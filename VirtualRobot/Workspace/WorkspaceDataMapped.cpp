@@ -0,0 +1,713 @@
+#include "WorkspaceDataMapped.h"
+#include "../VirtualRobotException.h"
+#include "../XML/FileIO.h"
+#include "../Compression/CompressionRLE.h"
+#include "../Compression/CompressionBZip2.h"
+
+#include <cstring>
+#include <vector>
+#include <limits.h>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace VirtualRobot
+{
+
+    namespace
+    {
+        // header of the data section: sizeTr (uint32), sizeRot (uint32), end of data section (uint64)
+        const uint64_t headerSize = 16;
+        // index entry: offset (uint64), size (uint32), encoding (uint32)
+        const uint64_t indexEntrySize = 16;
+        // uncompressed blocks are aligned in the file (and hence in the mapped memory)
+        const uint64_t blockAlignment = 16;
+    }
+
+    struct WorkspaceDataMapped::MappedFile
+    {
+        MappedFile(const std::string& filename)
+            : mapping(filename.c_str(), boost::interprocess::read_only),
+              region(mapping, boost::interprocess::read_only)
+        {
+            data = static_cast<const unsigned char*>(region.get_address());
+            size = (uint64_t)region.get_size();
+        }
+
+        boost::interprocess::file_mapping mapping;
+        boost::interprocess::mapped_region region;
+        const unsigned char* data;
+        uint64_t size;
+    };
+
+    WorkspaceDataMapped::WorkspaceDataMapped(const std::string& filename, uint64_t dataOffset,
+            unsigned int size1, unsigned int size2, unsigned int size3,
+            unsigned int size4, unsigned int size5, unsigned int size6,
+            unsigned int maxCachedBlocks, bool adjustOnOverflow)
+    {
+        init(size1, size2, size3, size4, size5, size6);
+
+        try
+        {
+            mappedFile.reset(new MappedFile(filename));
+        }
+        catch (const std::exception& e)
+        {
+            THROW_VR_EXCEPTION("Could not map file " << filename << ": " << e.what());
+        }
+
+        THROW_VR_EXCEPTION_IF(dataOffset + headerSize > mappedFile->size, "Bad file format, data section out of bounds.");
+
+        const unsigned char* header = mappedFile->data + dataOffset;
+        uint32_t storedSizeTr, storedSizeRot;
+        memcpy(&storedSizeTr, header, sizeof(uint32_t));
+        memcpy(&storedSizeRot, header + 4, sizeof(uint32_t));
+        memcpy(&dataEnd, header + 8, sizeof(uint64_t));
+
+        THROW_VR_EXCEPTION_IF(storedSizeTr != getSizeTr() || storedSizeRot != getSizeRot(), "Bad file format, size of data section does not match.");
+        THROW_VR_EXCEPTION_IF(dataEnd > mappedFile->size || dataOffset + headerSize + (uint64_t)storedSizeTr * indexEntrySize > dataEnd, "Bad file format, block index out of bounds.");
+
+        index = header + headerSize;
+        this->maxCachedBlocks = maxCachedBlocks > 0 ? maxCachedBlocks : 1;
+        this->adjustOnOverflow = adjustOnOverflow;
+    }
+
+    WorkspaceDataMapped::WorkspaceDataMapped(WorkspaceDataMapped* other)
+    {
+        VR_ASSERT(other);
+        init(other->sizes[0], other->sizes[1], other->sizes[2], other->sizes[3], other->sizes[4], other->sizes[5]);
+
+        mappedFile = other->mappedFile;
+        index = other->index;
+        dataEnd = other->dataEnd;
+        maxCachedBlocks = other->maxCachedBlocks;
+
+        for (std::map<unsigned int, unsigned char*>::iterator it = other->modifiedBlocks.begin(); it != other->modifiedBlocks.end(); it++)
+        {
+            unsigned char* block = new unsigned char[getSizeRot()];
+            memcpy(block, it->second, getSizeRot() * sizeof(unsigned char));
+            modifiedBlocks[it->first] = block;
+        }
+
+        minValidValue = other->minValidValue;
+        maxEntry = other->maxEntry;
+        voxelFilledCount = other->voxelFilledCount;
+        adjustOnOverflow = other->adjustOnOverflow;
+    }
+
+    WorkspaceDataMapped::~WorkspaceDataMapped()
+    {
+        clear();
+    }
+
+    void WorkspaceDataMapped::init(unsigned int size1, unsigned int size2, unsigned int size3,
+                                   unsigned int size4, unsigned int size5, unsigned int size6)
+    {
+        sizes[0] = size1;
+        sizes[1] = size2;
+        sizes[2] = size3;
+        sizes[3] = size4;
+        sizes[4] = size5;
+        sizes[5] = size6;
+        sizeTr0 = sizes[1] * sizes[2];
+        sizeTr1 = sizes[2];
+        sizeRot0 = sizes[4] * sizes[5];
+        sizeRot1 = sizes[5];
+
+        unsigned long long sizeTr = (unsigned long long)size1 * (unsigned long long)size2 * (unsigned long long)size3;
+        unsigned long long sizeRot = (unsigned long long)size4 * (unsigned long long)size5 * (unsigned long long)size6;
+        THROW_VR_EXCEPTION_IF(sizeRot > UINT_MAX || sizeTr > UINT_MAX, "Size of workspace data exceeds UINT_MAX");
+
+        index = NULL;
+        dataEnd = 0;
+        maxCachedBlocks = 1;
+        minValidValue = 1;
+        maxEntry = 0;
+        voxelFilledCount = 0;
+        adjustOnOverflow = true;
+    }
+
+    bool WorkspaceDataMapped::saveBlockIndexed(std::ofstream& file, WorkspaceDataPtr data, bool compressBlocks)
+    {
+        THROW_VR_EXCEPTION_IF(!data, "NULL data");
+
+        uint32_t sizeTr = data->getSizeTr();
+        uint32_t sizeRot = data->getSizeRot();
+        uint64_t start = (uint64_t)file.tellp();
+
+        FileIO::write<uint32_t>(file, sizeTr);
+        FileIO::write<uint32_t>(file, sizeRot);
+        FileIO::write<uint64_t>(file, 0); // end of data section, written below
+
+        // reserve space for the index
+        for (uint32_t i = 0; i < sizeTr; i++)
+        {
+            FileIO::write<uint64_t>(file, 0);
+            FileIO::write<uint32_t>(file, 0);
+            FileIO::write<uint32_t>(file, eEmpty);
+        }
+
+        std::vector<uint64_t> offsets(sizeTr, 0);
+        std::vector<uint32_t> blockSizes(sizeTr, 0);
+        std::vector<uint32_t> encodings(sizeTr, eEmpty);
+        unsigned char* compressedData = new unsigned char[sizeRot * 3];
+        unsigned char padding[blockAlignment];
+        memset(padding, 0, blockAlignment);
+        uint32_t pos = 0;
+
+        for (unsigned int x = 0; x < data->getSize(0); x++)
+            for (unsigned int y = 0; y < data->getSize(1); y++)
+                for (unsigned int z = 0; z < data->getSize(2); z++, pos++)
+                {
+                    // empty blocks are not stored
+                    if (!data->hasEntry(x, y, z))
+                    {
+                        continue;
+                    }
+
+                    const unsigned char* block = data->getDataRot(x, y, z);
+                    bool empty = true;
+
+                    for (uint32_t i = 0; i < sizeRot; i++)
+                    {
+                        if (block[i] != 0)
+                        {
+                            empty = false;
+                            break;
+                        }
+                    }
+
+                    if (empty)
+                    {
+                        continue;
+                    }
+
+                    const unsigned char* blockData = block;
+                    uint32_t blockSize = sizeRot;
+                    uint32_t encoding = eUncompressed;
+
+                    if (compressBlocks)
+                    {
+                        int compressedSize = CompressionRLE::RLE_Compress(block, compressedData, sizeRot);
+
+                        if (compressedSize > 0 && (uint32_t)compressedSize < sizeRot)
+                        {
+                            blockData = compressedData;
+                            blockSize = (uint32_t)compressedSize;
+                            encoding = eRLE;
+                        }
+                    }
+
+                    uint64_t filePos = (uint64_t)file.tellp();
+                    uint64_t paddingSize = (blockAlignment - filePos % blockAlignment) % blockAlignment;
+                    FileIO::writeArray<unsigned char>(file, padding, (int)paddingSize);
+
+                    offsets[pos] = filePos + paddingSize;
+                    blockSizes[pos] = blockSize;
+                    encodings[pos] = encoding;
+                    FileIO::writeArray<unsigned char>(file, blockData, (int)blockSize);
+                }
+
+        delete[] compressedData;
+
+        // write index
+        uint64_t end = (uint64_t)file.tellp();
+        file.seekp((std::streamoff)(start + 8));
+        FileIO::write<uint64_t>(file, end);
+
+        for (uint32_t i = 0; i < sizeTr; i++)
+        {
+            FileIO::write<uint64_t>(file, offsets[i]);
+            FileIO::write<uint32_t>(file, blockSizes[i]);
+            FileIO::write<uint32_t>(file, encodings[i]);
+        }
+
+        file.seekp((std::streamoff)end);
+
+        if (!file.good())
+        {
+            VR_ERROR << "Error writing to file.." << endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    uint64_t WorkspaceDataMapped::getDataEnd() const
+    {
+        return dataEnd;
+    }
+
+    void WorkspaceDataMapped::setMaxCachedBlocks(unsigned int n)
+    {
+        boost::mutex::scoped_lock lock(cacheMutex);
+        maxCachedBlocks = n > 0 ? n : 1;
+
+        while (cachedBlocks.size() > maxCachedBlocks)
+        {
+            std::map<unsigned int, CachedBlock>::iterator it = cachedBlocks.find(lruList.back());
+            delete[] it->second.data;
+            cachedBlocks.erase(it);
+            lruList.pop_back();
+        }
+    }
+
+    unsigned int WorkspaceDataMapped::getMaxCachedBlocks() const
+    {
+        return maxCachedBlocks;
+    }
+
+    unsigned int WorkspaceDataMapped::getNrOfCachedBlocks()
+    {
+        boost::mutex::scoped_lock lock(cacheMutex);
+        return (unsigned int)cachedBlocks.size();
+    }
+
+    unsigned int WorkspaceDataMapped::getSizeTr() const
+    {
+        return sizes[0] * sizes[1] * sizes[2];
+    }
+
+    unsigned int WorkspaceDataMapped::getSizeRot() const
+    {
+        return sizes[3] * sizes[4] * sizes[5];
+    }
+
+    void WorkspaceDataMapped::getBlockInfo(unsigned int posTr, uint64_t& offset, uint32_t& size, uint32_t& encoding) const
+    {
+        if (!mappedFile)
+        {
+            encoding = eEmpty;
+            return;
+        }
+
+        const unsigned char* entry = index + (uint64_t)posTr * indexEntrySize;
+        memcpy(&offset, entry, sizeof(uint64_t));
+        memcpy(&size, entry + 8, sizeof(uint32_t));
+        memcpy(&encoding, entry + 12, sizeof(uint32_t));
+
+        if (encoding != eEmpty && (offset + size > dataEnd || (encoding == eUncompressed && size != getSizeRot()) || encoding > eRLE))
+        {
+            VR_ERROR << "Invalid data block " << posTr << ", skipping..." << endl;
+            encoding = eEmpty;
+        }
+    }
+
+    const unsigned char* WorkspaceDataMapped::getBlock(unsigned int posTr, boost::mutex::scoped_lock& lock)
+    {
+        uint64_t offset;
+        uint32_t size, encoding;
+        getBlockInfo(posTr, offset, size, encoding);
+
+        if (encoding == eEmpty)
+        {
+            return NULL;
+        }
+
+        if (encoding == eUncompressed)
+        {
+            return mappedFile->data + offset;
+        }
+
+        // only the cache of the decoded blocks is shared
+        lock.lock();
+        std::map<unsigned int, CachedBlock>::iterator it = cachedBlocks.find(posTr);
+
+        if (it != cachedBlocks.end())
+        {
+            lruList.splice(lruList.begin(), lruList, it->second.lruPosition);
+            return it->second.data;
+        }
+
+        // reuse the memory of the least recently used block
+        unsigned char* block = NULL;
+
+        if (cachedBlocks.size() >= maxCachedBlocks)
+        {
+            it = cachedBlocks.find(lruList.back());
+            block = it->second.data;
+            cachedBlocks.erase(it);
+            lruList.pop_back();
+        }
+        else
+        {
+            block = new unsigned char[getSizeRot()];
+        }
+
+        // the data is taken from the file, hence the decoder must not write beyond the block
+        if (CompressionRLE::RLE_Uncompress(mappedFile->data + offset, block, size, getSizeRot()) != (int)getSizeRot())
+        {
+            delete[] block;
+            THROW_VR_EXCEPTION("Bad file format, corrupt data block " << posTr);
+        }
+
+        lruList.push_front(posTr);
+        CachedBlock c;
+        c.data = block;
+        c.lruPosition = lruList.begin();
+        cachedBlocks[posTr] = c;
+        return block;
+    }
+
+    unsigned char* WorkspaceDataMapped::getModifiableBlock(unsigned int posTr)
+    {
+        std::map<unsigned int, unsigned char*>::iterator it = modifiedBlocks.find(posTr);
+
+        if (it != modifiedBlocks.end())
+        {
+            return it->second;
+        }
+
+        boost::mutex::scoped_lock lock(cacheMutex, boost::defer_lock);
+        const unsigned char* b = getBlock(posTr, lock);
+        unsigned char* block = new unsigned char[getSizeRot()];
+
+        if (b)
+        {
+            memcpy(block, b, getSizeRot() * sizeof(unsigned char));
+        }
+        else
+        {
+            memset(block, 0, getSizeRot() * sizeof(unsigned char));
+        }
+
+        modifiedBlocks[posTr] = block;
+        return block;
+    }
+
+    void WorkspaceDataMapped::setDatum(float x[6], unsigned char value, const WorkspaceRepresentation* workspace)
+    {
+        // get voxels
+        unsigned int v[6];
+
+        if (workspace->getVoxelFromPose(x, v))
+        {
+            setDatum(v, value);
+        }
+    }
+
+    void WorkspaceDataMapped::setDatum(unsigned int x0, unsigned int x1, unsigned int x2, unsigned int x3, unsigned int x4, unsigned int x5, unsigned char value)
+    {
+        unsigned int posTr = 0, posRot = 0;
+        getPos(x0, x1, x2, x3, x4, x5, posTr, posRot);
+        unsigned char* block = getModifiableBlock(posTr);
+
+        if (block[posRot] == 0)
+        {
+            voxelFilledCount++;
+        }
+
+        block[posRot] = value;
+
+        if (value >= maxEntry)
+        {
+            maxEntry = value;
+        }
+    }
+
+    void WorkspaceDataMapped::setDatum(unsigned int x[6], unsigned char value)
+    {
+        setDatum(x[0], x[1], x[2], x[3], x[4], x[5], value);
+    }
+
+    void WorkspaceDataMapped::setDatumCheckNeighbors(unsigned int x[6], unsigned char value, unsigned int neighborVoxels)
+    {
+        setDatum(x, value);
+
+        if (neighborVoxels == 0)
+        {
+            return;
+        }
+
+        int minX[6];
+        int maxX[6];
+
+        for (int i = 0; i < 6; i++)
+        {
+            minX[i] = x[i] - neighborVoxels;
+            maxX[i] = x[i] + neighborVoxels;
+
+            if (minX[i] < 0)
+            {
+                minX[i] = 0;
+            }
+
+            if (maxX[i] >= (int)sizes[i])
+            {
+                maxX[i] = sizes[i] - 1;
+            }
+        }
+
+        for (int a = minX[0]; a <= maxX[0]; a++)
+            for (int b = minX[1]; b <= maxX[1]; b++)
+                for (int c = minX[2]; c <= maxX[2]; c++)
+                    for (int d = minX[3]; d <= maxX[3]; d++)
+                        for (int e = minX[4]; e <= maxX[4]; e++)
+                            for (int f = minX[5]; f <= maxX[5]; f++)
+                            {
+                                if (get(a, b, c, d, e, f) < value)
+                                {
+                                    setDatum((unsigned int)a, (unsigned int)b, (unsigned int)c, (unsigned int)d, (unsigned int)e, (unsigned int)f, value);
+                                }
+                            }
+    }
+
+    void WorkspaceDataMapped::increaseDatum(float x[6], const WorkspaceRepresentation* workspace)
+    {
+        // get voxels
+        unsigned int v[6];
+
+        if (workspace->getVoxelFromPose(x, v))
+        {
+            increaseDatum(v);
+        }
+    }
+
+    void WorkspaceDataMapped::increaseDatum(unsigned int x[6])
+    {
+        unsigned int posTr = 0, posRot = 0;
+        getPos(x[0], x[1], x[2], x[3], x[4], x[5], posTr, posRot);
+        unsigned char* block = getModifiableBlock(posTr);
+        unsigned char e = block[posRot];
+
+        if (e == 0)
+        {
+            voxelFilledCount++;
+        }
+
+        if (e < UCHAR_MAX)
+        {
+            block[posRot]++;
+
+            if (e >= maxEntry)
+            {
+                maxEntry = e + 1;
+            }
+        }
+        else if (adjustOnOverflow)
+        {
+            bisectData();
+        }
+    }
+
+    void WorkspaceDataMapped::setDataRot(unsigned char* data, unsigned int x, unsigned int y, unsigned int z)
+    {
+        memcpy(getModifiableBlock(x * sizeTr0 + y * sizeTr1 + z), data, getSizeRot() * sizeof(unsigned char));
+    }
+
+    const unsigned char* WorkspaceDataMapped::getDataRot(unsigned int x, unsigned int y, unsigned int z)
+    {
+        unsigned int posTr = x * sizeTr0 + y * sizeTr1 + z;
+        std::map<unsigned int, unsigned char*>::iterator it = modifiedBlocks.find(posTr);
+
+        if (it != modifiedBlocks.end())
+        {
+            return it->second;
+        }
+
+        {
+            boost::mutex::scoped_lock lock(cacheMutex, boost::defer_lock);
+            const unsigned char* block = getBlock(posTr, lock);
+
+            if (block)
+            {
+                return block;
+            }
+        }
+
+        // same behavior as WorkspaceDataArray: empty blocks are created
+        return getModifiableBlock(posTr);
+    }
+
+    bool WorkspaceDataMapped::hasEntry(unsigned int x, unsigned int y, unsigned int z)
+    {
+        if (x >= sizes[0] || y >= sizes[1] || z >= sizes[2])
+        {
+            return false;
+        }
+
+        unsigned int posTr = x * sizeTr0 + y * sizeTr1 + z;
+
+        if (modifiedBlocks.find(posTr) != modifiedBlocks.end())
+        {
+            return true;
+        }
+
+        uint64_t offset;
+        uint32_t size, encoding;
+        getBlockInfo(posTr, offset, size, encoding);
+        return encoding != eEmpty;
+    }
+
+    unsigned char WorkspaceDataMapped::get(float x[6], const WorkspaceRepresentation* workspace)
+    {
+        unsigned int v[6];
+
+        if (workspace->getVoxelFromPose(x, v))
+        {
+            return get(v);
+        }
+
+        return 0;
+    }
+
+    unsigned char WorkspaceDataMapped::get(unsigned int x0, unsigned int x1, unsigned int x2, unsigned int x3, unsigned int x4, unsigned int x5)
+    {
+        unsigned int posTr = 0, posRot = 0;
+        getPos(x0, x1, x2, x3, x4, x5, posTr, posRot);
+
+        std::map<unsigned int, unsigned char*>::iterator it = modifiedBlocks.find(posTr);
+
+        if (it != modifiedBlocks.end())
+        {
+            return it->second[posRot];
+        }
+
+        // the lock is only taken for compressed blocks, the value is copied while it is held (the block may be evicted afterwards)
+        boost::mutex::scoped_lock lock(cacheMutex, boost::defer_lock);
+        const unsigned char* block = getBlock(posTr, lock);
+        return block ? block[posRot] : 0;
+    }
+
+    unsigned char WorkspaceDataMapped::get(unsigned int x[6])
+    {
+        return get(x[0], x[1], x[2], x[3], x[4], x[5]);
+    }
+
+    void WorkspaceDataMapped::clear()
+    {
+        for (std::map<unsigned int, unsigned char*>::iterator it = modifiedBlocks.begin(); it != modifiedBlocks.end(); it++)
+        {
+            delete[] it->second;
+        }
+
+        modifiedBlocks.clear();
+
+        {
+            boost::mutex::scoped_lock lock(cacheMutex);
+
+            for (std::map<unsigned int, CachedBlock>::iterator it = cachedBlocks.begin(); it != cachedBlocks.end(); it++)
+            {
+                delete[] it->second.data;
+            }
+
+            cachedBlocks.clear();
+            lruList.clear();
+        }
+
+        mappedFile.reset();
+        index = NULL;
+        maxEntry = 0;
+        voxelFilledCount = 0;
+    }
+
+    void WorkspaceDataMapped::binarize()
+    {
+        unsigned int sizeRot = getSizeRot();
+
+        for (unsigned int posTr = 0; posTr < getSizeTr(); posTr++)
+        {
+            if (!hasEntry(posTr / sizeTr0, (posTr % sizeTr0) / sizeTr1, posTr % sizeTr1))
+            {
+                continue;
+            }
+
+            unsigned char* block = getModifiableBlock(posTr);
+
+            for (unsigned int posRot = 0; posRot < sizeRot; posRot++)
+            {
+                if (block[posRot] > minValidValue)
+                {
+                    block[posRot] = minValidValue;
+                }
+            }
+        }
+
+        maxEntry = minValidValue;
+    }
+
+    void WorkspaceDataMapped::bisectData()
+    {
+        unsigned int sizeRot = getSizeRot();
+
+        for (unsigned int posTr = 0; posTr < getSizeTr(); posTr++)
+        {
+            if (!hasEntry(posTr / sizeTr0, (posTr % sizeTr0) / sizeTr1, posTr % sizeTr1))
+            {
+                continue;
+            }
+
+            unsigned char* block = getModifiableBlock(posTr);
+
+            for (unsigned int posRot = 0; posRot < sizeRot; posRot++)
+            {
+                if (block[posRot] > minValidValue)
+                {
+                    block[posRot] /= 2;
+
+                    if (block[posRot] < minValidValue)
+                    {
+                        block[posRot] = minValidValue;
+                    }
+                }
+            }
+        }
+
+        if (maxEntry > minValidValue)
+        {
+            maxEntry = maxEntry / 2;
+
+            if (maxEntry < minValidValue)
+            {
+                maxEntry = minValidValue;
+            }
+        }
+    }
+
+    unsigned char** WorkspaceDataMapped::getRawData()
+    {
+        VR_ERROR << "Raw data is not available for memory mapped workspace data" << endl;
+        return NULL;
+    }
+
+    WorkspaceData* WorkspaceDataMapped::clone()
+    {
+        return new WorkspaceDataMapped(this);
+    }
+
+    bool WorkspaceDataMapped::save(std::ofstream& file)
+    {
+        CompressionBZip2Ptr bzip2(new CompressionBZip2(&file));
+        unsigned char* emptyData = new unsigned char[getSizeRot()];
+        memset(emptyData, 0, getSizeRot() * sizeof(unsigned char));
+        bool ok = true;
+
+        for (unsigned int x = 0; x < sizes[0] && ok; x++)
+            for (unsigned int y = 0; y < sizes[1] && ok; y++)
+                for (unsigned int z = 0; z < sizes[2] && ok; z++)
+                {
+                    void* dataBlock;
+
+                    // this avoids that an empty data block is created within the workspace data when no data is available.
+                    if (hasEntry(x, y, z))
+                    {
+                        dataBlock = (void*)(getDataRot(x, y, z));
+                    }
+                    else
+                    {
+                        dataBlock = (void*) emptyData;
+                    }
+
+                    if (!bzip2->write(dataBlock, getSizeRot() * sizeof(unsigned char)))
+                    {
+                        VR_ERROR << "Error writing to file.." << endl;
+                        ok = false;
+                    }
+                }
+
+        delete [] emptyData;
+        bzip2->close();
+        return ok;
+    }
+
+} // namespace VirtualRobot
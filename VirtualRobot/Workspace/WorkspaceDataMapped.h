@@ -0,0 +1,211 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    VirtualRobot
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef _VirtualRobot_WorkspaceDataMapped_h_
+#define _VirtualRobot_WorkspaceDataMapped_h_
+
+#include "WorkspaceRepresentation.h"
+#include "WorkspaceData.h"
+#include "../VirtualRobotImportExport.h"
+
+#include <string>
+#include <list>
+#include <map>
+#include <fstream>
+
+#include <stdint.h>
+
+#include <boost/thread/mutex.hpp>
+
+namespace VirtualRobot
+{
+    /*!
+        Read access to workspace data that is stored in the block indexed file format (\see WorkspaceRepresentation::save).
+
+        In this format the rotation data of each x/y/z position is stored as an independent block, either uncompressed or RLE compressed.
+        An index at the beginning of the data section holds the file offset, size and encoding of each block.
+        The file is memory mapped, nothing is decoded on construction: Uncompressed blocks are accessed directly in the mapped memory,
+        compressed blocks are decoded on first access and kept in a bounded LRU cache.
+        Hence, loading large workspace files does not depend on the size of the data and only the accessed parts of the file are read from disk.
+
+        The file must not be modified as long as it is mapped. A corrupt compressed block raises an exception when it is accessed.
+        get() and hasEntry() may be called concurrently. Empty and uncompressed blocks are resolved from the index and the mapped memory without locking,
+        only the cache of the decoded blocks is protected by a mutex. getDataRot() may not be called concurrently: the returned pointer is invalidated
+        when the block is evicted from the cache by a subsequent access of any thread. Modifications are not thread safe, i.e. they must not be done
+        in parallel to any other access.
+
+        Modifications are supported but not intended to be used frequently: A modified block is copied to memory and kept until the data is cleared.
+        binarize() and bisectData() copy all non-empty blocks.
+    */
+    class VIRTUAL_ROBOT_IMPORT_EXPORT WorkspaceDataMapped : public WorkspaceData
+    {
+    public:
+        /*!
+            Maps the file and reads the block index.
+            \param filename The workspace file.
+            \param dataOffset The file position of the block indexed data section (directly after the DATA_START tag).
+            \param size1,size2,size3,size4,size5,size6 The number of voxels. Have to match the sizes that are stored in the data section.
+            \param maxCachedBlocks The maximum number of decoded blocks that are kept in memory.
+        */
+        WorkspaceDataMapped(const std::string& filename, uint64_t dataOffset,
+                            unsigned int size1, unsigned int size2, unsigned int size3,
+                            unsigned int size4, unsigned int size5, unsigned int size6,
+                            unsigned int maxCachedBlocks, bool adjustOnOverflow);
+
+        //! Clone other data structure. The file mapping is shared, the cache is not copied.
+        WorkspaceDataMapped(WorkspaceDataMapped* other);
+
+        ~WorkspaceDataMapped();
+
+        /*!
+            Writes the data section of the block indexed file format.
+            \param file The file, the section is written at the current position.
+            \param data The data to store.
+            \param compressBlocks If set, blocks are stored RLE compressed (unless compression does not reduce the size). Otherwise all blocks are stored uncompressed.
+        */
+        static bool saveBlockIndexed(std::ofstream& file, WorkspaceDataPtr data, bool compressBlocks);
+
+        //! The file position behind the data section.
+        uint64_t getDataEnd() const;
+
+        //! The maximum number of decoded blocks that are cached.
+        void setMaxCachedBlocks(unsigned int n);
+        unsigned int getMaxCachedBlocks() const;
+
+        //! The number of decoded blocks that are currently in the cache.
+        unsigned int getNrOfCachedBlocks();
+
+        //! Return the amount of data in bytes
+        unsigned int getSizeTr() const;
+        unsigned int getSizeRot() const;
+
+        void setDatum(float x[], unsigned char value, const WorkspaceRepresentation* workspace);
+
+        void setDatum(unsigned int x0, unsigned int x1, unsigned int x2,
+                      unsigned int x3, unsigned int x4, unsigned int x5, unsigned char value);
+
+        void setDatum(unsigned int x[6], unsigned char value);
+
+        void setDatumCheckNeighbors(unsigned int x[6], unsigned char value, unsigned int neighborVoxels);
+
+        void increaseDatum(float x[], const WorkspaceRepresentation* workspace);
+
+        void increaseDatum(unsigned int x[6]);
+
+        /*!
+            Set rotation data for given x,y,z position.
+        */
+        void setDataRot(unsigned char* data, unsigned int x, unsigned int y, unsigned int z);
+
+        /*!
+            Get rotation data for given x,y,z position.
+            The returned pointer may be invalidated by subsequent accesses (also by other threads), hence this method is not thread safe.
+        */
+        const unsigned char* getDataRot(unsigned int x, unsigned int y, unsigned int z);
+
+        bool hasEntry(unsigned int x, unsigned int y, unsigned int z);
+
+        unsigned char get(float x[], const WorkspaceRepresentation* workspace);
+
+        //! Simulates a multi-dimensional array access
+        unsigned char get(unsigned int x0, unsigned int x1, unsigned int x2,
+                          unsigned int x3, unsigned int x4, unsigned int x5);
+
+        //! Simulates a multi-dimensional array access
+        unsigned char get(unsigned int x[6]);
+
+        // Set all entries to 0, the file mapping is released
+        void clear();
+        void binarize();
+
+        void bisectData();
+
+        unsigned int getSize(int dim)
+        {
+            return sizes[dim];
+        }
+
+        //! Not available, the data is not stored as one array (returns NULL).
+        unsigned char** getRawData();
+
+        WorkspaceData* clone();
+
+        //! Stores the data in the standard (BZip2 compressed) format.
+        bool save(std::ofstream& file);
+
+    protected:
+        enum BlockEncoding
+        {
+            eEmpty = 0,
+            eUncompressed = 1,
+            eRLE = 2
+        };
+
+        struct MappedFile;
+
+        struct CachedBlock
+        {
+            unsigned char* data;
+            std::list<unsigned int>::iterator lruPosition;
+        };
+
+        void init(unsigned int size1, unsigned int size2, unsigned int size3,
+                  unsigned int size4, unsigned int size5, unsigned int size6);
+
+        void getBlockInfo(unsigned int posTr, uint64_t& offset, uint32_t& size, uint32_t& encoding) const;
+
+        /*!
+            Returns the rotation data of a block that is not modified or NULL for empty blocks. Throws if the block is corrupt.
+            \param lock An unlocked lock of cacheMutex. It is locked if the block is decoded into the cache, in this case it has to be held as long as the data is accessed.
+        */
+        const unsigned char* getBlock(unsigned int posTr, boost::mutex::scoped_lock& lock);
+
+        //! Returns a writable copy of the block at posTr.
+        unsigned char* getModifiableBlock(unsigned int posTr);
+
+        inline void getPos(unsigned int x0, unsigned int x1, unsigned int x2,
+                           unsigned int x3, unsigned int x4, unsigned int x5 ,
+                           unsigned int& storePosTr, unsigned int& storePosRot) const
+        {
+            storePosTr  = x0 * sizeTr0  + x1 * sizeTr1  + x2;
+            storePosRot = x3 * sizeRot0 + x4 * sizeRot1 + x5;
+        }
+
+        unsigned int sizes[6];
+        unsigned int sizeTr0, sizeTr1;
+        unsigned int sizeRot0, sizeRot1;
+
+        boost::shared_ptr<MappedFile> mappedFile;
+        const unsigned char* index;
+        uint64_t dataEnd;
+
+        unsigned int maxCachedBlocks;
+        std::list<unsigned int> lruList;                        //!< the most recently used block is at the front
+        std::map<unsigned int, CachedBlock> cachedBlocks;
+        boost::mutex cacheMutex;                                //!< protects lruList and cachedBlocks
+
+        std::map<unsigned int, unsigned char*> modifiedBlocks;  //!< blocks that have been written, these blocks are never evicted (only changed by modifications, hence read without locking)
+    };
+
+} // namespace VirtualRobot
+
+#endif // _VirtualRobot_WorkspaceDataMapped_h_
@@ -0,0 +1,595 @@
+#include "WorkspaceDataSparse.h"
+#include "../VirtualRobotException.h"
+#include "../Compression/CompressionBZip2.h"
+
+#include <cstring>
+#include <limits.h>
+
+namespace VirtualRobot
+{
+
+    namespace
+    {
+        inline unsigned int popCount(uint64_t v)
+        {
+#ifdef __GNUC__
+            return (unsigned int)__builtin_popcountll(v);
+#else
+            v = v - ((v >> 1) & 0x5555555555555555ULL);
+            v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+            v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            return (unsigned int)((v * 0x0101010101010101ULL) >> 56);
+#endif
+        }
+    }
+
+    WorkspaceDataSparse::WorkspaceDataSparse(unsigned int size1, unsigned int size2, unsigned int size3,
+            unsigned int size4, unsigned int size5, unsigned int size6, bool adjustOnOverflow)
+    {
+        unsigned long long sizeTr = (unsigned long long)size1 * (unsigned long long)size2 * (unsigned long long)size3;
+        unsigned long long sizeRot = (unsigned long long)size4 * (unsigned long long)size5 * (unsigned long long)size6;
+        sizes[0] = size1;
+        sizes[1] = size2;
+        sizes[2] = size3;
+        sizes[3] = size4;
+        sizes[4] = size5;
+        sizes[5] = size6;
+        sizeTr0 = sizes[1] * sizes[2];
+        sizeTr1 = sizes[2];
+        sizeRot0 = sizes[4] * sizes[5];
+        sizeRot1 = sizes[5];
+
+        THROW_VR_EXCEPTION_IF(sizeRot > UINT_MAX || sizeTr > UINT_MAX, "Size of workspace data exceeds UINT_MAX");
+
+        data = new Block*[(unsigned int)sizeTr];
+        memset(data, 0, (unsigned int)sizeTr * sizeof(Block*));
+
+        minValidValue = 1;
+        maxEntry = 0;
+        voxelFilledCount = 0;
+        this->adjustOnOverflow = adjustOnOverflow;
+    }
+
+    WorkspaceDataSparse::WorkspaceDataSparse(WorkspaceDataSparse* other)
+    {
+        VR_ASSERT(other);
+
+        for (int i = 0; i < 6; i++)
+        {
+            sizes[i] = other->sizes[i];
+        }
+
+        sizeTr0 = other->sizeTr0;
+        sizeTr1 = other->sizeTr1;
+        sizeRot0 = other->sizeRot0;
+        sizeRot1 = other->sizeRot1;
+
+        data = new Block*[getSizeTr()];
+
+        for (unsigned int i = 0; i < getSizeTr(); i++)
+        {
+            data[i] = other->data[i] ? new Block(*(other->data[i])) : NULL;
+        }
+
+        minValidValue = other->minValidValue;
+        maxEntry = other->maxEntry;
+        voxelFilledCount = other->voxelFilledCount;
+        adjustOnOverflow = other->adjustOnOverflow;
+    }
+
+    WorkspaceDataSparse::~WorkspaceDataSparse()
+    {
+        for (unsigned int i = 0; i < getSizeTr(); i++)
+        {
+            delete data[i];
+        }
+
+        delete[] data;
+    }
+
+    unsigned int WorkspaceDataSparse::getSizeTr() const
+    {
+        return sizes[0] * sizes[1] * sizes[2];
+    }
+
+    unsigned int WorkspaceDataSparse::getSizeRot() const
+    {
+        return sizes[3] * sizes[4] * sizes[5];
+    }
+
+    unsigned long long WorkspaceDataSparse::getMemoryUsage() const
+    {
+        unsigned long long res = sizeof(WorkspaceDataSparse) + (unsigned long long)getSizeTr() * sizeof(Block*) + rotBuffer.capacity();
+
+        for (unsigned int i = 0; i < getSizeTr(); i++)
+        {
+            if (data[i])
+            {
+                res += sizeof(Block) + data[i]->chunks.capacity() * sizeof(Chunk) + data[i]->values.capacity();
+            }
+        }
+
+        return res;
+    }
+
+    unsigned int WorkspaceDataSparse::findChunk(const Block* block, uint32_t id)
+    {
+        // binary search, chunks are ordered by id
+        unsigned int lo = 0;
+        unsigned int hi = (unsigned int)block->chunks.size();
+
+        while (lo < hi)
+        {
+            unsigned int mid = (lo + hi) / 2;
+
+            if (block->chunks[mid].id < id)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+
+        return lo;
+    }
+
+    const unsigned char* WorkspaceDataSparse::find(unsigned int posTr, unsigned int posRot) const
+    {
+        const Block* block = data[posTr];
+
+        if (!block)
+        {
+            return NULL;
+        }
+
+        uint32_t id = posRot >> 6;
+        uint64_t bit = (uint64_t)1 << (posRot & 63);
+        unsigned int c = findChunk(block, id);
+
+        if (c >= block->chunks.size() || block->chunks[c].id != id || !(block->chunks[c].mask & bit))
+        {
+            return NULL;
+        }
+
+        const Chunk& chunk = block->chunks[c];
+        return &(block->values[chunk.offset + popCount(chunk.mask & (bit - 1))]);
+    }
+
+    unsigned char* WorkspaceDataSparse::findOrInsert(unsigned int posTr, unsigned int posRot)
+    {
+        if (!data[posTr])
+        {
+            data[posTr] = new Block();
+        }
+
+        Block* block = data[posTr];
+        uint32_t id = posRot >> 6;
+        uint64_t bit = (uint64_t)1 << (posRot & 63);
+        unsigned int c = findChunk(block, id);
+
+        if (c >= block->chunks.size() || block->chunks[c].id != id)
+        {
+            Chunk chunk;
+            chunk.mask = 0;
+            chunk.id = id;
+            chunk.offset = (c < block->chunks.size()) ? block->chunks[c].offset : (uint32_t)block->values.size();
+            block->chunks.insert(block->chunks.begin() + c, chunk);
+        }
+
+        Chunk& chunk = block->chunks[c];
+        unsigned int pos = chunk.offset + popCount(chunk.mask & (bit - 1));
+
+        if (!(chunk.mask & bit))
+        {
+            chunk.mask |= bit;
+            block->values.insert(block->values.begin() + pos, (unsigned char)0);
+
+            for (size_t i = c + 1; i < block->chunks.size(); i++)
+            {
+                block->chunks[i].offset++;
+            }
+        }
+
+        return &(block->values[pos]);
+    }
+
+    void WorkspaceDataSparse::erase(unsigned int posTr, unsigned int posRot)
+    {
+        Block* block = data[posTr];
+
+        if (!block)
+        {
+            return;
+        }
+
+        uint32_t id = posRot >> 6;
+        uint64_t bit = (uint64_t)1 << (posRot & 63);
+        unsigned int c = findChunk(block, id);
+
+        if (c >= block->chunks.size() || block->chunks[c].id != id || !(block->chunks[c].mask & bit))
+        {
+            return;
+        }
+
+        Chunk& chunk = block->chunks[c];
+        unsigned int pos = chunk.offset + popCount(chunk.mask & (bit - 1));
+        chunk.mask &= ~bit;
+        block->values.erase(block->values.begin() + pos);
+
+        for (size_t i = c + 1; i < block->chunks.size(); i++)
+        {
+            block->chunks[i].offset--;
+        }
+
+        if (chunk.mask == 0)
+        {
+            block->chunks.erase(block->chunks.begin() + c);
+        }
+    }
+
+    void WorkspaceDataSparse::setDatum(float x[6], unsigned char value, const WorkspaceRepresentation* workspace)
+    {
+        // get voxels
+        unsigned int v[6];
+
+        if (workspace->getVoxelFromPose(x, v))
+        {
+            setDatum(v, value);
+        }
+    }
+
+    void WorkspaceDataSparse::setDatum(unsigned int x0, unsigned int x1, unsigned int x2, unsigned int x3, unsigned int x4, unsigned int x5, unsigned char value)
+    {
+        unsigned int posTr = 0, posRot = 0;
+        getPos(x0, x1, x2, x3, x4, x5, posTr, posRot);
+
+        if (!find(posTr, posRot))
+        {
+            voxelFilledCount++;
+        }
+
+        // zero entries are not stored
+        if (value == 0)
+        {
+            erase(posTr, posRot);
+
+            if (!data[posTr])
+            {
+                data[posTr] = new Block();
+            }
+        }
+        else
+        {
+            *findOrInsert(posTr, posRot) = value;
+        }
+
+        if (value >= maxEntry)
+        {
+            maxEntry = value;
+        }
+    }
+
+    void WorkspaceDataSparse::setDatum(unsigned int x[6], unsigned char value)
+    {
+        setDatum(x[0], x[1], x[2], x[3], x[4], x[5], value);
+    }
+
+    void WorkspaceDataSparse::setDatumCheckNeighbors(unsigned int x[6], unsigned char value, unsigned int neighborVoxels)
+    {
+        setDatum(x, value);
+
+        if (neighborVoxels == 0)
+        {
+            return;
+        }
+
+        int minX[6];
+        int maxX[6];
+
+        for (int i = 0; i < 6; i++)
+        {
+            minX[i] = x[i] - neighborVoxels;
+            maxX[i] = x[i] + neighborVoxels;
+
+            if (minX[i] < 0)
+            {
+                minX[i] = 0;
+            }
+
+            if (maxX[i] >= (int)sizes[i])
+            {
+                maxX[i] = sizes[i] - 1;
+            }
+        }
+
+        for (int a = minX[0]; a <= maxX[0]; a++)
+            for (int b = minX[1]; b <= maxX[1]; b++)
+                for (int c = minX[2]; c <= maxX[2]; c++)
+                    for (int d = minX[3]; d <= maxX[3]; d++)
+                        for (int e = minX[4]; e <= maxX[4]; e++)
+                            for (int f = minX[5]; f <= maxX[5]; f++)
+                            {
+                                if (get(a, b, c, d, e, f) < value)
+                                {
+                                    setDatum((unsigned int)a, (unsigned int)b, (unsigned int)c, (unsigned int)d, (unsigned int)e, (unsigned int)f, value);
+                                }
+                            }
+    }
+
+    void WorkspaceDataSparse::increaseDatum(float x[6], const WorkspaceRepresentation* workspace)
+    {
+        // get voxels
+        unsigned int v[6];
+
+        if (workspace->getVoxelFromPose(x, v))
+        {
+            increaseDatum(v);
+        }
+    }
+
+    void WorkspaceDataSparse::increaseDatum(unsigned int x0, unsigned int x1, unsigned int x2, unsigned int x3, unsigned int x4, unsigned int x5)
+    {
+        unsigned int posTr = 0, posRot = 0;
+        getPos(x0, x1, x2, x3, x4, x5, posTr, posRot);
+        unsigned char* entry = findOrInsert(posTr, posRot);
+        unsigned char e = *entry;
+
+        if (e == 0)
+        {
+            voxelFilledCount++;
+        }
+
+        if (e < UCHAR_MAX)
+        {
+            (*entry)++;
+
+            if (e >= maxEntry)
+            {
+                maxEntry = e + 1;
+            }
+        }
+        else if (adjustOnOverflow)
+        {
+            bisectData();
+        }
+    }
+
+    void WorkspaceDataSparse::increaseDatum(unsigned int x[6])
+    {
+        increaseDatum(x[0], x[1], x[2], x[3], x[4], x[5]);
+    }
+
+    void WorkspaceDataSparse::setDataRot(unsigned char* data, unsigned int x, unsigned int y, unsigned int z)
+    {
+        unsigned int posTr = x * sizeTr0 + y * sizeTr1 + z;
+
+        if (!this->data[posTr])
+        {
+            this->data[posTr] = new Block();
+        }
+
+        Block* block = this->data[posTr];
+        block->chunks.clear();
+        block->values.clear();
+
+        // count entries in order to avoid reallocations
+        unsigned int nrChunks = 0;
+        unsigned int nrValues = 0;
+        unsigned int sizeRot = getSizeRot();
+
+        for (unsigned int i = 0; i < sizeRot; i += 64)
+        {
+            bool chunkUsed = false;
+
+            for (unsigned int j = i; j < i + 64 && j < sizeRot; j++)
+            {
+                if (data[j] != 0)
+                {
+                    chunkUsed = true;
+                    nrValues++;
+                }
+            }
+
+            if (chunkUsed)
+            {
+                nrChunks++;
+            }
+        }
+
+        std::vector<Chunk>(nrChunks).swap(block->chunks);
+        std::vector<unsigned char>(nrValues).swap(block->values);
+        unsigned int c = 0;
+        unsigned int v = 0;
+
+        for (unsigned int i = 0; i < sizeRot; i += 64)
+        {
+            uint64_t mask = 0;
+            unsigned int offset = v;
+
+            for (unsigned int j = i; j < i + 64 && j < sizeRot; j++)
+            {
+                if (data[j] != 0)
+                {
+                    mask |= (uint64_t)1 << (j - i);
+                    block->values[v++] = data[j];
+                }
+            }
+
+            if (mask != 0)
+            {
+                block->chunks[c].mask = mask;
+                block->chunks[c].id = i >> 6;
+                block->chunks[c].offset = offset;
+                c++;
+            }
+        }
+    }
+
+    const unsigned char* WorkspaceDataSparse::getDataRot(unsigned int x, unsigned int y, unsigned int z)
+    {
+        unsigned int posTr = x * sizeTr0 + y * sizeTr1 + z;
+        rotBuffer.assign(getSizeRot(), 0);
+        const Block* block = data[posTr];
+
+        if (block)
+        {
+            for (size_t c = 0; c < block->chunks.size(); c++)
+            {
+                const Chunk& chunk = block->chunks[c];
+                unsigned int v = chunk.offset;
+
+                for (unsigned int i = 0; i < 64; i++)
+                {
+                    if (chunk.mask & ((uint64_t)1 << i))
+                    {
+                        rotBuffer[chunk.id * 64 + i] = block->values[v++];
+                    }
+                }
+            }
+        }
+
+        return &(rotBuffer[0]);
+    }
+
+    unsigned char WorkspaceDataSparse::get(float x[6], const WorkspaceRepresentation* workspace)
+    {
+        unsigned int v[6];
+
+        if (workspace->getVoxelFromPose(x, v))
+        {
+            return get(v);
+        }
+
+        return 0;
+    }
+
+    unsigned char WorkspaceDataSparse::get(unsigned int x0, unsigned int x1, unsigned int x2, unsigned int x3, unsigned int x4, unsigned int x5)
+    {
+        unsigned int posTr = 0, posRot = 0;
+        getPos(x0, x1, x2, x3, x4, x5, posTr, posRot);
+        const unsigned char* entry = find(posTr, posRot);
+        return entry ? *entry : 0;
+    }
+
+    unsigned char WorkspaceDataSparse::get(unsigned int x[6])
+    {
+        return get(x[0], x[1], x[2], x[3], x[4], x[5]);
+    }
+
+    bool WorkspaceDataSparse::hasEntry(unsigned int x, unsigned int y, unsigned int z)
+    {
+        if (x >= sizes[0] || y >= sizes[1] || z >= sizes[2])
+        {
+            return false;
+        }
+
+        return (data[x * sizeTr0 + y * sizeTr1 + z] != NULL);
+    }
+
+    void WorkspaceDataSparse::clear()
+    {
+        for (unsigned int i = 0; i < getSizeTr(); i++)
+        {
+            delete data[i];
+            data[i] = NULL;
+        }
+
+        std::vector<unsigned char>().swap(rotBuffer);
+        maxEntry = 0;
+        voxelFilledCount = 0;
+    }
+
+    void WorkspaceDataSparse::binarize()
+    {
+        for (unsigned int i = 0; i < getSizeTr(); i++)
+        {
+            if (!data[i])
+            {
+                continue;
+            }
+
+            std::vector<unsigned char>& values = data[i]->values;
+
+            for (size_t j = 0; j < values.size(); j++)
+            {
+                if (values[j] > minValidValue)
+                {
+                    values[j] = minValidValue;
+                }
+            }
+        }
+
+        maxEntry = minValidValue;
+    }
+
+    void WorkspaceDataSparse::bisectData()
+    {
+        for (unsigned int i = 0; i < getSizeTr(); i++)
+        {
+            if (!data[i])
+            {
+                continue;
+            }
+
+            std::vector<unsigned char>& values = data[i]->values;
+
+            for (size_t j = 0; j < values.size(); j++)
+            {
+                if (values[j] > minValidValue)
+                {
+                    values[j] /= 2;
+
+                    if (values[j] < minValidValue)
+                    {
+                        values[j] = minValidValue;
+                    }
+                }
+            }
+        }
+
+        if (maxEntry > minValidValue)
+        {
+            maxEntry = maxEntry / 2;
+
+            if (maxEntry < minValidValue)
+            {
+                maxEntry = minValidValue;
+            }
+        }
+    }
+
+    unsigned char** WorkspaceDataSparse::getRawData()
+    {
+        VR_ERROR << "Raw data is not available for sparse workspace data" << endl;
+        return NULL;
+    }
+
+    WorkspaceData* WorkspaceDataSparse::clone()
+    {
+        return new WorkspaceDataSparse(this);
+    }
+
+    bool WorkspaceDataSparse::save(std::ofstream& file)
+    {
+        CompressionBZip2Ptr bzip2(new CompressionBZip2(&file));
+        bool ok = true;
+
+        // empty blocks are decoded to zeros
+        for (unsigned int x = 0; x < sizes[0] && ok; x++)
+            for (unsigned int y = 0; y < sizes[1] && ok; y++)
+                for (unsigned int z = 0; z < sizes[2] && ok; z++)
+                {
+                    if (!bzip2->write((void*)getDataRot(x, y, z), getSizeRot() * sizeof(unsigned char)))
+                    {
+                        VR_ERROR << "Error writing to file.." << endl;
+                        ok = false;
+                    }
+                }
+
+        bzip2->close();
+        return ok;
+    }
+
+} // namespace VirtualRobot
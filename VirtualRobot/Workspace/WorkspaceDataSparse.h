@@ -0,0 +1,170 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    VirtualRobot
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef _VirtualRobot_WorkspaceDataSparse_h_
+#define _VirtualRobot_WorkspaceDataSparse_h_
+
+#include "WorkspaceRepresentation.h"
+#include "WorkspaceData.h"
+#include "../VirtualRobotImportExport.h"
+
+#include <vector>
+#include <fstream>
+
+#include <stdint.h>
+
+namespace VirtualRobot
+{
+    /*!
+        Stores the 6-dimensional workspace data in a sparse data structure.
+
+        As with WorkspaceDataArray, one block of rotation data is created for each populated x/y/z position.
+        Within a block, the rotation entries are grouped into chunks of 64 entries. Only non-empty chunks are stored,
+        each chunk holds a 64 bit occupancy mask and the offset of its entries in a packed array of (non-zero) values.
+        Hence, the memory consumption depends on the number of filled voxels and not on the rotational resolution,
+        which results in much smaller memory footprints for typical 6D reachability data.
+        Accessing an entry needs a binary search over the chunks of a block and a bit count.
+
+        Read access via get() is thread safe, getDataRot() uses an internal buffer and is not thread safe.
+    */
+    class VIRTUAL_ROBOT_IMPORT_EXPORT WorkspaceDataSparse : public WorkspaceData
+    {
+    public:
+        /*!
+            Constructor, all entries are 0
+        */
+        WorkspaceDataSparse(unsigned int size1, unsigned int size2, unsigned int size3,
+                            unsigned int size4, unsigned int size5, unsigned int size6, bool adjustOnOverflow);
+
+        //! Clone other data structure
+        WorkspaceDataSparse(WorkspaceDataSparse* other);
+
+        ~WorkspaceDataSparse();
+
+        //! Return the amount of data in bytes
+        unsigned int getSizeTr() const;
+        unsigned int getSizeRot() const;
+
+        //! The approximated number of bytes that are allocated by this data structure.
+        unsigned long long getMemoryUsage() const;
+
+        void setDatum(float x[], unsigned char value, const WorkspaceRepresentation* workspace);
+
+        void setDatum(unsigned int x0, unsigned int x1, unsigned int x2,
+                      unsigned int x3, unsigned int x4, unsigned int x5, unsigned char value);
+
+        void setDatum(unsigned int x[6], unsigned char value);
+
+        void setDatumCheckNeighbors(unsigned int x[6], unsigned char value, unsigned int neighborVoxels);
+
+        void increaseDatum(float x[], const WorkspaceRepresentation* workspace);
+
+        void increaseDatum(unsigned int x0, unsigned int x1, unsigned int x2,
+                           unsigned int x3, unsigned int x4, unsigned int x5);
+
+        void increaseDatum(unsigned int x[6]);
+
+        /*!
+            Set rotation data for given x,y,z position.
+        */
+        void setDataRot(unsigned char* data, unsigned int x, unsigned int y, unsigned int z);
+
+        /*!
+            Get rotation data for given x,y,z position.
+            The data is decoded to an internal buffer, which is overwritten by the next call.
+        */
+        const unsigned char* getDataRot(unsigned int x, unsigned int y, unsigned int z);
+
+        unsigned char get(float x[], const WorkspaceRepresentation* workspace);
+
+        //! Simulates a multi-dimensional array access
+        unsigned char get(unsigned int x0, unsigned int x1, unsigned int x2,
+                          unsigned int x3, unsigned int x4, unsigned int x5);
+
+        //! Simulates a multi-dimensional array access
+        unsigned char get(unsigned int x[6]);
+
+        bool hasEntry(unsigned int x, unsigned int y, unsigned int z);
+
+        // Set all entries to 0
+        void clear();
+        void binarize();
+
+        void bisectData();
+
+        unsigned int getSize(int dim)
+        {
+            return sizes[dim];
+        }
+
+        //! Not available, the data is not stored as one array (returns NULL).
+        unsigned char** getRawData();
+
+        WorkspaceData* clone();
+
+        bool save(std::ofstream& file);
+
+    protected:
+        struct Chunk
+        {
+            uint64_t mask;      //!< bit i is set, if entry (id*64+i) is stored
+            uint32_t id;        //!< index of the chunk within the block (rotation position / 64)
+            uint32_t offset;    //!< index of the first entry of this chunk in values
+        };
+
+        struct Block
+        {
+            std::vector<Chunk> chunks;          //!< non-empty chunks, ordered by id
+            std::vector<unsigned char> values;  //!< packed entries of all chunks
+        };
+
+        //! Index of the chunk with the given id or the position where it has to be inserted.
+        static unsigned int findChunk(const Block* block, uint32_t id);
+
+        //! Returns a pointer to the entry or NULL if the entry is 0.
+        const unsigned char* find(unsigned int posTr, unsigned int posRot) const;
+
+        //! Returns a pointer to the entry, a (zero) entry is created if needed. The pointer is invalidated by subsequent insertions.
+        unsigned char* findOrInsert(unsigned int posTr, unsigned int posRot);
+
+        //! Removes an entry (sets it to 0).
+        void erase(unsigned int posTr, unsigned int posRot);
+
+        inline void getPos(unsigned int x0, unsigned int x1, unsigned int x2,
+                           unsigned int x3, unsigned int x4, unsigned int x5 ,
+                           unsigned int& storePosTr, unsigned int& storePosRot) const
+        {
+            storePosTr  = x0 * sizeTr0  + x1 * sizeTr1  + x2;
+            storePosRot = x3 * sizeRot0 + x4 * sizeRot1 + x5;
+        }
+
+        unsigned int sizes[6];
+        unsigned int sizeTr0, sizeTr1;
+        unsigned int sizeRot0, sizeRot1;
+
+        Block** data;
+        std::vector<unsigned char> rotBuffer;
+    };
+
+} // namespace VirtualRobot
+
+#endif // _VirtualRobot_WorkspaceDataSparse_h_
@@ -1,4 +1,6 @@
 #include "WorkspaceRepresentation.h"
+#include "WorkspaceDataMapped.h"
+#include "WorkspaceDataSparse.h"
 #include "../VirtualRobotException.h"
 #include "../Robot.h"
 #include "../RobotNodeSet.h"
@@ -9,6 +11,7 @@
 #include "../Visualization/Visualization.h"
 #include "../Visualization/VisualizationFactory.h"
 #include "../CollisionDetection/CollisionChecker.h"
+#include "../CollisionDetection/CDManager.h"
 #include "../Visualization/ColorMap.h"
 #include "../ManipulationObject.h"
 #include "../Grasping/Grasp.h"
@@ -18,6 +21,9 @@
 #include <float.h>
 #include <limits.h>
 
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
 namespace VirtualRobot
 {
 
@@ -29,6 +35,8 @@ namespace VirtualRobot
         versionMajor = 2;
         versionMinor = 7;
         orientationType = EulerXYZExtrinsic;
+        blockCacheSize = 4096;
+        useSparseData = false;
         reset();
     }
 
@@ -183,7 +191,7 @@ namespace VirtualRobot
                 // now check if an older version is used
                 THROW_VR_EXCEPTION_IF(
                     (version[0] > 2) ||
-                    (version[0] == 2 && !(version[1] == 0 || version[1] == 1 || version[1] == 2 || version[1] == 3 || version[1] == 4 || version[1] == 5 || version[1] == 6)) ||
+                    (version[0] == 2 && !(version[1] == 0 || version[1] == 1 || version[1] == 2 || version[1] == 3 || version[1] == 4 || version[1] == 5 || version[1] == 6 || version[1] == 8)) ||
                     (version[0] == 1 && !(version[1] == 0 || version[1] == 2 || version[1] == 3)
                     ),  "Wrong file format version");
             }
@@ -309,10 +317,18 @@ namespace VirtualRobot
             THROW_VR_EXCEPTION_IF(tmpString != "DATA_START", "Bad file format, expecting DATA_START.");
 
             long size = numVoxels[0] * numVoxels[1] * numVoxels[2] * numVoxels[3] * numVoxels[4] * numVoxels[5];
-            data.reset(new WorkspaceDataArray(numVoxels[0], numVoxels[1], numVoxels[2], numVoxels[3], numVoxels[4], numVoxels[5], true));
 
-            if (version[0] <= 1 || (version[0] == 2 && version[1] <= 3))
+            if (version[0] == 2 && version[1] == 8)
+            {
+                // block indexed data: the file is mapped, nothing is decoded here
+                WorkspaceDataMappedPtr mappedData(new WorkspaceDataMapped(filename, (uint64_t)file.tellg(), numVoxels[0], numVoxels[1], numVoxels[2], numVoxels[3], numVoxels[4], numVoxels[5], blockCacheSize, true));
+                data = mappedData;
+                file.seekg((std::streamoff)mappedData->getDataEnd());
+            }
+            else if (version[0] <= 1 || (version[0] == 2 && version[1] <= 3))
             {
+                data = createData(true);
+
                 // one data block
                 unsigned char* d = new unsigned char[size];
 
@@ -369,6 +385,8 @@ namespace VirtualRobot
             }
             else
             {
+                data = createData(true);
+
                 // data is split, only rotations are given in blocks
                 // Data is compressed
 
@@ -466,7 +484,7 @@ namespace VirtualRobot
         file.close();
     }
 
-    void WorkspaceRepresentation::save(const std::string& filename)
+    void WorkspaceRepresentation::save(const std::string& filename, eFileFormat format, bool compressBlocks)
     {
         THROW_VR_EXCEPTION_IF(!data || !nodeSet, "No WorkspaceRepresentation data loaded");
 
@@ -482,8 +500,9 @@ namespace VirtualRobot
             FileIO::writeString(file, tmpStr);
 
             // Version
+            // The block indexed format is stored as version 2.8
             FileIO::write<ioIntTypeWrite>(file, (ioIntTypeWrite)(versionMajor));
-            FileIO::write<ioIntTypeWrite>(file, (ioIntTypeWrite)(versionMinor));
+            FileIO::write<ioIntTypeWrite>(file, (ioIntTypeWrite)(format == eBlockIndexed ? 8 : versionMinor));
 
             // Robot type
             FileIO::writeString(file, robot->getType());
@@ -568,7 +587,18 @@ namespace VirtualRobot
             // Data
             FileIO::writeString(file, "DATA_START");
 
-            if (!data->save(file))
+            bool dataOK;
+
+            if (format == eBlockIndexed)
+            {
+                dataOK = WorkspaceDataMapped::saveBlockIndexed(file, data, compressBlocks);
+            }
+            else
+            {
+                dataOK = data->save(file);
+            }
+
+            if (!dataOK)
             {
                 VR_ERROR << "Unable to store data!" << endl;
                 return;
@@ -1004,6 +1034,26 @@ namespace VirtualRobot
         cout << endl;
     }
 
+    void WorkspaceRepresentation::setBlockCacheSize(unsigned int nrBlocks)
+    {
+        blockCacheSize = nrBlocks;
+    }
+
+    void WorkspaceRepresentation::setUseSparseData(bool enable)
+    {
+        useSparseData = enable;
+    }
+
+    WorkspaceDataPtr WorkspaceRepresentation::createData(bool adjustOnOverflow) const
+    {
+        if (useSparseData)
+        {
+            return WorkspaceDataPtr(new WorkspaceDataSparse(numVoxels[0], numVoxels[1], numVoxels[2], numVoxels[3], numVoxels[4], numVoxels[5], adjustOnOverflow));
+        }
+
+        return WorkspaceDataPtr(new WorkspaceDataArray(numVoxels[0], numVoxels[1], numVoxels[2], numVoxels[3], numVoxels[4], numVoxels[5], adjustOnOverflow));
+    }
+
     void WorkspaceRepresentation::reset()
     {
         data.reset();
@@ -1098,7 +1148,7 @@ namespace VirtualRobot
             THROW_VR_EXCEPTION_IF((numVoxels[i] <= 0), " numVoxels <= 0 in dimension " << i);
         }
 
-        data.reset(new WorkspaceDataArray(numVoxels[0], numVoxels[1], numVoxels[2], numVoxels[3], numVoxels[4], numVoxels[5], adjustOnOverflow));
+        data = createData(adjustOnOverflow);
 
         customInitialize();
     }
@@ -1864,6 +1914,8 @@ namespace VirtualRobot
         res->setOrientationType(this->orientationType);
         res->versionMajor = this->versionMajor;
         res->versionMinor = this->versionMinor;
+        res->blockCacheSize = this->blockCacheSize;
+        res->useSparseData = this->useSparseData;
         res->nodeSet = this->nodeSet;
         res->type = this->type;
 
@@ -1918,4 +1970,218 @@ namespace VirtualRobot
         nodeSet->setJointValues(c);
     }
 
+    void WorkspaceRepresentation::addRandomTCPPosesMultiThreaded(unsigned int loops, unsigned int numThreads, unsigned int seed, bool checkForSelfCollisions)
+    {
+        THROW_VR_EXCEPTION_IF(!data || !nodeSet || !tcpNode, "Workspace data not initialized");
+
+        if (numThreads == 0)
+        {
+            numThreads = std::max(1u, boost::thread::hardware_concurrency());
+        }
+
+        // the samples are merged batch-wise in order to limit the memory consumption
+        const unsigned int samplesPerBatch = 10000;
+
+        std::vector<float> c;
+        nodeSet->getJointValues(c);
+        bool visuSate = robot->getUpdateVisualizationStatus();
+        robot->setUpdateVisualization(false);
+
+        // setup the workers: the cloning reads the original robot, so this is done sequentially
+        std::vector<SampleThreadData> threadData(numThreads);
+
+        for (unsigned int t = 0; t < numThreads; t++)
+        {
+            SampleThreadData& d = threadData[t];
+            d.threadIndex = t;
+            CollisionCheckerPtr colChecker(new CollisionChecker());
+            std::stringstream ss;
+            ss << robot->getName() << "_workspace_thread_" << t;
+            d.robot = robot->clone(ss.str(), colChecker);
+            d.robot->setUpdateVisualization(false);
+            d.robot->setLazyPoseUpdates(true);
+
+            if (d.robot->hasRobotNodeSet(nodeSet->getName()))
+            {
+                d.nodeSet = d.robot->getRobotNodeSet(nodeSet->getName());
+            }
+            else
+            {
+                d.nodeSet = nodeSet->clone(d.robot);
+            }
+
+            d.tcpNode = d.robot->getRobotNode(tcpNode->getName());
+            THROW_VR_EXCEPTION_IF(!d.tcpNode, "Could not clone TCP node " << tcpNode->getName());
+
+            if (checkForSelfCollisions && staticCollisionModel && dynamicCollisionModel)
+            {
+                CDManagerPtr cdm(new CDManager(robot->getCollisionChecker()));
+                cdm->addCollisionModelPair(staticCollisionModel, dynamicCollisionModel);
+                std::map<RobotPtr, RobotPtr> robotMapping;
+                robotMapping[robot] = d.robot;
+                d.cdm = cdm->clone(colChecker, robotMapping);
+            }
+
+            d.generator.seed(seed + t);
+            d.collisionConfigs = 0;
+            d.failedSamples = 0;
+            d.error = false;
+            setupSampleThread(d);
+        }
+
+        Eigen::VectorXf config(nodeSet->getSize());
+        unsigned int loopsDone = 0;
+        int failedSamples = 0;
+
+        while (loopsDone < loops)
+        {
+            unsigned int batch = std::min(loops - loopsDone, samplesPerBatch * numThreads);
+            boost::thread_group threads;
+
+            for (unsigned int t = 0; t < numThreads; t++)
+            {
+                // distribute the remainder to the first threads
+                threadData[t].loops = batch / numThreads + (t < batch % numThreads ? 1 : 0);
+                threads.create_thread(boost::bind(&WorkspaceRepresentation::sampleTCPPoses, this, &threadData[t], checkForSelfCollisions));
+            }
+
+            threads.join_all();
+
+            // merge in thread order
+            for (unsigned int t = 0; t < numThreads; t++)
+            {
+                SampleThreadData& d = threadData[t];
+
+                if (d.error)
+                {
+                    for (unsigned int i = 0; i < numThreads; i++)
+                    {
+                        releaseSampleThread(threadData[i]);
+                    }
+
+                    robot->setUpdateVisualization(visuSate);
+                    nodeSet->setJointValues(c);
+                    THROW_VR_EXCEPTION("Error while sampling TCP poses in worker thread " << t);
+                }
+
+                for (size_t i = 0; i < d.tcpPoses.size(); i++)
+                {
+                    for (unsigned int j = 0; j < nodeSet->getSize(); j++)
+                    {
+                        config[j] = d.configs[i * nodeSet->getSize() + j];
+                    }
+
+                    addSampledTCPPose(d.tcpPoses[i], config, d.values.size() == d.tcpPoses.size() ? &d.values[i] : NULL);
+                }
+
+                collisionConfigs += d.collisionConfigs;
+                failedSamples += d.failedSamples;
+            }
+
+            loopsDone += batch;
+        }
+
+        for (unsigned int t = 0; t < numThreads; t++)
+        {
+            releaseSampleThread(threadData[t]);
+        }
+
+        if (failedSamples > 0)
+        {
+            VR_WARNING << "Could not find collision-free configuration for " << failedSamples << " samples..." << endl;
+        }
+
+        robot->setUpdateVisualization(visuSate);
+        nodeSet->setJointValues(c);
+    }
+
+    void WorkspaceRepresentation::sampleTCPPoses(SampleThreadData* sampleData, bool checkForSelfCollisions)
+    {
+        VR_ASSERT(sampleData);
+        sampleData->tcpPoses.clear();
+        sampleData->configs.clear();
+        sampleData->values.clear();
+        sampleData->collisionConfigs = 0;
+        sampleData->failedSamples = 0;
+
+        try
+        {
+            const double randMult = 1.0 / (double)(boost::mt19937::max)();
+            const int maxLoops = 1000;
+            unsigned int dof = sampleData->nodeSet->getSize();
+            Eigen::VectorXf v(dof);
+
+            for (unsigned int i = 0; i < sampleData->loops; i++)
+            {
+                int loop = 0;
+                bool found = false;
+
+                while (!found && loop < maxLoops)
+                {
+                    for (unsigned int j = 0; j < dof; j++)
+                    {
+                        float rndValue = (float)((double)sampleData->generator() * randMult); // value from 0 to 1
+                        float minJ = (*sampleData->nodeSet)[j]->getJointLimitLo();
+                        float maxJ = (*sampleData->nodeSet)[j]->getJointLimitHi();
+                        v[j] = minJ + ((maxJ - minJ) * rndValue);
+                    }
+
+                    sampleData->nodeSet->setJointValues(v);
+
+                    if (!checkForSelfCollisions || !sampleData->cdm || !sampleData->cdm->isInCollision())
+                    {
+                        found = true;
+                    }
+                    else
+                    {
+                        sampleData->collisionConfigs++;
+                        loop++;
+                    }
+                }
+
+                if (!found)
+                {
+                    sampleData->failedSamples++;
+                    continue;
+                }
+
+                sampleData->tcpPoses.push_back(sampleData->tcpNode->getGlobalPose());
+
+                for (unsigned int j = 0; j < dof; j++)
+                {
+                    sampleData->configs.push_back(v[j]);
+                }
+
+                float value;
+
+                if (evaluateSampledTCPPose(*sampleData, value))
+                {
+                    sampleData->values.push_back(value);
+                }
+            }
+        }
+        catch (...)
+        {
+            sampleData->error = true;
+        }
+    }
+
+    void WorkspaceRepresentation::addSampledTCPPose(const Eigen::Matrix4f& tcpPoseGlobal, const Eigen::VectorXf& config, const float* value)
+    {
+        addPose(tcpPoseGlobal);
+    }
+
+    void WorkspaceRepresentation::setupSampleThread(SampleThreadData& sampleData)
+    {
+    }
+
+    bool WorkspaceRepresentation::evaluateSampledTCPPose(SampleThreadData& sampleData, float& storeValue)
+    {
+        return false;
+    }
+
+    void WorkspaceRepresentation::releaseSampleThread(SampleThreadData& sampleData)
+    {
+    }
+
 } // namespace VirtualRobot
@@ -31,6 +31,8 @@
 
 #include <vector>
 
+#include <boost/random/mersenne_twister.hpp>
+
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 
@@ -68,6 +70,12 @@ namespace VirtualRobot
             EulerXYZExtrinsic   // fixed frame (standard)
         };
 
+        enum eFileFormat
+        {
+            eCompressedBZip2,   // the data is compressed as one BZip2 stream (standard)
+            eBlockIndexed       // the rotation data of each position is stored in an independent (RLE compressed) block, the file is memory mapped on load
+        };
+
         WorkspaceRepresentation(RobotPtr robot);
 
         /*!
@@ -77,15 +85,32 @@ namespace VirtualRobot
 
         /*!
             Load the workspace data from a binary file.
+            Files in the block indexed format are memory mapped, the data is decoded lazily on access (\see WorkspaceDataMapped).
             Exceptions are thrown on case errors are detected.
         */
         virtual void load(const std::string& filename);
 
         /*!
             Store the workspace data to a binary file.
+            \param filename The file.
+            \param format With eBlockIndexed the file can be loaded without decoding the complete data, which is useful for large workspace representations.
+                   Such files result in larger file sizes and can't be read by older versions.
+            \param compressBlocks Only used with eBlockIndexed: If not set, the blocks are stored uncompressed and can be accessed directly in the mapped file.
             Exceptions are thrown on case errors are detected.
         */
-        virtual void save(const std::string& filename);
+        virtual void save(const std::string& filename, eFileFormat format = eCompressedBZip2, bool compressBlocks = true);
+
+        /*!
+            The maximum number of decoded data blocks that are cached when block indexed files are loaded (standard: 4096).
+            Has to be set before loading.
+        */
+        void setBlockCacheSize(unsigned int nrBlocks);
+
+        /*!
+            Store the workspace data in a sparse data structure (\see WorkspaceDataSparse), which reduces the memory consumption of sparsely populated data considerably.
+            Has to be set before the data is initialized or loaded (standard: disabled).
+        */
+        void setUseSparseData(bool enable);
 
         /*!
             Return corresponding entry of workspace data
@@ -346,6 +371,20 @@ namespace VirtualRobot
         */
         void addRandomTCPPoses(unsigned int loops, bool checkForSelfCollisions = true);
 
+        /*!
+            Append a number of random TCP poses to workspace Data by using multiple threads.
+            Each thread operates on its own clone of the robot and the collision models (with its own collision checker) and samples
+            collision-free configurations independently. The threads use their own random number generators which are seeded with seed+threadIndex,
+            the resulting TCP poses are merged in a fixed order. Hence the result only depends on seed and numThreads and can be reproduced.
+            Derived classes that need the robot state for computing the voxel entries (e.g. Manipulability) can evaluate the samples within the
+            worker threads (\see evaluateSampledTCPPose), otherwise the merged samples are evaluated sequentially with the original robot (\see addSampledTCPPose).
+            \param loops Number of poses that should be appended
+            \param numThreads Number of worker threads. If 0, the number of hardware threads is used.
+            \param seed The seed of the random number generators.
+            \param checkForSelfCollisions Build collision-free configurations. If true, random configs are generated until one is collision-free.
+        */
+        void addRandomTCPPosesMultiThreaded(unsigned int loops, unsigned int numThreads, unsigned int seed, bool checkForSelfCollisions = true);
+
         void setVoxelEntry(unsigned int v[6], unsigned char e);
         void setEntry(const Eigen::Matrix4f& poseGlobal, unsigned char e);
         void setEntryCheckNeighbors(const Eigen::Matrix4f& poseGlobal, unsigned char e, unsigned int neighborVoxels);
@@ -396,6 +435,57 @@ namespace VirtualRobot
         virtual void customInitialize() {}
         virtual void customPrint() {}
 
+        /*!
+            Adds a sample that was generated by addRandomTCPPosesMultiThreaded().
+            Derived classes which need the robot state for computing the entry can use config in order to set the joint values of nodeSet.
+            \param tcpPoseGlobal The global pose of the TCP.
+            \param config The corresponding configuration of nodeSet.
+            \param value The value that was computed by evaluateSampledTCPPose() within the worker thread, NULL if no value was computed.
+        */
+        virtual void addSampledTCPPose(const Eigen::Matrix4f& tcpPoseGlobal, const Eigen::VectorXf& config, const float* value);
+
+        //! Data of one worker thread of addRandomTCPPosesMultiThreaded()
+        struct SampleThreadData
+        {
+            unsigned int threadIndex;
+            RobotPtr robot;
+            RobotNodeSetPtr nodeSet;
+            RobotNodePtr tcpNode;
+            CDManagerPtr cdm;
+            boost::mt19937 generator;
+            unsigned int loops;
+            std::vector< Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > tcpPoses;
+            std::vector<float> configs;                         //!< nodeSet->getSize() values per sample
+            std::vector<float> values;                          //!< one value per sample, if evaluateSampledTCPPose() is implemented
+            int collisionConfigs;
+            int failedSamples;
+            bool error;
+        };
+
+        /*!
+            Thread method of addRandomTCPPosesMultiThreaded. Samples sampleData->loops configurations and stores the results in sampleData.
+        */
+        void sampleTCPPoses(SampleThreadData* sampleData, bool checkForSelfCollisions);
+
+        /*!
+            Called by addRandomTCPPosesMultiThreaded() for each worker, after the robot has been cloned. The workers are set up sequentially,
+            so derived classes can create their thread specific data here (e.g. copies of objects that operate on sampleData.robot).
+        */
+        virtual void setupSampleThread(SampleThreadData& sampleData);
+
+        /*!
+            Called within the worker threads of addRandomTCPPosesMultiThreaded() for each sample, while sampleData.robot is in the sampled configuration.
+            Derived classes can compute a value here, which is passed to addSampledTCPPose(). Only thread specific data must be accessed.
+            \return False if no value is computed (standard).
+        */
+        virtual bool evaluateSampledTCPPose(SampleThreadData& sampleData, float& storeValue);
+
+        //! Called by addRandomTCPPosesMultiThreaded() for each worker when all samples have been merged. Thread specific data can be released here.
+        virtual void releaseSampleThread(SampleThreadData& sampleData);
+
+        //! Creates an empty data structure according to numVoxels.
+        WorkspaceDataPtr createData(bool adjustOnOverflow) const;
+
         //! Uncompress the data
         void uncompressData(const unsigned char* source, int size, unsigned char* dest);
         //! Compress the data
@@ -444,6 +534,9 @@ namespace VirtualRobot
         int versionMajor;
         int versionMinor;
 
+        unsigned int blockCacheSize;
+        bool useSparseData;
+
         //! Specifies how the rotation part (x[3],x[4],x[5]) of an 6D voxel entry is encoded.
         eOrientationType orientationType;
 
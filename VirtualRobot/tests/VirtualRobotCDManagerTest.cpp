@@ -0,0 +1,267 @@
+/**
+* @package    VirtualRobot
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE VirtualRobot_VirtualRobotCDManagerTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/Obstacle.h>
+#include <VirtualRobot/SceneObjectSet.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/CollisionDetection/CDManager.h>
+#include <VirtualRobot/CollisionDetection/CollisionChecker.h>
+#include <VirtualRobot/CollisionDetection/CollisionModel.h>
+#include <VirtualRobot/CollisionDetection/AllowedCollisionMatrix.h>
+#include <string>
+#include <cstdlib>
+
+#include <boost/filesystem.hpp>
+
+#include <Eigen/Core>
+
+using namespace VirtualRobot;
+using namespace VirtualRobotTest;
+
+namespace
+{
+    /*
+        A chain of three links with limited joint ranges on a base, two overlapping (fixed) sensor boxes are attached to the base.
+        Adjacent pairs: Base-Joint1, Joint1-Joint2, Joint2-Joint3, Base-SensorA, Base-SensorB
+        Always colliding: SensorA-SensorB
+        All other pairs never collide.
+    */
+    RobotPtr createRobot()
+    {
+        const std::string robotString =
+            "<Robot Type='ACMTestRobot' RootNode='Base'>"
+            " <RobotNode name='Base'>"
+            "  <Child name='Joint1'/>"
+            "  <Child name='SensorA'/>"
+            "  <Child name='SensorB'/>"
+            " </RobotNode>"
+            " <RobotNode name='SensorA'/>"
+            " <RobotNode name='SensorB'/>"
+            " <RobotNode name='Joint1'>"
+            "  <Transform><Translation x='0' y='0' z='100'/></Transform>"
+            "  <Joint type='revolute'>"
+            "    <axis x='1' y='0' z='0'/>"
+            "    <Limits unit='radian' lo='-0.3' hi='0.3'/>"
+            "  </Joint>"
+            "  <Child name='Joint2'/>"
+            " </RobotNode>"
+            " <RobotNode name='Joint2'>"
+            "  <Transform><Translation x='0' y='0' z='220'/></Transform>"
+            "  <Joint type='revolute'>"
+            "    <axis x='1' y='0' z='0'/>"
+            "    <Limits unit='radian' lo='-0.3' hi='0.3'/>"
+            "  </Joint>"
+            "  <Child name='Joint3'/>"
+            " </RobotNode>"
+            " <RobotNode name='Joint3'>"
+            "  <Transform><Translation x='0' y='0' z='220'/></Transform>"
+            "  <Joint type='revolute'>"
+            "    <axis x='1' y='0' z='0'/>"
+            "    <Limits unit='radian' lo='-1.5' hi='1.5'/>"
+            "  </Joint>"
+            " </RobotNode>"
+            "</Robot>";
+        RobotPtr robot = RobotIO::createRobotFromString(robotString);
+        BOOST_REQUIRE(robot);
+
+        robot->getRobotNode("Base")->setCollisionModel(createBox(Eigen::Vector3f(-50, -50, 0), Eigen::Vector3f(50, 50, 100), "Base"));
+        robot->getRobotNode("SensorA")->setCollisionModel(createBox(Eigen::Vector3f(60, -20, 0), Eigen::Vector3f(100, 20, 40), "SensorA"));
+        robot->getRobotNode("SensorB")->setCollisionModel(createBox(Eigen::Vector3f(80, -20, 0), Eigen::Vector3f(120, 20, 40), "SensorB"));
+        robot->getRobotNode("Joint1")->setCollisionModel(createBox(Eigen::Vector3f(-40, -40, 20), Eigen::Vector3f(40, 40, 200), "Joint1"));
+        robot->getRobotNode("Joint2")->setCollisionModel(createBox(Eigen::Vector3f(-40, -40, 20), Eigen::Vector3f(40, 40, 200), "Joint2"));
+        robot->getRobotNode("Joint3")->setCollisionModel(createBox(Eigen::Vector3f(-40, -40, 20), Eigen::Vector3f(40, 40, 200), "Joint3"));
+        robot->applyJointValues();
+        return robot;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(CollisionManager)
+
+BOOST_AUTO_TEST_CASE(testAllowedCollisionMatrixCompute)
+{
+    RobotPtr robot = createRobot();
+    robot->getRobotNode("Joint3")->setJointValue(0.2f);
+
+    srand(42);
+    AllowedCollisionMatrixPtr acm = AllowedCollisionMatrix::compute(robot, 500);
+    BOOST_REQUIRE(acm);
+    BOOST_CHECK_EQUAL(acm->getRobotName(), robot->getName());
+
+    // the configuration is restored
+    BOOST_CHECK_SMALL(robot->getRobotNode("Joint3")->getJointValue() - 0.2f, 1e-6f);
+
+    AllowedCollisionMatrix::Reason r;
+    BOOST_REQUIRE(acm->getReason("Base", "Joint1", r));
+    BOOST_CHECK_EQUAL(r, AllowedCollisionMatrix::eAdjacent);
+    BOOST_REQUIRE(acm->getReason("Joint2", "Joint1", r));
+    BOOST_CHECK_EQUAL(r, AllowedCollisionMatrix::eAdjacent);
+    BOOST_REQUIRE(acm->getReason("Joint3", "Joint2", r));
+    BOOST_CHECK_EQUAL(r, AllowedCollisionMatrix::eAdjacent);
+    BOOST_REQUIRE(acm->getReason("SensorA", "SensorB", r));
+    BOOST_CHECK_EQUAL(r, AllowedCollisionMatrix::eAlwaysColliding);
+    BOOST_REQUIRE(acm->getReason("Base", "Joint2", r));
+    BOOST_CHECK_EQUAL(r, AllowedCollisionMatrix::eNeverColliding);
+    BOOST_REQUIRE(acm->getReason("SensorA", "Joint3", r));
+    BOOST_CHECK_EQUAL(r, AllowedCollisionMatrix::eNeverColliding);
+
+    // 6 nodes -> 15 pairs, all of them can be disabled
+    BOOST_CHECK_EQUAL(acm->getNrOfDisabledPairs(), 15u);
+    BOOST_CHECK(acm->isDisabled("Joint1", "Base"));
+
+    acm->enablePair("Joint1", "Base");
+    BOOST_CHECK(!acm->isDisabled("Base", "Joint1"));
+    BOOST_CHECK_EQUAL(acm->getNrOfDisabledPairs(), 14u);
+}
+
+BOOST_AUTO_TEST_CASE(testAllowedCollisionMatrixSaveLoad)
+{
+    AllowedCollisionMatrix acm("MyRobot");
+    acm.disablePair("a", "b", AllowedCollisionMatrix::eAdjacent);
+    acm.disablePair("c", "a", AllowedCollisionMatrix::eNeverColliding);
+    acm.disablePair("b", "c", AllowedCollisionMatrix::eAlwaysColliding);
+    acm.disablePair("d", "e");
+
+    boost::filesystem::path tmpFile = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("simox_acm_%%%%%%%%.acm.xml");
+    BOOST_REQUIRE(acm.save(tmpFile.string()));
+
+    AllowedCollisionMatrixPtr loaded = AllowedCollisionMatrix::load(tmpFile.string());
+    boost::filesystem::remove(tmpFile);
+
+    BOOST_REQUIRE(loaded);
+    BOOST_CHECK_EQUAL(loaded->getRobotName(), "MyRobot");
+    BOOST_CHECK_EQUAL(loaded->getNrOfDisabledPairs(), 4u);
+
+    AllowedCollisionMatrix::Reason r;
+    BOOST_REQUIRE(loaded->getReason("b", "a", r));
+    BOOST_CHECK_EQUAL(r, AllowedCollisionMatrix::eAdjacent);
+    BOOST_REQUIRE(loaded->getReason("a", "c", r));
+    BOOST_CHECK_EQUAL(r, AllowedCollisionMatrix::eNeverColliding);
+    BOOST_REQUIRE(loaded->getReason("b", "c", r));
+    BOOST_CHECK_EQUAL(r, AllowedCollisionMatrix::eAlwaysColliding);
+    BOOST_REQUIRE(loaded->getReason("e", "d", r));
+    BOOST_CHECK_EQUAL(r, AllowedCollisionMatrix::eUser);
+    BOOST_CHECK(!loaded->isDisabled("a", "d"));
+}
+
+BOOST_AUTO_TEST_CASE(testCDManagerAllowedCollisionMatrix)
+{
+    RobotPtr robot = createRobot();
+    ObstaclePtr obstacle(new Obstacle("Obstacle", VisualizationNodePtr(), createBox(Eigen::Vector3f(-200, 100, 400), Eigen::Vector3f(200, 300, 800), "Obstacle")));
+    obstacle->setGlobalPose(Eigen::Matrix4f::Identity());
+
+    SceneObjectSetPtr robotSet(new SceneObjectSet("Robot"));
+    std::vector<RobotNodePtr> nodes = robot->getRobotNodes();
+
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        robotSet->addSceneObject(nodes[i]);
+    }
+
+    SceneObjectSetPtr sensors(new SceneObjectSet("Sensors"));
+    sensors->addSceneObject(robot->getRobotNode("SensorA"));
+    SceneObjectSetPtr obstacles(new SceneObjectSet("Obstacles"));
+    obstacles->addSceneObject(obstacle);
+
+    CDManager cdm;
+    cdm.addCollisionModelPair(obstacles, robotSet);
+    cdm.addCollisionModelPair(robot->getRobotNode("SensorB"), sensors);
+    BOOST_CHECK_EQUAL(cdm.getNrOfCheckedPairs(), 7u);
+
+    // the sensors overlap
+    BOOST_CHECK(cdm.isInCollision());
+
+    srand(43);
+    AllowedCollisionMatrixPtr acm = AllowedCollisionMatrix::compute(robot, 200);
+    cdm.setAllowedCollisionMatrix(acm);
+    BOOST_CHECK(cdm.getAllowedCollisionMatrix() == acm);
+    BOOST_CHECK_EQUAL(cdm.getNrOfCheckedPairs(), 6u);
+
+    // compare with checking all pairs that are not disabled
+    CollisionCheckerPtr colChecker = cdm.getCollisionChecker();
+    int nrCollisions = 0;
+
+    for (int k = 0; k < 200; k++)
+    {
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            if (nodes[i]->isRotationalJoint())
+            {
+                nodes[i]->setJointValue(nodes[i]->getJointLimitLo() + (nodes[i]->getJointLimitHi() - nodes[i]->getJointLimitLo()) * float(rand()) / float(RAND_MAX));
+            }
+        }
+
+        bool expected = false;
+
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            expected |= colChecker->checkCollision(obstacle->getCollisionModel(), nodes[i]->getCollisionModel());
+        }
+
+        BOOST_CHECK_EQUAL(cdm.isInCollision(), expected);
+        nrCollisions += expected ? 1 : 0;
+    }
+
+    BOOST_CHECK_GT(nrCollisions, 0);
+    BOOST_CHECK_LT(nrCollisions, 200);
+
+    // adding objects to a set updates the pairs
+    ObstaclePtr obstacle2(new Obstacle("Obstacle2", VisualizationNodePtr(), createBox(Eigen::Vector3f(-50, -50, -50), Eigen::Vector3f(50, 50, 50), "Obstacle2")));
+    Eigen::Matrix4f gp = Eigen::Matrix4f::Identity();
+    gp(0, 3) = 1000.0f;
+    obstacle2->setGlobalPose(gp);
+    obstacles->addSceneObject(obstacle2);
+    BOOST_CHECK_EQUAL(cdm.getNrOfCheckedPairs(), 12u);
+
+    cdm.setAllowedCollisionMatrix(AllowedCollisionMatrixPtr());
+    BOOST_CHECK_EQUAL(cdm.getNrOfCheckedPairs(), 13u);
+    BOOST_CHECK(cdm.isInCollision());
+}
+
+BOOST_AUTO_TEST_CASE(testCDManagerAllowedCollisionMatrixObjects)
+{
+    RobotPtr robot = createRobot();
+    RobotPtr robot2 = createRobot();
+    srand(43);
+    AllowedCollisionMatrixPtr acm = AllowedCollisionMatrix::compute(robot, 200);
+    BOOST_REQUIRE(acm->isDisabled("SensorA", "SensorB"));
+
+    // pairs are only disabled for nodes of the same robot
+    BOOST_CHECK(acm->isDisabled(robot->getRobotNode("SensorA"), robot->getRobotNode("SensorB")));
+    BOOST_CHECK(!acm->isDisabled(robot->getRobotNode("SensorA"), robot2->getRobotNode("SensorB")));
+
+    // an obstacle that has the name of a link, placed at the sensor
+    ObstaclePtr obstacle(new Obstacle("SensorB", VisualizationNodePtr(), createBox(Eigen::Vector3f(80, -20, 0), Eigen::Vector3f(120, 20, 40), "SensorB")));
+    obstacle->setGlobalPose(robot->getRobotNode("SensorB")->getGlobalPose());
+    BOOST_CHECK(!acm->isDisabled(robot->getRobotNode("SensorA"), obstacle));
+
+    ObstaclePtr farObstacle(new Obstacle("Far", VisualizationNodePtr(), createBox(Eigen::Vector3f(-50, -50, -50), Eigen::Vector3f(50, 50, 50), "Far")));
+    Eigen::Matrix4f gp = Eigen::Matrix4f::Identity();
+    gp(0, 3) = 1000.0f;
+    farObstacle->setGlobalPose(gp);
+
+    SceneObjectSetPtr obstacles(new SceneObjectSet("Obstacles"));
+    obstacles->addSceneObject(farObstacle);
+
+    CDManager cdm;
+    cdm.setAllowedCollisionMatrix(acm);
+    cdm.addCollisionModelPair(robot->getRobotNode("SensorA"), obstacles);
+    BOOST_CHECK_EQUAL(cdm.getNrOfCheckedPairs(), 1u);
+    BOOST_CHECK(!cdm.isInCollision());
+
+    // exchanging an object of a set (same size) updates the pairs
+    obstacles->removeSceneObject(farObstacle);
+    obstacles->addSceneObject(obstacle);
+    BOOST_CHECK_EQUAL(cdm.getNrOfCheckedPairs(), 1u);
+    BOOST_CHECK(cdm.isInCollision());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
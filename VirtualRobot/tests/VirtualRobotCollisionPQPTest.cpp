@@ -0,0 +1,749 @@
+/**
+* @package    VirtualRobot
+* @author     Nikolaus Vahrenkamp
+* @copyright  2010 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE VirtualRobot_VirtualRobotCollisionPQPTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
+#include <VirtualRobot/CollisionDetection/PQP/PQP++/PQP.h>
+#include <VirtualRobot/CollisionDetection/PQP/CollisionModelPQP.h>
+#include <VirtualRobot/CollisionDetection/CollisionModel.h>
+#include <VirtualRobot/CollisionDetection/CollisionChecker.h>
+#include <VirtualRobot/Visualization/VisualizationNode.h>
+#include <VirtualRobot/Visualization/TriMeshModel.h>
+#include <vector>
+#include <set>
+#include <utility>
+#include <iostream>
+#include <fstream>
+#include <ctime>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+
+#include <boost/filesystem.hpp>
+#include <boost/cstdint.hpp>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+namespace
+{
+    typedef std::vector<Eigen::Vector3f> Triangles;
+
+    float randomFloat(float lo, float hi)
+    {
+        return lo + (hi - lo) * float(rand()) / float(RAND_MAX);
+    }
+
+    // a bumpy, slightly noisy sphere with 2*n*n triangles
+    Triangles createBlob(int n, float radius)
+    {
+        std::vector<Eigen::Vector3f> points;
+
+        for (int i = 0; i <= n; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                float theta = float(M_PI) * float(i) / float(n);
+                float phi = 2.0f * float(M_PI) * float(j) / float(n);
+                float r = radius * (1.0f + 0.2f * sinf(3.0f * theta) * cosf(5.0f * phi)) + randomFloat(-0.01f, 0.01f) * radius;
+                points.push_back(Eigen::Vector3f(r * sinf(theta) * cosf(phi), r * sinf(theta) * sinf(phi), r * cosf(theta)));
+            }
+        }
+
+        Triangles tris;
+
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                int a = i * n + j;
+                int b = i * n + (j + 1) % n;
+                int c = (i + 1) * n + j;
+                int d = (i + 1) * n + (j + 1) % n;
+                tris.push_back(points[a]);
+                tris.push_back(points[c]);
+                tris.push_back(points[b]);
+                tris.push_back(points[b]);
+                tris.push_back(points[c]);
+                tris.push_back(points[d]);
+            }
+        }
+
+        return tris;
+    }
+
+    void buildModel(PQP::PQP_Model& m, const Triangles& tris, int first, int count)
+    {
+        m.BeginModel(count);
+
+        for (int i = first; i < first + count; i++)
+        {
+            m.AddTri(tris[i * 3].data(), tris[i * 3 + 1].data(), tris[i * 3 + 2].data(), i);
+        }
+
+        m.EndModel();
+    }
+
+    VirtualRobot::VisualizationNodePtr createVisualization(const Triangles& tris)
+    {
+        VirtualRobot::TriMeshModelPtr model(new VirtualRobot::TriMeshModel());
+
+        for (size_t i = 0; i + 2 < tris.size(); i += 3)
+        {
+            Eigen::Vector3f a = tris[i];
+            Eigen::Vector3f b = tris[i + 1];
+            Eigen::Vector3f c = tris[i + 2];
+            model->addTriangleWithFace(a, b, c);
+        }
+
+        return VirtualRobot::VisualizationNodePtr(new VirtualRobotTest::MeshVisualizationNode(model));
+    }
+
+    void createVisualizations(const std::vector<Triangles>& meshes, std::vector<VirtualRobot::VisualizationNodePtr>& storeVisus)
+    {
+        storeVisus.clear();
+
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            storeVisus.push_back(createVisualization(meshes[i]));
+        }
+    }
+
+    bool equalBV(const PQP::BV& a, const PQP::BV& b)
+    {
+        return memcmp(a.R, b.R, sizeof(a.R)) == 0 && memcmp(a.Tr, b.Tr, sizeof(a.Tr)) == 0 && memcmp(a.l, b.l, sizeof(a.l)) == 0
+               && a.r == b.r && memcmp(a.To, b.To, sizeof(a.To)) == 0 && memcmp(a.d, b.d, sizeof(a.d)) == 0 && a.first_child == b.first_child;
+    }
+
+    void randomPose(PQP::PQP_REAL R[3][3], PQP::PQP_REAL T[3], float maxTranslation)
+    {
+        Eigen::Matrix3f m = (Eigen::AngleAxisf(randomFloat(-3.14f, 3.14f), Eigen::Vector3f::UnitX()) *
+                             Eigen::AngleAxisf(randomFloat(-3.14f, 3.14f), Eigen::Vector3f::UnitY()) *
+                             Eigen::AngleAxisf(randomFloat(-3.14f, 3.14f), Eigen::Vector3f::UnitZ())).toRotationMatrix();
+
+        for (int i = 0; i < 3; i++)
+        {
+            for (int j = 0; j < 3; j++)
+            {
+                R[i][j] = m(i, j);
+            }
+
+            T[i] = randomFloat(-maxTranslation, maxTranslation);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(CollisionPQP)
+
+BOOST_AUTO_TEST_CASE(testPQPCollideAllContacts)
+{
+    srand(42);
+    Triangles tris1 = createBlob(10, 100.0f);
+    Triangles tris2 = createBlob(8, 60.0f);
+    int n1 = (int)tris1.size() / 3;
+    int n2 = (int)tris2.size() / 3;
+
+    PQP::PQP_Model m1, m2;
+    buildModel(m1, tris1, 0, n1);
+    buildModel(m2, tris2, 0, n2);
+
+    // single triangle models for the brute force reference
+    std::vector<PQP::PQP_Model*> single1(n1), single2(n2);
+
+    for (int i = 0; i < n1; i++)
+    {
+        single1[i] = new PQP::PQP_Model();
+        buildModel(*single1[i], tris1, i, 1);
+    }
+
+    for (int i = 0; i < n2; i++)
+    {
+        single2[i] = new PQP::PQP_Model();
+        buildModel(*single2[i], tris2, i, 1);
+    }
+
+    PQP::PQP_Checker checker;
+    PQP::PQP_REAL R1[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    PQP::PQP_REAL T1[3] = {0, 0, 0};
+    int nrColliding = 0;
+
+    for (int k = 0; k < 20; k++)
+    {
+        PQP::PQP_REAL R2[3][3], T2[3];
+        randomPose(R2, T2, 150.0f);
+
+        PQP::PQP_CollideResult result;
+        checker.PQP_Collide(&result, R1, T1, &m1, R2, T2, &m2, PQP::PQP_ALL_CONTACTS);
+        std::set< std::pair<int, int> > contacts;
+
+        for (int i = 0; i < result.NumPairs(); i++)
+        {
+            contacts.insert(std::make_pair(result.Id1(i), result.Id2(i)));
+        }
+
+        // each pair is reported once
+        BOOST_CHECK_EQUAL(contacts.size(), (size_t)result.NumPairs());
+
+        std::set< std::pair<int, int> > expected;
+
+        for (int i = 0; i < n1; i++)
+        {
+            for (int j = 0; j < n2; j++)
+            {
+                PQP::PQP_CollideResult r;
+                checker.PQP_Collide(&r, R1, T1, single1[i], R2, T2, single2[j], PQP::PQP_FIRST_CONTACT);
+
+                if (r.Colliding())
+                {
+                    expected.insert(std::make_pair(i, j));
+                }
+            }
+        }
+
+        BOOST_CHECK(contacts == expected);
+
+        // first contact has to be one of the contacts
+        PQP::PQP_CollideResult first;
+        checker.PQP_Collide(&first, R1, T1, &m1, R2, T2, &m2, PQP::PQP_FIRST_CONTACT);
+        BOOST_CHECK_EQUAL(first.Colliding() != 0, !expected.empty());
+
+        if (first.Colliding())
+        {
+            BOOST_CHECK(expected.count(std::make_pair(first.Id1(0), first.Id2(0))) == 1);
+            nrColliding++;
+        }
+    }
+
+    BOOST_CHECK_GT(nrColliding, 0);
+
+    for (int i = 0; i < n1; i++)
+    {
+        delete single1[i];
+    }
+
+    for (int i = 0; i < n2; i++)
+    {
+        delete single2[i];
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testPQPDistance)
+{
+    srand(43);
+    Triangles tris1 = createBlob(10, 100.0f);
+    Triangles tris2 = createBlob(8, 60.0f);
+    int n1 = (int)tris1.size() / 3;
+    int n2 = (int)tris2.size() / 3;
+
+    PQP::PQP_Model m1, m2;
+    buildModel(m1, tris1, 0, n1);
+    buildModel(m2, tris2, 0, n2);
+
+    PQP::PQP_Checker checker;
+    PQP::PQP_REAL R1[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    PQP::PQP_REAL T1[3] = {0, 0, 0};
+
+    for (int k = 0; k < 20; k++)
+    {
+        PQP::PQP_REAL R2[3][3], T2[3];
+        randomPose(R2, T2, 300.0f);
+
+        PQP::PQP_DistanceResult result;
+        checker.PQP_Distance(&result, R1, T1, &m1, R2, T2, &m2, 0, 0);
+
+        // brute force: minimal distance over all triangle pairs
+        float expected = 1e10f;
+
+        for (int i = 0; i < n1; i++)
+        {
+            PQP::PQP_Model s1;
+            buildModel(s1, tris1, i, 1);
+
+            for (int j = 0; j < n2; j++)
+            {
+                PQP::PQP_Model s2;
+                buildModel(s2, tris2, j, 1);
+                PQP::PQP_DistanceResult r;
+                checker.PQP_Distance(&r, R1, T1, &s1, R2, T2, &s2, 0, 0);
+
+                if (r.Distance() < expected)
+                {
+                    expected = r.Distance();
+                }
+            }
+        }
+
+        BOOST_CHECK_SMALL(result.Distance() - expected, 1e-3f);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testPQPShareModel)
+{
+    srand(45);
+    Triangles tris1 = createBlob(20, 100.0f);
+    Triangles tris2 = createBlob(15, 60.0f);
+
+    PQP::PQP_Model m1, m2;
+    buildModel(m1, tris1, 0, (int)tris1.size() / 3);
+    buildModel(m2, tris2, 0, (int)tris2.size() / 3);
+
+    PQP::PQP_Model empty;
+    BOOST_CHECK_EQUAL(empty.ShareModel(&empty), PQP::PQP_ERR_UNPROCESSED_MODEL);
+
+    PQP::PQP_Checker checker;
+    PQP::PQP_REAL R1[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    PQP::PQP_REAL T1[3] = {0, 0, 0};
+
+    {
+        PQP::PQP_Model shared;
+        BOOST_REQUIRE_EQUAL(shared.ShareModel(&m1), PQP::PQP_OK);
+        BOOST_CHECK(shared.tris == m1.tris);
+        BOOST_CHECK(shared.b == m1.b);
+
+        for (int k = 0; k < 50; k++)
+        {
+            PQP::PQP_REAL R2[3][3], T2[3];
+            randomPose(R2, T2, 200.0f);
+
+            PQP::PQP_CollideResult c1, c2;
+            checker.PQP_Collide(&c1, R1, T1, &m1, R2, T2, &m2, PQP::PQP_ALL_CONTACTS);
+            checker.PQP_Collide(&c2, R1, T1, &shared, R2, T2, &m2, PQP::PQP_ALL_CONTACTS);
+            BOOST_CHECK_EQUAL(c1.NumPairs(), c2.NumPairs());
+
+            PQP::PQP_DistanceResult d1, d2;
+            checker.PQP_Distance(&d1, R1, T1, &m1, R2, T2, &m2, 0, 0);
+            checker.PQP_Distance(&d2, R1, T1, &shared, R2, T2, &m2, 0, 0);
+            BOOST_CHECK_SMALL(d1.Distance() - d2.Distance(), 1e-3f);
+        }
+    }
+
+    // the data is still owned by m1
+    PQP::PQP_REAL T2[3] = {100, 0, 0};
+    PQP::PQP_CollideResult c;
+    BOOST_CHECK_EQUAL(checker.PQP_Collide(&c, R1, T1, &m1, R1, T2, &m2, PQP::PQP_FIRST_CONTACT), PQP::PQP_OK);
+    BOOST_CHECK(c.Colliding());
+}
+
+BOOST_AUTO_TEST_CASE(testCollisionModelSharedData)
+{
+    srand(46);
+    Triangles tris = createBlob(100, 100.0f);
+    VirtualRobot::CollisionCheckerPtr colChecker = VirtualRobot::CollisionChecker::getGlobalCollisionChecker();
+    unsigned int nrShared = VirtualRobot::CollisionModelPQP::getNrOfSharedModels();
+
+    clock_t t1 = clock();
+    VirtualRobot::CollisionModelPtr c1(new VirtualRobot::CollisionModel(createVisualization(tris), "c1"));
+    clock_t t2 = clock();
+    BOOST_CHECK_EQUAL(VirtualRobot::CollisionModelPQP::getNrOfSharedModels(), nrShared + 1);
+
+    // clones share the triangle data and the BVH, but the query state is private
+    VirtualRobot::CollisionModelPtr c2 = c1->clone();
+    clock_t t3 = clock();
+    BOOST_CHECK(c2->getCollisionModelImplementation()->getSharedPQPModel() == c1->getCollisionModelImplementation()->getSharedPQPModel());
+    BOOST_CHECK(c2->getCollisionModelImplementation()->getPQPModel() != c1->getCollisionModelImplementation()->getPQPModel());
+    BOOST_CHECK_EQUAL(c2->getNumFaces(), c1->getNumFaces());
+    BOOST_CHECK(c2->getTriMeshModel() != c1->getTriMeshModel());
+
+    VirtualRobot::CollisionCheckerPtr colChecker2(new VirtualRobot::CollisionChecker());
+    VirtualRobot::CollisionModelPtr c5 = c1->clone(colChecker2);
+    BOOST_CHECK(c5->getCollisionChecker() == colChecker2);
+    BOOST_CHECK(c5->getCollisionModelImplementation()->getSharedPQPModel() == c1->getCollisionModelImplementation()->getSharedPQPModel());
+
+    // an independently created model with the same content shares the data, too
+    VirtualRobot::CollisionModelPtr c3(new VirtualRobot::CollisionModel(createVisualization(tris), "c3"));
+    BOOST_CHECK(c3->getCollisionModelImplementation()->getSharedPQPModel() == c1->getCollisionModelImplementation()->getSharedPQPModel());
+
+    // scaled clones get their own data
+    clock_t t4 = clock();
+    VirtualRobot::CollisionModelPtr c4 = c1->clone(colChecker, 1.01f);
+    clock_t t5 = clock();
+    BOOST_CHECK(c4->getCollisionModelImplementation()->getSharedPQPModel() != c1->getCollisionModelImplementation()->getSharedPQPModel());
+    BOOST_CHECK_EQUAL(VirtualRobot::CollisionModelPQP::getNrOfSharedModels(), nrShared + 2);
+
+    // the clone is posed independently
+    Eigen::Matrix4f p = Eigen::Matrix4f::Identity();
+    p(0, 3) = 50.0f;
+    c3->setGlobalPose(p);
+    p(0, 3) = 1000.0f;
+    c2->setGlobalPose(p);
+    BOOST_CHECK(colChecker->checkCollision(c1, c3));
+    BOOST_CHECK(!colChecker->checkCollision(c1, c2));
+    BOOST_CHECK(!colChecker->checkCollision(c2, c3));
+    p(0, 3) = 50.0f;
+    c2->setGlobalPose(p);
+    BOOST_CHECK(colChecker->checkCollision(c1, c2));
+    p(0, 3) = 300.0f;
+    c2->setGlobalPose(p);
+    c3->setGlobalPose(p);
+    BOOST_CHECK_SMALL(colChecker->calculateDistance(c1, c2) - colChecker->calculateDistance(c1, c3), 1e-3f);
+
+    std::cout << "CollisionModel with " << c1->getNumFaces() << " triangles: creation " << (double)(t2 - t1) * 1000.0 / CLOCKS_PER_SEC
+              << " ms, clone " << (double)(t3 - t2) * 1000.0 / CLOCKS_PER_SEC << " ms, scaled clone (rebuild) " << (double)(t5 - t4) * 1000.0 / CLOCKS_PER_SEC << " ms" << std::endl;
+
+    // the data is released with the last model
+    c1.reset();
+    c2.reset();
+    c3.reset();
+    c4.reset();
+    c5.reset();
+    BOOST_CHECK_EQUAL(VirtualRobot::CollisionModelPQP::getNrOfSharedModels(), nrShared);
+}
+
+BOOST_AUTO_TEST_CASE(testCollisionModelCache)
+{
+    const int nrModels = 30;
+    std::vector<Triangles> meshes;
+    srand(47);
+
+    for (int i = 0; i < nrModels; i++)
+    {
+        meshes.push_back(createBlob(50, 50.0f + float(i)));
+    }
+
+    boost::filesystem::path cacheDir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vr_bvh_cache_%%%%-%%%%-%%%%");
+    std::string oldCacheDir = VirtualRobot::CollisionModelPQP::getCacheDirectory();
+
+    // reference data, built without cache
+    VirtualRobot::CollisionModelPQP::setCacheDirectory("");
+    std::vector< std::vector<PQP::Tri> > refTris(nrModels);
+    std::vector< std::vector<PQP::BV> > refBVs(nrModels);
+    std::vector<VirtualRobot::CollisionModelPtr> models(nrModels);
+    std::vector<VirtualRobot::VisualizationNodePtr> visus;
+
+    createVisualizations(meshes, visus);
+    clock_t t1 = clock();
+
+    for (int i = 0; i < nrModels; i++)
+    {
+        models[i].reset(new VirtualRobot::CollisionModel(visus[i]));
+    }
+
+    clock_t t2 = clock();
+
+    for (int i = 0; i < nrModels; i++)
+    {
+        boost::shared_ptr<const PQP::PQP_Model> m = models[i]->getCollisionModelImplementation()->getSharedPQPModel();
+        BOOST_REQUIRE(m);
+        refTris[i].assign(m->tris, m->tris + m->num_tris);
+        refBVs[i].assign(m->b, m->b + m->num_bvs);
+        models[i].reset();
+    }
+
+    // the first run builds the models and writes the cache files
+    VirtualRobot::CollisionModelPQP::setCacheDirectory(cacheDir.string());
+    BOOST_REQUIRE(boost::filesystem::is_directory(cacheDir));
+
+    createVisualizations(meshes, visus);
+    clock_t t3 = clock();
+
+    for (int i = 0; i < nrModels; i++)
+    {
+        models[i].reset(new VirtualRobot::CollisionModel(visus[i]));
+    }
+
+    clock_t t4 = clock();
+
+    std::vector<std::string> files;
+
+    for (boost::filesystem::directory_iterator it(cacheDir); it != boost::filesystem::directory_iterator(); it++)
+    {
+        files.push_back(it->path().string());
+    }
+
+    BOOST_CHECK_EQUAL(files.size(), (size_t)nrModels);
+
+    for (int i = 0; i < nrModels; i++)
+    {
+        models[i].reset();
+    }
+
+    // the second run maps the cache files
+    createVisualizations(meshes, visus);
+    clock_t t5 = clock();
+
+    for (int i = 0; i < nrModels; i++)
+    {
+        models[i].reset(new VirtualRobot::CollisionModel(visus[i]));
+    }
+
+    clock_t t6 = clock();
+
+    for (int i = 0; i < nrModels; i++)
+    {
+        boost::shared_ptr<const PQP::PQP_Model> m = models[i]->getCollisionModelImplementation()->getSharedPQPModel();
+        BOOST_REQUIRE(m);
+        BOOST_REQUIRE_EQUAL(m->num_tris, (int)refTris[i].size());
+        BOOST_REQUIRE_EQUAL(m->num_bvs, (int)refBVs[i].size());
+        BOOST_CHECK(memcmp(m->tris, &refTris[i][0], refTris[i].size() * sizeof(PQP::Tri)) == 0);
+
+        int nrEqualBVs = 0;
+
+        for (int j = 0; j < m->num_bvs; j++)
+        {
+            nrEqualBVs += equalBV(m->b[j], refBVs[i][j]) ? 1 : 0;
+        }
+
+        BOOST_CHECK_EQUAL(nrEqualBVs, m->num_bvs);
+    }
+
+    VirtualRobot::CollisionCheckerPtr colChecker = VirtualRobot::CollisionChecker::getGlobalCollisionChecker();
+    Eigen::Matrix4f p = Eigen::Matrix4f::Identity();
+    p(0, 3) = 60.0f;
+    models[1]->setGlobalPose(p);
+    BOOST_CHECK(colChecker->checkCollision(models[0], models[1]));
+    p(0, 3) = 300.0f;
+    models[1]->setGlobalPose(p);
+    BOOST_CHECK(!colChecker->checkCollision(models[0], models[1]));
+
+    for (int i = 0; i < nrModels; i++)
+    {
+        models[i].reset();
+    }
+
+    // the bytewise validation of the cached triangles (debugging option)
+    VirtualRobot::CollisionModelPQP::setTriangleValidation(true);
+    createVisualizations(meshes, visus);
+    clock_t t7 = clock();
+
+    for (int i = 0; i < nrModels; i++)
+    {
+        models[i].reset(new VirtualRobot::CollisionModel(visus[i]));
+    }
+
+    clock_t t8 = clock();
+    VirtualRobot::CollisionModelPQP::setTriangleValidation(false);
+
+    BOOST_TEST_MESSAGE("Startup with " << nrModels << " models of " << refTris[0].size() << " triangles: no cache " << (double)(t2 - t1) * 1000.0 / CLOCKS_PER_SEC
+                       << " ms, building the cache " << (double)(t4 - t3) * 1000.0 / CLOCKS_PER_SEC << " ms, cached " << (double)(t6 - t5) * 1000.0 / CLOCKS_PER_SEC
+                       << " ms, cached with triangle validation " << (double)(t8 - t7) * 1000.0 / CLOCKS_PER_SEC << " ms");
+
+    for (int i = 0; i < nrModels; i++)
+    {
+        models[i].reset();
+    }
+
+    // broken or outdated files are replaced
+    boost::uintmax_t fileSize = boost::filesystem::file_size(files[0]);
+    boost::filesystem::resize_file(files[0], 100);
+
+    // a different digest of the triangle data (stored at byte 40)
+    {
+        std::fstream f(files[1].c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        boost::uint64_t digest;
+        f.seekg(40);
+        f.read((char*)&digest, sizeof(boost::uint64_t));
+        digest++;
+        f.seekp(40);
+        f.write((const char*)&digest, sizeof(boost::uint64_t));
+    }
+
+    // a child index out of range (the offset of the bounding volumes is stored at byte 64)
+    {
+        std::fstream f(files[2].c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        boost::uint64_t bvsOffset;
+        PQP::BV bv;
+        f.seekg(64);
+        f.read((char*)&bvsOffset, sizeof(boost::uint64_t));
+        f.seekg(bvsOffset);
+        f.read((char*)&bv, sizeof(PQP::BV));
+        bv.first_child = 1000000;
+        f.seekp(bvsOffset);
+        f.write((const char*)&bv, sizeof(PQP::BV));
+    }
+
+    for (int i = 0; i < nrModels; i++)
+    {
+        models[i].reset(new VirtualRobot::CollisionModel(createVisualization(meshes[i])));
+        boost::shared_ptr<const PQP::PQP_Model> m = models[i]->getCollisionModelImplementation()->getSharedPQPModel();
+        BOOST_REQUIRE_EQUAL(m->num_tris, (int)refTris[i].size());
+        BOOST_REQUIRE_EQUAL(m->num_bvs, (int)refBVs[i].size());
+        BOOST_CHECK(memcmp(m->tris, &refTris[i][0], refTris[i].size() * sizeof(PQP::Tri)) == 0);
+
+        int nrEqualBVs = 0;
+
+        for (int j = 0; j < m->num_bvs; j++)
+        {
+            nrEqualBVs += equalBV(m->b[j], refBVs[i][j]) ? 1 : 0;
+        }
+
+        BOOST_CHECK_EQUAL(nrEqualBVs, m->num_bvs);
+    }
+
+    BOOST_CHECK_EQUAL(boost::filesystem::file_size(files[0]), fileSize);
+
+    // a modified triangle (the offset of the triangles is stored at byte 56) is only detected by the validation
+    models[3].reset();
+    {
+        std::fstream f(files[3].c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        boost::uint64_t trisOffset;
+        PQP::Tri t;
+        f.seekg(56);
+        f.read((char*)&trisOffset, sizeof(boost::uint64_t));
+        f.seekg(trisOffset);
+        f.read((char*)&t, sizeof(PQP::Tri));
+        t.p2[1] += 1.0f;
+        f.seekp(trisOffset);
+        f.write((const char*)&t, sizeof(PQP::Tri));
+    }
+
+    VirtualRobot::CollisionModelPQP::setTriangleValidation(true);
+    models[3].reset(new VirtualRobot::CollisionModel(createVisualization(meshes[3])));
+    VirtualRobot::CollisionModelPQP::setTriangleValidation(false);
+    {
+        boost::shared_ptr<const PQP::PQP_Model> m = models[3]->getCollisionModelImplementation()->getSharedPQPModel();
+        BOOST_REQUIRE_EQUAL(m->num_tris, (int)refTris[3].size());
+        BOOST_CHECK(memcmp(m->tris, &refTris[3][0], refTris[3].size() * sizeof(PQP::Tri)) == 0);
+    }
+
+    models.clear();
+    VirtualRobot::CollisionModelPQP::setCacheDirectory(oldCacheDir);
+    boost::filesystem::remove_all(cacheDir);
+}
+
+BOOST_AUTO_TEST_CASE(testPQPDistanceCache)
+{
+    srand(47);
+    VirtualRobot::CollisionCheckerPtr colChecker(new VirtualRobot::CollisionChecker());
+    BOOST_CHECK(!colChecker->isDistanceCacheEnabled());
+
+    // a moving model that is queried against several obstacles in turn
+    VirtualRobot::CollisionModelPtr mover(new VirtualRobot::CollisionModel(createVisualization(createBlob(60, 100.0f)), "mover", colChecker));
+    std::vector<VirtualRobot::CollisionModelPtr> obstacles;
+
+    for (int i = 0; i < 4; i++)
+    {
+        VirtualRobot::CollisionModelPtr o(new VirtualRobot::CollisionModel(createVisualization(createBlob(60, 80.0f)), "obstacle", colChecker));
+        Eigen::Matrix4f p = Eigen::Matrix4f::Identity();
+        p.block(0, 3, 3, 1) = Eigen::AngleAxisf(float(i) * float(M_PI) * 0.5f, Eigen::Vector3f::UnitZ()) * Eigen::Vector3f(400.0f, 0, 0);
+        o->setGlobalPose(p);
+        obstacles.push_back(o);
+    }
+
+    const int nrSteps = 300;
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > poses;
+
+    for (int k = 0; k < nrSteps; k++)
+    {
+        float t = float(k) / float(nrSteps);
+        Eigen::Matrix4f p = Eigen::Matrix4f::Identity();
+        p.block(0, 0, 3, 3) = Eigen::AngleAxisf(t * 2.0f, Eigen::Vector3f(1.0f, 1.0f, 0).normalized()).toRotationMatrix();
+        p(0, 3) = 100.0f * cosf(t * 6.28f);
+        p(1, 3) = 100.0f * sinf(t * 6.28f);
+        poses.push_back(p);
+    }
+
+    std::vector<float> distances[3];
+    clock_t times[3];
+    Eigen::Vector3f p1, p2;
+
+    for (int mode = 0; mode < 3; mode++)
+    {
+        colChecker->enableDistanceCache(mode > 0);
+        colChecker->setDistanceTolerance(mode == 2 ? 0.05f : 0.0f, 0.0f);
+        clock_t t1 = clock();
+
+        for (int k = 0; k < nrSteps; k++)
+        {
+            mover->setGlobalPose(poses[k]);
+
+            for (size_t i = 0; i < obstacles.size(); i++)
+            {
+                distances[mode].push_back(colChecker->calculateDistance(mover, obstacles[i], p1, p2));
+
+                // the reported points correspond to the distance
+                BOOST_CHECK_SMALL((p1 - p2).norm() - distances[mode].back(), 1e-2f);
+            }
+        }
+
+        times[mode] = clock() - t1;
+    }
+
+    BOOST_CHECK_EQUAL(colChecker->getCollisionCheckerImplementation()->getDistanceCacheSize(), obstacles.size());
+
+    for (size_t i = 0; i < distances[0].size(); i++)
+    {
+        // exact with and without cache
+        BOOST_CHECK_SMALL(distances[1][i] - distances[0][i], 1e-3f);
+        // approximated within the tolerance
+        BOOST_CHECK_GE(distances[2][i], distances[0][i] - 1e-3f);
+        BOOST_CHECK_LE(distances[2][i], distances[0][i] * 1.05f + 1e-3f);
+    }
+
+    colChecker->enableDistanceCache(false);
+    BOOST_CHECK_EQUAL(colChecker->getCollisionCheckerImplementation()->getDistanceCacheSize(), 0u);
+
+    std::cout << "Distance queries (" << distances[0].size() << " queries, " << mover->getNumFaces() << " x " << obstacles[0]->getNumFaces() << " triangles): "
+              << "no cache " << (double)times[0] * 1000.0 / CLOCKS_PER_SEC << " ms, cache " << (double)times[1] * 1000.0 / CLOCKS_PER_SEC
+              << " ms, cache and 5% tolerance " << (double)times[2] * 1000.0 / CLOCKS_PER_SEC << " ms" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(testPQPBenchmark)
+{
+    srand(44);
+    Triangles tris1 = createBlob(100, 100.0f);
+    Triangles tris2 = createBlob(70, 60.0f);
+
+    PQP::PQP_Model m1, m2;
+    buildModel(m1, tris1, 0, (int)tris1.size() / 3);
+    buildModel(m2, tris2, 0, (int)tris2.size() / 3);
+
+    PQP::PQP_Checker checker;
+    PQP::PQP_REAL R1[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    PQP::PQP_REAL T1[3] = {0, 0, 0};
+    const int nrPoses = 2000;
+    std::vector<PQP::PQP_REAL> poses(nrPoses * 12);
+
+    for (int k = 0; k < nrPoses; k++)
+    {
+        randomPose((PQP::PQP_REAL(*)[3])&poses[k * 12], &poses[k * 12 + 9], 200.0f);
+    }
+
+    clock_t t1 = clock();
+    long long nrContacts = 0;
+    long long nrBVTests = 0;
+
+    for (int k = 0; k < nrPoses; k++)
+    {
+        PQP::PQP_CollideResult result;
+        checker.PQP_Collide(&result, R1, T1, &m1, (PQP::PQP_REAL(*)[3])&poses[k * 12], &poses[k * 12 + 9], &m2, PQP::PQP_ALL_CONTACTS);
+        nrContacts += result.NumPairs();
+        nrBVTests += result.NumBVTests();
+    }
+
+    clock_t t2 = clock();
+    int nrFirstContacts = 0;
+
+    for (int k = 0; k < nrPoses; k++)
+    {
+        PQP::PQP_CollideResult result;
+        checker.PQP_Collide(&result, R1, T1, &m1, (PQP::PQP_REAL(*)[3])&poses[k * 12], &poses[k * 12 + 9], &m2, PQP::PQP_FIRST_CONTACT);
+        nrFirstContacts += result.Colliding() ? 1 : 0;
+    }
+
+    clock_t t3 = clock();
+    double sumDist = 0;
+
+    for (int k = 0; k < nrPoses; k++)
+    {
+        PQP::PQP_DistanceResult result;
+        checker.PQP_Distance(&result, R1, T1, &m1, (PQP::PQP_REAL(*)[3])&poses[k * 12], &poses[k * 12 + 9], &m2, 0, 0);
+        sumDist += result.Distance();
+    }
+
+    clock_t t4 = clock();
+
+    std::cout << "PQP benchmark (" << tris1.size() / 3 << " x " << tris2.size() / 3 << " triangles, " << nrPoses << " poses)" << std::endl;
+    std::cout << "all contacts:  " << (double)(t2 - t1) * 1000.0 / CLOCKS_PER_SEC << " ms, " << nrContacts << " contacts, " << nrBVTests << " BV tests" << std::endl;
+    std::cout << "first contact: " << (double)(t3 - t2) * 1000.0 / CLOCKS_PER_SEC << " ms, " << nrFirstContacts << " colliding" << std::endl;
+    std::cout << "distance:      " << (double)(t4 - t3) * 1000.0 / CLOCKS_PER_SEC << " ms, sum " << sumDist << std::endl;
+
+    BOOST_CHECK_GT(nrContacts, 0);
+    BOOST_CHECK_GT(sumDist, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,200 @@
+/**
+* @package    VirtualRobot
+* @author     Nikolaus Vahrenkamp
+* @copyright  2013 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE VirtualRobot_VirtualRobotCompiledKinematicsTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/RobotNodeSet.h>
+#include <VirtualRobot/CompiledKinematics.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/Nodes/Sensor.h>
+#include <VirtualRobot/RuntimeEnvironment.h>
+#include <string>
+#include <time.h>
+
+#include <Eigen/Core>
+
+using namespace VirtualRobot;
+
+BOOST_AUTO_TEST_SUITE(CompiledKinematics)
+
+namespace
+{
+    float randomJointValue(RobotNodePtr rn)
+    {
+        return rn->getJointLimitLo() + (rn->getJointLimitHi() - rn->getJointLimitLo()) * (float)rand() / (float)RAND_MAX;
+    }
+
+    void checkPoses(RobotPtr r1, RobotPtr r2)
+    {
+        std::vector<RobotNodePtr> rn1 = r1->getRobotNodes();
+
+        for (size_t i = 0; i < rn1.size(); i++)
+        {
+            RobotNodePtr n2 = r2->getRobotNode(rn1[i]->getName());
+            BOOST_REQUIRE(n2);
+            BOOST_CHECK_SMALL(rn1[i]->getJointValue() - n2->getJointValue(), 1e-5f);
+            bool poseOK = rn1[i]->getGlobalPose().isApprox(n2->getGlobalPose(), 1e-4f);
+            BOOST_CHECK(poseOK);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testCompiledKinematicsPoses)
+{
+    const std::string robotString =
+        "<Robot Type='MyDemoRobotType' RootNode='Joint1'>"
+        " <RobotNode name='Joint1'>"
+        "  <Transform>"
+        "    <DH a='1' d='0' theta='0' alpha='-90' units='degree' unitsLength='m'/>"
+        "  </Transform>"
+        "  <Joint type='revolute'>"
+        "    <axis x='0' y='0' z='1'/>"
+        "    <Limits unit='degree' lo='0' hi='180'/>"
+        "    <PropagateJointValue factor='0.5' name='Joint3'/>"
+        "  </Joint>"
+        "  <Child name='Joint2'/>"
+        "  <Child name='Joint3'/>"
+        " </RobotNode>"
+        " <RobotNode name='Joint2'>"
+        "  <Transform>"
+        "    <Translation x='100' y='50' z='0'/>"
+        "  </Transform>"
+        "  <Joint type='prismatic'>"
+        "    <TranslationDirection x='0' y='1' z='1'/>"
+        "    <Limits unit='mm' lo='-100' hi='100'/>"
+        "  </Joint>"
+        "  <Child name='Fixed1'/>"
+        " </RobotNode>"
+        " <RobotNode name='Fixed1'>"
+        "  <Transform>"
+        "    <Translation x='0' y='0' z='200'/>"
+        "  </Transform>"
+        "  <Sensor type='position' name='sensor1'>"
+        "    <Transform>"
+        "       <Translation x='100' y='50' z='0'/>"
+        "    </Transform>"
+        "  </Sensor>"
+        " </RobotNode>"
+        " <RobotNode name='Joint3'>"
+        "  <Transform>"
+        "    <Translation x='-100' y='0' z='0'/>"
+        "  </Transform>"
+        "   <Joint type='revolute'>"
+        "    <axis x='1' y='0' z='0'/>"
+        "    <Limits unit='degree' lo='0' hi='90'/>"
+        "   </Joint>"
+        " </RobotNode>"
+        "</Robot>";
+    RobotPtr rob;
+    BOOST_REQUIRE_NO_THROW(rob = RobotIO::createRobotFromString(robotString));
+    BOOST_REQUIRE(rob);
+    RobotPtr robCompiled;
+    BOOST_REQUIRE_NO_THROW(robCompiled = RobotIO::createRobotFromString(robotString));
+    BOOST_REQUIRE(robCompiled);
+
+    robCompiled->setUseCompiledKinematics(true);
+    CompiledKinematicsPtr ck = robCompiled->getCompiledKinematics();
+    BOOST_REQUIRE(ck);
+    BOOST_CHECK_EQUAL(ck->getNrOfNodes(), 4u);
+
+    // depth first order
+    BOOST_CHECK_EQUAL(ck->getIndex("Joint1"), 0);
+    BOOST_CHECK_EQUAL(ck->getIndex("Fixed1"), ck->getIndex("Joint2") + 1);
+    BOOST_CHECK_EQUAL(ck->getIndex("unknown"), -1);
+
+    Eigen::Matrix4f gp = Eigen::Matrix4f::Identity();
+    gp.block(0, 3, 3, 1) = Eigen::Vector3f(10.0f, 20.0f, 30.0f);
+    rob->setGlobalPose(gp);
+    robCompiled->setGlobalPose(gp);
+    checkPoses(rob, robCompiled);
+
+    for (int i = 0; i < 20; i++)
+    {
+        std::map<std::string, float> jv;
+        jv["Joint1"] = randomJointValue(rob->getRobotNode("Joint1"));
+        jv["Joint2"] = randomJointValue(rob->getRobotNode("Joint2"));
+        rob->setJointValues(jv);
+        robCompiled->setJointValues(jv);
+        checkPoses(rob, robCompiled);
+
+        // subtree update
+        float v = randomJointValue(rob->getRobotNode("Joint2"));
+        rob->getRobotNode("Joint2")->setJointValue(v);
+        robCompiled->getRobotNode("Joint2")->setJointValue(v);
+        checkPoses(rob, robCompiled);
+    }
+
+    // propagated joint value
+    robCompiled->getRobotNode("Joint1")->setJointValue(0.2f);
+    BOOST_CHECK_CLOSE(robCompiled->getRobotNode("Joint3")->getJointValue(), 0.1f, 0.01f);
+
+    // sensors are updated
+    SensorPtr s1 = rob->getSensor("sensor1");
+    SensorPtr s2 = robCompiled->getSensor("sensor1");
+    BOOST_REQUIRE(s1);
+    BOOST_REQUIRE(s2);
+    rob->getRobotNode("Joint1")->setJointValue(0.2f);
+    bool sensorOK = s1->getGlobalPose().isApprox(s2->getGlobalPose(), 1e-4f);
+    BOOST_CHECK(sensorOK);
+
+    robCompiled->setUseCompiledKinematics(false);
+    BOOST_CHECK(!robCompiled->getCompiledKinematics());
+}
+
+BOOST_AUTO_TEST_CASE(testCompiledKinematicsBenchmark)
+{
+    std::string filename = "robots/ArmarIII/ArmarIII.xml";
+    bool fileOK = RuntimeEnvironment::getDataFileAbsolute(filename);
+    BOOST_REQUIRE(fileOK);
+
+    RobotPtr rob;
+    BOOST_REQUIRE_NO_THROW(rob = RobotIO::loadRobot(filename, RobotIO::eStructure));
+    BOOST_REQUIRE(rob);
+    RobotPtr robCompiled;
+    BOOST_REQUIRE_NO_THROW(robCompiled = RobotIO::loadRobot(filename, RobotIO::eStructure));
+    BOOST_REQUIRE(robCompiled);
+    robCompiled->setUseCompiledKinematics(true);
+    robCompiled->getCompiledKinematics()->setUpdateVisualization(false);
+
+    std::vector<RobotNodePtr> nodes = rob->getRobotNodes();
+    const int nrUpdates = 2000;
+    std::vector< std::map<std::string, float> > configs(nrUpdates);
+
+    for (int i = 0; i < nrUpdates; i++)
+    {
+        for (size_t j = 0; j < nodes.size(); j++)
+        {
+            configs[i][nodes[j]->getName()] = randomJointValue(nodes[j]);
+        }
+    }
+
+    clock_t t1 = clock();
+
+    for (int i = 0; i < nrUpdates; i++)
+    {
+        rob->setJointValues(configs[i]);
+    }
+
+    clock_t t2 = clock();
+
+    for (int i = 0; i < nrUpdates; i++)
+    {
+        robCompiled->setJointValues(configs[i]);
+    }
+
+    clock_t t3 = clock();
+
+    checkPoses(rob, robCompiled);
+
+    std::cout << "Forward kinematics (" << nodes.size() << " nodes, " << nrUpdates << " updates): standard: "
+              << (float)(t2 - t1) / (float)CLOCKS_PER_SEC * 1000.0f << " ms, compiled: "
+              << (float)(t3 - t2) / (float)CLOCKS_PER_SEC * 1000.0f << " ms" << std::endl;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
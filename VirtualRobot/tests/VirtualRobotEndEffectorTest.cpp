@@ -0,0 +1,216 @@
+/**
+* @package    VirtualRobot
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE VirtualRobot_VirtualRobotEndEffectorTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/Obstacle.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/EndEffector/EndEffector.h>
+#include <VirtualRobot/CollisionDetection/CollisionModel.h>
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace VirtualRobot;
+using namespace VirtualRobotTest;
+
+namespace
+{
+    // an elongated, bumpy ellipsoid
+    TriMeshModelPtr createBlob(int n, float radius)
+    {
+        TriMeshModelPtr model(new TriMeshModel());
+        std::vector<Eigen::Vector3f> points;
+
+        for (int i = 0; i <= n; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                float theta = float(M_PI) * float(i) / float(n);
+                float phi = 2.0f * float(M_PI) * float(j) / float(n);
+                float r = radius * (1.0f + 0.3f * cosf(2.0f * phi) * sinf(theta));
+                points.push_back(Eigen::Vector3f(r * sinf(theta) * cosf(phi), 0.6f * r * sinf(theta) * sinf(phi), 1.5f * r * cosf(theta)));
+            }
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < n; j++)
+            {
+                int a = i * n + j;
+                int b = i * n + (j + 1) % n;
+                int c = (i + 1) * n + j;
+                int d = (i + 1) * n + (j + 1) % n;
+                model->addTriangleWithFace(points[a], points[b], points[c]);
+                model->addTriangleWithFace(points[b], points[d], points[c]);
+            }
+        }
+
+        return model;
+    }
+
+    void setCollisionModel(RobotNodePtr node, TriMeshModelPtr model)
+    {
+        node->setCollisionModel(createCollisionModel(model, node->getName()));
+    }
+
+    // a hand with a palm and four fingers with one joint each
+    RobotPtr createHand()
+    {
+        const std::string robotString =
+            "<Robot Type='TestHand' RootNode='Base'>"
+            " <RobotNode name='Base'>"
+            "  <Child name='Palm'/><Child name='TCP'/><Child name='Finger1'/><Child name='Finger2'/><Child name='Finger3'/><Child name='Finger4'/>"
+            " </RobotNode>"
+            " <RobotNode name='Palm'/>"
+            " <RobotNode name='TCP'><Transform><Translation x='0' y='0' z='600'/></Transform></RobotNode>"
+            " <RobotNode name='Finger1'><Transform><Translation x='700' y='0' z='0'/></Transform>"
+            "  <Joint type='revolute'><axis x='0' y='1' z='0'/><Limits unit='radian' lo='-1.5' hi='1.5'/></Joint>"
+            " </RobotNode>"
+            " <RobotNode name='Finger2'><Transform><Translation x='-700' y='0' z='0'/></Transform>"
+            "  <Joint type='revolute'><axis x='0' y='1' z='0'/><Limits unit='radian' lo='-1.5' hi='1.5'/></Joint>"
+            " </RobotNode>"
+            " <RobotNode name='Finger3'><Transform><Translation x='0' y='700' z='0'/></Transform>"
+            "  <Joint type='revolute'><axis x='1' y='0' z='0'/><Limits unit='radian' lo='-1.5' hi='1.5'/></Joint>"
+            " </RobotNode>"
+            " <RobotNode name='Finger4'><Transform><Translation x='0' y='-700' z='0'/></Transform>"
+            "  <Joint type='revolute'><axis x='1' y='0' z='0'/><Limits unit='radian' lo='-1.5' hi='1.5'/></Joint>"
+            " </RobotNode>"
+            " <Endeffector name='Hand' base='Base' tcp='TCP'>"
+            "  <Static><Node name='Palm'/></Static>"
+            "  <Actor name='Actor1'><Node name='Finger1' considerCollisions='All' direction='-1'/></Actor>"
+            "  <Actor name='Actor2'><Node name='Finger2' considerCollisions='All' direction='1'/></Actor>"
+            "  <Actor name='Actor3'><Node name='Finger3' considerCollisions='All' direction='1'/></Actor>"
+            "  <Actor name='Actor4'><Node name='Finger4' considerCollisions='All' direction='-1'/></Actor>"
+            " </Endeffector>"
+            "</Robot>";
+        RobotPtr robot = RobotIO::createRobotFromString(robotString);
+        BOOST_REQUIRE(robot);
+        setCollisionModel(robot->getRobotNode("Palm"), createBoxMesh(Eigen::Vector3f(-800, -800, -300), Eigen::Vector3f(800, 800, -120)));
+        setCollisionModel(robot->getRobotNode("Finger1"), createBoxMesh(Eigen::Vector3f(-100, -100, 0), Eigen::Vector3f(0, 100, 1400)));
+        setCollisionModel(robot->getRobotNode("Finger2"), createBoxMesh(Eigen::Vector3f(0, -100, 0), Eigen::Vector3f(100, 100, 1400)));
+        setCollisionModel(robot->getRobotNode("Finger3"), createBoxMesh(Eigen::Vector3f(-100, -100, 0), Eigen::Vector3f(100, 0, 1400)));
+        setCollisionModel(robot->getRobotNode("Finger4"), createBoxMesh(Eigen::Vector3f(-100, 0, 0), Eigen::Vector3f(100, 100, 1400)));
+        robot->applyJointValues();
+        return robot;
+    }
+
+    void openHand(RobotPtr robot)
+    {
+        std::vector<RobotNodePtr> nodes = robot->getRobotNodes();
+
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            robot->setJointValue(nodes[i], 0.0f);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(EndEffectorTest)
+
+BOOST_AUTO_TEST_CASE(testCloseActorsBisection)
+{
+    RobotPtr robot = createHand();
+    EndEffectorPtr eef = robot->getEndEffector("Hand");
+    BOOST_REQUIRE(eef);
+    BOOST_CHECK_EQUAL(eef->getClosingMode(), EndEffector::eClosingFixedStep);
+
+    VisualizationNodePtr visu(new MeshVisualizationNode(createBlob(30, 250.0f)));
+    ObstaclePtr object(new Obstacle("Object", visu, CollisionModelPtr(new CollisionModel(visu, "Object"))));
+
+    std::vector<RobotNodePtr> fingers;
+    fingers.push_back(robot->getRobotNode("Finger1"));
+    fingers.push_back(robot->getRobotNode("Finger2"));
+    fingers.push_back(robot->getRobotNode("Finger3"));
+    fingers.push_back(robot->getRobotNode("Finger4"));
+
+    const float stepSize = 0.01f;
+    const int nrTests = 50;
+    EndEffector::ClosingStatistics statsFixed = { 0, 0, 0.0f };
+    EndEffector::ClosingStatistics statsBisection = { 0, 0, 0.0f };
+    int nrContacts = 0;
+    srand(42);
+
+    for (int t = 0; t < nrTests; t++)
+    {
+        Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+        pose.block(0, 0, 3, 3) = Eigen::AngleAxisf(float(rand()) / float(RAND_MAX) * 6.28f, Eigen::Vector3f::UnitZ()).toRotationMatrix();
+        pose(0, 3) = float(rand() % 200 - 100);
+        pose(1, 3) = float(rand() % 200 - 100);
+        pose(2, 3) = 700.0f + float(rand() % 200);
+        object->setGlobalPose(pose);
+
+        openHand(robot);
+        eef->setClosingMode(EndEffector::eClosingFixedStep);
+        eef->resetClosingStatistics();
+        EndEffector::ContactInfoVector contactsFixed = eef->closeActors(object, stepSize);
+        EndEffector::ClosingStatistics s = eef->getClosingStatistics();
+        statsFixed.nrCalls += s.nrCalls;
+        statsFixed.nrCollisionQueries += s.nrCollisionQueries;
+        statsFixed.timeMS += s.timeMS;
+        std::vector<float> jointValuesFixed;
+
+        for (size_t i = 0; i < fingers.size(); i++)
+        {
+            jointValuesFixed.push_back(fingers[i]->getJointValue());
+        }
+
+        openHand(robot);
+        eef->setClosingMode(EndEffector::eClosingBisection, 8);
+        eef->resetClosingStatistics();
+        EndEffector::ContactInfoVector contactsBisection = eef->closeActors(object, stepSize);
+        s = eef->getClosingStatistics();
+        statsBisection.nrCalls += s.nrCalls;
+        statsBisection.nrCollisionQueries += s.nrCollisionQueries;
+        statsBisection.timeMS += s.timeMS;
+
+        // the fingers stop at the same positions and touch the object with the same links
+        for (size_t i = 0; i < fingers.size(); i++)
+        {
+            BOOST_CHECK_SMALL(fingers[i]->getJointValue() - jointValuesFixed[i], 1e-4f);
+        }
+
+        BOOST_REQUIRE_EQUAL(contactsBisection.size(), contactsFixed.size());
+
+        for (size_t i = 0; i < contactsFixed.size(); i++)
+        {
+            bool found = false;
+
+            for (size_t j = 0; j < contactsBisection.size(); j++)
+            {
+                if (contactsBisection[j].robotNode == contactsFixed[i].robotNode && contactsBisection[j].obstacle == contactsFixed[i].obstacle)
+                {
+                    found = true;
+                    BOOST_CHECK_SMALL((contactsBisection[j].contactPointObstacleGlobal - contactsFixed[i].contactPointObstacleGlobal).norm(), 1.0f);
+                    BOOST_CHECK_SMALL(contactsBisection[j].distance - contactsFixed[i].distance, 1.0f);
+                }
+            }
+
+            BOOST_CHECK(found);
+        }
+
+        nrContacts += (int)contactsFixed.size();
+    }
+
+    std::cout << "closeActors (" << nrTests << " grasps, " << nrContacts << " contacts, step size " << stepSize << ")" << std::endl;
+    std::cout << "fixed step: " << statsFixed.nrCollisionQueries << " collision queries, " << statsFixed.timeMS << " ms" << std::endl;
+    std::cout << "bisection:  " << statsBisection.nrCollisionQueries << " collision queries, " << statsBisection.timeMS << " ms" << std::endl;
+
+    BOOST_CHECK_GT(nrContacts, 0);
+    BOOST_CHECK_EQUAL(statsBisection.nrCalls, nrTests);
+    BOOST_CHECK_LT(statsBisection.nrCollisionQueries * 3, statsFixed.nrCollisionQueries);
+
+    // the closing mode is passed on to clones
+    RobotPtr robot2 = robot->clone("TestHand2");
+    BOOST_CHECK_EQUAL(robot2->getEndEffector("Hand")->getClosingMode(), EndEffector::eClosingBisection);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
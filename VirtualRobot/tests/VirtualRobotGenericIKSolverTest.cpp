@@ -0,0 +1,301 @@
+/**
+* @package    VirtualRobot
+* @author     Nikolaus Vahrenkamp
+* @copyright  2014 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE VirtualRobot_VirtualRobotGenericIKSolverTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
+#include <VirtualRobot/VirtualRobot.h>
+#include <VirtualRobot/IK/GenericIKSolver.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/Obstacle.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/CollisionDetection/CDManager.h>
+#include <VirtualRobot/CollisionDetection/CollisionChecker.h>
+#include <VirtualRobot/CollisionDetection/CollisionModel.h>
+#include <string>
+#include <iostream>
+#include <cstdlib>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+using namespace VirtualRobot;
+using namespace VirtualRobotTest;
+
+namespace
+{
+    // the forearm (J5) has a collision model
+    RobotNodeSetPtr createArm(RobotPtr& rob)
+    {
+        rob = createSevenDoFArm();
+        BOOST_REQUIRE(rob);
+        RobotNodeSetPtr rns = rob->getRobotNodeSet("Arm");
+        BOOST_REQUIRE(rns);
+        return rns;
+    }
+
+    std::vector<float> randomConfig(RobotNodeSetPtr rns)
+    {
+        std::vector<float> jv(rns->getSize());
+
+        for (size_t i = 0; i < jv.size(); i++)
+        {
+            RobotNodePtr n = rns->getNode(i);
+            jv[i] = n->getJointLimitLo() + (n->getJointLimitHi() - n->getJointLimitLo()) * float(rand()) / float(RAND_MAX);
+        }
+
+        return jv;
+    }
+
+    bool checkPose(RobotNodeSetPtr rns, const Eigen::Matrix4f& goal)
+    {
+        Eigen::Matrix4f p = rns->getTCP()->getGlobalPose();
+        Eigen::AngleAxisf aa(Eigen::Matrix3f(goal.block<3, 3>(0, 0) * p.block<3, 3>(0, 0).transpose()));
+        return (goal.block<3, 1>(0, 3) - p.block<3, 1>(0, 3)).norm() < 2.0f && fabs(aa.angle()) < 0.05f;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(GenericIKSolverTest)
+
+BOOST_AUTO_TEST_CASE(testSolveParallel)
+{
+    srand(42);
+    RobotPtr rob;
+    RobotNodeSetPtr rns = createArm(rob);
+    GenericIKSolver ik(rns, JacobiProvider::eSVDDamped);
+    ik.setMaximumError(1.0f, 0.02f);
+    ik.setupJacobian(0.5f, 100);
+    int nrSolved = 0;
+
+    for (int k = 0; k < 10; k++)
+    {
+        rns->setJointValues(randomConfig(rns));
+        Eigen::Matrix4f goal = rns->getTCP()->getGlobalPose();
+        std::vector<float> start = randomConfig(rns);
+        rns->setJointValues(start);
+        Eigen::Matrix4f basePose = rob->getRobotNode("Base")->getGlobalPose();
+
+        if (ik.solveParallel(goal, IKSolver::All, 100, 4, k))
+        {
+            nrSolved++;
+            BOOST_CHECK(checkPose(rns, goal));
+        }
+        else
+        {
+            // joints are not changed
+            std::vector<float> jv = rns->getJointValues();
+
+            for (size_t i = 0; i < jv.size(); i++)
+            {
+                BOOST_CHECK_EQUAL(jv[i], start[i]);
+            }
+        }
+
+        BOOST_CHECK(rob->getRobotNode("Base")->getGlobalPose().isApprox(basePose));
+    }
+
+    BOOST_CHECK_GE(nrSolved, 8);
+
+    // a goal that cannot be reached
+    Eigen::Matrix4f farAway = Eigen::Matrix4f::Identity();
+    farAway(0, 3) = 5000.0f;
+    BOOST_CHECK(!ik.solveParallel(farAway, IKSolver::All, 20, 4));
+
+    // the first try starts at the goal configuration, its solution cancels the remaining tries
+    std::vector<float> goalConfig = randomConfig(rns);
+    rns->setJointValues(goalConfig);
+    Eigen::Matrix4f goal = rns->getTCP()->getGlobalPose();
+    BOOST_REQUIRE(ik.solveParallel(goal, IKSolver::All, 100000, 4));
+    BOOST_CHECK_GE(ik.getNrOfParallelTries(), 1);
+    BOOST_CHECK_LT(ik.getNrOfParallelTries(), 1000);
+}
+
+BOOST_AUTO_TEST_CASE(testSolveParallelSolutions)
+{
+    srand(43);
+    RobotPtr rob;
+    RobotNodeSetPtr rns = createArm(rob);
+    GenericIKSolver ik(rns, JacobiProvider::eSVDDamped);
+    ik.setMaximumError(1.0f, 0.02f);
+    ik.setupJacobian(0.5f, 100);
+
+    rns->setJointValues(randomConfig(rns));
+    Eigen::Matrix4f goal = rns->getTCP()->getGlobalPose();
+    std::vector<float> start = randomConfig(rns);
+
+    std::vector< std::vector<float> > solutions1, solutions4;
+    rns->setJointValues(start);
+    BOOST_REQUIRE(ik.solveParallel(goal, IKSolver::All, 200, 1, 7, 0.0f, &solutions1, 0.2f));
+    rns->setJointValues(start);
+    BOOST_REQUIRE(ik.solveParallel(goal, IKSolver::All, 200, 4, 7, 0.0f, &solutions4, 0.2f));
+
+    // a redundant arm has many solutions
+    BOOST_CHECK_GT(solutions4.size(), 1u);
+
+    // the result does not depend on the number of threads
+    BOOST_REQUIRE_EQUAL(solutions1.size(), solutions4.size());
+
+    for (size_t i = 0; i < solutions1.size(); i++)
+    {
+        for (size_t j = 0; j < solutions1[i].size(); j++)
+        {
+            BOOST_CHECK_EQUAL(solutions1[i][j], solutions4[i][j]);
+        }
+    }
+
+    // all solutions are valid and distinct, the joints are set to the first one
+    BOOST_CHECK(checkPose(rns, goal));
+
+    for (size_t i = 0; i < solutions4.size(); i++)
+    {
+        rns->setJointValues(solutions4[i]);
+        BOOST_CHECK(checkPose(rns, goal));
+
+        for (size_t j = 0; j < i; j++)
+        {
+            float d = 0;
+
+            for (size_t k = 0; k < solutions4[i].size(); k++)
+            {
+                d += (solutions4[i][k] - solutions4[j][k]) * (solutions4[i][k] - solutions4[j][k]);
+            }
+
+            BOOST_CHECK_GT(sqrtf(d), 0.2f);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testSolveParallelCollision)
+{
+    srand(44);
+    RobotPtr rob;
+    RobotNodeSetPtr rns = createArm(rob);
+
+    // the obstacle blocks some of the forearm positions
+    ObstaclePtr obstacle(new Obstacle("Obstacle", VisualizationNodePtr(), createBox(Eigen::Vector3f(-1000, -1000, 500), Eigen::Vector3f(1000, 0, 1000), "Obstacle", rob->getCollisionChecker())));
+    obstacle->setGlobalPose(Eigen::Matrix4f::Identity());
+    CDManagerPtr cdm(new CDManager(rob->getCollisionChecker()));
+    cdm->addCollisionModel(obstacle);
+    cdm->addCollisionModel(rob->getRobotNode("J5"));
+
+    GenericIKSolver ik(rns, JacobiProvider::eSVDDamped);
+    ik.setMaximumError(1.0f, 0.02f);
+    ik.setupJacobian(0.5f, 100);
+    int nrTested = 0;
+
+    for (int k = 0; k < 20; k++)
+    {
+        // a collision-free goal
+        do
+        {
+            rns->setJointValues(randomConfig(rns));
+        }
+        while (cdm->isInCollision());
+
+        Eigen::Matrix4f goal = rns->getTCP()->getGlobalPose();
+
+        // without collision detection, some solutions collide
+        ik.collisionDetection(CDManagerPtr());
+        std::vector< std::vector<float> > solutions;
+        rns->setJointValues(randomConfig(rns));
+
+        if (!ik.solveParallel(goal, IKSolver::All, 40, 4, k, 0.0f, &solutions))
+        {
+            continue;
+        }
+
+        bool colliding = false;
+
+        for (size_t i = 0; i < solutions.size(); i++)
+        {
+            rns->setJointValues(solutions[i]);
+            colliding |= cdm->isInCollision();
+        }
+
+        if (!colliding)
+        {
+            continue;
+        }
+
+        // with collision detection, the solution is collision-free
+        nrTested++;
+        ik.collisionDetection(cdm);
+        rns->setJointValues(randomConfig(rns));
+
+        if (ik.solveParallel(goal, IKSolver::All, 100, 4, k))
+        {
+            BOOST_CHECK(checkPose(rns, goal));
+            BOOST_CHECK(!cdm->isInCollision());
+        }
+    }
+
+    BOOST_CHECK_GT(nrTested, 0);
+}
+
+BOOST_AUTO_TEST_CASE(testSolveParallelBenchmark)
+{
+    srand(45);
+    RobotPtr rob;
+    RobotNodeSetPtr rns = createArm(rob);
+    GenericIKSolver ik(rns, JacobiProvider::eSVDDamped);
+
+    ik.setMaximumError(1.0f, 0.02f);
+    ik.setupJacobian(0.5f, 100);
+    const int nrGoals = 20;
+    const int nrLoops = 200;
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > goals;
+
+    for (int k = 0; k < nrGoals; k++)
+    {
+        rns->setJointValues(randomConfig(rns));
+        goals.push_back(rns->getTCP()->getGlobalPose());
+    }
+
+    std::vector<float> start = randomConfig(rns);
+    int solvedSeq = 0;
+    int solvedPar = 0;
+    boost::posix_time::ptime t1 = boost::posix_time::microsec_clock::universal_time();
+
+    for (int k = 0; k < nrGoals; k++)
+    {
+        rns->setJointValues(start);
+        solvedSeq += ik.solve(goals[k], IKSolver::All, nrLoops) ? 1 : 0;
+    }
+
+    boost::posix_time::ptime t2 = boost::posix_time::microsec_clock::universal_time();
+
+    for (int k = 0; k < nrGoals; k++)
+    {
+        rns->setJointValues(start);
+        solvedPar += ik.solveParallel(goals[k], IKSolver::All, nrLoops, 0, k) ? 1 : 0;
+    }
+
+    boost::posix_time::ptime t3 = boost::posix_time::microsec_clock::universal_time();
+
+    // collect all solutions within 20ms
+    std::vector< std::vector<float> > solutions;
+    rns->setJointValues(start);
+    ik.solveParallel(goals[0], IKSolver::All, 100000, 0, 0, 20.0f, &solutions);
+    boost::posix_time::ptime t4 = boost::posix_time::microsec_clock::universal_time();
+
+    BOOST_TEST_MESSAGE("GenericIKSolver benchmark (" << nrGoals << " goals, " << nrLoops << " tries, " << boost::thread::hardware_concurrency() << " hardware threads)");
+    BOOST_TEST_MESSAGE("solve:         " << (t2 - t1).total_milliseconds() << " ms, " << solvedSeq << " solved");
+    BOOST_TEST_MESSAGE("solveParallel: " << (t3 - t2).total_milliseconds() << " ms, " << solvedPar << " solved");
+    BOOST_TEST_MESSAGE("time budget 20 ms: " << (t4 - t3).total_milliseconds() << " ms, " << ik.getNrOfParallelTries() << " tries, " << solutions.size() << " distinct solutions");
+
+    BOOST_CHECK_GT(solvedPar, 0);
+
+    // the time budget stops the search long before all tries are done
+    BOOST_CHECK_GE(ik.getNrOfParallelTries(), 1);
+    BOOST_CHECK_LT(ik.getNrOfParallelTries(), 100000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,12 +7,16 @@
 #define BOOST_TEST_MODULE VirtualRobot_VirtualRobotJacobianTest
 
 #include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
 #include <VirtualRobot/VirtualRobot.h>
 #include <VirtualRobot/IK/DifferentialIK.h>
 #include <VirtualRobot/XML/RobotIO.h>
 #include <VirtualRobot/Robot.h>
 #include <VirtualRobot/Nodes/RobotNode.h>
 #include <string>
+#include <iostream>
+#include <ctime>
+#include <cstdlib>
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
@@ -22,6 +26,48 @@ BOOST_AUTO_TEST_SUITE(RobotNode)
 #define MAX_ERROR 0.3f
 #define STEP_SIZE 0.001f
 
+namespace
+{
+    // the 7 DoF arm, the fixed tcp is part of the node set
+    VirtualRobot::RobotNodeSetPtr createArm(VirtualRobot::RobotPtr& rob)
+    {
+        rob = VirtualRobotTest::createSevenDoFArm();
+        BOOST_REQUIRE(rob);
+
+        std::vector<std::string> names;
+        names.push_back("J1");
+        names.push_back("J2");
+        names.push_back("J3");
+        names.push_back("J4");
+        names.push_back("J5");
+        names.push_back("J6");
+        names.push_back("J7");
+        names.push_back("TCP");
+        std::vector< VirtualRobot::RobotNodePtr > nodes;
+
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            nodes.push_back(rob->getRobotNode(names[i]));
+            BOOST_REQUIRE(nodes.back());
+        }
+
+        return VirtualRobot::RobotNodeSet::createRobotNodeSet(rob, "ArmWithTCP", nodes, VirtualRobot::RobotNodePtr(), nodes.back());
+    }
+
+    void setRandomJointValues(VirtualRobot::RobotPtr rob, VirtualRobot::RobotNodeSetPtr rns)
+    {
+        std::vector<float> jv(rns->getSize());
+
+        for (size_t i = 0; i < jv.size(); i++)
+        {
+            VirtualRobot::RobotNodePtr n = rns->getNode(i);
+            jv[i] = n->getJointLimitLo() + (n->getJointLimitHi() - n->getJointLimitLo()) * float(rand()) / float(RAND_MAX);
+        }
+
+        rob->setJointValues(rns, jv);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(testJacobianRevoluteJoint)
 {
     const std::string robotString =
@@ -103,4 +149,131 @@ BOOST_AUTO_TEST_CASE(testJacobianRevoluteJoint)
 
 }
 
+BOOST_AUTO_TEST_CASE(testDifferentialIKStep)
+{
+    srand(42);
+    VirtualRobot::RobotPtr rob;
+    VirtualRobot::RobotNodeSetPtr arm = createArm(rob);
+    BOOST_REQUIRE(arm);
+
+    VirtualRobot::JacobiProvider::InverseJacobiMethod methods[3] = { VirtualRobot::JacobiProvider::eSVD, VirtualRobot::JacobiProvider::eSVDDamped, VirtualRobot::JacobiProvider::eTranspose };
+    VirtualRobot::RobotNodePtr coordSystems[2] = { VirtualRobot::RobotNodePtr(), rob->getRobotNode("J2") };
+
+    for (int m = 0; m < 3; m++)
+    {
+        for (int c = 0; c < 2; c++)
+        {
+            for (int k = 0; k < 10; k++)
+            {
+                setRandomJointValues(rob, arm);
+                Eigen::Matrix4f goal = arm->getTCP()->getGlobalPose();
+                setRandomJointValues(rob, arm);
+
+                // goals are given in global coordinates, the coordinate system only affects the Jacobian
+                VirtualRobot::DifferentialIK ik(arm, coordSystems[c], methods[m]);
+
+                if (m == 2)
+                {
+                    // position only, otherwise J*J^T is singular for a 7 DoF arm with one prismatic joint
+                    ik.setGoal(goal, arm->getTCP(), VirtualRobot::IKSolver::Position);
+                }
+                else
+                {
+                    ik.setGoal(goal);
+                }
+
+                // reference: explicitly built pseudo inverse
+                Eigen::MatrixXf jac = ik.getJacobianMatrix();
+                Eigen::VectorXf expected = ik.computePseudoInverseJacobianMatrix(jac) * ik.getError(0.5f);
+                Eigen::VectorXf step = ik.computeStep(0.5f);
+                BOOST_REQUIRE_EQUAL(step.rows(), expected.rows());
+                BOOST_CHECK_SMALL((step - expected).norm(), 1e-3f * (1.0f + expected.norm()));
+            }
+        }
+    }
+
+    // the Jacobian in a different coordinate system is the rotated global Jacobian
+    setRandomJointValues(rob, arm);
+    VirtualRobot::DifferentialIK ikGlobal(arm);
+    VirtualRobot::DifferentialIK ikLocal(arm, rob->getRobotNode("J3"));
+    Eigen::MatrixXf jGlobal = ikGlobal.getJacobianMatrix(arm->getTCP());
+    Eigen::MatrixXf jLocal = ikLocal.getJacobianMatrix(arm->getTCP());
+    Eigen::Matrix3f r = rob->getRobotNode("J3")->getGlobalPose().block<3, 3>(0, 0);
+    BOOST_CHECK_SMALL((r * jLocal.block(0, 0, 3, 8) - jGlobal.block(0, 0, 3, 8)).norm(), 1e-2f);
+    BOOST_CHECK_SMALL((r * jLocal.block(3, 0, 3, 8) - jGlobal.block(3, 0, 3, 8)).norm(), 1e-4f);
+
+    // the fixed tcp node does not contribute
+    BOOST_CHECK_SMALL(jGlobal.col(7).norm(), 1e-6f);
+}
+
+BOOST_AUTO_TEST_CASE(testDifferentialIKBenchmark)
+{
+    srand(43);
+    VirtualRobot::RobotPtr rob;
+    VirtualRobot::RobotNodeSetPtr arm = createArm(rob);
+    BOOST_REQUIRE(arm);
+
+    const int nrGoals = 200;
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > goals;
+    std::vector< std::vector<float> > starts;
+
+    for (int k = 0; k < nrGoals; k++)
+    {
+        setRandomJointValues(rob, arm);
+        goals.push_back(arm->getTCP()->getGlobalPose());
+        setRandomJointValues(rob, arm);
+        starts.push_back(arm->getJointValues());
+    }
+
+    VirtualRobot::DifferentialIK ik(arm, VirtualRobot::RobotNodePtr(), VirtualRobot::JacobiProvider::eSVDDamped);
+    ik.setGoal(goals[0]);
+
+    // single steps: fixed size LDLT solve vs. explicit pseudo inverse
+    const int nrSteps = 20000;
+    clock_t t1 = clock();
+
+    for (int k = 0; k < nrSteps; k++)
+    {
+        ik.computeStep(0.2f);
+    }
+
+    clock_t t2 = clock();
+    Eigen::VectorXf sum = Eigen::VectorXf::Zero(arm->getSize());
+
+    for (int k = 0; k < nrSteps; k++)
+    {
+        Eigen::MatrixXf jac = ik.getJacobianMatrix();
+        sum += ik.computePseudoInverseJacobianMatrix(jac) * ik.getError(0.2f);
+    }
+
+    clock_t t3 = clock();
+
+    // complete IK queries
+    int nrSolved = 0;
+
+    for (int k = 0; k < nrGoals; k++)
+    {
+        rob->setJointValues(arm, starts[k]);
+        ik.setGoal(goals[k]);
+
+        if (ik.solveIK(0.5f, 0.0f, 100))
+        {
+            nrSolved++;
+        }
+    }
+
+    clock_t t4 = clock();
+
+    double msStep = (double)(t2 - t1) * 1000.0 / CLOCKS_PER_SEC;
+    double msPInv = (double)(t3 - t2) * 1000.0 / CLOCKS_PER_SEC;
+    double msSolve = (double)(t4 - t3) * 1000.0 / CLOCKS_PER_SEC;
+    BOOST_TEST_MESSAGE("DifferentialIK benchmark (" << arm->getSize() << " nodes, eSVDDamped)");
+    BOOST_TEST_MESSAGE("computeStep:           " << nrSteps / (msStep / 1000.0) << " iterations/s");
+    BOOST_TEST_MESSAGE("explicit pseudo inv.:  " << nrSteps / (msPInv / 1000.0) << " iterations/s");
+    BOOST_TEST_MESSAGE("solveIK:               " << nrGoals / (msSolve / 1000.0) << " queries/s, " << nrSolved << " of " << nrGoals << " solved");
+
+    BOOST_CHECK(sum.allFinite());
+    BOOST_CHECK_GT(nrSolved, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
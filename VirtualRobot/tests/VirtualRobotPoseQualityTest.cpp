@@ -0,0 +1,211 @@
+/**
+* @package    VirtualRobot
+* @author     Nikolaus Vahrenkamp
+* @copyright  2014 Nikolaus Vahrenkamp
+*/
+
+#define BOOST_TEST_MODULE VirtualRobot_VirtualRobotPoseQualityTest
+
+#include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/VirtualRobot.h>
+#include <VirtualRobot/IK/PoseQualityExtendedManipulability.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/RobotNodeSet.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/RuntimeEnvironment.h>
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include <float.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <Eigen/Core>
+#include <Eigen/Dense>
+
+using namespace VirtualRobot;
+
+namespace
+{
+    //! Gives access to the penalization methods, in order to compute the reference result with one SVD for each of the 64 hyperoctants.
+    class ExtendedManipulabilityReference : public PoseQualityExtendedManipulability
+    {
+    public:
+        ExtendedManipulabilityReference(RobotNodeSetPtr rns) : PoseQualityExtendedManipulability(rns)
+        {
+        }
+
+        void getReference(bool (&dims)[6], int nrSV, float& storeVolume, float& storeInvCondNumber)
+        {
+            std::vector<RobotNodePtr> joints = rns->getAllRobotNodes();
+            Eigen::MatrixXf jac = jacobian->getJacobianMatrix(rns->getTCP());
+            jac.block(3, 0, 3, jac.cols()) *= penalizeRotationFactor;
+
+            Eigen::VectorXf penLo, penHi;
+            Eigen::MatrixXf penObstLo, penObstHi;
+            getPenalizations(joints, penLo, penHi);
+
+            if (considerObstacle)
+            {
+                getObstaclePenalizations(joints, obstacleDir, jac, penObstLo, penObstHi);
+            }
+
+            storeVolume = FLT_MAX;
+            storeInvCondNumber = FLT_MAX;
+
+            for (int i = 0; i < 64; i++)
+            {
+                Eigen::MatrixXf jacPen;
+
+                if (considerObstacle)
+                {
+                    jacPen = getJacobianWeightedObstacles(jac, cartDimPermutations[i], penLo, penHi, penObstLo, penObstHi);
+                }
+                else
+                {
+                    jacPen = getJacobianWeighted(jac, cartDimPermutations[i], penLo, penHi);
+                }
+
+                for (int j = 0; j < 6; j++)
+                {
+                    if (!dims[j])
+                    {
+                        jacPen.row(j).setZero();
+                    }
+                }
+
+                Eigen::JacobiSVD<Eigen::MatrixXf> svd(jacPen);
+                Eigen::VectorXf sv = svd.singularValues();
+                float v = 1.0f;
+
+                for (int j = 0; j < nrSV; j++)
+                {
+                    v *= sv(j);
+                }
+
+                storeVolume = std::min(storeVolume, v);
+                storeInvCondNumber = std::min(storeInvCondNumber, sv(0) > 0 ? sv(nrSV - 1) / sv(0) : 0.0f);
+            }
+        }
+    };
+
+    RobotPtr loadArmar()
+    {
+        std::string filename = "robots/ArmarIII/ArmarIII.xml";
+        bool fileOK = RuntimeEnvironment::getDataFileAbsolute(filename);
+        BOOST_REQUIRE(fileOK);
+
+        RobotPtr rob;
+        BOOST_REQUIRE_NO_THROW(rob = RobotIO::loadRobot(filename, RobotIO::eStructure));
+        BOOST_REQUIRE(rob);
+        return rob;
+    }
+
+    void setRandomConfig(RobotNodeSetPtr rns)
+    {
+        std::vector<float> v(rns->getSize());
+
+        for (unsigned int j = 0; j < rns->getSize(); j++)
+        {
+            float lo = (*rns)[j]->getJointLimitLo();
+            float hi = (*rns)[j]->getJointLimitHi();
+            v[j] = lo + (hi - lo) * float(rand()) / float(RAND_MAX);
+        }
+
+        rns->setJointValues(v);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(PoseQuality)
+
+BOOST_AUTO_TEST_CASE(testExtendedManipulabilityReference)
+{
+    RobotPtr rob = loadArmar();
+    RobotNodeSetPtr rns = rob->getRobotNodeSet("TorsoRightArm");
+    BOOST_REQUIRE(rns);
+
+    ExtendedManipulabilityReference q(rns);
+    srand(42);
+
+    bool allDims[6] = { true, true, true, true, true, true };
+    bool posDims[6] = { true, true, true, false, false, false };
+
+    for (int i = 0; i < 100; i++)
+    {
+        setRandomConfig(rns);
+
+        if (i % 2 == 1)
+        {
+            Eigen::Vector3f obst(float(rand() % 200) - 100.0f, float(rand() % 200) - 100.0f, float(rand() % 200) - 100.0f);
+            q.setObstacleDistanceVector(obst);
+            q.considerObstacles(true);
+        }
+        else
+        {
+            q.considerObstacles(false);
+        }
+
+        float refVolume, refInvCond;
+        q.getReference(allDims, 6, refVolume, refInvCond);
+        PoseQualityExtendedManipulability::extManipData d;
+        BOOST_REQUIRE(q.getDetailedAnalysis(d, allDims));
+
+        BOOST_CHECK_CLOSE(d.extManip_Volume, refVolume, 0.5f);
+        BOOST_CHECK_SMALL(d.extManip_InvCondNumber - refInvCond, 1e-4f);
+        BOOST_CHECK_SMALL(q.getPoseQuality(PoseQualityManipulability::eMinMaxRatio, -1) - refInvCond, 1e-4f);
+
+        // translational part only
+        q.getReference(posDims, 3, refVolume, refInvCond);
+        PoseQualityExtendedManipulability::extManipData d2;
+        BOOST_REQUIRE(q.getDetailedAnalysis(d2, posDims, 3));
+
+        BOOST_CHECK_CLOSE(d2.extManip_Volume, refVolume, 0.5f);
+        BOOST_CHECK_SMALL(d2.extManip_InvCondNumber - refInvCond, 1e-4f);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(testPoseQualityClone)
+{
+    RobotPtr rob = loadArmar();
+    RobotNodeSetPtr rns = rob->getRobotNodeSet("TorsoRightArm");
+    BOOST_REQUIRE(rns);
+    RobotPtr rob2 = rob->clone("clone");
+
+    // the base class can not be cloned, since it would replace the derived measure
+    PoseQualityMeasurement base(rns);
+    BOOST_CHECK(!base.clone(rob2));
+
+    PoseQualityExtendedManipulability q(rns);
+    PoseQualityMeasurementPtr q2 = q.clone(rob2);
+    BOOST_REQUIRE(q2);
+    BOOST_CHECK(boost::dynamic_pointer_cast<PoseQualityExtendedManipulability>(q2));
+    BOOST_CHECK(q2->getRNS()->getRobot() == rob2);
+}
+
+BOOST_AUTO_TEST_CASE(testExtendedManipulabilityBenchmark)
+{
+    RobotPtr rob = loadArmar();
+    RobotNodeSetPtr rns = rob->getRobotNodeSet("TorsoRightArm");
+    BOOST_REQUIRE(rns);
+
+    PoseQualityExtendedManipulability q(rns);
+    srand(42);
+    const int nrQueries = 2000;
+    float sum = 0.0f;
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+
+    for (int i = 0; i < nrQueries; i++)
+    {
+        setRandomConfig(rns);
+        sum += q.getPoseQuality();
+    }
+
+    boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::local_time() - start;
+    double ms = (double)elapsed.total_microseconds() / 1000.0;
+    std::cout << "PoseQualityExtendedManipulability: " << nrQueries << " queries in " << ms << " ms (" << ms * 1000.0 / (double)nrQueries << " us per query)" << std::endl;
+    BOOST_CHECK_GT(sum, 0.0f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,11 +7,17 @@
 #define BOOST_TEST_MODULE VirtualRobot_VirtualRobotRobotTest
 
 #include <VirtualRobot/VirtualRobotTest.h>
+#include <VirtualRobot/tests/VirtualRobotTestMeshes.h>
 #include <VirtualRobot/XML/RobotIO.h>
 #include <VirtualRobot/Robot.h>
+#include <VirtualRobot/RobotNodeSet.h>
+#include <VirtualRobot/RuntimeEnvironment.h>
 #include <VirtualRobot/VirtualRobotException.h>
 #include <VirtualRobot/Nodes/Sensor.h>
 #include <VirtualRobot/Nodes/PositionSensor.h>
+#include <VirtualRobot/Obstacle.h>
+#include <VirtualRobot/SceneObjectSet.h>
+#include <VirtualRobot/CollisionDetection/CollisionChecker.h>
 #include <string>
 
 BOOST_AUTO_TEST_SUITE(RobotFactory)
@@ -451,4 +457,191 @@ BOOST_AUTO_TEST_CASE(testVirtualRobotToXML)
     BOOST_REQUIRE(p.isApprox(p2));
 }
 
+BOOST_AUTO_TEST_CASE(testVirtualRobotIncrementalPoseUpdate)
+{
+    std::string filename = "robots/ArmarIII/ArmarIII.xml";
+    bool fileOK = VirtualRobot::RuntimeEnvironment::getDataFileAbsolute(filename);
+    BOOST_REQUIRE(fileOK);
+
+    // rob: full updates, rob2: incremental updates, rob3: incremental updates with compiled kinematics
+    VirtualRobot::RobotPtr rob, rob2, rob3;
+    BOOST_REQUIRE_NO_THROW(rob = VirtualRobot::RobotIO::loadRobot(filename, VirtualRobot::RobotIO::eStructure));
+    BOOST_REQUIRE_NO_THROW(rob2 = VirtualRobot::RobotIO::loadRobot(filename, VirtualRobot::RobotIO::eStructure));
+    BOOST_REQUIRE_NO_THROW(rob3 = VirtualRobot::RobotIO::loadRobot(filename, VirtualRobot::RobotIO::eStructure));
+    BOOST_REQUIRE(rob && rob2 && rob3);
+
+    rob2->setLazyPoseUpdates(true);
+    BOOST_CHECK(rob2->getRobotNode("Elbow R")->getLazyPoseUpdatesStatus());
+    rob3->setUseCompiledKinematics(true);
+
+    std::vector<VirtualRobot::RobotPtr> robots;
+    robots.push_back(rob2);
+    robots.push_back(rob3);
+
+    VirtualRobot::RobotNodeSetPtr rns = rob->getRobotNodeSet("TorsoRightArm");
+    BOOST_REQUIRE(rns);
+    std::vector<float> jv;
+    rns->getJointValues(jv);
+
+    for (int i = 0; i < 100; i++)
+    {
+        // modify up to three joints
+        int nrJoints = rand() % 3 + 1;
+
+        for (int j = 0; j < nrJoints; j++)
+        {
+            int index = rand() % rns->getSize();
+            VirtualRobot::RobotNodePtr rn = rns->getNode(index);
+            jv[index] = rn->getJointLimitLo() + (rn->getJointLimitHi() - rn->getJointLimitLo()) * (float)rand() / (float)RAND_MAX;
+        }
+
+        if (i == 50)
+        {
+            Eigen::Matrix4f gp = Eigen::Matrix4f::Identity();
+            gp.block(0, 3, 3, 1) << 100.0f, 200.0f, 0.0f;
+            rob->setGlobalPose(gp);
+            rob2->setGlobalPose(gp);
+            rob3->setGlobalPose(gp);
+        }
+
+        std::map<std::string, float> jvMap;
+
+        for (unsigned int j = 0; j < rns->getSize(); j++)
+        {
+            jvMap[rns->getNode(j)->getName()] = jv[j];
+        }
+
+        rob->setJointValues(jvMap);
+
+        for (size_t r = 0; r < robots.size(); r++)
+        {
+            robots[r]->getRobotNodeSet("TorsoRightArm")->setJointValues(jv);
+
+            std::vector<VirtualRobot::RobotNodePtr> nodes = rob->getRobotNodes();
+
+            for (size_t j = 0; j < nodes.size(); j++)
+            {
+                Eigen::Matrix4f p1 = nodes[j]->getGlobalPose();
+                Eigen::Matrix4f p2 = robots[r]->getRobotNode(nodes[j]->getName())->getGlobalPose();
+                bool poseOK = p1.isApprox(p2, 1e-4f);
+                BOOST_CHECK(poseOK);
+            }
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(testVirtualRobotLazyCollisionModelPoses)
+{
+    // a planar arm with three links, all links have a collision model
+    const std::string robotString =
+        "<Robot Type='LazyArm' RootNode='J1'>"
+        " <RobotNode name='J1'>"
+        "  <Joint type='revolute'><Limits unit='radian' lo='-3' hi='3'/><Axis x='0' y='0' z='1'/></Joint>"
+        "  <Child name='J2'/>"
+        " </RobotNode>"
+        " <RobotNode name='J2'><Transform><Translation x='300' y='0' z='0'/></Transform>"
+        "  <Joint type='revolute'><Limits unit='radian' lo='-3' hi='3'/><Axis x='0' y='0' z='1'/></Joint>"
+        "  <Child name='J3'/>"
+        " </RobotNode>"
+        " <RobotNode name='J3'><Transform><Translation x='300' y='0' z='0'/></Transform>"
+        "  <Joint type='revolute'><Limits unit='radian' lo='-3' hi='3'/><Axis x='0' y='0' z='1'/></Joint>"
+        " </RobotNode>"
+        " <RobotNodeSet name='Arm'><Node name='J1'/><Node name='J2'/><Node name='J3'/></RobotNodeSet>"
+        "</Robot>";
+
+    // rob: standard updates, rob2: lazy updates, rob3: lazy updates with compiled kinematics
+    std::vector<VirtualRobot::RobotPtr> robots;
+
+    for (int r = 0; r < 3; r++)
+    {
+        VirtualRobot::RobotPtr rob;
+        BOOST_REQUIRE_NO_THROW(rob = VirtualRobot::RobotIO::createRobotFromString(robotString));
+        BOOST_REQUIRE(rob);
+        const char* names[3] = {"J1", "J2", "J3"};
+
+        for (int i = 0; i < 3; i++)
+        {
+            rob->getRobotNode(names[i])->setCollisionModel(VirtualRobotTest::createBox(Eigen::Vector3f(0, -20, -20), Eigen::Vector3f(280, 20, 20), names[i], rob->getCollisionChecker()));
+        }
+
+        robots.push_back(rob);
+    }
+
+    robots[1]->setLazyPoseUpdates(true);
+    robots[2]->setLazyPoseUpdates(true);
+    robots[2]->setUseCompiledKinematics(true);
+
+    VirtualRobot::CollisionCheckerPtr colChecker = robots[0]->getCollisionChecker();
+    VirtualRobot::ObstaclePtr obstacle(new VirtualRobot::Obstacle("Obstacle", VirtualRobot::VisualizationNodePtr(),
+                                       VirtualRobotTest::createBox(Eigen::Vector3f(400, 200, -50), Eigen::Vector3f(600, 400, 50), "Obstacle", colChecker), VirtualRobot::SceneObject::Physics(), colChecker));
+
+    VirtualRobot::SceneObjectSetPtr obstacleSet(new VirtualRobot::SceneObjectSet("Obstacles", colChecker));
+    obstacleSet->addSceneObject(obstacle);
+    std::vector<VirtualRobot::SceneObjectSetPtr> armSets;
+
+    for (size_t r = 0; r < robots.size(); r++)
+    {
+        VirtualRobot::SceneObjectSetPtr arm(new VirtualRobot::SceneObjectSet("Arm", colChecker));
+        arm->addSceneObjects(robots[r]->getRobotNodeSet("Arm"));
+        armSets.push_back(arm);
+    }
+
+    int nrCollisions = 0;
+
+    for (int i = 0; i < 200; i++)
+    {
+        std::vector<float> jv(3);
+
+        for (int j = 0; j < 3; j++)
+        {
+            jv[j] = -1.5f + 3.0f * (float)rand() / (float)RAND_MAX;
+        }
+
+        if (i == 100)
+        {
+            Eigen::Matrix4f gp = Eigen::Matrix4f::Identity();
+            gp.block(0, 3, 3, 1) << 50.0f, -100.0f, 0.0f;
+
+            for (size_t r = 0; r < robots.size(); r++)
+            {
+                robots[r]->setGlobalPose(gp);
+            }
+        }
+
+        for (size_t r = 0; r < robots.size(); r++)
+        {
+            robots[r]->getRobotNodeSet("Arm")->setJointValues(jv);
+        }
+
+        // the collision check accesses the outdated models first
+        bool collision = colChecker->checkCollision(armSets[0], obstacleSet);
+
+        if (collision)
+        {
+            nrCollisions++;
+        }
+
+        for (size_t r = 1; r < robots.size(); r++)
+        {
+            BOOST_CHECK_EQUAL(colChecker->checkCollision(armSets[r], obstacleSet), collision);
+
+            std::vector<VirtualRobot::RobotNodePtr> nodes = robots[r]->getRobotNodes();
+
+            for (size_t j = 0; j < nodes.size(); j++)
+            {
+                BOOST_REQUIRE(nodes[j]->getCollisionModel());
+                Eigen::Matrix4f p1 = robots[0]->getRobotNode(nodes[j]->getName())->getCollisionModel()->getGlobalPose();
+                Eigen::Matrix4f p2 = nodes[j]->getCollisionModel()->getGlobalPose();
+                BOOST_CHECK(p1.isApprox(p2, 1e-4f));
+                BOOST_CHECK(p2.isApprox(nodes[j]->getGlobalPose(), 1e-4f));
+            }
+        }
+    }
+
+    // both cases have been tested
+    BOOST_CHECK_GT(nrCollisions, 0);
+    BOOST_CHECK_LT(nrCollisions, 200);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,167 @@
+/**
+* This file is part of Simox.
+*
+* Simox is free software; you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 2 of
+* the License, or (at your option) any later version.
+*
+* Simox is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+* @package    VirtualRobot
+* @author     Nikolaus Vahrenkamp
+* @copyright  2011 Nikolaus Vahrenkamp
+*             GNU Lesser General Public License
+*
+*/
+#ifndef _VirtualRobot_TestMeshes_h_
+#define _VirtualRobot_TestMeshes_h_
+
+#include <VirtualRobot/VirtualRobot.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Nodes/RobotNode.h>
+#include <VirtualRobot/CollisionDetection/CollisionModel.h>
+#include <VirtualRobot/CollisionDetection/CollisionChecker.h>
+#include <VirtualRobot/Visualization/VisualizationNode.h>
+#include <VirtualRobot/Visualization/TriMeshModel.h>
+#include <string>
+
+#include <Eigen/Core>
+
+/*
+    Mesh based collision models for the VirtualRobot and Saba tests, no visualization factory is needed.
+*/
+namespace VirtualRobotTest
+{
+    //! A visualization that holds a triangle mesh and does not need a visualization factory.
+    class MeshVisualizationNode : public VirtualRobot::VisualizationNode
+    {
+    public:
+        MeshVisualizationNode(VirtualRobot::TriMeshModelPtr model) : model(model)
+        {
+        }
+
+        VirtualRobot::TriMeshModelPtr getTriMeshModel()
+        {
+            return model;
+        }
+
+        // deep copy of the mesh, as done by the Coin visualization
+        VirtualRobot::VisualizationNodePtr clone(bool deepCopy = true, float scaling = 1.0f)
+        {
+            Eigen::Vector3f s(scaling, scaling, scaling);
+            return VirtualRobot::VisualizationNodePtr(new MeshVisualizationNode(model->clone(s)));
+        }
+
+        VirtualRobot::TriMeshModelPtr model;
+    };
+
+    //! An axis aligned box.
+    inline VirtualRobot::TriMeshModelPtr createBoxMesh(const Eigen::Vector3f& minP, const Eigen::Vector3f& maxP)
+    {
+        VirtualRobot::TriMeshModelPtr model(new VirtualRobot::TriMeshModel());
+        Eigen::Vector3f p[8];
+
+        for (int i = 0; i < 8; i++)
+        {
+            p[i] = Eigen::Vector3f((i & 1) ? maxP(0) : minP(0), (i & 2) ? maxP(1) : minP(1), (i & 4) ? maxP(2) : minP(2));
+        }
+
+        const int faces[6][4] = { {0, 1, 3, 2}, {4, 6, 7, 5}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 2, 6, 4}, {1, 5, 7, 3} };
+
+        for (int i = 0; i < 6; i++)
+        {
+            model->addTriangleWithFace(p[faces[i][0]], p[faces[i][1]], p[faces[i][2]]);
+            model->addTriangleWithFace(p[faces[i][0]], p[faces[i][2]], p[faces[i][3]]);
+        }
+
+        return model;
+    }
+
+    inline VirtualRobot::CollisionModelPtr createCollisionModel(VirtualRobot::TriMeshModelPtr model, const std::string& name, VirtualRobot::CollisionCheckerPtr colChecker = VirtualRobot::CollisionCheckerPtr())
+    {
+        VirtualRobot::VisualizationNodePtr visu(new MeshVisualizationNode(model));
+        return VirtualRobot::CollisionModelPtr(new VirtualRobot::CollisionModel(visu, name, colChecker));
+    }
+
+    inline VirtualRobot::CollisionModelPtr createBox(const Eigen::Vector3f& minP, const Eigen::Vector3f& maxP, const std::string& name, VirtualRobot::CollisionCheckerPtr colChecker = VirtualRobot::CollisionCheckerPtr())
+    {
+        return createCollisionModel(createBoxMesh(minP, maxP), name, colChecker);
+    }
+
+    /*!
+        A box (50mm) that moves in the plane: prismatic joints X and Y (+/-1000mm), the collision model is attached to Y.
+        RobotNodeSets: "Planning" (X, Y), "ColModel" (Y).
+    */
+    inline VirtualRobot::RobotPtr createPlanarBoxRobot()
+    {
+        const std::string robotString =
+            "<Robot Type='PlanarBox' RootNode='X'>"
+            " <RobotNode name='X'>"
+            "  <Joint type='prismatic'><Limits unit='mm' lo='-1000' hi='1000'/><TranslationDirection x='1' y='0' z='0'/></Joint>"
+            "  <Child name='Y'/>"
+            " </RobotNode>"
+            " <RobotNode name='Y'>"
+            "  <Joint type='prismatic'><Limits unit='mm' lo='-1000' hi='1000'/><TranslationDirection x='0' y='1' z='0'/></Joint>"
+            " </RobotNode>"
+            " <RobotNodeSet name='Planning'><Node name='X'/><Node name='Y'/></RobotNodeSet>"
+            " <RobotNodeSet name='ColModel'><Node name='Y'/></RobotNodeSet>"
+            "</Robot>";
+        VirtualRobot::RobotPtr robot = VirtualRobot::RobotIO::createRobotFromString(robotString);
+
+        if (robot)
+        {
+            robot->getRobotNode("Y")->setCollisionModel(createBox(Eigen::Vector3f(-25.0f, -25.0f, -25.0f), Eigen::Vector3f(25.0f, 25.0f, 25.0f), "Box"));
+        }
+
+        return robot;
+    }
+
+    /*!
+        A 7 DoF arm with one prismatic joint (J4) and a fixed TCP, the forearm (J5) has a box collision model.
+        RobotNodeSet: "Arm" (J1 - J7, kinematic root Base, tcp TCP).
+    */
+    inline VirtualRobot::RobotPtr createSevenDoFArm()
+    {
+        const std::string robotString =
+            "<Robot Type='MyDemoRobotType' RootNode='Base'>"
+            " <RobotNode name='Base'><Child name='J1'/></RobotNode>"
+            " <RobotNode name='J1'><Transform><Translation x='0' y='0' z='100'/></Transform>"
+            "  <Joint type='revolute'><Limits unit='radian' lo='-3' hi='3'/><Axis x='0' y='0' z='1'/></Joint><Child name='J2'/></RobotNode>"
+            " <RobotNode name='J2'><Transform><Translation x='0' y='0' z='100'/></Transform>"
+            "  <Joint type='revolute'><Limits unit='radian' lo='-2' hi='2'/><Axis x='1' y='0' z='0'/></Joint><Child name='J3'/></RobotNode>"
+            " <RobotNode name='J3'><Transform><Translation x='0' y='0' z='200'/></Transform>"
+            "  <Joint type='revolute'><Limits unit='radian' lo='-3' hi='3'/><Axis x='0' y='0' z='1'/></Joint><Child name='J4'/></RobotNode>"
+            " <RobotNode name='J4'><Transform><Translation x='0' y='0' z='50'/></Transform>"
+            "  <Joint type='prismatic'><Limits unit='mm' lo='0' hi='200'/><TranslationDirection x='0' y='0' z='1'/></Joint><Child name='J5'/></RobotNode>"
+            " <RobotNode name='J5'><Transform><Translation x='0' y='0' z='150'/></Transform>"
+            "  <Joint type='revolute'><Limits unit='radian' lo='-2' hi='2'/><Axis x='1' y='0' z='0'/></Joint><Child name='J6'/></RobotNode>"
+            " <RobotNode name='J6'><Transform><Translation x='0' y='0' z='100'/></Transform>"
+            "  <Joint type='revolute'><Limits unit='radian' lo='-3' hi='3'/><Axis x='0' y='0' z='1'/></Joint><Child name='J7'/></RobotNode>"
+            " <RobotNode name='J7'><Transform><Translation x='0' y='0' z='50'/></Transform>"
+            "  <Joint type='revolute'><Limits unit='radian' lo='-2' hi='2'/><Axis x='0' y='1' z='0'/></Joint><Child name='TCP'/></RobotNode>"
+            " <RobotNode name='TCP'><Transform><Translation x='0' y='20' z='80'/></Transform></RobotNode>"
+            " <RobotNodeSet name='Arm' kinematicRoot='Base' tcp='TCP'>"
+            "  <Node name='J1'/><Node name='J2'/><Node name='J3'/><Node name='J4'/><Node name='J5'/><Node name='J6'/><Node name='J7'/>"
+            " </RobotNodeSet>"
+            "</Robot>";
+        VirtualRobot::RobotPtr robot = VirtualRobot::RobotIO::createRobotFromString(robotString);
+
+        if (robot)
+        {
+            robot->getRobotNode("J5")->setCollisionModel(createBox(Eigen::Vector3f(-30.0f, -30.0f, 0.0f), Eigen::Vector3f(30.0f, 30.0f, 150.0f), "J5", robot->getCollisionChecker()));
+            robot->applyJointValues();
+        }
+
+        return robot;
+    }
+}
+
+#endif /* _VirtualRobot_TestMeshes_h_ */
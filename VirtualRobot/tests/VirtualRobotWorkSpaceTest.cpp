@@ -9,10 +9,70 @@
 #include <VirtualRobot/VirtualRobotTest.h>
 #include <VirtualRobot/MathTools.h>
 #include <VirtualRobot/Workspace/WorkspaceRepresentation.h>
+#include <VirtualRobot/Workspace/Reachability.h>
+#include <VirtualRobot/Workspace/Manipulability.h>
+#include <VirtualRobot/IK/PoseQualityExtendedManipulability.h>
+#include <VirtualRobot/Workspace/WorkspaceDataMapped.h>
+#include <VirtualRobot/Workspace/WorkspaceDataArray.h>
+#include <VirtualRobot/Workspace/WorkspaceDataSparse.h>
 #include <VirtualRobot/XML/RobotIO.h>
+#include <VirtualRobot/Robot.h>
+#include <VirtualRobot/RobotNodeSet.h>
+#include <VirtualRobot/RuntimeEnvironment.h>
 #include <VirtualRobot/VirtualRobotException.h>
 #include <VirtualRobot/MathTools.h>
 #include <string>
+#include <fstream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+namespace
+{
+    //! Evaluates the manipulability of all samples sequentially with the original robot.
+    class SequentialManipulability : public VirtualRobot::Manipulability
+    {
+    public:
+        SequentialManipulability(VirtualRobot::RobotPtr robot) : VirtualRobot::Manipulability(robot)
+        {
+        }
+    protected:
+        virtual bool evaluateSampledTCPPose(SampleThreadData& sampleData, float& storeValue)
+        {
+            return false;
+        }
+    };
+
+    //! Compares every step-th x/y/z block of data with reference, starting at start.
+    void countDifferences(VirtualRobot::WorkspaceDataPtr reference, VirtualRobot::WorkspaceDataPtr data, unsigned int start, unsigned int step, int* storeDiff)
+    {
+        unsigned int v[6];
+        *storeDiff = 0;
+
+        for (unsigned int posTr = start; posTr < reference->getSizeTr(); posTr += step)
+        {
+            v[0] = posTr / (reference->getSize(1) * reference->getSize(2));
+            v[1] = (posTr / reference->getSize(2)) % reference->getSize(1);
+            v[2] = posTr % reference->getSize(2);
+
+            for (v[3] = 0; v[3] < reference->getSize(3); v[3]++)
+                for (v[4] = 0; v[4] < reference->getSize(4); v[4]++)
+                    for (v[5] = 0; v[5] < reference->getSize(5); v[5]++)
+                    {
+                        if (reference->get(v) != data->get(v))
+                        {
+                            (*storeDiff)++;
+                        }
+                    }
+        }
+    }
+}
 
 BOOST_AUTO_TEST_SUITE(WorkSpace)
 
@@ -138,4 +198,529 @@ BOOST_AUTO_TEST_CASE(testWorksSpaceEuler)
 
 }
 
+BOOST_AUTO_TEST_CASE(testWorkSpaceMultiThreaded)
+{
+    std::string filename = "robots/ArmarIII/ArmarIII.xml";
+    bool fileOK = VirtualRobot::RuntimeEnvironment::getDataFileAbsolute(filename);
+    BOOST_REQUIRE(fileOK);
+
+    VirtualRobot::RobotPtr rob;
+    BOOST_REQUIRE_NO_THROW(rob = VirtualRobot::RobotIO::loadRobot(filename, VirtualRobot::RobotIO::eStructure));
+    BOOST_REQUIRE(rob);
+    VirtualRobot::RobotNodeSetPtr rns = rob->getRobotNodeSet("TorsoRightArm");
+    BOOST_REQUIRE(rns);
+    VirtualRobot::RobotNodePtr baseNode = rob->getRobotNode("Platform");
+    BOOST_REQUIRE(baseNode);
+
+    float minB[6] = { -2000.0f, -2000.0f, -2000.0f, float(-M_PI), float(-M_PI), float(-M_PI) };
+    float maxB[6] = { 2000.0f, 2000.0f, 2000.0f, float(M_PI), float(M_PI), float(M_PI) };
+
+    // same seed and number of threads: identical data
+    std::vector<VirtualRobot::ReachabilityPtr> ws;
+
+    for (int i = 0; i < 3; i++)
+    {
+        VirtualRobot::ReachabilityPtr r(new VirtualRobot::Reachability(rob));
+        r->initialize(rns, 200.0f, 1.0f, minB, maxB, VirtualRobot::SceneObjectSetPtr(), VirtualRobot::SceneObjectSetPtr(), baseNode);
+        ws.push_back(r);
+    }
+
+    BOOST_REQUIRE_NO_THROW(ws[0]->addRandomTCPPosesMultiThreaded(5000, 3, 42, false));
+    BOOST_REQUIRE_NO_THROW(ws[1]->addRandomTCPPosesMultiThreaded(5000, 3, 42, false));
+    BOOST_REQUIRE_NO_THROW(ws[2]->addRandomTCPPosesMultiThreaded(5000, 3, 43, false));
+    BOOST_CHECK_GT(ws[0]->getMaxEntry(), 0);
+
+    int nrDiffSameSeed = 0;
+    int nrDiffOtherSeed = 0;
+    unsigned int v[6];
+
+    for (v[0] = 0; v[0] < (unsigned int)ws[0]->getNumVoxels(0); v[0]++)
+        for (v[1] = 0; v[1] < (unsigned int)ws[0]->getNumVoxels(1); v[1]++)
+            for (v[2] = 0; v[2] < (unsigned int)ws[0]->getNumVoxels(2); v[2]++)
+                for (v[3] = 0; v[3] < (unsigned int)ws[0]->getNumVoxels(3); v[3]++)
+                    for (v[4] = 0; v[4] < (unsigned int)ws[0]->getNumVoxels(4); v[4]++)
+                        for (v[5] = 0; v[5] < (unsigned int)ws[0]->getNumVoxels(5); v[5]++)
+                        {
+                            unsigned char e = ws[0]->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]);
+
+                            if (e != ws[1]->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]))
+                            {
+                                nrDiffSameSeed++;
+                            }
+
+                            if (e != ws[2]->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]))
+                            {
+                                nrDiffOtherSeed++;
+                            }
+                        }
+
+    BOOST_CHECK_EQUAL(nrDiffSameSeed, 0);
+    BOOST_CHECK_GT(nrDiffOtherSeed, 0);
+}
+
+BOOST_AUTO_TEST_CASE(testManipulabilityMultiThreaded)
+{
+    std::string filename = "robots/ArmarIII/ArmarIII.xml";
+    bool fileOK = VirtualRobot::RuntimeEnvironment::getDataFileAbsolute(filename);
+    BOOST_REQUIRE(fileOK);
+
+    VirtualRobot::RobotPtr rob;
+    BOOST_REQUIRE_NO_THROW(rob = VirtualRobot::RobotIO::loadRobot(filename, VirtualRobot::RobotIO::eStructure));
+    BOOST_REQUIRE(rob);
+    VirtualRobot::RobotNodeSetPtr rns = rob->getRobotNodeSet("TorsoRightArm");
+    BOOST_REQUIRE(rns);
+    VirtualRobot::RobotNodePtr baseNode = rob->getRobotNode("Platform");
+    BOOST_REQUIRE(baseNode);
+
+    float minB[6] = { -2000.0f, -2000.0f, -2000.0f, float(-M_PI), float(-M_PI), float(-M_PI) };
+    float maxB[6] = { 2000.0f, 2000.0f, 2000.0f, float(M_PI), float(M_PI), float(M_PI) };
+
+    // the manipulability is computed in the worker threads (ws[0]) or sequentially (ws[1]), both with the same samples
+    std::vector<VirtualRobot::ManipulabilityPtr> ws;
+    ws.push_back(VirtualRobot::ManipulabilityPtr(new VirtualRobot::Manipulability(rob)));
+    ws.push_back(VirtualRobot::ManipulabilityPtr(new SequentialManipulability(rob)));
+    double ms[2];
+
+    for (size_t i = 0; i < ws.size(); i++)
+    {
+        VirtualRobot::PoseQualityExtendedManipulabilityPtr measure(new VirtualRobot::PoseQualityExtendedManipulability(rns));
+        ws[i]->setManipulabilityMeasure(measure);
+        ws[i]->setMaxManipulability(0.5f);
+        ws[i]->initialize(rns, 200.0f, 1.0f, minB, maxB, VirtualRobot::SceneObjectSetPtr(), VirtualRobot::SceneObjectSetPtr(), baseNode);
+
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::local_time();
+        BOOST_REQUIRE_NO_THROW(ws[i]->addRandomTCPPosesMultiThreaded(2000, 2, 42, false));
+        ms[i] = (double)(boost::posix_time::microsec_clock::local_time() - start).total_microseconds() / 1000.0;
+    }
+
+    std::cout << "Manipulability (2000 samples, 2 threads): evaluated in worker threads: " << ms[0] << " ms, evaluated sequentially: " << ms[1] << " ms" << std::endl;
+    BOOST_CHECK_GT(ws[0]->getMaxEntry(), 1);
+
+    int nrDiff = 0;
+    unsigned int v[6];
+
+    for (v[0] = 0; v[0] < (unsigned int)ws[0]->getNumVoxels(0); v[0]++)
+        for (v[1] = 0; v[1] < (unsigned int)ws[0]->getNumVoxels(1); v[1]++)
+            for (v[2] = 0; v[2] < (unsigned int)ws[0]->getNumVoxels(2); v[2]++)
+                for (v[3] = 0; v[3] < (unsigned int)ws[0]->getNumVoxels(3); v[3]++)
+                    for (v[4] = 0; v[4] < (unsigned int)ws[0]->getNumVoxels(4); v[4]++)
+                        for (v[5] = 0; v[5] < (unsigned int)ws[0]->getNumVoxels(5); v[5]++)
+                        {
+                            if (ws[0]->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]) != ws[1]->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]))
+                            {
+                                nrDiff++;
+                            }
+                        }
+
+    BOOST_CHECK_EQUAL(nrDiff, 0);
+}
+
+BOOST_AUTO_TEST_CASE(testWorkSpaceBlockIndexedFile)
+{
+    std::string filename = "robots/ArmarIII/ArmarIII.xml";
+    bool fileOK = VirtualRobot::RuntimeEnvironment::getDataFileAbsolute(filename);
+    BOOST_REQUIRE(fileOK);
+
+    VirtualRobot::RobotPtr rob;
+    BOOST_REQUIRE_NO_THROW(rob = VirtualRobot::RobotIO::loadRobot(filename, VirtualRobot::RobotIO::eStructure));
+    BOOST_REQUIRE(rob);
+    VirtualRobot::RobotNodeSetPtr rns = rob->getRobotNodeSet("TorsoRightArm");
+    BOOST_REQUIRE(rns);
+    VirtualRobot::RobotNodePtr baseNode = rob->getRobotNode("Platform");
+    BOOST_REQUIRE(baseNode);
+
+    float minB[6] = { -2000.0f, -2000.0f, -2000.0f, float(-M_PI), float(-M_PI), float(-M_PI) };
+    float maxB[6] = { 2000.0f, 2000.0f, 2000.0f, float(M_PI), float(M_PI), float(M_PI) };
+
+    VirtualRobot::ReachabilityPtr ws(new VirtualRobot::Reachability(rob));
+    ws->initialize(rns, 200.0f, 1.0f, minB, maxB, VirtualRobot::SceneObjectSetPtr(), VirtualRobot::SceneObjectSetPtr(), baseNode);
+    BOOST_REQUIRE_NO_THROW(ws->addRandomTCPPosesMultiThreaded(5000, 2, 42, false));
+
+    const std::string fileCompressed = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vr_ws_rle_%%%%%%%%.bin")).string();
+    const std::string fileUncompressed = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vr_ws_raw_%%%%%%%%.bin")).string();
+    const std::string fileStandard = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vr_ws_std_%%%%%%%%.bin")).string();
+    BOOST_REQUIRE_NO_THROW(ws->save(fileCompressed, VirtualRobot::WorkspaceRepresentation::eBlockIndexed, true));
+    BOOST_REQUIRE_NO_THROW(ws->save(fileUncompressed, VirtualRobot::WorkspaceRepresentation::eBlockIndexed, false));
+
+    std::vector<VirtualRobot::ReachabilityPtr> loaded;
+
+    for (int i = 0; i < 2; i++)
+    {
+        VirtualRobot::ReachabilityPtr r(new VirtualRobot::Reachability(rob));
+        BOOST_REQUIRE_NO_THROW(r->load(i == 0 ? fileCompressed : fileUncompressed));
+        loaded.push_back(r);
+    }
+
+    // blocks are decoded on access
+    VirtualRobot::WorkspaceDataMappedPtr mappedData = boost::dynamic_pointer_cast<VirtualRobot::WorkspaceDataMapped>(loaded[0]->getData());
+    BOOST_REQUIRE(mappedData);
+    BOOST_CHECK_EQUAL(mappedData->getNrOfCachedBlocks(), 0u);
+    mappedData->setMaxCachedBlocks(4);
+    BOOST_CHECK_EQUAL(loaded[0]->getMaxEntry(), ws->getMaxEntry());
+
+    int nrDiff = 0;
+    unsigned int v[6];
+
+    for (v[0] = 0; v[0] < (unsigned int)ws->getNumVoxels(0); v[0]++)
+        for (v[1] = 0; v[1] < (unsigned int)ws->getNumVoxels(1); v[1]++)
+            for (v[2] = 0; v[2] < (unsigned int)ws->getNumVoxels(2); v[2]++)
+                for (v[3] = 0; v[3] < (unsigned int)ws->getNumVoxels(3); v[3]++)
+                    for (v[4] = 0; v[4] < (unsigned int)ws->getNumVoxels(4); v[4]++)
+                        for (v[5] = 0; v[5] < (unsigned int)ws->getNumVoxels(5); v[5]++)
+                        {
+                            unsigned char e = ws->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]);
+
+                            for (size_t i = 0; i < loaded.size(); i++)
+                            {
+                                if (e != loaded[i]->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]))
+                                {
+                                    nrDiff++;
+                                }
+                            }
+                        }
+
+    BOOST_CHECK_EQUAL(nrDiff, 0);
+    BOOST_CHECK_GT(mappedData->getNrOfCachedBlocks(), 0u);
+    BOOST_CHECK_LE(mappedData->getNrOfCachedBlocks(), 4u);
+
+    // concurrent queries of compressed (evicted from the small cache) and uncompressed blocks
+    for (size_t i = 0; i < loaded.size(); i++)
+    {
+        const unsigned int nrThreads = 4;
+        std::vector<int> diffs(nrThreads);
+        boost::thread_group threads;
+
+        for (unsigned int t = 0; t < nrThreads; t++)
+        {
+            threads.create_thread(boost::bind(&countDifferences, ws->getData(), loaded[i]->getData(), t, nrThreads, &diffs[t]));
+        }
+
+        threads.join_all();
+
+        for (unsigned int t = 0; t < nrThreads; t++)
+        {
+            BOOST_CHECK_EQUAL(diffs[t], 0);
+        }
+    }
+
+    BOOST_CHECK_LE(mappedData->getNrOfCachedBlocks(), 4u);
+
+    // convert to the standard format
+    BOOST_REQUIRE_NO_THROW(loaded[0]->save(fileStandard));
+    VirtualRobot::ReachabilityPtr ws2(new VirtualRobot::Reachability(rob));
+    BOOST_REQUIRE_NO_THROW(ws2->load(fileStandard));
+    BOOST_CHECK(!boost::dynamic_pointer_cast<VirtualRobot::WorkspaceDataMapped>(ws2->getData()));
+    BOOST_CHECK_EQUAL(ws2->getData()->getVoxelFilledCount(), ws->getData()->getVoxelFilledCount());
+
+    nrDiff = 0;
+
+    for (v[0] = 0; v[0] < (unsigned int)ws->getNumVoxels(0); v[0]++)
+        for (v[1] = 0; v[1] < (unsigned int)ws->getNumVoxels(1); v[1]++)
+            for (v[2] = 0; v[2] < (unsigned int)ws->getNumVoxels(2); v[2]++)
+                for (v[3] = 0; v[3] < (unsigned int)ws->getNumVoxels(3); v[3]++)
+                    for (v[4] = 0; v[4] < (unsigned int)ws->getNumVoxels(4); v[4]++)
+                        for (v[5] = 0; v[5] < (unsigned int)ws->getNumVoxels(5); v[5]++)
+                        {
+                            if (ws->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]) != ws2->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]))
+                            {
+                                nrDiff++;
+                            }
+                        }
+
+    BOOST_CHECK_EQUAL(nrDiff, 0);
+
+    loaded.clear();
+    mappedData.reset();
+    std::remove(fileCompressed.c_str());
+    std::remove(fileUncompressed.c_str());
+    std::remove(fileStandard.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(testWorkSpaceBlockIndexedCorruptBlock)
+{
+    VirtualRobot::WorkspaceDataPtr data(new VirtualRobot::WorkspaceDataArray(2, 2, 2, 4, 4, 4, true));
+    unsigned int v[6] = { 1, 0, 1, 2, 3, 1 };
+    data->setDatum(v, 7);
+
+    const std::string filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vr_ws_corrupt_%%%%%%%%.bin")).string();
+    {
+        std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+        BOOST_REQUIRE(VirtualRobot::WorkspaceDataMapped::saveBlockIndexed(file, data, true));
+    }
+
+    {
+        VirtualRobot::WorkspaceDataMapped mapped(filename, 0, 2, 2, 2, 4, 4, 4, 4, true);
+        BOOST_CHECK_EQUAL(mapped.get(v), 7);
+    }
+
+    // header: sizeTr, sizeRot, end; index entries: offset, size, encoding
+    const unsigned int posTr = v[0] * 4 + v[1] * 2 + v[2];
+    uint64_t offset;
+    uint32_t size, encoding;
+    {
+        std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+        file.seekg(16 + posTr * 16);
+        file.read((char*)&offset, sizeof(uint64_t));
+        file.read((char*)&size, sizeof(uint32_t));
+        file.read((char*)&encoding, sizeof(uint32_t));
+        BOOST_REQUIRE(file.good());
+        BOOST_REQUIRE_EQUAL(encoding, 2u); // RLE
+    }
+
+    // let the first run expand far beyond the size of a block
+    {
+        std::vector<unsigned char> block(size);
+        std::fstream file(filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(offset);
+        file.read((char*)&block[0], size);
+        BOOST_REQUIRE(file.good() && size >= 3);
+        block[1] = block[0];
+        block[2] = 0xFF;
+        file.seekp(offset);
+        file.write((char*)&block[0], size);
+        BOOST_REQUIRE(file.good());
+    }
+
+    {
+        VirtualRobot::WorkspaceDataMapped mapped(filename, 0, 2, 2, 2, 4, 4, 4, 4, true);
+        BOOST_CHECK_THROW(mapped.get(v), VirtualRobot::VirtualRobotException);
+        BOOST_CHECK_EQUAL(mapped.getNrOfCachedBlocks(), 0u);
+    }
+
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(testWorkSpaceSparseData)
+{
+    VirtualRobot::WorkspaceDataArray dense(4, 4, 4, 10, 10, 10, true);
+    VirtualRobot::WorkspaceDataSparse sparse(4, 4, 4, 10, 10, 10, true);
+    srand(42);
+
+    for (int i = 0; i < 5000; i++)
+    {
+        unsigned int v[6];
+
+        for (int j = 0; j < 6; j++)
+        {
+            v[j] = rand() % (j < 3 ? 4 : 10);
+        }
+
+        if (i % 10 == 0)
+        {
+            unsigned char value = (unsigned char)(rand() % 5);
+            dense.setDatum(v, value);
+            sparse.setDatum(v, value);
+        }
+        else
+        {
+            dense.increaseDatum(v);
+            sparse.increaseDatum(v);
+        }
+    }
+
+    VirtualRobot::WorkspaceDataSparse* sparseClone = static_cast<VirtualRobot::WorkspaceDataSparse*>(sparse.clone());
+    BOOST_REQUIRE(sparseClone);
+    int nrDiff = 0;
+
+    for (unsigned int a = 0; a < 4; a++)
+        for (unsigned int b = 0; b < 4; b++)
+            for (unsigned int c = 0; c < 4; c++)
+            {
+                if (dense.hasEntry(a, b, c) != sparse.hasEntry(a, b, c))
+                {
+                    nrDiff++;
+                }
+
+                const unsigned char* rotDense = dense.getDataRot(a, b, c);
+                const unsigned char* rotSparse = sparse.getDataRot(a, b, c);
+
+                if (memcmp(rotDense, rotSparse, dense.getSizeRot()) != 0)
+                {
+                    nrDiff++;
+                }
+
+                for (unsigned int d = 0; d < 10; d++)
+                    for (unsigned int e = 0; e < 10; e++)
+                        for (unsigned int f = 0; f < 10; f++)
+                        {
+                            if (dense.get(a, b, c, d, e, f) != sparse.get(a, b, c, d, e, f) || dense.get(a, b, c, d, e, f) != sparseClone->get(a, b, c, d, e, f))
+                            {
+                                nrDiff++;
+                            }
+                        }
+            }
+
+    BOOST_CHECK_EQUAL(nrDiff, 0);
+    BOOST_CHECK_EQUAL(dense.getVoxelFilledCount(), sparse.getVoxelFilledCount());
+    BOOST_CHECK_EQUAL(dense.getMaxEntry(), sparse.getMaxEntry());
+    delete sparseClone;
+
+    // rotation data
+    unsigned char rot[1000];
+
+    for (int i = 0; i < 1000; i++)
+    {
+        rot[i] = (i % 7 == 0) ? (unsigned char)(i % 255) : 0;
+    }
+
+    sparse.setDataRot(rot, 1, 2, 3);
+    BOOST_CHECK_EQUAL(memcmp(rot, sparse.getDataRot(1, 2, 3), 1000), 0);
+
+    sparse.bisectData();
+    dense.bisectData();
+    nrDiff = 0;
+
+    for (unsigned int a = 0; a < 4; a++)
+        for (unsigned int b = 0; b < 4; b++)
+            for (unsigned int c = 0; c < 4; c++)
+            {
+                if (a == 1 && b == 2 && c == 3)
+                {
+                    continue;
+                }
+
+                for (unsigned int d = 0; d < 10; d++)
+                    for (unsigned int e = 0; e < 10; e++)
+                        for (unsigned int f = 0; f < 10; f++)
+                        {
+                            if (dense.get(a, b, c, d, e, f) != sparse.get(a, b, c, d, e, f))
+                            {
+                                nrDiff++;
+                            }
+                        }
+            }
+
+    BOOST_CHECK_EQUAL(nrDiff, 0);
+
+    sparse.clear();
+    BOOST_CHECK(!sparse.hasEntry(1, 2, 3));
+    BOOST_CHECK_EQUAL(sparse.get(1, 2, 3, 0, 0, 0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testWorkSpaceSparseDataReachability)
+{
+    std::string filename = "robots/ArmarIII/ArmarIII.xml";
+    bool fileOK = VirtualRobot::RuntimeEnvironment::getDataFileAbsolute(filename);
+    BOOST_REQUIRE(fileOK);
+
+    VirtualRobot::RobotPtr rob;
+    BOOST_REQUIRE_NO_THROW(rob = VirtualRobot::RobotIO::loadRobot(filename, VirtualRobot::RobotIO::eStructure));
+    BOOST_REQUIRE(rob);
+    VirtualRobot::RobotNodeSetPtr rns = rob->getRobotNodeSet("TorsoRightArm");
+    BOOST_REQUIRE(rns);
+    VirtualRobot::RobotNodePtr baseNode = rob->getRobotNode("Platform");
+    BOOST_REQUIRE(baseNode);
+
+    float minB[6] = { -2000.0f, -2000.0f, -2000.0f, float(-M_PI), float(-M_PI), float(-M_PI) };
+    float maxB[6] = { 2000.0f, 2000.0f, 2000.0f, float(M_PI), float(M_PI), float(M_PI) };
+
+    VirtualRobot::ReachabilityPtr ws(new VirtualRobot::Reachability(rob));
+    ws->initialize(rns, 200.0f, 1.0f, minB, maxB, VirtualRobot::SceneObjectSetPtr(), VirtualRobot::SceneObjectSetPtr(), baseNode);
+    VirtualRobot::ReachabilityPtr wsSparse(new VirtualRobot::Reachability(rob));
+    wsSparse->setUseSparseData(true);
+    wsSparse->initialize(rns, 200.0f, 1.0f, minB, maxB, VirtualRobot::SceneObjectSetPtr(), VirtualRobot::SceneObjectSetPtr(), baseNode);
+    BOOST_REQUIRE(boost::dynamic_pointer_cast<VirtualRobot::WorkspaceDataSparse>(wsSparse->getData()));
+
+    BOOST_REQUIRE_NO_THROW(ws->addRandomTCPPosesMultiThreaded(5000, 2, 42, false));
+    BOOST_REQUIRE_NO_THROW(wsSparse->addRandomTCPPosesMultiThreaded(5000, 2, 42, false));
+
+    // store and load with sparse data
+    const std::string fileSparse = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vr_ws_sparse_%%%%%%%%.bin")).string();
+    BOOST_REQUIRE_NO_THROW(wsSparse->save(fileSparse));
+    VirtualRobot::ReachabilityPtr wsLoaded(new VirtualRobot::Reachability(rob));
+    wsLoaded->setUseSparseData(true);
+    BOOST_REQUIRE_NO_THROW(wsLoaded->load(fileSparse));
+    BOOST_CHECK(boost::dynamic_pointer_cast<VirtualRobot::WorkspaceDataSparse>(wsLoaded->getData()));
+    std::remove(fileSparse.c_str());
+
+    int nrDiff = 0;
+    unsigned int v[6];
+
+    for (v[0] = 0; v[0] < (unsigned int)ws->getNumVoxels(0); v[0]++)
+        for (v[1] = 0; v[1] < (unsigned int)ws->getNumVoxels(1); v[1]++)
+            for (v[2] = 0; v[2] < (unsigned int)ws->getNumVoxels(2); v[2]++)
+                for (v[3] = 0; v[3] < (unsigned int)ws->getNumVoxels(3); v[3]++)
+                    for (v[4] = 0; v[4] < (unsigned int)ws->getNumVoxels(4); v[4]++)
+                        for (v[5] = 0; v[5] < (unsigned int)ws->getNumVoxels(5); v[5]++)
+                        {
+                            unsigned char e = ws->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]);
+
+                            if (e != wsSparse->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]) || e != wsLoaded->getVoxelEntry(v[0], v[1], v[2], v[3], v[4], v[5]))
+                            {
+                                nrDiff++;
+                            }
+                        }
+
+    BOOST_CHECK_EQUAL(nrDiff, 0);
+    BOOST_CHECK_EQUAL(ws->getMaxEntry(), wsSparse->getMaxEntry());
+}
+
+BOOST_AUTO_TEST_CASE(testWorkSpaceSparseDataBenchmark)
+{
+    // typical 6D data: positions are partly covered, only few orientations are reachable per position
+    const unsigned int s[6] = { 16, 16, 16, 20, 20, 20 };
+    VirtualRobot::WorkspaceDataArray dense(s[0], s[1], s[2], s[3], s[4], s[5], false);
+    VirtualRobot::WorkspaceDataSparse sparse(s[0], s[1], s[2], s[3], s[4], s[5], false);
+    srand(42);
+    unsigned int nrBlocks = 0;
+
+    for (unsigned int a = 0; a < s[0]; a++)
+        for (unsigned int b = 0; b < s[1]; b++)
+            for (unsigned int c = 0; c < s[2]; c++)
+            {
+                if (rand() % 100 >= 40)
+                {
+                    continue;
+                }
+
+                nrBlocks++;
+
+                for (int i = 0; i < 100; i++)
+                {
+                    unsigned int v[6] = { a, b, c, (unsigned int)rand() % s[3], (unsigned int)rand() % s[4], (unsigned int)rand() % s[5] };
+                    dense.increaseDatum(v);
+                    sparse.increaseDatum(v);
+                }
+            }
+
+    unsigned long long memoryDense = (unsigned long long)dense.getSizeTr() * sizeof(unsigned char*) + (unsigned long long)nrBlocks * dense.getSizeRot();
+    unsigned long long memorySparse = sparse.getMemoryUsage();
+    BOOST_CHECK_LT(memorySparse, memoryDense);
+
+    const int nrQueries = 1000000;
+    std::vector<unsigned int> queries(nrQueries * 6);
+
+    for (int i = 0; i < nrQueries; i++)
+    {
+        for (int j = 0; j < 6; j++)
+        {
+            queries[i * 6 + j] = (unsigned int)rand() % s[j];
+        }
+    }
+
+    clock_t t1 = clock();
+    unsigned int sumDense = 0;
+
+    for (int i = 0; i < nrQueries; i++)
+    {
+        sumDense += dense.get(&(queries[i * 6]));
+    }
+
+    clock_t t2 = clock();
+    unsigned int sumSparse = 0;
+
+    for (int i = 0; i < nrQueries; i++)
+    {
+        sumSparse += sparse.get(&(queries[i * 6]));
+    }
+
+    clock_t t3 = clock();
+    BOOST_CHECK_EQUAL(sumDense, sumSparse);
+
+    std::cout << "Workspace data (" << nrBlocks << " of " << dense.getSizeTr() << " positions, " << sparse.getVoxelFilledCount() << " entries): memory dense: "
+              << memoryDense / 1024 << " KB, sparse: " << memorySparse / 1024 << " KB; "
+              << nrQueries << " queries dense: " << (float)(t2 - t1) / (float)CLOCKS_PER_SEC * 1000.0f << " ms, sparse: "
+              << (float)(t3 - t2) / (float)CLOCKS_PER_SEC * 1000.0f << " ms" << std::endl;
+}
+
 BOOST_AUTO_TEST_SUITE_END()